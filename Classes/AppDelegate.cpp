@@ -24,7 +24,11 @@
 
 #include "AppDelegate.h"
 #include "GameScene.h"
+#include "configs/GameConfig.h"
+#include "2d/CCFontAtlasCache.h"
 #include "utils/LevelConfigLoader.h"
+#include "managers/AnalyticsManager.h"
+#include "services/GameSnapshotService.h"
 
 // #define USE_AUDIO_ENGINE 1
 // #define USE_SIMPLE_AUDIO_ENGINE 1
@@ -48,12 +52,17 @@ static cocos2d::Size smallResolutionSize = cocos2d::Size(480, 320);
 static cocos2d::Size mediumResolutionSize = cocos2d::Size(1024, 768);
 static cocos2d::Size largeResolutionSize = cocos2d::Size(2048, 1536);
 
+// 埋点上报地址，为空时事件只缓存在本地
+static const char* kAnalyticsUploadUrl = "";
+
 AppDelegate::AppDelegate()
 {
 }
 
 AppDelegate::~AppDelegate() 
 {
+    // AnalyticsManager 已在 Director 重置时把未上报的事件写入缓存文件，下次启动后继续上报
+
 #if USE_AUDIO_ENGINE
     AudioEngine::end();
 #elif USE_SIMPLE_AUDIO_ENGINE
@@ -88,8 +97,25 @@ bool AppDelegate::applicationDidFinishLaunching() {
         director->setOpenGLView(glview);
     }
     
-    // 创建游戏场景
-    Scene* scene = GameScene::create(1);
+    // 界面文字的字体图集缓存在可写目录，下次启动直接加载，不用再渲染字形
+    FontAtlasCache::setDiskCacheEnabled(true);
+    if (FileUtils::getInstance()->isFileExist(GameConfig::kUIFontFile)) {
+        TTFConfig fontConfig(GameConfig::kUIFontFile, GameConfig::kUIFontSize);
+        FontAtlasCache::preloadFontAtlasTTF(&fontConfig, GameConfig::kUIFontPreloadText);
+    }
+    
+    // 启动埋点管线
+    AnalyticsManager::getInstance()->start(kAnalyticsUploadUrl);
+    
+    // 有未完成的关卡时直接恢复，否则从第一关开始
+    Scene* scene = nullptr;
+    GameSnapshot snapshot;
+    if (GameSnapshotService::loadSnapshot(snapshot)) {
+        scene = GameScene::createWithSnapshot(snapshot);
+    }
+    if (!scene) {
+        scene = GameScene::create(1);
+    }
     director->runWithScene(scene);
     
     return true;
@@ -99,6 +125,15 @@ bool AppDelegate::applicationDidFinishLaunching() {
 void AppDelegate::applicationDidEnterBackground() {
     Director::getInstance()->stopAnimation();
 
+    // 切到后台时进程可能被杀掉，先落盘
+    AnalyticsManager::getInstance()->flush();
+    
+    // 保存新渲染的字形
+    FontAtlasCache::saveToDiskCache();
+    
+    // 保存当前关卡的快照，下次启动时恢复
+    Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(GameSnapshotService::EVENT_SAVE_SNAPSHOT);
+
 #if USE_AUDIO_ENGINE
     AudioEngine::pauseAll();
 #elif USE_SIMPLE_AUDIO_ENGINE
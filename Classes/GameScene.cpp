@@ -17,6 +17,17 @@ GameScene* GameScene::create(int levelId)
     return nullptr;
 }
 
+GameScene* GameScene::createWithSnapshot(const GameSnapshot& snapshot)
+{
+    GameScene* scene = new GameScene();
+    if (scene && scene->initWithSnapshot(snapshot)) {
+        scene->autorelease();
+        return scene;
+    }
+    CC_SAFE_DELETE(scene);
+    return nullptr;
+}
+
 GameScene::GameScene()
     : _gameController(nullptr)
 {
@@ -63,3 +74,34 @@ bool GameScene::initWithLevelId(int levelId)
     
     return true;
 }
+
+bool GameScene::initWithSnapshot(const GameSnapshot& snapshot)
+{
+    if (!Scene::init()) {
+        return false;
+    }
+    
+    // 创建游戏控制器
+    _gameController = GameController::create();
+    if (!_gameController) {
+        return false;
+    }
+    
+    _gameController->retain();
+    
+    // 从快照恢复控制器，不重新加载关卡配置
+    if (!_gameController->initWithSnapshot(snapshot)) {
+        return false;
+    }
+    
+    // 获取游戏视图并添加到场景
+    GameView* gameView = _gameController->getGameView();
+    if (gameView) {
+        addChild(gameView);
+    }
+    
+    // 启动游戏
+    _gameController->startGame();
+    
+    return true;
+}
@@ -32,6 +32,20 @@ public:
      */
     bool initWithLevelId(int levelId);
     
+    /**
+     * @brief 从存档快照创建游戏场景
+     * @param snapshot 关卡快照
+     * @return GameScene* 游戏场景指针，快照无效时返回nullptr
+     */
+    static GameScene* createWithSnapshot(const GameSnapshot& snapshot);
+    
+    /**
+     * @brief 从存档快照初始化场景
+     * @param snapshot 关卡快照
+     * @return bool 是否初始化成功
+     */
+    bool initWithSnapshot(const GameSnapshot& snapshot);
+    
 protected:
     GameScene();
     virtual ~GameScene();
@@ -36,6 +36,12 @@ public:
     static constexpr float kCardMoveAnimationDuration = 0.3f;
     static constexpr float kCardFlipAnimationDuration = 0.2f;
     
+    // 界面文字的字体，需要包含中文字形；文件不存在时退回系统字体
+    static constexpr const char* kUIFontFile = "fonts/NotoSansSC-Regular.otf";
+    static constexpr float kUIFontSize = 36.0f;
+    // 启动时预先渲染进字体图集的文字
+    static constexpr const char* kUIFontPreloadText = "回退";
+    
     // 区域位置
     static constexpr float kPlayfieldPosY = 1500.0f;    // 主牌区Y坐标
     static constexpr float kStackAreaPosY = 750.0f;     // 堆牌区Y坐标
@@ -7,6 +7,8 @@
 #include "../services/GameModelGenerator.h"
 #include "../views/CardView.h"
 #include "../configs/GameConfig.h"
+#include "../managers/AnalyticsManager.h"
+#include "../services/GameSnapshotService.h"
 
 GameController* GameController::create()
 {
@@ -23,6 +25,8 @@ GameController::GameController()
     : _gameModel(nullptr)
     , _gameView(nullptr)
     , _undoManager(nullptr)
+    , _saveSnapshotListener(nullptr)
+    , _levelId(0)
     , _selectedCardId(-1)
     , _currentGameState(GameStateType::IDLE)
 {
@@ -30,6 +34,10 @@ GameController::GameController()
 
 GameController::~GameController()
 {
+    if (_saveSnapshotListener) {
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_saveSnapshotListener);
+        _saveSnapshotListener = nullptr;
+    }
     if (_gameModel) {
         delete _gameModel;
         _gameModel = nullptr;
@@ -48,6 +56,8 @@ bool GameController::_initialize()
 
 bool GameController::initWithLevelConfig(const LevelConfig& levelConfig)
 {
+    _levelId = levelConfig.levelId;
+    
     if (!_initializeModel(levelConfig)) {
         return false;
     }
@@ -61,6 +71,30 @@ bool GameController::initWithLevelConfig(const LevelConfig& levelConfig)
     return true;
 }
 
+bool GameController::initWithSnapshot(const GameSnapshot& snapshot)
+{
+    _levelId = snapshot.levelId;
+    
+    // 直接从快照重建模型，不需要重新解析关卡配置
+    _gameModel = GameSnapshotService::restoreGameModel(snapshot);
+    if (!_gameModel) {
+        return false;
+    }
+    
+    if (!_initializeUndoManager()) {
+        return false;
+    }
+    _undoManager->restoreRecords(snapshot.undoRecords);
+    
+    if (!_initializeView()) {
+        return false;
+    }
+    
+    _bindCallbacks();
+    
+    return true;
+}
+
 bool GameController::_initializeModel(const LevelConfig& levelConfig)
 {
     // 使用服务生成游戏模型
@@ -69,6 +103,11 @@ bool GameController::_initializeModel(const LevelConfig& levelConfig)
         return false;
     }
     
+    return _initializeUndoManager();
+}
+
+bool GameController::_initializeUndoManager()
+{
     // 创建撤销管理器
     _undoManager = UndoManager::create(_gameModel);
     if (!_undoManager) {
@@ -145,6 +184,12 @@ void GameController::_bindCallbacks()
             }
         });
     }
+    
+    // 切到后台时保存快照（由AppDelegate派发）
+    _saveSnapshotListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(
+        GameSnapshotService::EVENT_SAVE_SNAPSHOT, [this](EventCustom*) {
+            this->saveSnapshot();
+        });
 }
 
 bool GameController::handleCardClick(int cardId)
@@ -159,13 +204,18 @@ bool GameController::handleCardClick(int cardId)
     }
     
     // 分两种情况处理：Playfield卡牌的匹配 和 Stack卡牌的补牌
-    if (clickedCard->getArea() == CardAreaType::PLAYFIELD) {
-        return _handlePlayfieldCardClick(cardId, clickedCard);
-    } else if (clickedCard->getArea() == CardAreaType::STACK) {
-        return _handleStackCardClick(cardId, clickedCard);
+    CardAreaType area = clickedCard->getArea();
+    bool handled = false;
+    if (area == CardAreaType::PLAYFIELD) {
+        handled = _handlePlayfieldCardClick(cardId, clickedCard);
+    } else if (area == CardAreaType::STACK) {
+        handled = _handleStackCardClick(cardId, clickedCard);
     }
     
-    return false;
+    // 埋点：卡牌ID、区域、是否生效
+    AnalyticsManager::getInstance()->logEvent("card_click", cardId, static_cast<int>(area), handled ? 1 : 0);
+    
+    return handled;
 }
 
 bool GameController::_handlePlayfieldCardClick(int cardId, Card* clickedCard)
@@ -189,12 +239,10 @@ bool GameController::_handlePlayfieldCardClick(int cardId, Card* clickedCard)
     
     // 记录撤销信息
     UndoRecord undoRecord = _createMatchUndoRecord(cardId, clickedCard, rightStackCard);
-    if (_undoManager) {
-        _undoManager->recordUndo(undoRecord);
-    }
+    int undoSerial = _undoManager ? _undoManager->recordUndo(undoRecord) : -1;
     
     // 执行匹配动画
-    _executeMatchAnimation(cardId, clickedCard, rightStackCard);
+    _executeMatchAnimation(cardId, clickedCard, rightStackCard, undoSerial);
     
     return true;
 }
@@ -218,17 +266,19 @@ UndoRecord GameController::_createMatchUndoRecord(int cardId, Card* clickedCard,
     return undoRecord;
 }
 
-void GameController::_executeMatchAnimation(int cardId, Card* clickedCard, Card* rightStackCard)
+void GameController::_executeMatchAnimation(int cardId, Card* clickedCard, Card* rightStackCard, int undoSerial)
 {
     CardView* clickedCardView = _gameView->getCardViewById(cardId);
     CardView* rightStackCardView = _gameView->getCardViewById(rightStackCard->getCardId());
     
     if (clickedCardView && rightStackCardView) {
         Vec2 targetPos = rightStackCard->getPosition();
+        _pendingUndoSerials.insert(undoSerial);
         clickedCardView->playMoveAnimation(
             targetPos,
             GameConfig::kCardMoveAnimationDuration,
-            [this, clickedCard, rightStackCard]() {
+            [this, clickedCard, rightStackCard, undoSerial]() {
+                _pendingUndoSerials.erase(undoSerial);
                 _updateModelAfterMatch(clickedCard, rightStackCard);
                 _refreshStackDisplay();
             }
@@ -258,6 +308,14 @@ void GameController::_updateModelAfterMatch(Card* clickedCard, Card* rightStackC
     
     // 将点击的卡牌添加到Stack中作为新的右边牌
     _gameModel->addStackCard(clickedCard);
+    
+    // 主牌区清空即通关，埋点：关卡ID、结果（1通关）、剩余Stack卡牌数
+    if (_gameModel->getPlayfieldCards().empty()) {
+        AnalyticsManager::getInstance()->logEvent("level_result", _levelId, 1, static_cast<int>(_gameModel->getStackCards().size()));
+        
+        // 关卡已结束，下次启动不再恢复
+        GameSnapshotService::clearSnapshot();
+    }
 }
 
 bool GameController::_handleStackCardClick(int cardId, Card* clickedCard)
@@ -304,9 +362,7 @@ bool GameController::_handleStackCardClick(int cardId, Card* clickedCard)
         undoRecord.stackCardIds.push_back(card->getCardId());
     }
     
-    if (_undoManager) {
-        _undoManager->recordUndo(undoRecord);
-    }
+    int undoSerial = _undoManager ? _undoManager->recordUndo(undoRecord) : -1;
     
     // 获取点击卡牌的视图
     CardView* clickedCardView = _gameView->getCardViewById(cardId);
@@ -315,10 +371,13 @@ bool GameController::_handleStackCardClick(int cardId, Card* clickedCard)
     if (clickedCardView && rightStackCardView) {
         // 执行动画：将左边堆的卡牌移动到右边
         Vec2 targetPos = rightStackCard->getPosition();
+        _pendingUndoSerials.insert(undoSerial);
         clickedCardView->playMoveAnimation(
             targetPos,
             GameConfig::kCardMoveAnimationDuration,
-            [this, clickedCard, rightStackCard, cardId]() {
+            [this, clickedCard, rightStackCard, cardId, undoSerial]() {
+                _pendingUndoSerials.erase(undoSerial);
+                
                 // 从Sta ck中移除右边的质底牌
                 _gameModel->removeStackCard(rightStackCard);
                 
@@ -469,11 +528,12 @@ bool GameController::handleUndo()
         return false;
     }
     
-    if (!_undoManager->hasUndo()) {
-        return false;
-    }
+    bool succeed = _undoManager->hasUndo() && _undoManager->executeUndo();
     
-    return _undoManager->executeUndo();
+    // 埋点：关卡ID、是否成功
+    AnalyticsManager::getInstance()->logEvent("undo", _levelId, succeed ? 1 : 0);
+    
+    return succeed;
 }
 
 void GameController::startGame()
@@ -490,14 +550,38 @@ void GameController::stopGame()
         _gameModel->setGameState(GameStateType::PAUSED);
         _currentGameState = GameStateType::PAUSED;
     }
+    
+    saveSnapshot();
 }
 
 void GameController::restartGame()
 {
+    // 埋点：重开视为放弃当前关卡（结果0），附带剩余主牌区卡牌数
+    if (_gameModel && !_gameModel->getPlayfieldCards().empty()) {
+        AnalyticsManager::getInstance()->logEvent("level_result", _levelId, 0, static_cast<int>(_gameModel->getPlayfieldCards().size()));
+    }
+    
     // 清空撤销历史
     if (_undoManager) {
         _undoManager->clearAll();
     }
     
+    // 放弃的关卡不再恢复
+    GameSnapshotService::clearSnapshot();
+    
     // 可以在这里添加重启逻辑
 }
+
+void GameController::saveSnapshot()
+{
+    // 主牌区已清空说明关卡结束，不需要保存
+    if (!_gameModel || _gameModel->getPlayfieldCards().empty()) {
+        return;
+    }
+    
+    // 动画中的操作已经记录了撤销、但模型还没更新，去掉这些记录使快照与模型一致
+    GameSnapshot snapshot = GameSnapshotService::captureSnapshot(
+        _levelId, _gameModel, _undoManager ? _undoManager->getUndoModel() : nullptr, _pendingUndoSerials);
+    
+    GameSnapshotService::saveSnapshotAsync(std::move(snapshot));
+}
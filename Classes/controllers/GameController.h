@@ -12,6 +12,8 @@
 #include "../views/GameView.h"
 #include "../managers/UndoManager.h"
 #include "../configs/LevelConfig.h"
+#include "../models/GameSnapshot.h"
+#include <set>
 
 USING_NS_CC;
 
@@ -41,6 +43,13 @@ public:
      */
     bool initWithLevelConfig(const LevelConfig& levelConfig);
     
+    /**
+     * @brief 从存档快照恢复游戏
+     * @param snapshot 关卡快照
+     * @return bool 是否恢复成功
+     */
+    bool initWithSnapshot(const GameSnapshot& snapshot);
+    
     /**
      * @brief 获取游戏模型
      * @return GameModel* 游戏模型
@@ -81,6 +90,12 @@ public:
      */
     void restartGame();
     
+    /**
+     * @brief 异步保存当前关卡的快照
+     * @details 主线程只拷贝模型，序列化和写文件在IO线程完成
+     */
+    void saveSnapshot();
+    
 protected:
     GameController();
     virtual ~GameController();
@@ -95,6 +110,11 @@ protected:
      */
     bool _initializeModel(const LevelConfig& levelConfig);
     
+    /**
+     * @brief 创建撤销管理器
+     */
+    bool _initializeUndoManager();
+    
     /**
      * @brief 初始化视图
      */
@@ -158,8 +178,9 @@ protected:
      * @param cardId 点击的卡牌ID
      * @param clickedCard 点击的卡牌
      * @param rightStackCard Stack右边的质底牌
+     * @param undoSerial 这次操作的撤销记录序号
      */
-    void _executeMatchAnimation(int cardId, Card* clickedCard, Card* rightStackCard);
+    void _executeMatchAnimation(int cardId, Card* clickedCard, Card* rightStackCard, int undoSerial);
     
     /**
      * @brief 执行匹配后的模型更新
@@ -200,8 +221,11 @@ private:
     GameModel* _gameModel;              // 游戏数据模型
     GameView* _gameView;                // 游戏视图
     UndoManager* _undoManager;          // 撤销管理器
+    EventListenerCustom* _saveSnapshotListener;  // 保存快照事件监听
     
+    int _levelId;                       // 当前关卡ID
     int _selectedCardId;                // 当前选中的卡牌ID
+    std::set<int> _pendingUndoSerials;  // 已记录撤销、但动画未结束所以模型未更新的撤销记录序号
     GameStateType _currentGameState;    // 当前游戏状态
 };
 
@@ -0,0 +1,372 @@
+/**
+ * @file AnalyticsManager.cpp
+ * @brief 埋点事件管理器实现
+ */
+
+#include "AnalyticsManager.h"
+#include "network/HttpClient.h"
+#include <zlib.h>
+#include <algorithm>
+
+using namespace cocos2d::network;
+
+namespace {
+    AnalyticsManager* s_sharedInstance = nullptr;
+
+    const size_t kBatchSize = 200;                  // 攒够多少事件立即落盘
+    const int kFlushIntervalSeconds = 30;           // 最长多久落盘一次
+    const int kPollIntervalMilliseconds = 1000;     // 后台线程检查间隔
+    const size_t kMaxSpoolFiles = 100;              // 最多保留的缓存文件数，超过时删除最早的
+    const float kInitialBackoffSeconds = 5.0f;      // 首次上传失败后的等待时长
+    const float kMaxBackoffSeconds = 600.0f;        // 退避时长上限
+    const char* kSpoolFileSuffix = ".ndjson.gz";
+
+    /**
+     * @brief 当前Unix时间（毫秒）
+     */
+    int64_t currentTimeMillis()
+    {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief 追加一行NDJSON
+     */
+    void appendEventLine(std::string& out, const char* name, int64_t timestamp, const int values[3])
+    {
+        char line[256];
+        int len = snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ts\":%lld,\"v\":[%d,%d,%d]}\n",
+                           name, (long long)timestamp, values[0], values[1], values[2]);
+        if (len > 0) {
+            out.append(line, std::min((size_t)len, sizeof(line) - 1));
+        }
+    }
+
+    /**
+     * @brief 用zlib压缩成gzip格式
+     * @return bool 是否成功
+     */
+    bool gzipCompress(const std::string& input, Data& output)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        // windowBits加16表示输出gzip头，上报时使用Content-Encoding: gzip
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+
+        uLong bound = deflateBound(&stream, (uLong)input.size());
+        unsigned char* buffer = (unsigned char*)malloc(bound);
+        if (!buffer) {
+            deflateEnd(&stream);
+            return false;
+        }
+
+        stream.next_in = (Bytef*)input.data();
+        stream.avail_in = (uInt)input.size();
+        stream.next_out = buffer;
+        stream.avail_out = (uInt)bound;
+        int ret = deflate(&stream, Z_FINISH);
+        size_t compressedSize = stream.total_out;
+        deflateEnd(&stream);
+
+        if (ret != Z_STREAM_END) {
+            free(buffer);
+            return false;
+        }
+        output.fastSet(buffer, compressedSize);
+        return true;
+    }
+}
+
+AnalyticsManager* AnalyticsManager::getInstance()
+{
+    if (!s_sharedInstance) {
+        s_sharedInstance = new AnalyticsManager();
+    }
+    return s_sharedInstance;
+}
+
+void AnalyticsManager::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedInstance);
+}
+
+AnalyticsManager::AnalyticsManager()
+    : _head(0)
+    , _tail(0)
+    , _droppedCount(0)
+    , _thread(nullptr)
+    , _quit(false)
+    , _flushRequested(false)
+    , _fileUtils(nullptr)
+    , _scheduler(nullptr)
+    , _eventDispatcher(nullptr)
+    , _resetListener(nullptr)
+    , _batchSequence(0)
+    , _uploading(false)
+    , _backoffSeconds(0.0f)
+    , _nextUploadTime(std::chrono::steady_clock::now())
+{
+}
+
+AnalyticsManager::~AnalyticsManager()
+{
+    if (_thread) {
+        {
+            std::lock_guard<std::mutex> lock(_threadMutex);
+            _quit = true;
+        }
+        _threadCondition.notify_one();
+        // 后台线程退出前会把剩余事件写入缓存文件
+        _thread->join();
+        CC_SAFE_DELETE(_thread);
+    }
+    if (_resetListener) {
+        _eventDispatcher->removeEventListener(_resetListener);
+    }
+}
+
+void AnalyticsManager::start(const std::string& uploadUrl)
+{
+    if (_thread) {
+        return;
+    }
+
+    _uploadUrl = uploadUrl;
+
+    auto director = Director::getInstance();
+    _fileUtils = FileUtils::getInstance();
+    _scheduler = director->getScheduler();
+    _eventDispatcher = director->getEventDispatcher();
+    // Director::reset() 随后会销毁 FileUtils 等单例，必须在这之前结束后台线程
+    _resetListener = _eventDispatcher->addCustomEventListener(Director::EVENT_RESET, [](EventCustom*) {
+        AnalyticsManager::destroyInstance();
+    });
+
+    // 确保HttpClient单例在主线程创建
+    if (!_uploadUrl.empty()) {
+        HttpClient::getInstance();
+    }
+
+    // 加载上次未上报的缓存文件
+    _spoolPath = _fileUtils->getWritablePath() + "analytics/";
+    if (!_fileUtils->isDirectoryExist(_spoolPath)) {
+        _fileUtils->createDirectory(_spoolPath);
+    }
+
+    std::string suffix = kSpoolFileSuffix;
+    for (const auto& path : _fileUtils->listFiles(_spoolPath)) {
+        if (path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            _spoolFiles.push_back(path);
+        }
+    }
+    // 文件名以时间戳开头，排序后即为生成顺序
+    std::sort(_spoolFiles.begin(), _spoolFiles.end());
+
+    _thread = new std::thread(&AnalyticsManager::_threadEntry, this);
+}
+
+void AnalyticsManager::logEvent(const char* name, int value0, int value1, int value2)
+{
+    // 单生产者：只有主线程写_head，后台线程写_tail
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t tail = _tail.load(std::memory_order_acquire);
+    if (head - tail >= kQueueCapacity) {
+        _droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    AnalyticsEvent& event = _events[head & (kQueueCapacity - 1)];
+    event.name = name;
+    event.timestamp = currentTimeMillis();
+    event.values[0] = value0;
+    event.values[1] = value1;
+    event.values[2] = value2;
+    _head.store(head + 1, std::memory_order_release);
+}
+
+void AnalyticsManager::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(_threadMutex);
+        _flushRequested = true;
+    }
+    _threadCondition.notify_one();
+}
+
+size_t AnalyticsManager::getQueuedEventCount() const
+{
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+void AnalyticsManager::_drainQueue(std::vector<AnalyticsEvent>& events)
+{
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    size_t head = _head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+        events.push_back(_events[tail & (kQueueCapacity - 1)]);
+    }
+    _tail.store(tail, std::memory_order_release);
+}
+
+void AnalyticsManager::_threadEntry()
+{
+    std::vector<AnalyticsEvent> pendingEvents;
+    pendingEvents.reserve(kBatchSize);
+    auto lastFlushTime = std::chrono::steady_clock::now();
+    bool quit = false;
+
+    while (!quit) {
+        bool flushRequested = false;
+        {
+            std::unique_lock<std::mutex> lock(_threadMutex);
+            _threadCondition.wait_for(lock, std::chrono::milliseconds(kPollIntervalMilliseconds), [this]() {
+                return _quit || _flushRequested;
+            });
+            quit = _quit;
+            flushRequested = _flushRequested;
+            _flushRequested = false;
+        }
+
+        _drainQueue(pendingEvents);
+
+        // 攒够一批、到达间隔、请求落盘或退出时写缓存文件
+        auto now = std::chrono::steady_clock::now();
+        unsigned int dropped = _droppedCount.load(std::memory_order_relaxed);
+        bool hasEvents = !pendingEvents.empty() || dropped > 0;
+        if (hasEvents && (pendingEvents.size() >= kBatchSize || flushRequested || quit
+            || now - lastFlushTime >= std::chrono::seconds(kFlushIntervalSeconds))) {
+            dropped = _droppedCount.exchange(0, std::memory_order_relaxed);
+            _writeBatch(pendingEvents, dropped);
+            pendingEvents.clear();
+            lastFlushTime = now;
+        }
+
+        if (quit || _uploadUrl.empty()) {
+            continue;
+        }
+
+        // 同一时间只上传一个缓存文件，失败后等待退避时长
+        bool shouldUpload = false;
+        {
+            std::lock_guard<std::mutex> lock(_spoolMutex);
+            if (!_uploading && !_spoolFiles.empty() && (now >= _nextUploadTime || flushRequested)) {
+                _uploading = true;
+                shouldUpload = true;
+            }
+        }
+        if (shouldUpload) {
+            _scheduler->performFunctionInCocosThread([this]() {
+                // 管理器可能已在主线程销毁
+                if (s_sharedInstance == this) {
+                    _uploadOldestBatch();
+                }
+            });
+        }
+    }
+}
+
+void AnalyticsManager::_writeBatch(const std::vector<AnalyticsEvent>& events, unsigned int dropped)
+{
+    std::string body;
+    body.reserve(events.size() * 64 + 64);
+    for (const auto& event : events) {
+        appendEventLine(body, event.name, event.timestamp, event.values);
+    }
+    if (dropped > 0) {
+        int values[3] = { (int)dropped, 0, 0 };
+        appendEventLine(body, "analytics_dropped", currentTimeMillis(), values);
+    }
+
+    Data compressed;
+    if (!gzipCompress(body, compressed)) {
+        CCLOG("AnalyticsManager: failed to compress %d events", (int)events.size());
+        return;
+    }
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "batch_%013lld_%04u%s",
+             (long long)currentTimeMillis(), _batchSequence++ % 10000, kSpoolFileSuffix);
+    std::string path = _spoolPath + fileName;
+    if (!_fileUtils->writeDataToFile(compressed, path)) {
+        CCLOG("AnalyticsManager: failed to write %s", path.c_str());
+        return;
+    }
+
+    std::vector<std::string> expiredFiles;
+    {
+        std::lock_guard<std::mutex> lock(_spoolMutex);
+        _spoolFiles.push_back(path);
+        // 长期离线时只保留最近的缓存文件（正在上传的第一个除外）
+        size_t first = _uploading ? 1 : 0;
+        while (_spoolFiles.size() > kMaxSpoolFiles && _spoolFiles.size() > first + 1) {
+            expiredFiles.push_back(_spoolFiles[first]);
+            _spoolFiles.erase(_spoolFiles.begin() + first);
+        }
+    }
+    for (const auto& expired : expiredFiles) {
+        _fileUtils->removeFile(expired);
+    }
+}
+
+void AnalyticsManager::_uploadOldestBatch()
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(_spoolMutex);
+        if (_spoolFiles.empty()) {
+            _uploading = false;
+            return;
+        }
+        path = _spoolFiles.front();
+    }
+
+    Data data = _fileUtils->getDataFromFile(path);
+    if (data.isNull()) {
+        // 文件已损坏或被删除，直接跳过
+        _onUploadFinished(path, true);
+        return;
+    }
+
+    HttpRequest* request = new (std::nothrow) HttpRequest();
+    request->setUrl(_uploadUrl);
+    request->setRequestType(HttpRequest::Type::POST);
+    request->setHeaders({ "Content-Type: application/x-ndjson", "Content-Encoding: gzip" });
+    request->setRequestData((const char*)data.getBytes(), data.getSize());
+    request->setResponseCallback([this, path](HttpClient* client, HttpResponse* response) {
+        if (s_sharedInstance == this) {
+            _onUploadFinished(path, response && response->isSucceed());
+        }
+    });
+    HttpClient::getInstance()->send(request);
+    request->release();
+}
+
+void AnalyticsManager::_onUploadFinished(const std::string& path, bool succeed)
+{
+    bool removeFile = false;
+    {
+        std::lock_guard<std::mutex> lock(_spoolMutex);
+        _uploading = false;
+        if (succeed) {
+            if (!_spoolFiles.empty() && _spoolFiles.front() == path) {
+                _spoolFiles.erase(_spoolFiles.begin());
+            }
+            removeFile = true;
+            // 成功后立即尝试下一个缓存文件
+            _backoffSeconds = 0.0f;
+            _nextUploadTime = std::chrono::steady_clock::now();
+        } else {
+            // 离线或服务端错误：指数退避
+            _backoffSeconds = _backoffSeconds <= 0.0f ? kInitialBackoffSeconds : std::min(_backoffSeconds * 2.0f, kMaxBackoffSeconds);
+            _nextUploadTime = std::chrono::steady_clock::now()
+                + std::chrono::milliseconds((int64_t)(_backoffSeconds * 1000.0f));
+        }
+    }
+
+    if (removeFile) {
+        _fileUtils->removeFile(path);
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file AnalyticsManager.h
+ * @brief 埋点事件管理器
+ * @details 主线程无锁记录事件，后台线程批量压缩、落盘并通过HttpClient上报
+ */
+
+#ifndef __ANALYTICS_MANAGER_H__
+#define __ANALYTICS_MANAGER_H__
+
+#include "cocos2d.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+USING_NS_CC;
+
+/**
+ * @brief 埋点事件
+ * @details 定长POD结构，入队时不分配内存
+ */
+struct AnalyticsEvent
+{
+    const char* name;       // 事件名（必须是字符串字面量等静态字符串）
+    int64_t timestamp;      // 发生时间（Unix毫秒）
+    int values[3];          // 事件参数
+};
+
+/**
+ * @brief 埋点事件管理器
+ * @details 主线程通过单生产者单消费者环形队列记录事件，入队只有几次原子读写；
+ *          后台线程定期取出事件，按批序列化为NDJSON并用zlib压缩成gzip，
+ *          每批先写入可写目录下的缓存文件，再逐个上传，失败时按指数退避重试，
+ *          离线期间的事件因此不会丢失
+ */
+class AnalyticsManager
+{
+public:
+    /**
+     * @brief 获取单例（需在主线程首次调用）
+     * @return AnalyticsManager* 管理器指针
+     */
+    static AnalyticsManager* getInstance();
+
+    /**
+     * @brief 销毁单例，未上报的事件会写入缓存文件
+     * @details start() 之后会在 Director::EVENT_RESET 时自动调用，
+     *          此时引擎的单例还没有销毁，后台线程写完最后一批后退出
+     */
+    static void destroyInstance();
+
+    /**
+     * @brief 启动后台线程，并加载上次未上报的缓存文件
+     * @param uploadUrl 上报地址，为空时只落盘不上报
+     */
+    void start(const std::string& uploadUrl);
+
+    /**
+     * @brief 记录一个事件（只能在主线程调用）
+     * @details 队列满时丢弃事件并计数，不会阻塞
+     * @param name 事件名，必须是静态字符串
+     * @param value0 参数0
+     * @param value1 参数1
+     * @param value2 参数2
+     */
+    void logEvent(const char* name, int value0 = 0, int value1 = 0, int value2 = 0);
+
+    /**
+     * @brief 请求尽快落盘并上报（如切到后台时）
+     */
+    void flush();
+
+    /**
+     * @brief 还没被后台线程取走的事件数
+     * @return size_t 事件数
+     */
+    size_t getQueuedEventCount() const;
+
+private:
+    AnalyticsManager();
+    ~AnalyticsManager();
+
+    /**
+     * @brief 后台线程入口
+     */
+    void _threadEntry();
+
+    /**
+     * @brief 从环形队列取出所有事件
+     * @param events 输出的事件
+     */
+    void _drainQueue(std::vector<AnalyticsEvent>& events);
+
+    /**
+     * @brief 序列化并压缩一批事件，写入缓存文件
+     * @param events 事件
+     * @param dropped 因队列满丢弃的事件数
+     */
+    void _writeBatch(const std::vector<AnalyticsEvent>& events, unsigned int dropped);
+
+    /**
+     * @brief 在主线程上传最早的缓存文件
+     */
+    void _uploadOldestBatch();
+
+    /**
+     * @brief 上传结果回调（主线程）
+     * @param path 缓存文件路径
+     * @param succeed 是否成功
+     */
+    void _onUploadFinished(const std::string& path, bool succeed);
+
+    static const size_t kQueueCapacity = 4096;     // 环形队列容量（2的幂）
+
+    AnalyticsEvent _events[kQueueCapacity];         // 环形队列
+    std::atomic<size_t> _head;                      // 写位置（主线程）
+    std::atomic<size_t> _tail;                      // 读位置（后台线程）
+    std::atomic<unsigned int> _droppedCount;        // 队列满时丢弃的事件数
+
+    std::thread* _thread;                           // 后台线程
+    std::mutex _threadMutex;                        // 唤醒后台线程用
+    std::condition_variable _threadCondition;       // 唤醒后台线程用
+    bool _quit;                                     // 是否退出（受_threadMutex保护）
+    bool _flushRequested;                           // 是否请求立即落盘（受_threadMutex保护）
+
+    // 在主线程上取好，后台线程不调用引擎单例的 getInstance()
+    FileUtils* _fileUtils;                          // 写缓存文件用
+    Scheduler* _scheduler;                          // 切回主线程上传用
+    EventDispatcher* _eventDispatcher;              // 注册重置监听用
+    EventListenerCustom* _resetListener;            // Director 重置时销毁管理器
+
+    std::string _uploadUrl;                         // 上报地址
+    std::string _spoolPath;                         // 缓存目录
+    unsigned int _batchSequence;                    // 缓存文件序号
+
+    std::mutex _spoolMutex;                         // 保护以下上报状态
+    std::vector<std::string> _spoolFiles;           // 待上报的缓存文件，按时间排序
+    bool _uploading;                                // 是否有上传进行中
+    float _backoffSeconds;                          // 当前退避时长
+    std::chrono::steady_clock::time_point _nextUploadTime;  // 下次允许上传的时间
+};
+
+#endif // __ANALYTICS_MANAGER_H__
@@ -14,6 +14,7 @@ UndoManager* UndoManager::create(GameModel* gameModel)
 UndoManager::UndoManager(GameModel* gameModel)
     : _undoModel(UndoModel::create())
     , _gameModel(gameModel)
+    , _nextSerial(0)
 {
 }
 
@@ -25,11 +26,14 @@ UndoManager::~UndoManager()
     }
 }
 
-void UndoManager::recordUndo(const UndoRecord& record)
+int UndoManager::recordUndo(const UndoRecord& record)
 {
+    UndoRecord serialRecord = record;
+    serialRecord.serial = _nextSerial++;
     if (_undoModel) {
-        _undoModel->addRecord(record);
+        _undoModel->addRecord(serialRecord);
     }
+    return serialRecord.serial;
 }
 
 bool UndoManager::executeUndo()
@@ -60,6 +64,15 @@ void UndoManager::clearAll()
     }
 }
 
+void UndoManager::restoreRecords(const std::vector<UndoRecord>& records)
+{
+    if (!_undoModel) return;
+    _undoModel->clearAll();
+    for (const auto& record : records) {
+        recordUndo(record);
+    }
+}
+
 void UndoManager::setOnUndoCompleteCallback(const std::function<void(const UndoRecord&)>& callback)
 {
     _onUndoCompleteCallback = callback;
@@ -31,8 +31,9 @@ public:
     /**
      * @brief 记录一个撤销操作
      * @param record 撤销记录
+     * @return int 分配给这条记录的序号
      */
-    void recordUndo(const UndoRecord& record);
+    int recordUndo(const UndoRecord& record);
     
     /**
      * @brief 执行撤销（回退一步）
@@ -51,6 +52,18 @@ public:
      */
     void clearAll();
     
+    /**
+     * @brief 获取撤销数据模型（保存存档时使用）
+     * @return const UndoModel* 撤销数据模型
+     */
+    const UndoModel* getUndoModel() const { return _undoModel; }
+    
+    /**
+     * @brief 用存档中的记录替换当前撤销记录
+     * @param records 撤销记录（从旧到新）
+     */
+    void restoreRecords(const std::vector<UndoRecord>& records);
+    
     /**
      * @brief 注册撤销完成回调
      * @param callback 回调函数
@@ -70,6 +83,7 @@ public:
 private:
     UndoModel* _undoModel;              // 撤销数据模型
     GameModel* _gameModel;              // 游戏模型（用于状态恢复）
+    int _nextSerial;                    // 下一条记录的序号
     
     std::function<void(const UndoRecord&)> _onApplyUndoCallback;      // 撤销执行回调（由Controller注册）
     std::function<void(const UndoRecord&)> _onUndoCompleteCallback;   // 撤销完成回调
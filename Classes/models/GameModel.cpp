@@ -45,6 +45,14 @@ void GameModel::addStackCard(Card* card)
     }
 }
 
+void GameModel::registerCard(Card* card)
+{
+    if (!card) return;
+    if (std::find(_allCards.begin(), _allCards.end(), card) == _allCards.end()) {
+        _allCards.push_back(card);
+    }
+}
+
 Card* GameModel::getTopStackCard() const
 {
     if (_stackCards.empty()) return nullptr;
@@ -85,14 +93,13 @@ Card* GameModel::findCardById(int cardId) const
 
 void GameModel::clearAll()
 {
-    for (auto card : _playfieldCards) {
-        delete card;
-    }
-    for (auto card : _stackCards) {
+    // 全局列表包含所有卡牌，已离开两个区域的卡牌也在这里释放
+    for (auto card : _allCards) {
         delete card;
     }
     _playfieldCards.clear();
     _stackCards.clear();
+    _allCards.clear();
 }
 
 int GameModel::getTotalCardCount() const
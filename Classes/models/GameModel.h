@@ -56,6 +56,18 @@ public:
      */
     const std::vector<Card*>& getStackCards() const { return _stackCards; }
     
+    /**
+     * @brief 获取所有卡牌（包括已离开主牌区和堆牌区、撤销时仍需要的卡牌）
+     * @return const std::vector<Card*>& 全局卡牌列表
+     */
+    const std::vector<Card*>& getAllCards() const { return _allCards; }
+    
+    /**
+     * @brief 只登记到全局列表，不放入任何区域（恢复存档时使用）
+     * @param card 卡牌对象
+     */
+    void registerCard(Card* card);
+    
     /**
      * @brief 获取当前顶部卡牌（堆牌区最上面的牌）
      * @return Card* 顶部卡牌，如果没有返回nullptr
@@ -0,0 +1,49 @@
+/**
+ * @file GameSnapshot.h
+ * @brief 游戏存档快照数据结构
+ * @details 关卡进行中的完整状态（GameModel + UndoModel），用于切后台时保存和启动时恢复
+ */
+
+#ifndef __GAME_SNAPSHOT_H__
+#define __GAME_SNAPSHOT_H__
+
+#include "cocos2d.h"
+#include "UndoModel.h"
+#include "../configs/CardEnums.h"
+
+USING_NS_CC;
+
+/**
+ * @brief 单张卡牌的快照
+ */
+struct CardSnapshot
+{
+    int cardId;                 // 卡牌ID
+    CardFaceType face;          // 牌面
+    CardSuitType suit;          // 花色
+    CardAreaType area;          // 所处区域
+    bool visible;               // 是否翻开
+    int stackIndex;             // 在堆中的位置
+    Vec2 position;              // 位置
+    
+    CardSnapshot() : cardId(-1), face(CardFaceType::NONE), suit(CardSuitType::NONE),
+                     area(CardAreaType::NONE), visible(true), stackIndex(-1), position(0, 0) {}
+};
+
+/**
+ * @brief 关卡快照
+ * @details 只包含值类型，可以在主线程拷贝后交给工作线程序列化
+ */
+struct GameSnapshot
+{
+    int levelId;                            // 关卡ID
+    GameStateType gameState;                // 游戏状态
+    std::vector<CardSnapshot> cards;        // 所有卡牌（包括已被移出主牌区和堆牌区、撤销时需要的卡牌）
+    std::vector<int> playfieldCardIds;      // 主牌区卡牌ID（按顺序）
+    std::vector<int> stackCardIds;          // 堆牌区卡牌ID（按顺序，最后一个是顶部）
+    std::vector<UndoRecord> undoRecords;    // 撤销记录栈
+    
+    GameSnapshot() : levelId(0), gameState(GameStateType::IDLE) {}
+};
+
+#endif // __GAME_SNAPSHOT_H__
@@ -35,11 +35,12 @@ struct UndoRecord
     int removedPlayfieldCardId;     // 移除的Playfield卡牌ID（用于PLAYFIELD_TO_STACK）
     int removedStackCardId;         // 移除的Stack质底牌ID
     std::vector<int> stackCardIds;  // 撤销前Stack中的所有卡牌ID（按顺序）
+    int serial;                     // 记录序号，由UndoManager分配，只在运行时区分记录，不写入快照
     
     UndoRecord() : operationType(OperationType::CARD_MOVE), 
                    sourceCardId(-1), targetCardId(-1),
                    sourceVisible(true), targetVisible(true),
-                   removedPlayfieldCardId(-1), removedStackCardId(-1) {}
+                   removedPlayfieldCardId(-1), removedStackCardId(-1), serial(-1) {}
 };
 
 /**
@@ -85,6 +86,12 @@ public:
      */
     int getRecordCount() const { return (int)_records.size(); }
     
+    /**
+     * @brief 获取所有记录（从旧到新）
+     * @return const std::vector<UndoRecord>& 撤销记录栈
+     */
+    const std::vector<UndoRecord>& getRecords() const { return _records; }
+    
     /**
      * @brief 清空所有撤销记录
      */
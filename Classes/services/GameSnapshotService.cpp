@@ -0,0 +1,394 @@
+/**
+ * @file GameSnapshotService.cpp
+ * @brief 游戏存档快照服务实现
+ */
+
+#include "GameSnapshotService.h"
+#include <zlib.h>
+#include <unordered_map>
+
+const char* GameSnapshotService::EVENT_SAVE_SNAPSHOT = "game_save_snapshot";
+
+namespace {
+    const char kSnapshotMagic[4] = { 'C', 'S', 'N', 'P' };
+    const uint32_t kSnapshotVersion = 1;
+    const char* kSnapshotFileName = "game_snapshot.bin";
+    const uint32_t kMaxElementCount = 65536;        // 单个数组的元素数上限，防止损坏的文件导致超大分配
+
+    /**
+     * @brief 追加一个定长值（按本机字节序）
+     */
+    template <typename T>
+    void writeValue(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeIds(std::string& out, const std::vector<int>& ids)
+    {
+        writeValue<uint32_t>(out, (uint32_t)ids.size());
+        for (int cardId : ids) {
+            writeValue<int32_t>(out, cardId);
+        }
+    }
+
+    /**
+     * @brief 带边界检查的顺序读取
+     */
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader(const unsigned char* bytes, size_t size) : _cursor(bytes), _end(bytes + size) {}
+
+        template <typename T>
+        bool read(T& value)
+        {
+            if ((size_t)(_end - _cursor) < sizeof(T)) {
+                return false;
+            }
+            memcpy(&value, _cursor, sizeof(T));
+            _cursor += sizeof(T);
+            return true;
+        }
+
+        bool readCount(uint32_t& count)
+        {
+            return read(count) && count <= kMaxElementCount;
+        }
+
+        bool readIds(std::vector<int>& ids)
+        {
+            uint32_t count = 0;
+            if (!readCount(count)) {
+                return false;
+            }
+            ids.resize(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                int32_t cardId = 0;
+                if (!read(cardId)) {
+                    return false;
+                }
+                ids[i] = cardId;
+            }
+            return true;
+        }
+
+        bool isAtEnd() const { return _cursor == _end; }
+
+    private:
+        const unsigned char* _cursor;
+        const unsigned char* _end;
+    };
+}
+
+GameSnapshot GameSnapshotService::captureSnapshot(int levelId, const GameModel* gameModel, const UndoModel* undoModel,
+                                                  const std::set<int>& pendingUndoSerials)
+{
+    GameSnapshot snapshot;
+    snapshot.levelId = levelId;
+    if (!gameModel) {
+        return snapshot;
+    }
+    
+    // 只做值拷贝，序列化留给IO线程
+    snapshot.gameState = gameModel->getGameState();
+    const auto& allCards = gameModel->getAllCards();
+    snapshot.cards.reserve(allCards.size());
+    for (auto card : allCards) {
+        CardSnapshot cardSnapshot;
+        cardSnapshot.cardId = card->getCardId();
+        cardSnapshot.face = card->getFace();
+        cardSnapshot.suit = card->getSuit();
+        cardSnapshot.area = card->getArea();
+        cardSnapshot.visible = card->isVisible();
+        cardSnapshot.stackIndex = card->getStackIndex();
+        cardSnapshot.position = card->getPosition();
+        snapshot.cards.push_back(cardSnapshot);
+    }
+    
+    snapshot.playfieldCardIds.reserve(gameModel->getPlayfieldCards().size());
+    for (auto card : gameModel->getPlayfieldCards()) {
+        snapshot.playfieldCardIds.push_back(card->getCardId());
+    }
+    snapshot.stackCardIds.reserve(gameModel->getStackCards().size());
+    for (auto card : gameModel->getStackCards()) {
+        snapshot.stackCardIds.push_back(card->getCardId());
+    }
+    
+    if (undoModel) {
+        // 按序号而不是按条数去掉未完成的记录：动画中途撤销会先弹出未完成的那条
+        snapshot.undoRecords.reserve(undoModel->getRecords().size());
+        for (const auto& record : undoModel->getRecords()) {
+            if (pendingUndoSerials.count(record.serial) == 0) {
+                snapshot.undoRecords.push_back(record);
+            }
+        }
+    }
+    
+    return snapshot;
+}
+
+void GameSnapshotService::saveSnapshotAsync(GameSnapshot&& snapshot)
+{
+    // FileUtils单例需要在主线程创建
+    std::string path = _getSnapshotPath();
+    auto sharedSnapshot = std::make_shared<GameSnapshot>(std::move(snapshot));
+    
+    // IO队列按入队顺序串行执行，连续保存时后写入的总是最新状态
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [sharedSnapshot, path]() {
+        std::string bytes;
+        _serialize(*sharedSnapshot, bytes);
+        
+        Data data;
+        data.copy(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+        
+        // 先写临时文件再重命名，保证旧存档在写入失败时保持完整
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = path + ".tmp";
+        if (!fileUtils->writeDataToFile(data, tempPath) || !fileUtils->renameFile(tempPath, path)) {
+            CCLOG("GameSnapshotService: failed to write %s", path.c_str());
+            fileUtils->removeFile(tempPath);
+        }
+    });
+}
+
+bool GameSnapshotService::loadSnapshot(GameSnapshot& snapshot)
+{
+    std::string path = _getSnapshotPath();
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(path)) {
+        return false;
+    }
+    
+    Data data = fileUtils->getDataFromFile(path);
+    if (data.isNull() || !_deserialize(data.getBytes(), data.getSize(), snapshot)) {
+        CCLOG("GameSnapshotService: ignored invalid snapshot %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void GameSnapshotService::clearSnapshot()
+{
+    std::string path = _getSnapshotPath();
+    
+    // 同样走IO队列，避免排在前面的保存任务把快照重新写回来
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [path]() {
+        auto fileUtils = FileUtils::getInstance();
+        if (fileUtils->isFileExist(path)) {
+            fileUtils->removeFile(path);
+        }
+    });
+}
+
+GameModel* GameSnapshotService::restoreGameModel(const GameSnapshot& snapshot)
+{
+    GameModel* gameModel = GameModel::create();
+    if (!gameModel) {
+        return nullptr;
+    }
+    
+    std::unordered_map<int, Card*> cardsById;
+    cardsById.reserve(snapshot.cards.size());
+    for (const auto& cardSnapshot : snapshot.cards) {
+        Card* card = Card::create(cardSnapshot.cardId, cardSnapshot.face, cardSnapshot.suit);
+        if (!card || !cardsById.emplace(cardSnapshot.cardId, card).second) {
+            // 重复的卡牌ID说明快照已损坏
+            delete card;
+            for (const auto& pair : cardsById) {
+                delete pair.second;
+            }
+            delete gameModel;
+            return nullptr;
+        }
+        card->setPosition(cardSnapshot.position);
+        card->setVisible(cardSnapshot.visible);
+        card->setStackIndex(cardSnapshot.stackIndex);
+        card->setArea(cardSnapshot.area);
+    }
+    
+    // 按原顺序放回主牌区和堆牌区
+    bool valid = true;
+    for (int cardId : snapshot.playfieldCardIds) {
+        auto it = cardsById.find(cardId);
+        if (it == cardsById.end() || gameModel->findCardById(cardId)) {
+            valid = false;
+            break;
+        }
+        gameModel->addPlayfieldCard(it->second);
+    }
+    for (int cardId : snapshot.stackCardIds) {
+        if (!valid) {
+            break;
+        }
+        auto it = cardsById.find(cardId);
+        if (it == cardsById.end() || gameModel->findCardById(cardId)) {
+            valid = false;
+            break;
+        }
+        gameModel->addStackCard(it->second);
+    }
+    
+    // 已离开两个区域的卡牌只登记到全局列表，撤销时仍能找到
+    for (const auto& cardSnapshot : snapshot.cards) {
+        Card* card = cardsById[cardSnapshot.cardId];
+        if (!gameModel->findCardById(cardSnapshot.cardId)) {
+            gameModel->registerCard(card);
+        }
+    }
+    
+    // 撤销记录引用的卡牌必须都在快照中
+    for (const auto& record : snapshot.undoRecords) {
+        if (!valid) {
+            break;
+        }
+        if (record.sourceCardId >= 0 && !gameModel->findCardById(record.sourceCardId)) {
+            valid = false;
+        }
+        for (int cardId : record.stackCardIds) {
+            if (!gameModel->findCardById(cardId)) {
+                valid = false;
+                break;
+            }
+        }
+    }
+    
+    if (!valid) {
+        delete gameModel;
+        return nullptr;
+    }
+    
+    gameModel->setGameState(snapshot.gameState);
+    return gameModel;
+}
+
+std::string GameSnapshotService::_getSnapshotPath()
+{
+    return FileUtils::getInstance()->getWritablePath() + kSnapshotFileName;
+}
+
+void GameSnapshotService::_serialize(const GameSnapshot& snapshot, std::string& out)
+{
+    out.clear();
+    out.reserve(64 + snapshot.cards.size() * 32 + snapshot.undoRecords.size() * 256);
+    
+    // 文件头
+    out.append(kSnapshotMagic, sizeof(kSnapshotMagic));
+    writeValue<uint32_t>(out, kSnapshotVersion);
+    writeValue<int32_t>(out, snapshot.levelId);
+    writeValue<int32_t>(out, static_cast<int32_t>(snapshot.gameState));
+    
+    // 卡牌
+    writeValue<uint32_t>(out, (uint32_t)snapshot.cards.size());
+    for (const auto& card : snapshot.cards) {
+        writeValue<int32_t>(out, card.cardId);
+        writeValue<int32_t>(out, static_cast<int32_t>(card.face));
+        writeValue<int32_t>(out, static_cast<int32_t>(card.suit));
+        writeValue<int32_t>(out, static_cast<int32_t>(card.area));
+        writeValue<uint8_t>(out, card.visible ? 1 : 0);
+        writeValue<int32_t>(out, card.stackIndex);
+        writeValue<float>(out, card.position.x);
+        writeValue<float>(out, card.position.y);
+    }
+    writeIds(out, snapshot.playfieldCardIds);
+    writeIds(out, snapshot.stackCardIds);
+    
+    // 撤销记录
+    writeValue<uint32_t>(out, (uint32_t)snapshot.undoRecords.size());
+    for (const auto& record : snapshot.undoRecords) {
+        writeValue<int32_t>(out, static_cast<int32_t>(record.operationType));
+        writeValue<int32_t>(out, record.sourceCardId);
+        writeValue<int32_t>(out, record.targetCardId);
+        writeValue<float>(out, record.sourcePosition.x);
+        writeValue<float>(out, record.sourcePosition.y);
+        writeValue<float>(out, record.targetPosition.x);
+        writeValue<float>(out, record.targetPosition.y);
+        writeValue<uint8_t>(out, record.sourceVisible ? 1 : 0);
+        writeValue<uint8_t>(out, record.targetVisible ? 1 : 0);
+        writeValue<int32_t>(out, record.removedPlayfieldCardId);
+        writeValue<int32_t>(out, record.removedStackCardId);
+        writeIds(out, record.stackCardIds);
+    }
+    
+    // 末尾是前面所有内容的CRC32
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(out.data()), (uInt)out.size());
+    writeValue<uint32_t>(out, (uint32_t)crc);
+}
+
+bool GameSnapshotService::_deserialize(const unsigned char* bytes, size_t size, GameSnapshot& snapshot)
+{
+    const size_t headerSize = sizeof(kSnapshotMagic) + sizeof(uint32_t);
+    if (!bytes || size < headerSize + sizeof(uint32_t) || memcmp(bytes, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+        return false;
+    }
+    
+    size_t payloadSize = size - sizeof(uint32_t);
+    uint32_t storedCrc = 0;
+    memcpy(&storedCrc, bytes + payloadSize, sizeof(storedCrc));
+    if ((uint32_t)crc32(0L, bytes, (uInt)payloadSize) != storedCrc) {
+        return false;
+    }
+    
+    SnapshotReader reader(bytes + sizeof(kSnapshotMagic), payloadSize - sizeof(kSnapshotMagic));
+    uint32_t version = 0;
+    if (!reader.read(version) || version != kSnapshotVersion) {
+        return false;
+    }
+    
+    int32_t levelId = 0;
+    int32_t gameState = 0;
+    uint32_t count = 0;
+    if (!reader.read(levelId) || !reader.read(gameState) || !reader.readCount(count)) {
+        return false;
+    }
+    snapshot.levelId = levelId;
+    snapshot.gameState = static_cast<GameStateType>(gameState);
+    
+    snapshot.cards.resize(count);
+    for (auto& card : snapshot.cards) {
+        int32_t cardId = 0, face = 0, suit = 0, area = 0, stackIndex = 0;
+        uint8_t visible = 0;
+        float x = 0.0f, y = 0.0f;
+        if (!reader.read(cardId) || !reader.read(face) || !reader.read(suit) || !reader.read(area)
+            || !reader.read(visible) || !reader.read(stackIndex) || !reader.read(x) || !reader.read(y)) {
+            return false;
+        }
+        card.cardId = cardId;
+        card.face = static_cast<CardFaceType>(face);
+        card.suit = static_cast<CardSuitType>(suit);
+        card.area = static_cast<CardAreaType>(area);
+        card.visible = visible != 0;
+        card.stackIndex = stackIndex;
+        card.position.set(x, y);
+    }
+    
+    if (!reader.readIds(snapshot.playfieldCardIds) || !reader.readIds(snapshot.stackCardIds) || !reader.readCount(count)) {
+        return false;
+    }
+    
+    snapshot.undoRecords.resize(count);
+    for (auto& record : snapshot.undoRecords) {
+        int32_t operationType = 0, sourceCardId = 0, targetCardId = 0;
+        int32_t removedPlayfieldCardId = 0, removedStackCardId = 0;
+        float sx = 0.0f, sy = 0.0f, tx = 0.0f, ty = 0.0f;
+        uint8_t sourceVisible = 0, targetVisible = 0;
+        if (!reader.read(operationType) || !reader.read(sourceCardId) || !reader.read(targetCardId)
+            || !reader.read(sx) || !reader.read(sy) || !reader.read(tx) || !reader.read(ty)
+            || !reader.read(sourceVisible) || !reader.read(targetVisible)
+            || !reader.read(removedPlayfieldCardId) || !reader.read(removedStackCardId)
+            || !reader.readIds(record.stackCardIds)) {
+            return false;
+        }
+        record.operationType = static_cast<UndoRecord::OperationType>(operationType);
+        record.sourceCardId = sourceCardId;
+        record.targetCardId = targetCardId;
+        record.sourcePosition.set(sx, sy);
+        record.targetPosition.set(tx, ty);
+        record.sourceVisible = sourceVisible != 0;
+        record.targetVisible = targetVisible != 0;
+        record.removedPlayfieldCardId = removedPlayfieldCardId;
+        record.removedStackCardId = removedStackCardId;
+    }
+    
+    return reader.isAtEnd();
+}
@@ -0,0 +1,88 @@
+/**
+ * @file GameSnapshotService.h
+ * @brief 游戏存档快照服务
+ * @details 采集、异步保存、加载和恢复关卡快照
+ */
+
+#ifndef __GAME_SNAPSHOT_SERVICE_H__
+#define __GAME_SNAPSHOT_SERVICE_H__
+
+#include "cocos2d.h"
+#include "../models/GameModel.h"
+#include "../models/UndoModel.h"
+#include "../models/GameSnapshot.h"
+#include <set>
+
+USING_NS_CC;
+
+/**
+ * @brief 游戏存档快照服务
+ * @details 无状态的服务类。主线程只把模型拷贝成值类型的GameSnapshot，
+ *          二进制序列化和写文件在AsyncTaskPool的IO线程完成；
+ *          文件先写入临时文件再重命名，进程在写入途中被杀掉也不会损坏旧存档
+ */
+class GameSnapshotService
+{
+public:
+    /**
+     * @brief 请求保存快照的自定义事件名（切后台时由AppDelegate派发）
+     */
+    static const char* EVENT_SAVE_SNAPSHOT;
+    
+    /**
+     * @brief 从模型采集快照（主线程）
+     * @param levelId 关卡ID
+     * @param gameModel 游戏模型
+     * @param undoModel 撤销模型，可以为空
+     * @param pendingUndoSerials 已记录但还没更新到模型的撤销记录序号，这些记录不写入快照
+     * @return GameSnapshot 快照
+     */
+    static GameSnapshot captureSnapshot(int levelId, const GameModel* gameModel, const UndoModel* undoModel,
+                                        const std::set<int>& pendingUndoSerials = std::set<int>());
+    
+    /**
+     * @brief 在IO线程序列化并写入快照
+     * @param snapshot 快照（会被移动到工作线程）
+     */
+    static void saveSnapshotAsync(GameSnapshot&& snapshot);
+    
+    /**
+     * @brief 加载上次保存的快照
+     * @param snapshot 输出的快照
+     * @return bool 是否存在有效的快照
+     */
+    static bool loadSnapshot(GameSnapshot& snapshot);
+    
+    /**
+     * @brief 删除快照（关卡结束或重开时）
+     */
+    static void clearSnapshot();
+    
+    /**
+     * @brief 根据快照重建游戏模型
+     * @param snapshot 快照
+     * @return GameModel* 游戏模型
+     */
+    static GameModel* restoreGameModel(const GameSnapshot& snapshot);
+    
+private:
+    GameSnapshotService() = default;
+    
+    /**
+     * @brief 快照文件路径
+     */
+    static std::string _getSnapshotPath();
+    
+    /**
+     * @brief 序列化为二进制
+     */
+    static void _serialize(const GameSnapshot& snapshot, std::string& out);
+    
+    /**
+     * @brief 从二进制反序列化
+     * @return bool 数据是否完整有效
+     */
+    static bool _deserialize(const unsigned char* bytes, size_t size, GameSnapshot& snapshot);
+};
+
+#endif // __GAME_SNAPSHOT_SERVICE_H__
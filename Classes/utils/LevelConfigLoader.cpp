@@ -12,19 +12,28 @@ LevelConfig LevelConfigLoader::loadLevelConfig(int levelId)
     std::string filePath = StringUtils::format("levels/level_%d.json", levelId);
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
     
-    // 读取文件
-    std::string jsonContent = FileUtils::getInstance()->getStringFromFile(fullPath);
+    // 读取文件（可能直接映射到内存，避免拷贝）
+    MappedData jsonData = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
     
-    return loadLevelConfigFromString(jsonContent);
+    return loadLevelConfigFromData(reinterpret_cast<const char*>(jsonData.getBytes()), jsonData.getSize());
 }
 
 LevelConfig LevelConfigLoader::loadLevelConfigFromString(const std::string& jsonString)
+{
+    return loadLevelConfigFromData(jsonString.c_str(), jsonString.size());
+}
+
+LevelConfig LevelConfigLoader::loadLevelConfigFromData(const char* json, size_t length)
 {
     LevelConfig config;
+    if (!json || length == 0) {
+        CCLOG("Level config JSON is empty");
+        return config;
+    }
     
-    // 解析JSON
+    // 解析JSON（按长度解析，数据不需要以'\0'结尾）
     rapidjson::Document document;
-    document.Parse(jsonString.c_str());
+    document.Parse(json, length);
     
     if (document.HasParseError()) {
         CCLOG("Failed to parse level config JSON");
@@ -34,6 +34,14 @@ public:
      */
     static LevelConfig loadLevelConfigFromString(const std::string& jsonString);
     
+    /**
+     * @brief 从内存中的JSON数据加载关卡配置
+     * @param json JSON数据（不要求以'\0'结尾）
+     * @param length 数据长度
+     * @return LevelConfig 加载的关卡配置
+     */
+    static LevelConfig loadLevelConfigFromData(const char* json, size_t length);
+    
 private:
     LevelConfigLoader() = default;
     
@@ -151,14 +151,9 @@ void CardView::playMoveAnimation(const Vec2& targetPos, float duration, const st
 {
     if (!_cardModel) return;
     
-    auto moveAction = MoveTo::create(duration, targetPos);
-    
-    if (callback) {
-        auto sequence = Sequence::create(moveAction, CallFunc::create(callback), nullptr);
-        runAction(sequence);
-    } else {
-        runAction(moveAction);
-    }
+    // 使用 tween 代替 MoveTo + CallFunc，不需要创建 Action 对象
+    getActionManager()->addTween(this, ActionManager::TweenProperty::POSITION, duration,
+                                 Vec3(targetPos.x, targetPos.y, getPositionZ()), tweenfunc::Linear, callback);
     
     _cardModel->setPosition(targetPos);
 }
@@ -166,11 +161,11 @@ void CardView::playMoveAnimation(const Vec2& targetPos, float duration, const st
 void CardView::playFlipAnimation(bool isFaceUp, float duration)
 {
     // 简单的翻牌动画：缩放X轴
-    auto scaleDown = ScaleTo::create(duration * 0.5f, 0, 1);
-    auto scaleUp = ScaleTo::create(duration * 0.5f, 1, 1);
-    auto sequence = Sequence::create(scaleDown, scaleUp, nullptr);
-    
-    runAction(sequence);
+    auto actionManager = getActionManager();
+    actionManager->addTween(this, ActionManager::TweenProperty::SCALE, duration * 0.5f, Vec3(0, 1, 1), tweenfunc::Linear,
+                            [this, actionManager, duration]() {
+        actionManager->addTween(this, ActionManager::TweenProperty::SCALE, duration * 0.5f, Vec3(1, 1, 1));
+    });
     
     _cardModel->setVisible(isFaceUp);
 }
@@ -100,8 +100,13 @@ void GameView::_createStackArea()
 
 void GameView::_initializeButtons()
 {
-    // 撤销按钮（显示中文"回退"）
-    auto undoLabel = Label::createWithSystemFont("回退", "Arial", 36);
+    // 撤销按钮（显示中文"回退"），AppDelegate 已把这两个字预先渲染进字体图集
+    Label* undoLabel = nullptr;
+    if (FileUtils::getInstance()->isFileExist(GameConfig::kUIFontFile)) {
+        undoLabel = Label::createWithTTF(TTFConfig(GameConfig::kUIFontFile, GameConfig::kUIFontSize), "回退");
+    } else {
+        undoLabel = Label::createWithSystemFont("回退", "Arial", GameConfig::kUIFontSize);
+    }
     auto undoButton = MenuItemLabel::create(undoLabel, [this](Ref* sender) {
         if (_onUndoClickCallback) {
             _onUndoClickCallback();
@@ -26,6 +26,7 @@ message(STATUS "ENGINE_BINARY_PATH:" ${ENGINE_BINARY_PATH})
 option(DEBUG_MODE "Debug or Release?" ON)
 option(BUILD_LUA_LIBS "Build lua libraries" OFF)
 option(BUILD_JS_LIBS "Build js libraries" OFF)
+option(USE_FMOD_AUDIO "Use FMOD for AudioEngine on Linux instead of the built-in software mixer" OFF)
 
 # include helper functions
 include(CocosBuildHelpers)
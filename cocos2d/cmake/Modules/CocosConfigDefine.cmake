@@ -97,6 +97,9 @@ endif()
     elseif(LINUX)
         target_compile_definitions(${target} PUBLIC LINUX)
         target_compile_definitions(${target} PUBLIC _GNU_SOURCE)
+        if(NOT USE_FMOD_AUDIO)
+            target_compile_definitions(${target} PUBLIC CC_USE_AUDIO_MIXER=1)
+        endif()
     elseif(ANDROID)
         target_compile_definitions(${target} PUBLIC ANDROID)
         target_compile_definitions(${target} PUBLIC USE_FILE32API)
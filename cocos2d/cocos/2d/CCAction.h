@@ -30,6 +30,7 @@ THE SOFTWARE.
 #define __ACTIONS_CCACTION_H__
 
 #include "base/CCRef.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
 #include "math/CCGeometry.h"
 #include "base/CCScriptSupport.h"
 
@@ -29,6 +29,7 @@
 #include "2d/CCActionInstant.h"
 #include "2d/CCNode.h"
 #include "2d/CCSprite.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 #if defined(__GNUC__) && ((__GNUC__ >= 4) || ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 1)))
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -38,6 +39,8 @@
 #endif
 
 NS_CC_BEGIN
+
+CC_IMPLEMENT_OBJECT_POOL(CallFunc, 64)
 //
 // InstantAction
 //
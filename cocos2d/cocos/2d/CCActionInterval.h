@@ -128,6 +128,8 @@ protected:
 class CC_DLL Sequence : public ActionInterval
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Sequence)
+
     /** Helper constructor to create an array of sequenceable actions.
      *
      * @return An autoreleased Sequence object.
@@ -643,6 +645,8 @@ private:
 class CC_DLL MoveTo : public MoveBy
 {
 public:
+    CC_DECLARE_OBJECT_POOL(MoveTo)
+
     /** 
      * Creates the action.
      * @param duration Duration time, in seconds.
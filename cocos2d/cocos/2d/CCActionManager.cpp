@@ -28,6 +28,9 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <algorithm>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
 #include "base/CCScheduler.h"
@@ -50,10 +53,49 @@ typedef struct _hashElement
     UT_hash_handle      hh;
 } tHashElement;
 
+namespace {
+    const unsigned char TWEEN_PAUSED = 1;
+    const unsigned char TWEEN_REMOVED = 2;
+    // the first update only applies the start value, like ActionInterval::step
+    const unsigned char TWEEN_STARTING = 4;
+
+    template<typename T>
+    void moveTweenData(std::vector<T>& data, size_t to, size_t from)
+    {
+        data[to] = std::move(data[from]);
+    }
+
+    // same as RotateTo::calculateAngles
+    void calculateTweenAngles(float &startAngle, float &diffAngle, float dstAngle)
+    {
+        if (startAngle > 0)
+        {
+            startAngle = fmodf(startAngle, 360.0f);
+        }
+        else
+        {
+            startAngle = fmodf(startAngle, -360.0f);
+        }
+
+        diffAngle = dstAngle - startAngle;
+        if (diffAngle > 180)
+        {
+            diffAngle -= 360;
+        }
+        if (diffAngle < -180)
+        {
+            diffAngle += 360;
+        }
+    }
+}
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _tweenIdCounter(0),
+  _removedTweenCount(0),
+  _updatingTweens(false)
 {
 
 }
@@ -130,6 +172,8 @@ void ActionManager::pauseTarget(Node *target)
     {
         element->paused = true;
     }
+
+    setTweensPaused(target, true);
 }
 
 void ActionManager::resumeTarget(Node *target)
@@ -140,6 +184,8 @@ void ActionManager::resumeTarget(Node *target)
     {
         element->paused = false;
     }
+
+    setTweensPaused(target, false);
 }
 
 Vector<Node*> ActionManager::pauseAllRunningActions()
@@ -154,6 +200,19 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
             idsWithActions.pushBack(element->target);
         }
     }    
+
+    for (auto& tweenTarget : _tweenTargets)
+    {
+        if (! tweenTarget.second.paused)
+        {
+            Node *target = tweenTarget.first;
+            setTweensPaused(target, true);
+            if (! idsWithActions.contains(target))
+            {
+                idsWithActions.pushBack(target);
+            }
+        }
+    }
     
     return idsWithActions;
 }
@@ -206,6 +265,15 @@ void ActionManager::removeAllActions()
         element = (tHashElement*)element->hh.next;
         removeAllActionsFromTarget(target);
     }
+
+    for (size_t i = 0, count = _tweens.size(); i < count; ++i)
+    {
+        if (! (_tweens[i].flags & TWEEN_REMOVED))
+        {
+            removeTweenAtIndex(i);
+        }
+    }
+    compactTweens();
 }
 
 void ActionManager::removeAllActionsFromTarget(Node *target)
@@ -216,6 +284,8 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         return;
     }
 
+    removeAllTweensFromTarget(target);
+
     tHashElement *element = nullptr;
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
@@ -499,6 +569,355 @@ void ActionManager::update(float dt)
 
     // issue #635
     _currentTarget = nullptr;
+
+    updateTweens(dt);
+}
+
+// tweens
+
+unsigned int ActionManager::addTween(Node *target, TweenProperty property, float duration, const Vec3& value,
+                                     tweenfunc::TweenType easing, const std::function<void()>& callback)
+{
+    CCASSERT(target != nullptr, "target can't be nullptr!");
+    CCASSERT(easing != tweenfunc::CUSTOM_EASING, "custom easing isn't supported by tweens!");
+    if (target == nullptr)
+    {
+        return 0;
+    }
+
+    auto iter = _tweenTargets.find(target);
+    if (iter == _tweenTargets.end())
+    {
+        // new tweens are paused like the actions of the target
+        tHashElement *element = nullptr;
+        HASH_FIND_PTR(_targets, &target, element);
+        TweenTarget tweenTarget;
+        tweenTarget.count = 0;
+        tweenTarget.paused = element ? element->paused : ! target->isRunning();
+        iter = _tweenTargets.emplace(target, tweenTarget).first;
+        target->retain();
+    }
+    iter->second.count++;
+
+    Vec3 start;
+    Vec3 delta;
+    switch (property)
+    {
+        case TweenProperty::POSITION:
+            start = target->getPosition3D();
+            delta = value - start;
+            break;
+        case TweenProperty::SCALE:
+            start.set(target->getScaleX(), target->getScaleY(), target->getScaleZ());
+            delta = value - start;
+            break;
+        case TweenProperty::ROTATION:
+            start.set(target->getRotationSkewX(), target->getRotationSkewY(), 0);
+            calculateTweenAngles(start.x, delta.x, value.x);
+            calculateTweenAngles(start.y, delta.y, value.x);
+            break;
+        case TweenProperty::OPACITY:
+            start.x = target->getOpacity();
+            delta.x = value.x - start.x;
+            break;
+    }
+
+    // ids only grow, _tweens stays sorted by id
+    if (++_tweenIdCounter == 0)
+    {
+        ++_tweenIdCounter;
+    }
+
+    Tween tween;
+    tween.id = _tweenIdCounter;
+    tween.target = target;
+    tween.property = property;
+    tween.easing = easing;
+    tween.flags = TWEEN_STARTING | (iter->second.paused ? TWEEN_PAUSED : 0);
+    tween.callback = callback;
+    _tweens.push_back(std::move(tween));
+
+    // same as ActionInterval::initWithDuration
+    _tweenDurations.push_back(std::abs(duration) <= MATH_EPSILON ? MATH_EPSILON : duration);
+    _tweenElapsed.push_back(MATH_EPSILON);
+    _tweenRates.push_back(0);
+    _tweenTimes.push_back(0);
+    const float startValues[3] = { start.x, start.y, start.z };
+    const float deltaValues[3] = { delta.x, delta.y, delta.z };
+    for (int k = 0; k < 3; ++k)
+    {
+        _tweenStart[k].push_back(startValues[k]);
+        _tweenDelta[k].push_back(deltaValues[k]);
+        _tweenValues[k].push_back(startValues[k]);
+    }
+
+    return _tweenIdCounter;
+}
+
+void ActionManager::removeTween(unsigned int tweenId)
+{
+    auto iter = std::lower_bound(_tweens.begin(), _tweens.end(), tweenId, [](const Tween& tween, unsigned int id) {
+        return tween.id < id;
+    });
+    if (iter != _tweens.end() && iter->id == tweenId && ! (iter->flags & TWEEN_REMOVED))
+    {
+        removeTweenAtIndex(iter - _tweens.begin());
+        compactTweens();
+    }
+}
+
+void ActionManager::removeAllTweensFromTarget(Node *target)
+{
+    auto iter = _tweenTargets.find(target);
+    if (iter == _tweenTargets.end())
+    {
+        return;
+    }
+
+    for (size_t i = 0, count = _tweens.size(); i < count; ++i)
+    {
+        if (_tweens[i].target == target && ! (_tweens[i].flags & TWEEN_REMOVED))
+        {
+            removeTweenAtIndex(i);
+        }
+    }
+    compactTweens();
+}
+
+bool ActionManager::isTweenRunning(unsigned int tweenId) const
+{
+    auto iter = std::lower_bound(_tweens.begin(), _tweens.end(), tweenId, [](const Tween& tween, unsigned int id) {
+        return tween.id < id;
+    });
+    return iter != _tweens.end() && iter->id == tweenId && ! (iter->flags & TWEEN_REMOVED);
+}
+
+ssize_t ActionManager::getNumberOfRunningTweensInTarget(const Node *target) const
+{
+    auto iter = _tweenTargets.find(const_cast<Node*>(target));
+    return iter != _tweenTargets.end() ? iter->second.count : 0;
+}
+
+void ActionManager::setTweensPaused(Node *target, bool paused)
+{
+    auto iter = _tweenTargets.find(target);
+    if (iter == _tweenTargets.end() || iter->second.paused == paused)
+    {
+        return;
+    }
+
+    iter->second.paused = paused;
+    for (size_t i = 0, count = _tweens.size(); i < count; ++i)
+    {
+        Tween& tween = _tweens[i];
+        if (tween.target != target || (tween.flags & TWEEN_REMOVED))
+        {
+            continue;
+        }
+
+        if (paused)
+        {
+            tween.flags |= TWEEN_PAUSED;
+            _tweenRates[i] = 0;
+        }
+        else
+        {
+            tween.flags &= ~TWEEN_PAUSED;
+            _tweenRates[i] = (tween.flags & TWEEN_STARTING) ? 0.0f : 1.0f;
+        }
+    }
+}
+
+void ActionManager::removeTweenAtIndex(size_t index)
+{
+    Tween& tween = _tweens[index];
+    tween.flags |= TWEEN_REMOVED;
+    _tweenRates[index] = 0;
+    ++_removedTweenCount;
+
+    auto iter = _tweenTargets.find(tween.target);
+    if (--iter->second.count == 0)
+    {
+        // released once the arrays are compacted, releasing the target may remove other tweens
+        _tweenTargets.erase(iter);
+        _tweenTargetsToRelease.push_back(tween.target);
+    }
+}
+
+void ActionManager::compactTweens()
+{
+    if (_updatingTweens || _removedTweenCount == 0)
+    {
+        return;
+    }
+
+    size_t count = _tweens.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_tweens[i].flags & TWEEN_REMOVED)
+        {
+            continue;
+        }
+
+        if (kept != i)
+        {
+            moveTweenData(_tweens, kept, i);
+            moveTweenData(_tweenElapsed, kept, i);
+            moveTweenData(_tweenDurations, kept, i);
+            moveTweenData(_tweenRates, kept, i);
+            moveTweenData(_tweenTimes, kept, i);
+            for (int k = 0; k < 3; ++k)
+            {
+                moveTweenData(_tweenStart[k], kept, i);
+                moveTweenData(_tweenDelta[k], kept, i);
+                moveTweenData(_tweenValues[k], kept, i);
+            }
+        }
+        ++kept;
+    }
+
+    _tweens.resize(kept);
+    _tweenElapsed.resize(kept);
+    _tweenDurations.resize(kept);
+    _tweenRates.resize(kept);
+    _tweenTimes.resize(kept);
+    for (int k = 0; k < 3; ++k)
+    {
+        _tweenStart[k].resize(kept);
+        _tweenDelta[k].resize(kept);
+        _tweenValues[k].resize(kept);
+    }
+    _removedTweenCount = 0;
+
+    std::vector<Node*> targets;
+    targets.swap(_tweenTargetsToRelease);
+    for (auto target : targets)
+    {
+        target->release();
+    }
+}
+
+void ActionManager::updateTweens(float dt)
+{
+    const size_t count = _tweens.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    // the tweens added by the callbacks below are updated from the next frame, as for actions
+
+    // advance the time of all the tweens, the paused ones have a rate of 0
+    float *elapsed = _tweenElapsed.data();
+    const float *rates = _tweenRates.data();
+    const float *durations = _tweenDurations.data();
+    float *times = _tweenTimes.data();
+    for (size_t i = 0; i < count; ++i)
+    {
+        elapsed[i] += dt * rates[i];
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        times[i] = std::min(1.0f, elapsed[i] / durations[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_tweens[i].easing != tweenfunc::Linear)
+        {
+            times[i] = tweenfunc::tweenTo(times[i], _tweens[i].easing, nullptr);
+        }
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const float *start = _tweenStart[k].data();
+        const float *delta = _tweenDelta[k].data();
+        float *values = _tweenValues[k].data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = start[i] + delta[i] * times[i];
+        }
+    }
+
+    // the setters may be overridden and add or remove tweens, so the arrays are indexed again for each tween
+    _updatingTweens = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_tweens[i].flags & (TWEEN_PAUSED | TWEEN_REMOVED))
+        {
+            continue;
+        }
+
+        Node *target = _tweens[i].target;
+        switch (_tweens[i].property)
+        {
+            case TweenProperty::POSITION:
+                target->setPosition3D(Vec3(_tweenValues[0][i], _tweenValues[1][i], _tweenValues[2][i]));
+                break;
+            case TweenProperty::SCALE:
+                target->setScaleX(_tweenValues[0][i]);
+                target->setScaleY(_tweenValues[1][i]);
+                target->setScaleZ(_tweenValues[2][i]);
+                break;
+            case TweenProperty::ROTATION:
+                target->setRotationSkewX(_tweenValues[0][i]);
+                target->setRotationSkewY(_tweenValues[1][i]);
+                break;
+            case TweenProperty::OPACITY:
+                target->setOpacity((GLubyte)_tweenValues[0][i]);
+                break;
+        }
+
+        Tween& tween = _tweens[i];
+        if (tween.flags & TWEEN_REMOVED)
+        {
+            continue;
+        }
+
+        if (_tweenElapsed[i] >= _tweenDurations[i])
+        {
+            if (tween.callback)
+            {
+                // compactTweens() below releases the target of the tween, it's kept until the callback has run
+                tween.target->retain();
+                _tweenCompletions.push_back(std::make_pair(tween.target, std::move(tween.callback)));
+            }
+            removeTweenAtIndex(i);
+        }
+        else if (tween.flags & TWEEN_STARTING)
+        {
+            tween.flags &= ~TWEEN_STARTING;
+            _tweenRates[i] = 1;
+        }
+    }
+
+    //if some node reference 'target', it's reference count >= 2 (issues #14050)
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (! (_tweens[i].flags & TWEEN_REMOVED) && _tweens[i].target->getReferenceCount() == 1)
+        {
+            removeTweenAtIndex(i);
+        }
+    }
+    _updatingTweens = false;
+
+    compactTweens();
+
+    if (! _tweenCompletions.empty())
+    {
+        std::vector<std::pair<Node*, std::function<void()>>> completions;
+        completions.swap(_tweenCompletions);
+        for (const auto& completion : completions)
+        {
+            completion.second();
+        }
+        for (const auto& completion : completions)
+        {
+            completion.first->release();
+        }
+    }
 }
 
 NS_CC_END
@@ -30,9 +30,16 @@ THE SOFTWARE.
 #ifndef __ACTION_CCACTION_MANAGER_H__
 #define __ACTION_CCACTION_MANAGER_H__
 
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "2d/CCAction.h"
+#include "2d/CCTweenFunction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
+#include "math/Vec3.h"
 
 NS_CC_BEGIN
 
@@ -53,12 +60,26 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions.
+    - When you want to run many simple moves, scales, rotations or fades with addTween.
  
  @since v0.8
  */
 class CC_DLL ActionManager : public Ref
 {
 public:
+    /** The properties of a Node that addTween can animate. */
+    enum class TweenProperty
+    {
+        /** The position, like MoveTo. */
+        POSITION,
+        /** The scale, like ScaleTo. */
+        SCALE,
+        /** The rotation, along the shortest path like RotateTo. Only the x component of the value is used. */
+        ROTATION,
+        /** The opacity, like FadeTo. Only the x component of the value is used. */
+        OPACITY
+    };
+
     /**
      * @js ctor
      */
@@ -194,6 +215,48 @@ public:
      */
     virtual void resumeTargets(const Vector<Node*>& targetsToResume);
     
+    // tweens
+
+    /** Animates a property of a target to a value.
+     A tween does the same as a MoveTo, ScaleTo, RotateTo or FadeTo wrapped in an EaseXXX action, without creating
+     any object: the tweens are stored in contiguous arrays and all of them are updated at once after the actions.
+     Like the actions, the tweens of a target are paused with pauseTarget and removed with removeAllActionsFromTarget.
+     * @param target    The target to animate, it is retained until the tween is done.
+     * @param property  The property to animate.
+     * @param duration  The duration in seconds.
+     * @param value     The final value of the property.
+     * @param easing    The easing of the tween, CUSTOM_EASING isn't supported.
+     * @param callback  Called once the tween is done, after all the tweens of the frame were updated. Can be nullptr.
+     * @return  The id of the tween, it is never 0.
+     * @since v3.17
+     */
+    unsigned int addTween(Node *target, TweenProperty property, float duration, const Vec3& value,
+                          tweenfunc::TweenType easing = tweenfunc::Linear, const std::function<void()>& callback = nullptr);
+
+    /** Removes a tween, its callback isn't called.
+     * @param tweenId   The id returned by addTween.
+     * @since v3.17
+     */
+    void removeTween(unsigned int tweenId);
+
+    /** Removes all the tweens of a target, their callbacks aren't called.
+     * @param target    A certain target.
+     * @since v3.17
+     */
+    void removeAllTweensFromTarget(Node *target);
+
+    /** Returns whether a tween is still running.
+     * @param tweenId   The id returned by addTween.
+     * @since v3.17
+     */
+    bool isTweenRunning(unsigned int tweenId) const;
+
+    /** Returns the numbers of tweens that are running in a certain target.
+     * @param target    A certain target.
+     * @since v3.17
+     */
+    ssize_t getNumberOfRunningTweensInTarget(const Node *target) const;
+
     /** Main loop of ActionManager.
      * @param dt    In seconds.
      */
@@ -206,10 +269,50 @@ protected:
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
 
+    void updateTweens(float dt);
+    void setTweensPaused(Node *target, bool paused);
+    void removeTweenAtIndex(size_t index);
+    void compactTweens();
+
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+
+    struct TweenTarget
+    {
+        unsigned int count;
+        bool paused;
+    };
+
+    struct Tween
+    {
+        unsigned int id;
+        Node *target;
+        TweenProperty property;
+        tweenfunc::TweenType easing;
+        unsigned char flags;
+        std::function<void()> callback;
+    };
+
+    // sorted by id, the per frame data is stored in the parallel arrays below
+    std::vector<Tween> _tweens;
+    std::vector<float> _tweenElapsed;
+    std::vector<float> _tweenDurations;
+    // 0 when the tween doesn't advance: paused, removed or not started
+    std::vector<float> _tweenRates;
+    std::vector<float> _tweenTimes;
+    std::vector<float> _tweenStart[3];
+    std::vector<float> _tweenDelta[3];
+    std::vector<float> _tweenValues[3];
+
+    std::unordered_map<Node*, TweenTarget> _tweenTargets;
+    std::vector<Node*> _tweenTargetsToRelease;
+    // the targets are retained until their callbacks have run
+    std::vector<std::pair<Node*, std::function<void()>>> _tweenCompletions;
+    unsigned int _tweenIdCounter;
+    size_t _removedTweenCount;
+    bool _updatingTweens;
 };
 
 // end of actions group
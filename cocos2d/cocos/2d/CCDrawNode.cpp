@@ -37,6 +37,15 @@
 
 NS_CC_BEGIN
 
+// scratch memory for the current draw call, it is released by the renderer at the end of the frame
+template <typename T>
+static T* allocateFrameScratch(size_t count)
+{
+    T* scratch = (T*)Director::getInstance()->getRenderer()->getFrameAllocator()->allocate(sizeof(T) * count);
+    std::uninitialized_fill_n(scratch, count, T());
+    return scratch;
+}
+
 // Vec2 == CGPoint in 32-bits, but not in 64-bits (OS X)
 // that's why the "v2f" functions are needed
 static Vec2 v2fzero(0.0f,0.0f);
@@ -534,9 +543,7 @@ void DrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigne
 {
     const float coef = 2.0f * (float)M_PI/segments;
     
-    Vec2 *vertices = new (std::nothrow) Vec2[segments+2];
-    if( ! vertices )
-        return;
+    Vec2* vertices = allocateFrameScratch<Vec2>(segments+2);
     
     for(unsigned int i = 0;i <= segments; i++) {
         float rads = i*coef;
@@ -554,8 +561,6 @@ void DrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigne
     }
     else
         drawPoly(vertices, segments+1, true, color);
-    
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCircle(const Vec2 &center, float radius, float angle, unsigned int segments, bool drawLineToCenter, const Color4F &color)
@@ -565,9 +570,7 @@ void DrawNode::drawCircle(const Vec2 &center, float radius, float angle, unsigne
 
 void DrawNode::drawQuadBezier(const Vec2 &origin, const Vec2 &control, const Vec2 &destination, unsigned int segments, const Color4F &color)
 {
-    Vec2* vertices = new (std::nothrow) Vec2[segments + 1];
-    if( ! vertices )
-        return;
+    Vec2* vertices = allocateFrameScratch<Vec2>(segments + 1);
     
     float t = 0.0f;
     for(unsigned int i = 0; i < segments; i++)
@@ -580,15 +583,11 @@ void DrawNode::drawQuadBezier(const Vec2 &origin, const Vec2 &control, const Vec
     vertices[segments].y = destination.y;
     
     drawPoly(vertices, segments+1, false, color);
-
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCubicBezier(const Vec2 &origin, const Vec2 &control1, const Vec2 &control2, const Vec2 &destination, unsigned int segments, const Color4F &color)
 {
-    Vec2* vertices = new (std::nothrow) Vec2[segments + 1];
-    if( ! vertices )
-        return;
+    Vec2* vertices = allocateFrameScratch<Vec2>(segments + 1);
     
     float t = 0;
     for (unsigned int i = 0; i < segments; i++)
@@ -601,15 +600,11 @@ void DrawNode::drawCubicBezier(const Vec2 &origin, const Vec2 &control1, const V
     vertices[segments].y = destination.y;
     
     drawPoly(vertices, segments+1, false, color);
-
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCardinalSpline(PointArray *config, float tension,  unsigned int segments, const Color4F &color)
 {
-    Vec2* vertices = new (std::nothrow) Vec2[segments + 1];
-    if( ! vertices )
-        return;
+    Vec2* vertices = allocateFrameScratch<Vec2>(segments + 1);
     
     ssize_t p;
     float lt;
@@ -640,8 +635,6 @@ void DrawNode::drawCardinalSpline(PointArray *config, float tension,  unsigned i
     }
     
     drawPoly(vertices, segments+1, false, color);
-    
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawCatmullRom(PointArray *points, unsigned int segments, const Color4F &color)
@@ -778,8 +771,7 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
     if(outline)
     {
         struct ExtrudeVerts {Vec2 offset, n;};
-        struct ExtrudeVerts* extrude = (struct ExtrudeVerts*)malloc(sizeof(struct ExtrudeVerts)*count);
-        memset(extrude, 0, sizeof(struct ExtrudeVerts)*count);
+        struct ExtrudeVerts* extrude = allocateFrameScratch<struct ExtrudeVerts>(count);
         
         for (int i = 0; i < count; i++)
         {
@@ -825,8 +817,6 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
             };
             *cursor++ = tmp2;
         }
-        
-        free(extrude);
     }
     
     _bufferCount += vertex_count;
@@ -855,9 +845,7 @@ void DrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, un
 {
     const float coef = 2.0f * (float)M_PI/segments;
     
-    Vec2 *vertices = new (std::nothrow) Vec2[segments];
-    if( ! vertices )
-        return;
+    Vec2* vertices = allocateFrameScratch<Vec2>(segments);
     
     for(unsigned int i = 0;i < segments; i++)
     {
@@ -870,8 +858,6 @@ void DrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, un
     }
     
     drawSolidPoly(vertices, segments, color);
-    
-    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void DrawNode::drawSolidCircle( const Vec2& center, float radius, float angle, unsigned int segments, const Color4F& color)
@@ -36,6 +36,8 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCJobSystem.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
@@ -44,6 +46,55 @@ const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
 
+namespace
+{
+    // letters rendered by each job of prepareLetterDefinitionsAsync
+    const size_t AsyncLettersPerJob = 16;
+
+    const char AtlasFileMagic[4] = { 'C', 'C', 'F', 'A' };
+    const int AtlasFileVersion = 1;
+
+    struct AtlasFileHeader
+    {
+        char magic[4];
+        int version;
+        int width;
+        int height;
+        int bytesPerPixel;
+        int pageCount;
+        int letterCount;
+        float currentPageOrigX;
+        float currentPageOrigY;
+        int currLineHeight;
+        float lineHeight;
+    };
+
+    struct AtlasFileLetter
+    {
+        unsigned int utf32Char;
+        float U;
+        float V;
+        float width;
+        float height;
+        float offsetX;
+        float offsetY;
+        int textureID;
+        int xAdvance;
+        int validDefinition;
+    };
+
+    struct AsyncLetter
+    {
+        char32_t utf32Char;
+        unsigned int charCode;
+        unsigned char* bitmap;
+        long width;
+        long height;
+        Rect rect;
+        int xAdvance;
+    };
+}
+
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _fontFreeType(nullptr)
@@ -53,6 +104,8 @@ FontAtlas::FontAtlas(Font &theFont)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _currLineHeight(0)
+, _pagesDataKept(false)
+, _modified(false)
 {
     _font->retain();
 
@@ -89,8 +142,6 @@ void FontAtlas::reinit()
         _currentPageData = nullptr;
     }
     
-    auto texture = new (std::nothrow) Texture2D;
-    
     _currentPageDataSize = CacheTextureWidth * CacheTextureHeight;
     
     auto outlineSize = _fontFreeType->getOutlineSize();
@@ -103,14 +154,28 @@ void FontAtlas::reinit()
     _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
     memset(_currentPageData, 0, _currentPageDataSize);
     
-    auto  pixelFormat = outlineSize > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
-    texture->initWithData(_currentPageData, _currentPageDataSize,
-                          pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
-    
+    auto texture = createPageTexture();
     addTexture(texture,0);
     texture->release();
 }
 
+Texture2D* FontAtlas::createPageTexture()
+{
+    auto texture = new (std::nothrow) Texture2D;
+    if (_antialiasEnabled)
+    {
+        texture->setAntiAliasTexParameters();
+    }
+    else
+    {
+        texture->setAliasTexParameters();
+    }
+    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    texture->initWithData(_currentPageData, _currentPageDataSize,
+                          pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+    return texture;
+}
+
 FontAtlas::~FontAtlas()
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -145,6 +210,7 @@ void FontAtlas::reset()
     _currentPageOrigX = 0;
     _currentPageOrigY = 0;
     _letterDefinitions.clear();
+    _pagesData.clear();
     
     reinit();
 }
@@ -352,117 +418,380 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
     long bitmapWidth;
     long bitmapHeight;
-    int glyphHeight;
     Rect tempRect;
-    FontLetterDefinition tempDef;
-
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    int xAdvance;
 
     float startY = _currentPageOrigY;
 
     for (auto&& it : codeMapOfNewChar)
     {
-        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
-        if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
-        {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+        auto bitmap = _fontFreeType->renderGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, xAdvance);
+        addLetter(it.first, bitmap, bitmapWidth, bitmapHeight, tempRect, xAdvance, startY);
+        delete [] bitmap;
+    }
+
+    updateCurrentPageTexture(startY);
 
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+    return true;
+}
+
+void FontAtlas::addLetter(char32_t utf32Char, const unsigned char* bitmap, long bitmapWidth, long bitmapHeight, const Rect& rect, int xAdvance, float& startY)
+{
+    FontLetterDefinition tempDef;
+    tempDef.xAdvance = xAdvance;
+
+    if (bitmap)
+    {
+        int adjustForDistanceMap = _letterPadding / 2;
+        int adjustForExtend = _letterEdgeExtend / 2;
+        auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+        tempDef.validDefinition = true;
+        tempDef.width = rect.size.width + _letterPadding + _letterEdgeExtend;
+        tempDef.height = rect.size.height + _letterPadding + _letterEdgeExtend;
+        tempDef.offsetX = rect.origin.x - adjustForDistanceMap - adjustForExtend;
+        tempDef.offsetY = _fontAscender + rect.origin.y - adjustForDistanceMap - adjustForExtend;
+
+        if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+        {
+            _currentPageOrigY += _currLineHeight;
+            _currLineHeight = 0;
+            _currentPageOrigX = 0;
+            if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
             {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
+                _currentPageOrigY = CacheTextureHeight;
+                updateCurrentPageTexture(startY);
+                if (_pagesDataKept)
                 {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
+                    _pagesData.emplace_back(_currentPageData, _currentPageData + _currentPageDataSize);
                 }
+
+                startY = 0.0f;
+
+                _currentPageOrigY = 0;
+                memset(_currentPageData, 0, _currentPageDataSize);
+                _currentPage++;
+                auto tex = createPageTexture();
+                addTexture(tex, _currentPage);
+                tex->release();
+            }
+        }
+        // the bitmap already includes the distance map spread
+        int glyphHeight = static_cast<int>(bitmapHeight) + _letterEdgeExtend;
+        if (glyphHeight > _currLineHeight)
+        {
+            _currLineHeight = glyphHeight;
+        }
+
+        int bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+        auto dest = _currentPageData + (((int)_currentPageOrigY + adjustForExtend) * CacheTextureWidth + (int)_currentPageOrigX + adjustForExtend) * bytesPerPixel;
+        for (long y = 0; y < bitmapHeight; ++y)
+        {
+            memcpy(dest + y * CacheTextureWidth * bytesPerPixel, bitmap + y * bitmapWidth * bytesPerPixel, bitmapWidth * bytesPerPixel);
+        }
+
+        tempDef.U = _currentPageOrigX;
+        tempDef.V = _currentPageOrigY;
+        tempDef.textureID = _currentPage;
+        _currentPageOrigX += tempDef.width + 1;
+        // take from pixels to points
+        tempDef.width = tempDef.width / scaleFactor;
+        tempDef.height = tempDef.height / scaleFactor;
+        tempDef.U = tempDef.U / scaleFactor;
+        tempDef.V = tempDef.V / scaleFactor;
+    }
+    else
+    {
+        if (tempDef.xAdvance)
+            tempDef.validDefinition = true;
+        else
+            tempDef.validDefinition = false;
+
+        tempDef.width = 0;
+        tempDef.height = 0;
+        tempDef.U = 0;
+        tempDef.V = 0;
+        tempDef.offsetX = 0;
+        tempDef.offsetY = 0;
+        tempDef.textureID = 0;
+        _currentPageOrigX += 1;
+    }
+
+    _letterDefinitions[utf32Char] = tempDef;
+    _modified = true;
+}
+
+void FontAtlas::updateCurrentPageTexture(float startY)
+{
+    int bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    auto data = _currentPageData + CacheTextureWidth * (int)startY * bytesPerPixel;
+    float height = std::min<float>(_currentPageOrigY - startY + _currLineHeight, CacheTextureHeight - startY);
+    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, height);
+}
+
+void FontAtlas::prepareLetterDefinitionsAsync(const std::u32string& utf32Text, const std::function<void()>& callback)
+{
+    if (_fontFreeType == nullptr)
+    {
+        if (callback)
+            callback();
+        return;
+    }
+
+    if (!_currentPageData)
+        reinit();
+
+    std::unordered_map<unsigned int, unsigned int> codeMapOfNewChar;
+    findNewCharacters(utf32Text, codeMapOfNewChar);
+
+    auto letters = std::make_shared<std::vector<AsyncLetter>>();
+    letters->reserve(codeMapOfNewChar.size());
+    for (auto&& it : codeMapOfNewChar)
+    {
+        if (_pendingLetters.insert(it.first).second)
+        {
+            AsyncLetter letter;
+            letter.utf32Char = it.first;
+            letter.charCode = it.second;
+            letter.bitmap = nullptr;
+            letter.width = 0;
+            letter.height = 0;
+            letter.xAdvance = 0;
+            letters->push_back(letter);
+        }
+    }
+
+    if (letters->empty())
+    {
+        if (callback)
+            callback();
+        return;
+    }
+
+    // FreeType faces can't be used by several threads, each job renders its letters with its own face
+    auto jobSystem = JobSystem::getInstance();
+    size_t jobCount = (letters->size() + AsyncLettersPerJob - 1) / AsyncLettersPerJob;
+    jobCount = std::max<size_t>(1, std::min<size_t>(jobSystem->getWorkerCount(), jobCount));
+    size_t lettersPerJob = (letters->size() + jobCount - 1) / jobCount;
+
+    auto fonts = std::make_shared<std::vector<FontFreeType*>>();
+    for (size_t i = 0; i < jobCount; ++i)
+    {
+        auto font = FontFreeType::create(_fontFreeType->getFontName(), _fontFreeType->getFontSize(), GlyphCollection::DYNAMIC, nullptr,
+                                         _fontFreeType->isDistanceFieldEnabled(), _fontFreeType->getOutlineSize() / CC_CONTENT_SCALE_FACTOR());
+        if (font == nullptr)
+            break;
+        font->retain();
+        fonts->push_back(font);
+    }
+
+    if (fonts->size() < jobCount)
+    {
+        for (auto font : *fonts)
+            font->release();
+        for (auto&& letter : *letters)
+            _pendingLetters.erase(letter.utf32Char);
+        prepareLetterDefinitions(utf32Text);
+        if (callback)
+            callback();
+        return;
+    }
+
+    retain();
+    jobSystem->dispatch([jobSystem, letters, fonts, lettersPerJob]() {
+        auto job = jobSystem->parallelFor(letters->size(), lettersPerJob, [letters, fonts, lettersPerJob](size_t begin, size_t end) {
+            auto font = (*fonts)[begin / lettersPerJob];
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto& letter = (*letters)[i];
+                letter.bitmap = font->renderGlyphBitmap(letter.charCode, letter.width, letter.height, letter.rect, letter.xAdvance);
             }
-            glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
-            if (glyphHeight > _currLineHeight)
+        });
+        jobSystem->wait(job);
+        job->release();
+    }, [this, letters, fonts, callback]() {
+        for (auto font : *fonts)
+            font->release();
+
+        float startY = _currentPageOrigY;
+        bool added = false;
+        for (auto&& letter : *letters)
+        {
+            _pendingLetters.erase(letter.utf32Char);
+            // the letter may have been added by prepareLetterDefinitions meanwhile
+            if (_letterDefinitions.find(letter.utf32Char) == _letterDefinitions.end())
             {
-                _currLineHeight = glyphHeight;
+                addLetter(letter.utf32Char, letter.bitmap, letter.width, letter.height, letter.rect, letter.xAdvance, startY);
+                added = true;
             }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
-        }
-        else{
-            if(bitmap)
-                delete[] bitmap;
-            if (tempDef.xAdvance)
-                tempDef.validDefinition = true;
-            else
-                tempDef.validDefinition = false;
-
-            tempDef.width = 0;
-            tempDef.height = 0;
-            tempDef.U = 0;
-            tempDef.V = 0;
-            tempDef.offsetX = 0;
-            tempDef.offsetY = 0;
-            tempDef.textureID = 0;
-            _currentPageOrigX += 1;
+            delete [] letter.bitmap;
         }
 
-        _letterDefinitions[it.first] = tempDef;
+        if (added)
+            updateCurrentPageTexture(startY);
+
+        if (callback)
+            callback();
+        release();
+    });
+}
+
+bool FontAtlas::saveToFile(const std::string& fullPath)
+{
+    if (_fontFreeType == nullptr || !_currentPageData)
+        return false;
+
+    // the full pages can't be read back from their textures
+    if (_currentPage != (int)_pagesData.size())
+    {
+        CCLOG("FontAtlas::saveToFile: the full pages of %s were not kept", getFontName().c_str());
+        return false;
     }
 
-    unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    AtlasFileHeader header;
+    memcpy(header.magic, AtlasFileMagic, sizeof(header.magic));
+    header.version = AtlasFileVersion;
+    header.width = CacheTextureWidth;
+    header.height = CacheTextureHeight;
+    header.bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    header.pageCount = _currentPage + 1;
+    header.letterCount = (int)_letterDefinitions.size();
+    header.currentPageOrigX = _currentPageOrigX;
+    header.currentPageOrigY = _currentPageOrigY;
+    header.currLineHeight = _currLineHeight;
+    header.lineHeight = _lineHeight;
+
+    std::vector<unsigned char> buffer;
+    buffer.reserve(sizeof(header) + _letterDefinitions.size() * sizeof(AtlasFileLetter) + header.pageCount * _currentPageDataSize);
+    auto append = [&buffer](const void* data, size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    };
+
+    append(&header, sizeof(header));
+    for (auto&& it : _letterDefinitions)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+        AtlasFileLetter letter;
+        letter.utf32Char = it.first;
+        letter.U = it.second.U;
+        letter.V = it.second.V;
+        letter.width = it.second.width;
+        letter.height = it.second.height;
+        letter.offsetX = it.second.offsetX;
+        letter.offsetY = it.second.offsetY;
+        letter.textureID = it.second.textureID;
+        letter.xAdvance = it.second.xAdvance;
+        letter.validDefinition = it.second.validDefinition ? 1 : 0;
+        append(&letter, sizeof(letter));
     }
-    else
+    for (auto&& page : _pagesData)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY;
+        append(page.data(), page.size());
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
+    append(_currentPageData, _currentPageDataSize);
+
+    Data data;
+    data.fastSet(buffer.data(), buffer.size());
+    bool ret = FileUtils::getInstance()->writeDataToFile(data, fullPath);
+    data.takeBuffer(nullptr);
+
+    if (ret)
+        _modified = false;
+    return ret;
+}
+
+bool FontAtlas::loadFromFile(const std::string& fullPath)
+{
+    if (_fontFreeType == nullptr || !_pendingLetters.empty())
+        return false;
+
+    if (!_currentPageData)
+        reinit();
+
+    Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+    if (data.getSize() < 0 || (size_t)data.getSize() < sizeof(AtlasFileHeader))
+        return false;
+    size_t dataSize = (size_t)data.getSize();
+
+    auto bytes = data.getBytes();
+    AtlasFileHeader header;
+    memcpy(&header, bytes, sizeof(header));
+    int bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    if (memcmp(header.magic, AtlasFileMagic, sizeof(header.magic)) != 0
+        || header.version != AtlasFileVersion
+        || header.width != CacheTextureWidth
+        || header.height != CacheTextureHeight
+        || header.bytesPerPixel != bytesPerPixel
+        || header.pageCount <= 0
+        || header.letterCount < 0)
+    {
+        CCLOG("FontAtlas::loadFromFile: %s isn't a font atlas of %s", fullPath.c_str(), getFontName().c_str());
+        return false;
+    }
+
+    size_t lettersSize = header.letterCount * sizeof(AtlasFileLetter);
+    if (dataSize != sizeof(header) + lettersSize + header.pageCount * (size_t)_currentPageDataSize)
+    {
+        CCLOG("FontAtlas::loadFromFile: %s is truncated", fullPath.c_str());
+        return false;
+    }
+
+    // the letters are checked before the current atlas is dropped
+    auto letters = bytes + sizeof(header);
+    for (int i = 0; i < header.letterCount; ++i)
+    {
+        AtlasFileLetter letter;
+        memcpy(&letter, letters + i * sizeof(letter), sizeof(letter));
+        if (letter.textureID < 0 || letter.textureID >= header.pageCount)
+        {
+            CCLOG("FontAtlas::loadFromFile: %s has a letter on a missing page", fullPath.c_str());
+            return false;
+        }
+    }
+
+    releaseTextures();
+    _letterDefinitions.clear();
+    _pagesData.clear();
+
+    for (int i = 0; i < header.letterCount; ++i)
+    {
+        AtlasFileLetter letter;
+        memcpy(&letter, letters + i * sizeof(letter), sizeof(letter));
+
+        FontLetterDefinition definition;
+        definition.U = letter.U;
+        definition.V = letter.V;
+        definition.width = letter.width;
+        definition.height = letter.height;
+        definition.offsetX = letter.offsetX;
+        definition.offsetY = letter.offsetY;
+        definition.textureID = letter.textureID;
+        definition.xAdvance = letter.xAdvance;
+        definition.validDefinition = letter.validDefinition != 0;
+        _letterDefinitions[letter.utf32Char] = definition;
+    }
+
+    auto pages = letters + lettersSize;
+    for (int page = 0; page < header.pageCount; ++page)
+    {
+        memcpy(_currentPageData, pages + page * _currentPageDataSize, _currentPageDataSize);
+        if (_pagesDataKept && page + 1 < header.pageCount)
+        {
+            _pagesData.emplace_back(_currentPageData, _currentPageData + _currentPageDataSize);
+        }
+        auto texture = createPageTexture();
+        addTexture(texture, page);
+        texture->release();
+    }
+
+    _currentPage = header.pageCount - 1;
+    _currentPageOrigX = header.currentPageOrigX;
+    _currentPageOrigY = header.currentPageOrigY;
+    _currLineHeight = header.currLineHeight;
+    _lineHeight = header.lineHeight;
+    _modified = false;
 
     return true;
 }
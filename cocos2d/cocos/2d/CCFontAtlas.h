@@ -29,8 +29,11 @@
 
 /// @cond DO_NOT_SHOW
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
@@ -43,6 +46,7 @@ class Texture2D;
 class EventCustom;
 class EventListenerCustom;
 class FontFreeType;
+struct Rect;
 
 struct FontLetterDefinition
 {
@@ -79,6 +83,24 @@ public:
     
     bool prepareLetterDefinitions(const std::u32string& utf16String);
 
+    /** Renders the new letters of a text on the JobSystem instead of the cocos thread.
+     Several faces of the font render the letters in parallel, then the letters are added to the atlas
+     on the cocos thread and the callback is called.
+     */
+    void prepareLetterDefinitionsAsync(const std::u32string& utf32Text, const std::function<void()>& callback = nullptr);
+
+    /** Keeps a copy of the full pages so that saveToFile can save them, the textures can't be read back. */
+    void setPagesDataKept(bool kept) { _pagesDataKept = kept; }
+
+    /** Whether letters were added since the atlas was loaded or saved. */
+    bool isModified() const { return _modified; }
+
+    /** Saves the letters and the pages of a dynamic TTF atlas, the full pages are only saved if setPagesDataKept was enabled before they were filled. */
+    bool saveToFile(const std::string& fullPath);
+
+    /** Replaces the letters and the pages of a dynamic TTF atlas with the ones saved by saveToFile with the same font and config. */
+    bool loadFromFile(const std::string& fullPath);
+
     const std::unordered_map<ssize_t, Texture2D*>& getTextures() const { return _atlasTextures; }
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -122,6 +144,14 @@ protected:
 
     void conversionU32TOGB2312(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
+    /** Places a rendered letter in the current page, startY is the first row of the page to upload. */
+    void addLetter(char32_t utf32Char, const unsigned char* bitmap, long bitmapWidth, long bitmapHeight, const Rect& rect, int xAdvance, float& startY);
+
+    /** Uploads the rows of the current page from startY. */
+    void updateCurrentPageTexture(float startY);
+
+    Texture2D* createPageTexture();
+
     /**
      * Scale each font letter by scaleFactor.
      *
@@ -150,6 +180,12 @@ protected:
     bool _antialiasEnabled;
     int _currLineHeight;
 
+    // letters rendered by prepareLetterDefinitionsAsync
+    std::unordered_set<char32_t> _pendingLetters;
+    std::vector<std::vector<unsigned char>> _pagesData;
+    bool _pagesDataKept;
+    bool _modified;
+
     friend class Label;
 };
 
@@ -32,10 +32,14 @@
 #include "2d/CCFontCharMap.h"
 #include "2d/CCLabel.h"
 #include "platform/CCFileUtils.h"
+#include "base/ccUTF8.h"
+#include "xxhash.h"
 
 NS_CC_BEGIN
 
 std::unordered_map<std::string, FontAtlas *> FontAtlasCache::_atlasMap;
+std::unordered_map<FontAtlas*, std::string> FontAtlasCache::_diskCachePaths;
+bool FontAtlasCache::_diskCacheEnabled = false;
 #define ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE 255
 
 void FontAtlasCache::purgeCachedData()
@@ -49,6 +53,7 @@ void FontAtlasCache::purgeCachedData()
             atlas.second->purgeTexturesAtlas();
     }
     _atlasMap.clear();
+    _diskCachePaths.clear();
 }
 
 FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
@@ -62,7 +67,15 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 
     std::string key;
     char keyPrefix[ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE];
-    snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, useDistanceField ? "df %.2f %d " : "%.2f %d ", config->fontSize, config->outlineSize);
+    if (useDistanceField)
+    {
+        // the labels scale the distance field, so the atlas is rendered once at a fixed size
+        snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, "df %d ", config->outlineSize);
+    }
+    else
+    {
+        snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, "%.2f %d ", config->fontSize, config->outlineSize);
+    }
     std::string atlasName(keyPrefix);
     atlasName += realFontFilename;
 
@@ -70,13 +83,24 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 
     if ( it == _atlasMap.end() )
     {
-        auto font = FontFreeType::create(realFontFilename, config->fontSize, config->glyphs,
+        float fontSize = useDistanceField ? FontFreeType::DistanceFieldFontSize : config->fontSize;
+        auto font = FontFreeType::create(realFontFilename, fontSize, config->glyphs,
             config->customGlyphs, useDistanceField, config->outlineSize);
         if (font)
         {
             auto tempAtlas = font->createFontAtlas();
             if (tempAtlas)
             {
+                if (_diskCacheEnabled)
+                {
+                    auto path = getDiskCachePath(atlasName, font);
+                    tempAtlas->setPagesDataKept(true);
+                    if (FileUtils::getInstance()->isFileExist(path))
+                    {
+                        tempAtlas->loadFromFile(path);
+                    }
+                    _diskCachePaths[tempAtlas] = path;
+                }
                 _atlasMap[atlasName] = tempAtlas;
                 return _atlasMap[atlasName];
             }
@@ -88,6 +112,59 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+void FontAtlasCache::preloadFontAtlasTTF(const _ttfConfig* config, const std::string& text, const std::function<void()>& callback)
+{
+    auto atlas = getFontAtlasTTF(config);
+    std::u32string utf32Text;
+    if (atlas == nullptr || !StringUtils::UTF8ToUTF32(text, utf32Text))
+    {
+        if (callback)
+            callback();
+        return;
+    }
+
+    atlas->prepareLetterDefinitionsAsync(utf32Text, callback);
+}
+
+std::string FontAtlasCache::getDiskCachePath(const std::string& atlasName, FontFreeType* font)
+{
+    char fileName[ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE];
+    snprintf(fileName, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, "%08x_%08x_%.2f.atlas",
+        XXH32(atlasName.data(), atlasName.size(), 0), font->getFontDataHash(), CC_CONTENT_SCALE_FACTOR());
+
+    auto fileUtils = FileUtils::getInstance();
+    auto directory = fileUtils->getWritablePath() + "fontatlas/";
+    if (!fileUtils->isDirectoryExist(directory))
+    {
+        fileUtils->createDirectory(directory);
+    }
+    return directory + fileName;
+}
+
+void FontAtlasCache::saveToDiskCache()
+{
+    for (auto&& item : _diskCachePaths)
+    {
+        if (item.first->isModified())
+        {
+            item.first->saveToFile(item.second);
+        }
+    }
+}
+
+void FontAtlasCache::forgetFontAtlas(FontAtlas* atlas)
+{
+    auto it = _diskCachePaths.find(atlas);
+    if (it != _diskCachePaths.end())
+    {
+        if (atlas->isModified())
+        {
+            atlas->saveToFile(it->second);
+        }
+        _diskCachePaths.erase(it);
+    }
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset /* = Vec2::ZERO */)
 {
     auto realFontFilename = FileUtils::getInstance()->getNewFilename(fontFileName);  // resolves real file path, to prevent storing multiple atlases for the same file.
@@ -207,6 +284,7 @@ bool FontAtlasCache::releaseFontAtlas(FontAtlas *atlas)
             {
                 if (atlas->getReferenceCount() == 1)
                 {
+                  forgetFontAtlas(atlas);
                   _atlasMap.erase(item.first);
                 }
                 
@@ -253,6 +331,7 @@ void FontAtlasCache::unloadFontAtlasTTF(const std::string& fontFileName)
     {
         if (item->first.find(fontFileName) != std::string::npos)
         {
+            forgetFontAtlas(item->second);
             CC_SAFE_RELEASE_NULL(item->second);
             item = _atlasMap.erase(item);
         }
@@ -29,19 +29,25 @@
 
 /// @cond DO_NOT_SHOW
 
+#include <functional>
 #include <unordered_map>
 #include "base/ccTypes.h"
 
 NS_CC_BEGIN
 
 class FontAtlas;
+class FontFreeType;
 class Texture2D;
 struct _ttfConfig;
 
 class CC_DLL FontAtlasCache
 {  
 public:
+    /** Distance field atlases don't depend on the font size, they are shared by the labels of all the sizes. */
     static FontAtlas* getFontAtlasTTF(const _ttfConfig* config);
+
+    /** Renders the letters of a text in the atlas of a TTF config on the JobSystem, the callback is called on the cocos thread once they were added. */
+    static void preloadFontAtlasTTF(const _ttfConfig* config, const std::string& text, const std::function<void()>& callback = nullptr);
     static FontAtlas* getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset = Vec2::ZERO);
 
     static FontAtlas* getFontAtlasCharMap(const std::string& charMapFile, int itemWidth, int itemHeight, int startCharMap);
@@ -67,8 +73,22 @@ public:
     */
     static void unloadFontAtlasTTF(const std::string& fontFileName);
 
+    /** Loads the TTF atlases from the writable path when they are created, instead of rendering their letters again.
+     The atlases are saved by saveToDiskCache, the files are replaced when the font file or the content scale factor change.
+     */
+    static void setDiskCacheEnabled(bool enabled) { _diskCacheEnabled = enabled; }
+    static bool isDiskCacheEnabled() { return _diskCacheEnabled; }
+
+    /** Saves the TTF atlases that got new letters since they were loaded. */
+    static void saveToDiskCache();
+
 private:
+    static std::string getDiskCachePath(const std::string& atlasName, FontFreeType* font);
+    static void forgetFontAtlas(FontAtlas* atlas);
+
     static std::unordered_map<std::string, FontAtlas *> _atlasMap;
+    static std::unordered_map<FontAtlas*, std::string> _diskCachePaths;
+    static bool _diskCacheEnabled;
 };
 
 NS_CC_END
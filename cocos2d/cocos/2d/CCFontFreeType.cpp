@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "2d/CCFontFreeType.h"
 #include FT_BBOX_H
 #include "edtaa3func.h"
+#include "xxhash.h"
 #include "2d/CCFontAtlas.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
@@ -38,6 +39,7 @@ NS_CC_BEGIN
 FT_Library FontFreeType::_FTlibrary;
 bool       FontFreeType::_FTInitialized = false;
 const int  FontFreeType::DistanceMapSpread = 3;
+const int  FontFreeType::DistanceFieldFontSize = 50;
 
 const char* FontFreeType::_glyphASCII = "\"!#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ ";
 const char* FontFreeType::_glyphNEHE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ ";
@@ -102,6 +104,7 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outlin
 : _fontRef(nullptr)
 , _stroker(nullptr)
 , _encoding(FT_ENCODING_UNICODE)
+, _fontSize(0.0f)
 , _distanceFieldEnabled(distanceFieldEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
@@ -125,6 +128,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     FT_Face face;
     // save font name locally
     _fontName = fontName;
+    _fontSize = fontSize;
 
     auto it = s_cacheFontData.find(fontName);
     if (it != s_cacheFontData.end())
@@ -208,6 +212,15 @@ FontFreeType::~FontFreeType()
     }
 }
 
+unsigned int FontFreeType::getFontDataHash() const
+{
+    auto iter = s_cacheFontData.find(_fontName);
+    if (iter == s_cacheFontData.end() || iter->second.data.isNull())
+        return 0;
+
+    return XXH32(iter->second.data.getBytes(), iter->second.data.getSize(), 0);
+}
+
 FontAtlas * FontFreeType::createFontAtlas()
 {
     if (_fontAtlas == nullptr)
@@ -541,6 +554,41 @@ unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
     return out;
 }
 
+unsigned char* FontFreeType::renderGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance)
+{
+    auto bitmap = getGlyphBitmap(theChar, outWidth, outHeight, outRect, xAdvance);
+    if (bitmap == nullptr || outWidth <= 0 || outHeight <= 0)
+    {
+        // only the outlined bitmaps are allocated, the others belong to the glyph slot
+        if (bitmap && _outlineSize > 0)
+            delete [] bitmap;
+        return nullptr;
+    }
+
+    if (_outlineSize > 0)
+        return bitmap;
+
+    unsigned char* ret = nullptr;
+    if (_distanceFieldEnabled)
+    {
+        auto distanceMap = makeDistanceMap(bitmap, outWidth, outHeight);
+        outWidth += 2 * DistanceMapSpread;
+        outHeight += 2 * DistanceMapSpread;
+        ret = new (std::nothrow) unsigned char[outWidth * outHeight];
+        if (ret)
+            memcpy(ret, distanceMap, outWidth * outHeight);
+        free(distanceMap);
+    }
+    else
+    {
+        ret = new (std::nothrow) unsigned char[outWidth * outHeight];
+        if (ret)
+            memcpy(ret, bitmap, outWidth * outHeight);
+    }
+
+    return ret;
+}
+
 void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
 {
     int iX = posX;
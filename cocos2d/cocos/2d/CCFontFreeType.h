@@ -53,6 +53,8 @@ class CC_DLL FontFreeType : public Font
 {
 public:
     static const int DistanceMapSpread;
+    /** The font size of the distance field atlases, they are shared by the labels of all the sizes. */
+    static const int DistanceFieldFontSize;
 
     static FontFreeType* create(const std::string &fontName, float fontSize, GlyphCollection glyphs,
         const char *customGlyphs,bool distanceFieldEnabled = false, float outline = 0);
@@ -70,10 +72,20 @@ public:
     int* getHorizontalKerningForTextUTF32(const std::u32string& text, int &outNumLetters) const override;
     
     unsigned char* getGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance);
+
+    /** Renders a glyph in the pixel format of the atlas pages: the distance map when distance field is enabled,
+     *  the outline and the glyph interleaved when outlined. The dimensions include the distance map spread.
+     *  @return A buffer allocated with new[] and owned by the caller, nullptr if the glyph has no bitmap.
+     */
+    unsigned char* renderGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance);
     
     int getFontAscender() const;
     const char* getFontFamily() const;
     std::string getFontName() const { return _fontName; }
+    float getFontSize() const { return _fontSize; }
+
+    /** Returns a hash of the font file content. */
+    unsigned int getFontDataHash() const;
 
     virtual FontAtlas* createFontAtlas() override;
     virtual int getFontMaxHeight() const override { return _lineHeight; }
@@ -105,6 +117,7 @@ private:
     FT_Encoding _encoding;
 
     std::string _fontName;
+    float _fontSize;
     bool _distanceFieldEnabled;
     float _outlineSize;
     int _lineHeight;
@@ -57,6 +57,7 @@ public:
     {
         _textureAtlas = nullptr;
         _letterVisible = true;
+        _textColor = Color4B::WHITE;
     }
 
     static LabelLetter* createWithTexture(Texture2D *texture, const Rect& rect, bool rotated = false)
@@ -136,7 +137,10 @@ public:
         {
             displayedOpacity = 0.0f;
         }
-        Color4B color4(_displayedColor.r, _displayedColor.g, _displayedColor.b, displayedOpacity);
+        Color4B color4(_displayedColor.r * _textColor.r / 255,
+                       _displayedColor.g * _textColor.g / 255,
+                       _displayedColor.b * _textColor.b / 255,
+                       displayedOpacity * _textColor.a / 255);
         // special opacity for premultiplied textures
         if (_opacityModifyRGB)
         {
@@ -158,6 +162,16 @@ public:
         updateColor();
     }
 
+    /** The text color multiplied into the vertex colors, see Label::getVertexTextColor(). */
+    void setTextColor(const Color4B& color)
+    {
+        if (_textColor != color)
+        {
+            _textColor = color;
+            updateColor();
+        }
+    }
+
     bool isVisible() const override
     {
         return _letterVisible;
@@ -170,6 +184,7 @@ public:
     
 private:
     bool _letterVisible;
+    Color4B _textColor;
 };
 
 Label* Label::create()
@@ -464,6 +479,8 @@ void Label::reset()
     _letters.clear();
     _batchNodes.clear();
     _lettersInfo.clear();
+    _layoutKey = LayoutKey();
+    _layoutCache.clear();
     if (_fontAtlas)
     {
         FontAtlasCache::releaseFontAtlas(_fontAtlas);
@@ -557,10 +574,11 @@ void Label::updateShaderProgram()
     switch (_currLabelEffect)
     {
     case cocos2d::LabelEffect::NORMAL:
+        // without shadow the quads are drawn by a QuadCommand, which transforms the vertices on the CPU
         if (_useDistanceField)
-            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL));
+            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(_shadowEnabled ? GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL : GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL_NO_MVP));
         else if (_useA8Shader)
-            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_NORMAL));
+            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(_shadowEnabled ? GLProgram::SHADER_NAME_LABEL_NORMAL : GLProgram::SHADER_NAME_LABEL_NORMAL_NO_MVP));
         else if (_shadowEnabled)
             setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, _getTexture(this)));
         else
@@ -584,6 +602,34 @@ void Label::updateShaderProgram()
     }
     
     _uniformTextColor = glGetUniformLocation(getGLProgram()->getProgram(), "u_textColor");
+
+    // the text color moves between the vertex colors and the u_textColor uniform
+    updateColor();
+}
+
+bool Label::isQuadBatchingEnabled() const
+{
+    if (_shadowEnabled)
+        return false;
+
+    switch (_currentLabelType)
+    {
+    case LabelType::BMFONT:
+    case LabelType::CHARMAP:
+        return true;
+    case LabelType::TTF:
+        return _currLabelEffect == LabelEffect::NORMAL && (_useDistanceField || _useA8Shader);
+    default:
+        return false;
+    }
+}
+
+Color4B Label::getVertexTextColor() const
+{
+    if (_currentLabelType == LabelType::TTF && isQuadBatchingEnabled())
+        return _textColor;
+
+    return Color4B::WHITE;
 }
 
 void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false */, bool useA8Shader /* = false */)
@@ -603,6 +649,8 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
         FontAtlasCache::releaseFontAtlas(_fontAtlas);
     }
     _fontAtlas = atlas;
+    _layoutKey = LayoutKey();
+    _layoutCache.clear();
     
     if (_reusedLetter == nullptr)
     {
@@ -814,6 +862,7 @@ bool Label::alignText()
 {
     if (_fontAtlas == nullptr || _utf32Text.empty())
     {
+        _layoutKey = LayoutKey();
         setContentSize(Size::ZERO);
         return true;
     }
@@ -849,27 +898,39 @@ bool Label::alignText()
             _batchNodes.at(0)->reserveCapacity(_utf32Text.size());
 
         _reusedLetter->setBatchNode(_batchNodes.at(0));
-        
-        _lengthOfString = 0;
-        _textDesiredHeight = 0.f;
-        _linesWidth.clear();
-        if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
-        {
-            multilineTextWrapByWord();
-        }
-        else
+
+        this->updateBMFontScale();
+        auto layoutKey = getLayoutKey();
+        if (!restoreCachedLayout(layoutKey))
         {
-            multilineTextWrapByChar();
-        }
-        computeAlignmentOffset();
+            computeHorizontalKernings(_utf32Text);
 
-        if(_overflow == Overflow::SHRINK){
-            float fontSize = this->getRenderingFontSize();
+            _lengthOfString = 0;
+            _textDesiredHeight = 0.f;
+            _linesWidth.clear();
+            if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
+            {
+                multilineTextWrapByWord();
+            }
+            else
+            {
+                multilineTextWrapByChar();
+            }
+            computeAlignmentOffset();
 
-            if(fontSize > 0 &&  isVerticalClamp()){
-                this->shrinkLabelToContentSize(CC_CALLBACK_0(Label::isVerticalClamp, this));
+            if(_overflow == Overflow::SHRINK){
+                float fontSize = this->getRenderingFontSize();
+
+                if(fontSize > 0 &&  isVerticalClamp()){
+                    this->shrinkLabelToContentSize(CC_CALLBACK_0(Label::isVerticalClamp, this));
+                }
+            }
+            else
+            {
+                cacheLayout(layoutKey);
             }
         }
+        _layoutKey = layoutKey;
 
         if(!updateQuads()){
             ret = false;
@@ -939,13 +1000,13 @@ bool Label::updateQuads()
                 if (py > _tailoredTopY)
                 {
                     auto clipTop = py - _tailoredTopY;
-                    _reusedRect.origin.y += clipTop;
-                    _reusedRect.size.height -= clipTop;
+                    _reusedRect.origin.y += clipTop / _bmfontScale;
+                    _reusedRect.size.height -= clipTop / _bmfontScale;
                     py -= clipTop;
                 }
                 if (py - letterDef.height * _bmfontScale < _tailoredBottomY)
                 {
-                    _reusedRect.size.height = (py < _tailoredBottomY) ? 0.f : (py - _tailoredBottomY);
+                    _reusedRect.size.height = (py < _tailoredBottomY) ? 0.f : (py - _tailoredBottomY) / _bmfontScale;
                 }
             }
 
@@ -988,6 +1049,255 @@ bool Label::updateQuads()
     return ret;
 }
 
+// the layout cache is meant for labels switching between a few short texts, like scores and timers
+static const size_t LAYOUT_CACHE_SIZE = 4;
+static const size_t LAYOUT_CACHE_MAX_TEXT_LENGTH = 256;
+
+bool Label::LayoutKey::operator==(const LayoutKey& other) const
+{
+    return fontAtlas == other.fontAtlas
+        && bmfontScale == other.bmfontScale
+        && contentScaleFactor == other.contentScaleFactor
+        && lineHeight == other.lineHeight
+        && lineSpacing == other.lineSpacing
+        && additionalKerning == other.additionalKerning
+        && maxLineWidth == other.maxLineWidth
+        && labelWidth == other.labelWidth
+        && labelHeight == other.labelHeight
+        && hAlignment == other.hAlignment
+        && vAlignment == other.vAlignment
+        && enableWrap == other.enableWrap
+        && lineBreakWithoutSpaces == other.lineBreakWithoutSpaces;
+}
+
+Label::LayoutKey Label::getLayoutKey() const
+{
+    LayoutKey key;
+    key.fontAtlas = _fontAtlas;
+    key.bmfontScale = _bmfontScale;
+    key.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    key.lineHeight = _lineHeight;
+    key.lineSpacing = _lineSpacing;
+    key.additionalKerning = _additionalKerning;
+    key.maxLineWidth = _maxLineWidth;
+    key.labelWidth = _labelWidth;
+    key.labelHeight = _labelHeight;
+    key.hAlignment = _hAlignment;
+    key.vAlignment = _vAlignment;
+    key.enableWrap = _enableWrap;
+    key.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+    return key;
+}
+
+bool Label::restoreCachedLayout(const LayoutKey& key)
+{
+    // shrinking changes the font size while laying out the text
+    if (_overflow == Overflow::SHRINK || _layoutCache.empty() || _utf32Text.length() > LAYOUT_CACHE_MAX_TEXT_LENGTH)
+        return false;
+
+    auto textHash = std::hash<std::u32string>()(_utf32Text);
+    for (auto it = _layoutCache.begin(); it != _layoutCache.end(); ++it)
+    {
+        if (it->textHash != textHash || !(it->key == key) || it->text != _utf32Text)
+            continue;
+
+        // keep the most recently used layouts first
+        std::rotate(_layoutCache.begin(), it, it + 1);
+        auto& entry = _layoutCache.front();
+
+        _lengthOfString = static_cast<int>(entry.lettersInfo.size());
+        if (_lettersInfo.size() < entry.lettersInfo.size())
+        {
+            _lettersInfo.resize(entry.lettersInfo.size());
+        }
+        std::copy(entry.lettersInfo.begin(), entry.lettersInfo.end(), _lettersInfo.begin());
+
+        delete [] _horizontalKernings;
+        _horizontalKernings = nullptr;
+        if (!entry.horizontalKernings.empty())
+        {
+            _horizontalKernings = new (std::nothrow) int[entry.horizontalKernings.size()];
+            if (_horizontalKernings)
+            {
+                std::copy(entry.horizontalKernings.begin(), entry.horizontalKernings.end(), _horizontalKernings);
+            }
+        }
+
+        _linesWidth = entry.linesWidth;
+        _linesOffsetX = entry.linesOffsetX;
+        _letterOffsetY = entry.letterOffsetY;
+        _textDesiredHeight = entry.textDesiredHeight;
+        _tailoredTopY = entry.tailoredTopY;
+        _tailoredBottomY = entry.tailoredBottomY;
+        _numberOfLines = entry.numberOfLines;
+        setContentSize(entry.contentSize);
+        return true;
+    }
+
+    return false;
+}
+
+void Label::cacheLayout(const LayoutKey& key)
+{
+    if (_utf32Text.length() > LAYOUT_CACHE_MAX_TEXT_LENGTH)
+        return;
+
+    // recycle the least recently used entry, its vectors keep their capacity
+    if (_layoutCache.size() < LAYOUT_CACHE_SIZE)
+    {
+        _layoutCache.emplace_back();
+    }
+    std::rotate(_layoutCache.begin(), _layoutCache.end() - 1, _layoutCache.end());
+    auto& entry = _layoutCache.front();
+
+    entry.key = key;
+    entry.textHash = std::hash<std::u32string>()(_utf32Text);
+    entry.text = _utf32Text;
+    entry.lettersInfo.assign(_lettersInfo.begin(), _lettersInfo.begin() + _lengthOfString);
+    if (_horizontalKernings)
+    {
+        entry.horizontalKernings.assign(_horizontalKernings, _horizontalKernings + _lengthOfString);
+    }
+    else
+    {
+        entry.horizontalKernings.clear();
+    }
+    entry.linesWidth = _linesWidth;
+    entry.linesOffsetX = _linesOffsetX;
+    entry.contentSize = _contentSize;
+    entry.letterOffsetY = _letterOffsetY;
+    entry.textDesiredHeight = _textDesiredHeight;
+    entry.tailoredTopY = _tailoredTopY;
+    entry.tailoredBottomY = _tailoredBottomY;
+    entry.numberOfLines = _numberOfLines;
+}
+
+static bool isDigit(char32_t character)
+{
+    return character >= U'0' && character <= U'9';
+}
+
+// Scores and timers only change some digits of the text. When the font has the same advance for
+// all the digits the layout doesn't change, so only the quads of the changed digits are rewritten.
+bool Label::updateChangedDigits()
+{
+    // clipping, wrapping and shrinking depend on the size of the glyphs, not only on their advance
+    if (_overflow == Overflow::SHRINK || _labelWidth > 0.f || _labelHeight > 0.f || _maxLineWidth > 0.f
+        || _batchNodes.empty() || !_horizontalKernings || _utf32Text.empty()
+        || _lengthOfString != static_cast<int>(_utf32Text.length())
+        || _lettersInfo.size() < _utf32Text.length())
+    {
+        return false;
+    }
+
+    this->updateBMFontScale();
+    if (!(getLayoutKey() == _layoutKey))
+    {
+        return false;
+    }
+
+    bool digitsChanged = false;
+    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (letterInfo.utf32Char == _utf32Text[ctr])
+            continue;
+
+        if (!isDigit(letterInfo.utf32Char) || !isDigit(_utf32Text[ctr]) || !letterInfo.valid || letterInfo.atlasIndex < 0)
+            return false;
+
+        digitsChanged = true;
+    }
+    if (!digitsChanged)
+    {
+        return false;
+    }
+
+    _fontAtlas->prepareLetterDefinitions(_utf32Text);
+    if (_fontAtlas->getTextures().size() > static_cast<size_t>(_batchNodes.size()))
+    {
+        return false;
+    }
+
+    FontLetterDefinition oldDef;
+    FontLetterDefinition newDef;
+    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (letterInfo.utf32Char == _utf32Text[ctr])
+            continue;
+
+        if (!getFontLetterDef(letterInfo.utf32Char, oldDef) || !getFontLetterDef(_utf32Text[ctr], newDef))
+            return false;
+
+        if (!newDef.validDefinition || newDef.width <= 0.f || newDef.height <= 0.f
+            || newDef.xAdvance != oldDef.xAdvance || newDef.textureID != oldDef.textureID
+            || newDef.textureID >= _batchNodes.size()
+            || letterInfo.atlasIndex >= _batchNodes.at(newDef.textureID)->getTextureAtlas()->getTotalQuads())
+        {
+            return false;
+        }
+    }
+
+    // the kerning between the digits has to be the same too
+    int letterCount = 0;
+    auto horizontalKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(_utf32Text, letterCount);
+    if (!horizontalKernings)
+    {
+        return false;
+    }
+    bool sameKernings = memcmp(horizontalKernings, _horizontalKernings, sizeof(int) * _lengthOfString) == 0;
+    delete [] _horizontalKernings;
+    _horizontalKernings = horizontalKernings;
+    if (!sameKernings)
+    {
+        return false;
+    }
+
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (letterInfo.utf32Char == _utf32Text[ctr])
+            continue;
+
+        getFontLetterDef(letterInfo.utf32Char, oldDef);
+        getFontLetterDef(_utf32Text[ctr], newDef);
+
+        // same pen position, only the bearing of the glyph differs
+        letterInfo.positionX += (newDef.offsetX - oldDef.offsetX) * _bmfontScale / contentScaleFactor;
+        letterInfo.positionY -= (newDef.offsetY - oldDef.offsetY) * _bmfontScale / contentScaleFactor;
+        letterInfo.utf32Char = _utf32Text[ctr];
+
+        _reusedRect.size.height = newDef.height;
+        _reusedRect.size.width  = newDef.width;
+        _reusedRect.origin.x    = newDef.U;
+        _reusedRect.origin.y    = newDef.V;
+        _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
+        _reusedLetter->setPosition(letterInfo.positionX + _linesOffsetX[letterInfo.lineIndex], letterInfo.positionY + _letterOffsetY);
+        this->updateLetterSpriteScale(_reusedLetter);
+
+        // keep the colors, updateColor() isn't called for the whole label
+        auto batchNode = _batchNodes.at(newDef.textureID);
+        auto textureAtlas = batchNode->getTextureAtlas();
+        auto oldQuad = textureAtlas->getQuads()[letterInfo.atlasIndex];
+        _reusedLetter->setBatchNode(batchNode);
+        _reusedLetter->setAtlasIndex(letterInfo.atlasIndex);
+        _reusedLetter->setDirty(true);
+        _reusedLetter->updateTransform();
+        auto quad = textureAtlas->getQuads()[letterInfo.atlasIndex];
+        quad.bl.colors = oldQuad.bl.colors;
+        quad.br.colors = oldQuad.br.colors;
+        quad.tl.colors = oldQuad.tl.colors;
+        quad.tr.colors = oldQuad.tr.colors;
+        textureAtlas->updateQuad(&quad, letterInfo.atlasIndex);
+    }
+
+    updateLabelLetters();
+
+    return true;
+}
+
 bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 {
     FontAtlas *newAtlas = FontAtlasCache::getFontAtlasTTF(&ttfConfig);
@@ -1002,6 +1312,9 @@ bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
     setFontAtlas(newAtlas,ttfConfig.distanceFieldEnabled,true);
 
     _fontConfig = ttfConfig;
+    // distance field atlases are shared by all the sizes, setFontAtlas may have kept the same atlas
+    updateBMFontScale();
+    _contentDirty = true;
 
     if (_fontConfig.outlineSize > 0)
     {
@@ -1159,6 +1472,10 @@ void Label::enableShadow(const Color4B& shadowColor /* = Color4B::BLACK */,
     {
         setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(_shadowEnabled ? GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR : GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, _getTexture(this)));
     }
+    else if (_currentLabelType == LabelType::TTF)
+    {
+        updateShaderProgram();
+    }
 }
 
 void Label::enableItalics()
@@ -1412,8 +1729,10 @@ void Label::updateContent()
             _utf32Text = utf32String;
         }
 
-        computeHorizontalKernings(_utf32Text);
-        updateFinished = alignText();
+        if (!updateChangedDigits())
+        {
+            updateFinished = alignText();
+        }
     }
     else
     {
@@ -1619,18 +1938,34 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     if (_insideBounds)
 #endif
     {
-        if (!_shadowEnabled && (_currentLabelType == LabelType::BMFONT || _currentLabelType == LabelType::CHARMAP))
+        if (isQuadBatchingEnabled())
         {
             for (auto&& it : _letters)
             {
                 it.second->updateTransform();
             }
-            // ETC1 ALPHA supports for BMFONT & CHARMAP
-            auto textureAtlas = _batchNodes.at(0)->getTextureAtlas();
-            auto texture = textureAtlas->getTexture();
-            _quadCommand.init(_globalZOrder, texture, getGLProgramState(), 
-                _blendFunc, textureAtlas->getQuads(), textureAtlas->getTotalQuads(), transform, flags);
-            renderer->addCommand(&_quadCommand);
+
+            // The labels using the same atlas page, program and blend function produce the same material id,
+            // so the renderer merges their quads into a single draw call.
+            auto pageCount = static_cast<size_t>(_batchNodes.size());
+            if (_pageQuadCommands.size() + 1 != pageCount)
+            {
+                // QuadCommand owns its index buffers and can't be copied, so never let the vector move them
+                _pageQuadCommands.clear();
+                _pageQuadCommands.resize(pageCount - 1);
+            }
+            for (size_t page = 0; page < pageCount; ++page)
+            {
+                auto textureAtlas = _batchNodes.at(page)->getTextureAtlas();
+                if (textureAtlas->getTotalQuads() == 0)
+                    continue;
+
+                // ETC1 ALPHA supports for BMFONT & CHARMAP
+                auto& quadCommand = page == 0 ? _quadCommand : _pageQuadCommands[page - 1];
+                quadCommand.init(_globalZOrder, textureAtlas->getTexture(), getGLProgramState(),
+                    _blendFunc, textureAtlas->getQuads(), textureAtlas->getTotalQuads(), transform, flags);
+                renderer->addCommand(&quadCommand);
+            }
         }
         else
         {
@@ -1805,6 +2140,7 @@ Sprite* Label::getLetter(int letterIndex)
                     auto px = letterInfo.positionX + _bmfontScale * uvRect.size.width / 2 + _linesOffsetX[letterInfo.lineIndex];
                     auto py = letterInfo.positionY - _bmfontScale * uvRect.size.height / 2 + _letterOffsetY;
                     letter->setPosition(px,py);
+                    static_cast<LabelLetter*>(letter)->setTextColor(getVertexTextColor());
                     letter->setOpacity(_realOpacity);
                     this->updateLetterSpriteScale(letter);
                 }
@@ -1822,6 +2158,12 @@ void Label::setLineHeight(float height)
 {
     CCASSERT(_currentLabelType != LabelType::STRING_TEXTURE, "Not supported system font!");
 
+    // the line height of the distance field atlases is scaled to the font size
+    if (_currentLabelType == LabelType::TTF)
+    {
+        height /= _bmfontScale;
+    }
+
     if (_lineHeight != height)
     {
         _lineHeight = height;
@@ -1991,6 +2333,11 @@ void Label::setTextColor(const Color4B &color)
     _textColorF.g = _textColor.g / 255.0f;
     _textColorF.b = _textColor.b / 255.0f;
     _textColorF.a = _textColor.a / 255.0f;
+
+    if (_currentLabelType == LabelType::TTF && isQuadBatchingEnabled())
+    {
+        updateColor();
+    }
 }
 
 void Label::updateColor()
@@ -2000,7 +2347,11 @@ void Label::updateColor()
         return;
     }
 
-    Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
+    auto textColor = getVertexTextColor();
+    Color4B color4(_displayedColor.r * textColor.r / 255,
+                   _displayedColor.g * textColor.g / 255,
+                   _displayedColor.b * textColor.b / 255,
+                   _displayedOpacity * textColor.a / 255);
 
     // special opacity for premultiplied textures
     if (_isOpacityModifyRGB)
@@ -2010,6 +2361,11 @@ void Label::updateColor()
         color4.b *= _displayedOpacity/255.0f;
     }
 
+    for (auto&& it : _letters)
+    {
+        static_cast<LabelLetter*>(it.second)->setTextColor(textColor);
+    }
+
     cocos2d::TextureAtlas* textureAtlas;
     V3F_C4B_T2F_Quad *quads;
     for (auto&& batchNode:_batchNodes)
@@ -2219,7 +2575,7 @@ Label::Overflow Label::getOverflow()const
 
 void Label::updateLetterSpriteScale(Sprite* sprite)
 {
-    if (_currentLabelType == LabelType::BMFONT && _bmFontSize > 0)
+    if ((_currentLabelType == LabelType::BMFONT && _bmFontSize > 0) || _currentLabelType == LabelType::TTF)
     {
         sprite->setScale(_bmfontScale);
     }
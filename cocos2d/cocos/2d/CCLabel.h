@@ -648,6 +648,44 @@ protected:
         int lineIndex;
     };
 
+    /** The parameters the layout of the text depends on, besides the text itself. */
+    struct LayoutKey
+    {
+        FontAtlas* fontAtlas;
+        float bmfontScale;
+        float contentScaleFactor;
+        float lineHeight;
+        float lineSpacing;
+        float additionalKerning;
+        float maxLineWidth;
+        float labelWidth;
+        float labelHeight;
+        TextHAlignment hAlignment;
+        TextVAlignment vAlignment;
+        bool enableWrap;
+        bool lineBreakWithoutSpaces;
+
+        bool operator==(const LayoutKey& other) const;
+    };
+
+    /** A text laid out by alignText(), reused when the label shows the same text again. */
+    struct LayoutCacheEntry
+    {
+        LayoutKey key;
+        size_t textHash;
+        std::u32string text;
+        std::vector<LetterInfo> lettersInfo;
+        std::vector<int> horizontalKernings;
+        std::vector<float> linesWidth;
+        std::vector<float> linesOffsetX;
+        Size contentSize;
+        float letterOffsetY;
+        float textDesiredHeight;
+        float tailoredTopY;
+        float tailoredBottomY;
+        int numberOfLines;
+    };
+
     virtual void setFontAtlas(FontAtlas* atlas, bool distanceFieldEnabled = false, bool useA8Shader = false);
     bool getFontLetterDef(char32_t character, FontLetterDefinition& letterDef) const;
 
@@ -675,10 +713,19 @@ protected:
     
     bool updateQuads();
 
+    LayoutKey getLayoutKey() const;
+    bool restoreCachedLayout(const LayoutKey& key);
+    void cacheLayout(const LayoutKey& key);
+    bool updateChangedDigits();
+
     void createSpriteForSystemFont(const FontDefinition& fontDef);
     void createShadowSpriteForSystemFont(const FontDefinition& fontDef);
 
     virtual void updateShaderProgram();
+    /** Whether the quads are drawn by QuadCommands that the renderer can batch with other labels. */
+    bool isQuadBatchingEnabled() const;
+    /** The text color multiplied into the vertex colors, white when the shader applies it with u_textColor. */
+    Color4B getVertexTextColor() const;
     void updateBMFontScale();
     void scaleFontSizeDown(float fontSize);
     bool setTTFConfigInternal(const TTFConfig& ttfConfig);
@@ -714,6 +761,8 @@ protected:
     FontAtlas* _fontAtlas;
     Vector<SpriteBatchNode*> _batchNodes;
     std::vector<LetterInfo> _lettersInfo;
+    LayoutKey _layoutKey;
+    std::vector<LayoutCacheEntry> _layoutCache;
 
     //! used for optimization
     Sprite *_reusedLetter;
@@ -746,6 +795,7 @@ protected:
     Color4F _textColorF;
 
     QuadCommand _quadCommand;
+    std::vector<QuadCommand> _pageQuadCommands;
     CustomCommand _customCommand;
     Mat4  _shadowTransform;
     GLint _uniformEffectColor;
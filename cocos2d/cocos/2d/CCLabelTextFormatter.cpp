@@ -30,6 +30,7 @@
 #include "base/CCDirector.h"
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontFNT.h"
+#include "2d/CCFontFreeType.h"
 
 NS_CC_BEGIN
 
@@ -142,6 +143,11 @@ void Label::updateBMFontScale()
         FontFNT *bmFont = (FontFNT*)font;
         float originalFontSize = bmFont->getOriginalFontSize();
         _bmfontScale = _bmFontSize * CC_CONTENT_SCALE_FACTOR() / originalFontSize;
+    }else if (_currentLabelType == LabelType::TTF) {
+        // distance field atlases are rendered at FontFreeType::DistanceFieldFontSize
+        auto fontFreeType = dynamic_cast<const FontFreeType*>(font);
+        float atlasFontSize = fontFreeType ? fontFreeType->getFontSize() : 0.0f;
+        _bmfontScale = atlasFontSize > 0.0f ? _fontConfig.fontSize / atlasFontSize : 1.0f;
     }else{
         _bmfontScale = 1.0f;
     }
@@ -238,7 +244,7 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             {
                 float newLetterWidth = 0.f;
                 if (_horizontalKernings && letterIndex < textLen - 1)
-                    newLetterWidth = _horizontalKernings[letterIndex + 1];
+                    newLetterWidth = _horizontalKernings[letterIndex + 1] * _bmfontScale;
                 newLetterWidth += letterDef.xAdvance * _bmfontScale + _additionalKerning;
 
                 nextLetterX += newLetterWidth;
@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
 #include "math/TransformUtils.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 
 #if CC_NODE_RENDER_SUBPIXEL
@@ -56,6 +57,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(Node, 64)
+
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 std::uint32_t Node::s_globalOrderOfArrival = 0;
 int Node::__attachedNodeCount = 0;
@@ -1172,6 +1175,8 @@ void Node::reorderChild(Node *child, int zOrder)
     _reorderChildDirty = true;
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
+    // only the event priorities of the reordered child and its descendants change
+    _eventDispatcher->setDirtyForNode(child);
 }
 
 void Node::sortAllChildren()
@@ -1180,7 +1185,6 @@ void Node::sortAllChildren()
     {
         sortNodes(_children);
         _reorderChildDirty = false;
-        _eventDispatcher->setDirtyForNode(this);
     }
 }
 
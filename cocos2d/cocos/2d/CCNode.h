@@ -32,6 +32,8 @@
 
 #include <cstdint>
 #include "base/ccMacros.h"
+#include "base/ccRadixSort.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
 #include "base/CCVector.h"
 #include "base/CCProtocols.h"
 #include "base/CCScriptSupport.h"
@@ -109,6 +111,8 @@ class EventListener;
 class CC_DLL Node : public Ref
 {
 public:
+    CC_DECLARE_OBJECT_POOL(Node)
+
     /** Default tag used for all the nodes */
     static const int INVALID_TAG = -1;
 
@@ -938,6 +942,9 @@ public:
      */
     virtual void sortAllChildren();
 
+    /** Children lists with at least this many nodes are sorted with a radix sort in sortNodes(). */
+    static const size_t SORT_NODES_RADIX_THRESHOLD = 256;
+
     /**
     * Sorts helper function
     *
@@ -946,6 +953,26 @@ public:
     static void sortNodes(cocos2d::Vector<_T*>& nodes)
     {
         static_assert(std::is_base_of<Node, _T>::value, "Node::sortNodes: Only accept derived of Node!");
+        const size_t count = static_cast<size_t>(nodes.size());
+        if (count >= SORT_NODES_RADIX_THRESHOLD)
+        {
+            // local z order (sign flipped to sort as unsigned) in the high 32 bits, arrival order in the low 32 bits
+            static std::vector<std::uint64_t> keys, keysScratch;
+            static std::vector<_T*> sorted, sortedScratch;
+            keys.resize(count);
+            keysScratch.resize(count);
+            sorted.resize(count);
+            sortedScratch.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                _T* node = nodes.at(i);
+                keys[i] = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(node->_localZOrder) ^ 0x80000000u) << 32) | node->_orderOfArrival;
+                sorted[i] = node;
+            }
+            utils::radixSort(keys.data(), sorted.data(), keysScratch.data(), sortedScratch.data(), count);
+            std::copy(sorted.begin(), sorted.end(), nodes.begin());
+            return;
+        }
 #if CC_64BITS
         std::sort(std::begin(nodes), std::end(nodes), [](_T* n1, _T* n2) {
             return (n1->_localZOrder$Arrival < n2->_localZOrder$Arrival);
@@ -2035,6 +2062,9 @@ public:
 #endif
 
     static int __attachedNodeCount;
+
+    // compares the local z order and arrival order of nodes to sort the scene graph priority listeners
+    friend class EventDispatcher;
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Node);
@@ -0,0 +1,390 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCParticleKernels.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    // 4 lanes of floats, the kernels are written once on top of these helpers
+
+#if defined(USE_SSE)
+
+    typedef __m128 float4;
+    typedef __m128 mask4;
+
+    inline float4 load4(const float* p) { return _mm_loadu_ps(p); }
+    inline void store4(float* p, float4 v) { _mm_storeu_ps(p, v); }
+    inline float4 splat(float value) { return _mm_set1_ps(value); }
+    inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+    inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+    inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+    inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+    inline float4 min4(float4 a, float4 b) { return _mm_min_ps(a, b); }
+    inline float4 max4(float4 a, float4 b) { return _mm_max_ps(a, b); }
+    inline float4 sqrt4(float4 a) { return _mm_sqrt_ps(a); }
+    inline mask4 lessEqual(float4 a, float4 b) { return _mm_cmple_ps(a, b); }
+    inline mask4 greater(float4 a, float4 b) { return _mm_cmpgt_ps(a, b); }
+    inline float4 select(mask4 mask, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    inline int maskBits(mask4 mask) { return _mm_movemask_ps(mask); }
+
+#elif defined(USE_NEON)
+
+    typedef float32x4_t float4;
+    typedef uint32x4_t mask4;
+
+    inline float4 load4(const float* p) { return vld1q_f32(p); }
+    inline void store4(float* p, float4 v) { vst1q_f32(p, v); }
+    inline float4 splat(float value) { return vdupq_n_f32(value); }
+    inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+    inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+    inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+    inline float4 min4(float4 a, float4 b) { return vminq_f32(a, b); }
+    inline float4 max4(float4 a, float4 b) { return vmaxq_f32(a, b); }
+    inline mask4 lessEqual(float4 a, float4 b) { return vcleq_f32(a, b); }
+    inline mask4 greater(float4 a, float4 b) { return vcgtq_f32(a, b); }
+    inline float4 select(mask4 mask, float4 a, float4 b) { return vbslq_f32(mask, a, b); }
+    inline int maskBits(mask4 mask)
+    {
+        uint32_t lanes[4];
+        vst1q_u32(lanes, mask);
+        return (lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8);
+    }
+
+#if defined(__aarch64__) || defined(__arm64__)
+    inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+    inline float4 sqrt4(float4 a) { return vsqrtq_f32(a); }
+#else
+    // ARMv7 has no vector division nor square root, refine the estimates twice with Newton-Raphson
+    inline float4 div(float4 a, float4 b)
+    {
+        float4 r = vrecpeq_f32(b);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        r = vmulq_f32(vrecpsq_f32(b, r), r);
+        return vmulq_f32(a, r);
+    }
+    inline float4 sqrt4(float4 a)
+    {
+        float4 r = vrsqrteq_f32(a);
+        r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+        r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+        // rsqrt(0) is infinite
+        return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, r));
+    }
+#endif
+
+#else
+
+    struct float4 { float v[4]; };
+    struct mask4 { bool v[4]; };
+
+#define CC_PARTICLE_LANES(expr) for (int l = 0; l < 4; ++l) { expr; }
+
+    inline float4 load4(const float* p) { float4 r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    inline void store4(float* p, float4 v) { memcpy(p, v.v, sizeof(v.v)); }
+    inline float4 splat(float value) { float4 r; CC_PARTICLE_LANES(r.v[l] = value) return r; }
+    inline float4 add(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] + b.v[l]) return r; }
+    inline float4 sub(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] - b.v[l]) return r; }
+    inline float4 mul(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] * b.v[l]) return r; }
+    inline float4 div(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] / b.v[l]) return r; }
+    inline float4 min4(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] < b.v[l] ? a.v[l] : b.v[l]) return r; }
+    inline float4 max4(float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] > b.v[l] ? a.v[l] : b.v[l]) return r; }
+    inline float4 sqrt4(float4 a) { float4 r; CC_PARTICLE_LANES(r.v[l] = sqrtf(a.v[l])) return r; }
+    inline mask4 lessEqual(float4 a, float4 b) { mask4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] <= b.v[l]) return r; }
+    inline mask4 greater(float4 a, float4 b) { mask4 r; CC_PARTICLE_LANES(r.v[l] = a.v[l] > b.v[l]) return r; }
+    inline float4 select(mask4 mask, float4 a, float4 b) { float4 r; CC_PARTICLE_LANES(r.v[l] = mask.v[l] ? a.v[l] : b.v[l]) return r; }
+    inline int maskBits(mask4 mask) { int r = 0; CC_PARTICLE_LANES(r |= mask.v[l] ? (1 << l) : 0) return r; }
+
+#undef CC_PARTICLE_LANES
+
+#endif
+
+    // the last block of an array holds less than 4 particles
+
+    inline float4 load4(const float* p, int n)
+    {
+        if (n == 4)
+            return load4(p);
+
+        float lanes[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        memcpy(lanes, p, n * sizeof(float));
+        return load4(lanes);
+    }
+
+    inline void store4(float* p, float4 v, int n)
+    {
+        if (n == 4)
+        {
+            store4(p, v);
+        }
+        else
+        {
+            float lanes[4];
+            store4(lanes, v);
+            memcpy(p, lanes, n * sizeof(float));
+        }
+    }
+
+    inline float4 madd(float4 a, float4 b, float4 c) { return add(mul(a, b), c); }
+
+    const float PI = 3.14159265358979323846f;
+    const float INV_2PI = 0.159154943091895335768f;
+    // 2 * PI split in a part exact in float and the rest, so that large angles keep their precision
+    const float TWO_PI_HIGH = 6.28125f;
+    const float TWO_PI_LOW = 0.00193530717958647692f;
+    // adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+    const float ROUND_MAGIC = 12582912.0f;
+
+    // sine and cosine of the same angles, with an error below 1e-7 on [-PI / 2, PI / 2]
+    inline void sinCos4(float4 x, float4& outSin, float4& outCos)
+    {
+        float4 turns = sub(add(mul(x, splat(INV_2PI)), splat(ROUND_MAGIC)), splat(ROUND_MAGIC));
+        x = sub(sub(x, mul(turns, splat(TWO_PI_HIGH))), mul(turns, splat(TWO_PI_LOW)));
+
+        // cos(x) = sin(x + PI / 2), both are folded in [-PI / 2, PI / 2] with sin(x) = sin(PI - x)
+        float4 angles[2] = { x, add(x, splat(PI * 0.5f)) };
+        float4 results[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            float4 y = min4(angles[i], sub(splat(PI), angles[i]));
+            y = max4(y, sub(splat(-PI), y));
+            float4 y2 = mul(y, y);
+            float4 p = madd(y2, splat(-1.0f / 39916800.0f), splat(1.0f / 362880.0f));
+            p = madd(y2, p, splat(-1.0f / 5040.0f));
+            p = madd(y2, p, splat(1.0f / 120.0f));
+            p = madd(y2, p, splat(-1.0f / 6.0f));
+            p = madd(y2, p, splat(1.0f));
+            results[i] = mul(y, p);
+        }
+        outSin = results[0];
+        outCos = results[1];
+    }
+}
+
+namespace ParticleKernels
+{
+
+void addScaled(float* values, const float* deltas, float dt, int count)
+{
+    float4 dt4 = splat(dt);
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        store4(values + i, madd(load4(deltas + i, n), dt4, load4(values + i, n)), n);
+    }
+}
+
+void addScaledClamped(float* values, const float* deltas, float dt, float minValue, int count)
+{
+    float4 dt4 = splat(dt);
+    float4 min = splat(minValue);
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        store4(values + i, max4(madd(load4(deltas + i, n), dt4, load4(values + i, n)), min), n);
+    }
+}
+
+int decreaseTimeToLive(float* timeToLive, float dt, int count, int* deadIndices)
+{
+    float4 dt4 = splat(dt);
+    float4 zero = splat(0.0f);
+    int deadCount = 0;
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        float4 ttl = sub(load4(timeToLive + i, n), dt4);
+        store4(timeToLive + i, ttl, n);
+
+        int bits = maskBits(lessEqual(ttl, zero)) & ((1 << n) - 1);
+        // most blocks hold no dead particle
+        while (bits)
+        {
+            int lane = bits & 1 ? 0 : (bits & 2 ? 1 : (bits & 4 ? 2 : 3));
+            deadIndices[deadCount++] = i + lane;
+            bits &= bits - 1;
+        }
+    }
+    return deadCount;
+}
+
+void updateGravity(float* posX, float* posY, float* dirX, float* dirY,
+                   const float* radialAccel, const float* tangentialAccel,
+                   float gravityX, float gravityY, float dt, float yCoordFlipped, int count)
+{
+    float4 dt4 = splat(dt);
+    float4 moveScale = splat(dt * yCoordFlipped);
+    float4 gx = splat(gravityX);
+    float4 gy = splat(gravityY);
+    float4 zero = splat(0.0f);
+    float4 one = splat(1.0f);
+    float4 tolerance = splat(MATH_TOLERANCE);
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        float4 x = load4(posX + i, n);
+        float4 y = load4(posY + i, n);
+
+        // the particles at the center of the emitter have no radial direction
+        float4 length = sqrt4(madd(x, x, mul(y, y)));
+        float4 invLength = select(greater(length, tolerance), div(one, length), zero);
+        float4 radialX = mul(x, invLength);
+        float4 radialY = mul(y, invLength);
+
+        float4 radial = load4(radialAccel + i, n);
+        float4 tangential = load4(tangentialAccel + i, n);
+
+        // (gravity + radial + tangential) * dt
+        float4 accelX = sub(madd(radialX, radial, gx), mul(radialY, tangential));
+        float4 accelY = add(madd(radialY, radial, gy), mul(radialX, tangential));
+        float4 dx = madd(accelX, dt4, load4(dirX + i, n));
+        float4 dy = madd(accelY, dt4, load4(dirY + i, n));
+        store4(dirX + i, dx, n);
+        store4(dirY + i, dy, n);
+
+        store4(posX + i, madd(dx, moveScale, x), n);
+        store4(posY + i, madd(dy, moveScale, y), n);
+    }
+}
+
+void updateRadius(float* posX, float* posY, float* angle, const float* degreesPerSecond,
+                  float* radius, const float* deltaRadius, float dt, float yCoordFlipped, int count)
+{
+    float4 dt4 = splat(dt);
+    float4 minusOne = splat(-1.0f);
+    float4 minusFlipped = splat(-yCoordFlipped);
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        float4 a = madd(load4(degreesPerSecond + i, n), dt4, load4(angle + i, n));
+        float4 r = madd(load4(deltaRadius + i, n), dt4, load4(radius + i, n));
+        store4(angle + i, a, n);
+        store4(radius + i, r, n);
+
+        float4 s, c;
+        sinCos4(a, s, c);
+        store4(posX + i, mul(mul(c, r), minusOne), n);
+        store4(posY + i, mul(mul(s, r), minusFlipped), n);
+    }
+}
+
+void updateQuadVertices(V3F_C4B_T2F_Quad* quads, const float* x, const float* y,
+                        const float* startX, const float* startY, const float transform[6],
+                        const float* size, const float* rotation, int count)
+{
+    float4 a = splat(transform[0]);
+    float4 b = splat(transform[1]);
+    float4 c = splat(transform[2]);
+    float4 d = splat(transform[3]);
+    float4 e = splat(transform[4]);
+    float4 f = splat(transform[5]);
+    float4 half = splat(0.5f);
+    float4 toRadians = splat(-PI / 180.0f);
+
+    float lanes[8][4];
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        float4 sx = load4(startX + i, n);
+        float4 sy = load4(startY + i, n);
+        float4 cx = add(add(load4(x + i, n), madd(a, sx, mul(b, sy))), c);
+        float4 cy = add(add(load4(y + i, n), madd(d, sx, mul(e, sy))), f);
+
+        float4 s, co;
+        sinCos4(mul(load4(rotation + i, n), toRadians), s, co);
+        float4 halfSize = mul(load4(size + i, n), half);
+        float4 hc = mul(halfSize, co);
+        float4 hs = mul(halfSize, s);
+
+        // bottom-left, bottom-right, top-right, top-left
+        store4(lanes[0], add(sub(cx, hc), hs));
+        store4(lanes[1], sub(sub(cy, hs), hc));
+        store4(lanes[2], add(add(cx, hc), hs));
+        store4(lanes[3], sub(add(cy, hs), hc));
+        store4(lanes[4], sub(add(cx, hc), hs));
+        store4(lanes[5], add(add(cy, hs), hc));
+        store4(lanes[6], sub(sub(cx, hc), hs));
+        store4(lanes[7], add(sub(cy, hs), hc));
+
+        for (int l = 0; l < n; ++l)
+        {
+            auto quad = quads + i + l;
+            quad->bl.vertices.x = lanes[0][l];
+            quad->bl.vertices.y = lanes[1][l];
+            quad->br.vertices.x = lanes[2][l];
+            quad->br.vertices.y = lanes[3][l];
+            quad->tr.vertices.x = lanes[4][l];
+            quad->tr.vertices.y = lanes[5][l];
+            quad->tl.vertices.x = lanes[6][l];
+            quad->tl.vertices.y = lanes[7][l];
+        }
+    }
+}
+
+void updateQuadColors(V3F_C4B_T2F_Quad* quads, const float* r, const float* g, const float* b, const float* a,
+                      bool premultiplyAlpha, int count)
+{
+    float4 scale = splat(255.0f);
+    float4 zero = splat(0.0f);
+    float4 maxValue = splat(255.0f);
+    float lanes[4][4];
+    for (int i = 0; i < count; i += 4)
+    {
+        int n = count - i < 4 ? count - i : 4;
+        float4 alpha = mul(load4(a + i, n), scale);
+        // premultiplied with a factor of 1 when the alpha isn't premultiplied
+        float4 factor = premultiplyAlpha ? load4(a + i, n) : splat(1.0f);
+        float4 colorScale = mul(factor, scale);
+        store4(lanes[0], min4(max4(mul(load4(r + i, n), colorScale), zero), maxValue));
+        store4(lanes[1], min4(max4(mul(load4(g + i, n), colorScale), zero), maxValue));
+        store4(lanes[2], min4(max4(mul(load4(b + i, n), colorScale), zero), maxValue));
+        store4(lanes[3], min4(max4(alpha, zero), maxValue));
+
+        for (int l = 0; l < n; ++l)
+        {
+            Color4B color((GLubyte)lanes[0][l], (GLubyte)lanes[1][l], (GLubyte)lanes[2][l], (GLubyte)lanes[3][l]);
+            auto quad = quads + i + l;
+            quad->bl.colors = color;
+            quad->br.colors = color;
+            quad->tl.colors = color;
+            quad->tr.colors = color;
+        }
+    }
+}
+
+}
+
+NS_CC_END
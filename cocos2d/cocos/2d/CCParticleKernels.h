@@ -0,0 +1,79 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PARTICLE_KERNELS_H__
+#define __CC_PARTICLE_KERNELS_H__
+
+/// @cond DO_NOT_SHOW
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccTypes.h"
+
+NS_CC_BEGIN
+
+/**
+ * Vectorized loops over the SoA arrays of ParticleData.
+ * They use SSE2 or NEON when the compiler targets them, plain loops otherwise.
+ * The arrays don't need any alignment.
+ */
+namespace ParticleKernels
+{
+    /** values[i] += deltas[i] * dt */
+    CC_DLL void addScaled(float* values, const float* deltas, float dt, int count);
+
+    /** values[i] = max(values[i] + deltas[i] * dt, minValue) */
+    CC_DLL void addScaledClamped(float* values, const float* deltas, float dt, float minValue, int count);
+
+    /** Decreases the time to live of the particles and writes the indices of the dead ones in ascending order.
+     * @return The number of dead particles.
+     */
+    CC_DLL int decreaseTimeToLive(float* timeToLive, float dt, int count, int* deadIndices);
+
+    /** Gravity mode: accelerates the particles radially, tangentially and with the gravity, then moves them. */
+    CC_DLL void updateGravity(float* posX, float* posY, float* dirX, float* dirY,
+                              const float* radialAccel, const float* tangentialAccel,
+                              float gravityX, float gravityY, float dt, float yCoordFlipped, int count);
+
+    /** Radius mode: rotates the particles around the emitter. */
+    CC_DLL void updateRadius(float* posX, float* posY, float* angle, const float* degreesPerSecond,
+                             float* radius, const float* deltaRadius, float dt, float yCoordFlipped, int count);
+
+    /** Writes the vertices of the particle quads.
+     * The center of a quad is (x + a * startX + b * startY + c, y + d * startX + e * startY + f),
+     * which covers the three position types with a single loop.
+     * @param transform {a, b, c, d, e, f}
+     */
+    CC_DLL void updateQuadVertices(V3F_C4B_T2F_Quad* quads, const float* x, const float* y,
+                                   const float* startX, const float* startY, const float transform[6],
+                                   const float* size, const float* rotation, int count);
+
+    /** Writes the colors of the particle quads, premultiplied by the alpha when premultiplyAlpha is set. */
+    CC_DLL void updateQuadColors(V3F_C4B_T2F_Quad* quads, const float* r, const float* g, const float* b, const float* a,
+                                 bool premultiplyAlpha, int count);
+}
+
+NS_CC_END
+
+/// @endcond
+#endif // __CC_PARTICLE_KERNELS_H__
@@ -48,6 +48,8 @@ THE SOFTWARE.
 #include <string>
 
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleKernels.h"
+#include "base/CCJobSystem.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
@@ -79,23 +81,6 @@ NS_CC_BEGIN
 //
 
 
-inline void normalize_point(float x, float y, particle_point* out)
-{
-    float n = x * x + y * y;
-    // Already normalized.
-    if (n == 1.0f)
-        return;
-    
-    n = sqrt(n);
-    // Too close to zero.
-    if (n < MATH_TOLERANCE)
-        return;
-    
-    n = 1.0f / n;
-    out->x = x * n;
-    out->y = y * n;
-}
-
 /**
  A more effect random number getter function, get from ejoy2d.
  */
@@ -188,12 +173,18 @@ void ParticleData::release()
 
 Vector<ParticleSystem*> ParticleSystem::__allInstances;
 float ParticleSystem::__totalParticleCountFactor = 1.0f;
+bool ParticleSystem::__parallelSimulationEnabled = true;
+
+// below this count a job costs more than the simulation
+static const int PARALLEL_SIMULATION_MIN_PARTICLES = 256;
 
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
+, _simulationJob(nullptr)
+, _postStepPending(false)
 , _configName("")
 , _emitCounter(0)
 , _batchNode(nullptr)
@@ -604,6 +595,7 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
+    waitForSimulation();
     _particleData.release();
     CC_SAFE_RELEASE(_texture);
 }
@@ -612,6 +604,7 @@ void ParticleSystem::addParticles(int count)
 {
     if (_paused)
         return;
+    waitForSimulation();
     uint32_t RANDSEED = rand();
 
     int start = _particleCount;
@@ -849,6 +842,7 @@ void ParticleSystem::resetSystem()
 {
     _isActive = true;
     _elapsed = 0;
+    waitForSimulation();
     for (int i = 0; i < _particleCount; ++i)
     {
         _particleData.timeToLive[i] = 0.0f;
@@ -865,6 +859,8 @@ void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    waitForSimulation();
+
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -892,141 +888,76 @@ void ParticleSystem::update(float dt)
     }
     
     {
-        for (int i = 0; i < _particleCount; ++i)
+        if (_deadParticleIndices.size() < (size_t)_particleCount)
         {
-            _particleData.timeToLive[i] -= dt;
+            _deadParticleIndices.resize(_particleData.maxCount);
         }
-        
-        for (int i = 0; i < _particleCount; ++i)
-        {
-            if (_particleData.timeToLive[i] <= 0.0f)
-            {
-                int j = _particleCount - 1;
-                while (j > 0 && _particleData.timeToLive[j] <= 0)
-                {
-                    _particleCount--;
-                    j--;
-                }
-                _particleData.copyParticle(i, _particleCount - 1);
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    int currentIndex = _particleData.atlasIndex[i];
-                    _batchNode->disableParticle(_atlasIndex + currentIndex);
-                    //switch indexes
-                    _particleData.atlasIndex[_particleCount - 1] = currentIndex;
-                }
-                --_particleCount;
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        }
-        
-        if (_emitterMode == Mode::GRAVITY)
-        {
-            for (int i = 0 ; i < _particleCount; ++i)
-            {
-                particle_point tmp, radial = {0.0f, 0.0f}, tangential;
-                
-                // radial acceleration
-                if (_particleData.posx[i] || _particleData.posy[i])
-                {
-                    normalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
-                }
-                tangential = radial;
-                radial.x *= _particleData.modeA.radialAccel[i];
-                radial.y *= _particleData.modeA.radialAccel[i];
-                
-                // tangential acceleration
-                std::swap(tangential.x, tangential.y);
-                tangential.x *= - _particleData.modeA.tangentialAccel[i];
-                tangential.y *= _particleData.modeA.tangentialAccel[i];
-                
-                // (gravity + radial + tangential) * dt
-                tmp.x = radial.x + tangential.x + modeA.gravity.x;
-                tmp.y = radial.y + tangential.y + modeA.gravity.y;
-                tmp.x *= dt;
-                tmp.y *= dt;
-                
-                _particleData.modeA.dirX[i] += tmp.x;
-                _particleData.modeA.dirY[i] += tmp.y;
-                
-                // this is cocos2d-x v3.0
-                // if (_configName.length()>0 && _yCoordFlipped != -1)
-                
-                // this is cocos2d-x v3.0
-                tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
-                tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
-                _particleData.posx[i] += tmp.x;
-                _particleData.posy[i] += tmp.y;
-            }
-        }
-        else
+        int deadCount = ParticleKernels::decreaseTimeToLive(_particleData.timeToLive, dt, _particleCount, _deadParticleIndices.data());
+
+        // fill the holes left by the dead particles with the last living ones
+        int previousCount = _particleCount;
+        for (int d = 0; d < deadCount; ++d)
         {
-            //Why use so many for-loop separately instead of putting them together?
-            //When the processor needs to read from or write to a location in memory,
-            //it first checks whether a copy of that data is in the cache.
-            //And every property's memory of the particle system is continuous,
-            //for the purpose of improving cache hit rate, we should process only one property in one for-loop AFAP.
-            //It was proved to be effective especially for low-end machine. 
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.modeB.angle[i] += _particleData.modeB.degreesPerSecond[i] * dt;
-            }
-            
-            for (int i = 0; i < _particleCount; ++i)
+            int i = _deadParticleIndices[d];
+            if (i >= _particleCount)
             {
-                _particleData.modeB.radius[i] += _particleData.modeB.deltaRadius[i] * dt;
+                break;
             }
-            
-            for (int i = 0; i < _particleCount; ++i)
+            while (_particleCount - 1 > i && _particleData.timeToLive[_particleCount - 1] <= 0.0f)
             {
-                _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
+                _particleCount--;
             }
-            for (int i = 0; i < _particleCount; ++i)
+            if (i >= _particleCount - 1)
             {
-                _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
+                _particleCount = i;
+                break;
             }
+
+            //switch indexes, the quads are written in the order of the particles
+            unsigned int currentIndex = _particleData.atlasIndex[i];
+            _particleData.copyParticle(i, _particleCount - 1);
+            _particleData.atlasIndex[_particleCount - 1] = _particleData.atlasIndex[i];
+            _particleData.atlasIndex[i] = currentIndex;
+            --_particleCount;
         }
-        
-        //color r,g,b,a
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
+
+        if (_batchNode)
         {
-            _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
+            //disable the quads of the dead particles
+            for (int i = _particleCount; i < previousCount; ++i)
+            {
+                _batchNode->disableParticle(_atlasIndex + _particleData.atlasIndex[i]);
+            }
         }
-        //size
-        for (int i = 0 ; i < _particleCount; ++i)
+
+        if (deadCount > 0 && _particleCount == 0 && _isAutoRemoveOnFinish)
         {
-            _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-            _particleData.size[i] = MAX(0, _particleData.size[i]);
+            this->unscheduleUpdate();
+            _parent->removeChild(this, true);
+            return;
         }
-        //angle
-        for (int i = 0 ; i < _particleCount; ++i)
+
+        prepareParticleQuads();
+        _transformSystemDirty = false;
+
+        if (__parallelSimulationEnabled && !_batchNode && _particleCount >= PARALLEL_SIMULATION_MIN_PARTICLES)
         {
-            _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+            // the settings are copied, they may change on the cocos thread while the job runs
+            auto jobSystem = JobSystem::getInstance();
+            Mode emitterMode = _emitterMode;
+            Vec2 gravity = modeA.gravity;
+            int yCoordFlipped = _yCoordFlipped;
+            _simulationJob = jobSystem->createJob([this, dt, emitterMode, gravity, yCoordFlipped]() {
+                simulate(dt, emitterMode, gravity, yCoordFlipped);
+            });
+            jobSystem->run(_simulationJob);
+            _postStepPending = _visible;
+
+            CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+            return;
         }
-        
-        updateParticleQuads();
-        _transformSystemDirty = false;
+
+        simulate(dt, _emitterMode, modeA.gravity, _yCoordFlipped);
     }
 
     // only update gl buffer when visible
@@ -1038,6 +969,50 @@ void ParticleSystem::update(float dt)
     CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 }
 
+void ParticleSystem::simulate(float dt, Mode emitterMode, const Vec2& gravity, int yCoordFlipped)
+{
+    if (emitterMode == Mode::GRAVITY)
+    {
+        ParticleKernels::updateGravity(_particleData.posx, _particleData.posy, _particleData.modeA.dirX, _particleData.modeA.dirY,
+                                       _particleData.modeA.radialAccel, _particleData.modeA.tangentialAccel,
+                                       gravity.x, gravity.y, dt, yCoordFlipped, _particleCount);
+    }
+    else
+    {
+        ParticleKernels::updateRadius(_particleData.posx, _particleData.posy, _particleData.modeB.angle, _particleData.modeB.degreesPerSecond,
+                                      _particleData.modeB.radius, _particleData.modeB.deltaRadius, dt, yCoordFlipped, _particleCount);
+    }
+
+    //Why use so many for-loop separately instead of putting them together?
+    //When the processor needs to read from or write to a location in memory,
+    //it first checks whether a copy of that data is in the cache.
+    //And every property's memory of the particle system is continuous,
+    //for the purpose of improving cache hit rate, we should process only one property in one for-loop AFAP.
+    //It was proved to be effective especially for low-end machine.
+
+    //color r,g,b,a
+    ParticleKernels::addScaled(_particleData.colorR, _particleData.deltaColorR, dt, _particleCount);
+    ParticleKernels::addScaled(_particleData.colorG, _particleData.deltaColorG, dt, _particleCount);
+    ParticleKernels::addScaled(_particleData.colorB, _particleData.deltaColorB, dt, _particleCount);
+    ParticleKernels::addScaled(_particleData.colorA, _particleData.deltaColorA, dt, _particleCount);
+    //size
+    ParticleKernels::addScaledClamped(_particleData.size, _particleData.deltaSize, dt, 0.0f, _particleCount);
+    //angle
+    ParticleKernels::addScaled(_particleData.rotation, _particleData.deltaRotation, dt, _particleCount);
+    
+    updateParticleQuads();
+}
+
+void ParticleSystem::waitForSimulation()
+{
+    if (_simulationJob)
+    {
+        JobSystem::getInstance()->wait(_simulationJob);
+        _simulationJob->release();
+        _simulationJob = nullptr;
+    }
+}
+
 void ParticleSystem::updateWithNoTime(void)
 {
     this->update(0.0f);
@@ -1048,6 +1023,11 @@ void ParticleSystem::updateParticleQuads()
     //should be overridden
 }
 
+void ParticleSystem::prepareParticleQuads()
+{
+    //should be overridden
+}
+
 void ParticleSystem::postStep()
 {
     // should be overridden
@@ -1335,6 +1315,7 @@ ParticleBatchNode* ParticleSystem::getBatchNode(void) const
 void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
 {
     if( _batchNode != batchNode ) {
+        waitForSimulation();
 
         _batchNode = batchNode; // weak reference
 
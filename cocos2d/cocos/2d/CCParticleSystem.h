@@ -40,6 +40,7 @@ NS_CC_BEGIN
  */
 
 class ParticleBatchNode;
+class Job;
 
 /** @struct sParticle
 Structure that contains the values of each particle.
@@ -255,6 +256,19 @@ public:
     /** Gets all ParticleSystem references
      */
     static Vector<ParticleSystem*>& getAllParticleSystems();
+
+    /** Sets whether the particle systems are simulated on the JobSystem.
+     * The emission and the removal of the dead particles stay on the cocos thread, in the order of the Scheduler,
+     * so the simulation stays deterministic. The rest of the update of each emitter runs as a job
+     * which is waited for before drawing the emitter. Emitters in a ParticleBatchNode are always updated on the cocos thread.
+     * Subclasses overriding updateParticleQuads must not access other nodes from it when this is enabled.
+     * Enabled by default.
+     */
+    static void setParallelSimulationEnabled(bool enabled) { __parallelSimulationEnabled = enabled; }
+    static bool isParallelSimulationEnabled() { return __parallelSimulationEnabled; }
+
+    /** Waits until the particles simulated on the JobSystem are up to date. */
+    void waitForSimulation();
 public:
     void addParticles(int count);
     
@@ -272,6 +286,9 @@ public:
      should be overridden by subclasses. 
      */
     virtual void updateParticleQuads();
+    /** Called on the cocos thread before updateParticleQuads, which may run on a worker thread.
+     Subclasses read the state of the other nodes here. */
+    virtual void prepareParticleQuads();
     /** Update the VBO verts buffer which does not use batch node,
      should be overridden by subclasses. */
     virtual void postStep();
@@ -823,6 +840,9 @@ CC_CONSTRUCTOR_ACCESS:
 
 protected:
     virtual void updateBlendFunc();
+
+    /** Moves the living particles and updates their quads. */
+    void simulate(float dt, Mode emitterMode, const Vec2& gravity, int yCoordFlipped);
     
 private:
     friend class EngineDataManager;
@@ -889,6 +909,13 @@ protected:
     
     //particle data
     ParticleData _particleData;
+    // indices of the particles that died during the update
+    std::vector<int> _deadParticleIndices;
+    // simulation running on the JobSystem
+    Job* _simulationJob;
+    // postStep is done once the simulation finished
+    bool _postStepPending;
+    static bool __parallelSimulationEnabled;
 
     //Emitter name
     std::string _configName;
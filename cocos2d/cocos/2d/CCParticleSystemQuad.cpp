@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleKernels.h"
 #include "renderer/CCTextureAtlas.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
@@ -52,10 +53,13 @@ ParticleSystemQuad::ParticleSystemQuad()
 ,_VAOname(0)
 {
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    memset(_quadTransform, 0, sizeof(_quadTransform));
 }
 
 ParticleSystemQuad::~ParticleSystemQuad()
 {
+    // the simulation writes the quads
+    waitForSimulation();
     if (nullptr == _batchNode)
     {
         CC_SAFE_FREE(_quads);
@@ -259,45 +263,41 @@ void ParticleSystemQuad::initIndices()
     }
 }
 
-inline void updatePosWithParticle(V3F_C4B_T2F_Quad *quad, const Vec2& newPosition,float size,float rotation)
+void ParticleSystemQuad::prepareParticleQuads()
 {
-    // vertices
-    GLfloat size_2 = size/2;
-    GLfloat x1 = -size_2;
-    GLfloat y1 = -size_2;
-    
-    GLfloat x2 = size_2;
-    GLfloat y2 = size_2;
-    GLfloat x = newPosition.x;
-    GLfloat y = newPosition.y;
-    
-    GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation);
-    GLfloat cr = cosf(r);
-    GLfloat sr = sinf(r);
-    GLfloat ax = x1 * cr - y1 * sr + x;
-    GLfloat ay = x1 * sr + y1 * cr + y;
-    GLfloat bx = x2 * cr - y1 * sr + x;
-    GLfloat by = x2 * sr + y1 * cr + y;
-    GLfloat cx = x2 * cr - y2 * sr + x;
-    GLfloat cy = x2 * sr + y2 * cr + y;
-    GLfloat dx = x1 * cr - y2 * sr + x;
-    GLfloat dy = x1 * sr + y2 * cr + y;
-    
-    // bottom-left
-    quad->bl.vertices.x = ax;
-    quad->bl.vertices.y = ay;
-    
-    // bottom-right vertex:
-    quad->br.vertices.x = bx;
-    quad->br.vertices.y = by;
-    
-    // top-left vertex:
-    quad->tl.vertices.x = dx;
-    quad->tl.vertices.y = dy;
-    
-    // top-right vertex:
-    quad->tr.vertices.x = cx;
-    quad->tr.vertices.y = cy;
+    Vec2 pos = _batchNode ? _position : Vec2::ZERO;
+
+    // the center of a quad is the particle position plus an affine function of its start position,
+    // so the three position types share the same loop
+    float* transform = _quadTransform;
+    transform[0] = 0.0f;
+    transform[1] = 0.0f;
+    transform[2] = pos.x;
+    transform[3] = 0.0f;
+    transform[4] = 0.0f;
+    transform[5] = pos.y;
+    if( _positionType == PositionType::FREE )
+    {
+        Vec2 currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        Vec3 p1(currentPosition.x, currentPosition.y, 0);
+        const Mat4& worldToNodeTM = getWorldToNodeTransform();
+        worldToNodeTM.transformPoint(&p1);
+        // pos - (p1 - worldToNodeTM * start)
+        transform[0] = worldToNodeTM.m[0];
+        transform[1] = worldToNodeTM.m[4];
+        transform[2] = worldToNodeTM.m[12] - p1.x + pos.x;
+        transform[3] = worldToNodeTM.m[1];
+        transform[4] = worldToNodeTM.m[5];
+        transform[5] = worldToNodeTM.m[13] - p1.y + pos.y;
+    }
+    else if( _positionType == PositionType::RELATIVE )
+    {
+        // pos - (_position - start)
+        transform[0] = 1.0f;
+        transform[2] = pos.x - _position.x;
+        transform[4] = 1.0f;
+        transform[5] = pos.y - _position.y;
+    }
 }
 
 void ParticleSystemQuad::updateParticleQuads()
@@ -306,131 +306,24 @@ void ParticleSystemQuad::updateParticleQuads()
         return;
     }
  
-    Vec2 currentPosition;
-    if (_positionType == PositionType::FREE)
-    {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
-    }
-    else if (_positionType == PositionType::RELATIVE)
-    {
-        currentPosition = _position;
-    }
-    
     V3F_C4B_T2F_Quad *startQuad;
-    Vec2 pos = Vec2::ZERO;
     if (_batchNode)
     {
         V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
         startQuad = &(batchQuads[_atlasIndex]);
-        pos = _position;
     }
     else
     {
         startQuad = &(_quads[0]);
     }
-    
-    if( _positionType == PositionType::FREE )
-    {
-        Vec3 p1(currentPosition.x, currentPosition.y, 0);
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        worldToNodeTM.transformPoint(&p1);
-        Vec3 p2;
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            p2.set(*startX, *startY, 0);
-            worldToNodeTM.transformPoint(&p2);
-            newPos.set(*x,*y);
-            p2 = p1 - p2;
-            newPos.x -= p2.x - pos.x;
-            newPos.y -= p2.y - pos.y;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
-    }
-    else if( _positionType == PositionType::RELATIVE )
-    {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            newPos.set(*x, *y);
-            newPos.x = *x - (currentPosition.x - *startX);
-            newPos.y = *y - (currentPosition.y - *startY);
-            newPos += pos;
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
-    }
-    else
-    {
-        Vec2 newPos;
-        float* startX = _particleData.startPosX;
-        float* startY = _particleData.startPosY;
-        float* x = _particleData.posx;
-        float* y = _particleData.posy;
-        float* s = _particleData.size;
-        float* r = _particleData.rotation;
-        V3F_C4B_T2F_Quad* quadStart = startQuad;
-        for (int i = 0 ; i < _particleCount; ++i, ++startX, ++startY, ++x, ++y, ++quadStart, ++s, ++r)
-        {
-            newPos.set(*x + pos.x, *y + pos.y);
-            updatePosWithParticle(quadStart, newPos, *s, *r);
-        }
-    }
-    
+
+    ParticleKernels::updateQuadVertices(startQuad, _particleData.posx, _particleData.posy,
+                                        _particleData.startPosX, _particleData.startPosY, _quadTransform,
+                                        _particleData.size, _particleData.rotation, _particleCount);
+
     //set color
-    if(_opacityModifyRGB)
-    {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-        
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
-        {
-            GLubyte colorR = *r * *a * 255;
-            GLubyte colorG = *g * *a * 255;
-            GLubyte colorB = *b * *a * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
-        }
-    }
-    else
-    {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
-        
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
-        {
-            GLubyte colorR = *r * 255;
-            GLubyte colorG = *g * 255;
-            GLubyte colorB = *b * 255;
-            GLubyte colorA = *a * 255;
-            quad->bl.colors.set(colorR, colorG, colorB, colorA);
-            quad->br.colors.set(colorR, colorG, colorB, colorA);
-            quad->tl.colors.set(colorR, colorG, colorB, colorA);
-            quad->tr.colors.set(colorR, colorG, colorB, colorA);
-        }
-    }
+    ParticleKernels::updateQuadColors(startQuad, _particleData.colorR, _particleData.colorG, _particleData.colorB, _particleData.colorA,
+                                      _opacityModifyRGB, _particleCount);
 }
 
 void ParticleSystemQuad::postStep()
@@ -457,6 +350,13 @@ void ParticleSystemQuad::postStep()
 // overriding draw method
 void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
+    waitForSimulation();
+    if (_postStepPending)
+    {
+        _postStepPending = false;
+        postStep();
+    }
+
     //quad command
     if(_particleCount > 0)
     {
@@ -467,6 +367,7 @@ void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_
 
 void ParticleSystemQuad::setTotalParticles(int tp)
 {
+    waitForSimulation();
     // If we are setting the total number of particles to a number higher
     // than what is allocated, we need to allocate new arrays
     if( tp > _allocatedParticles )
@@ -643,6 +544,7 @@ bool ParticleSystemQuad::allocMemory()
 
 void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
 {
+    waitForSimulation();
     if( _batchNode != batchNode ) 
     {
         ParticleBatchNode* oldBatch = _batchNode;
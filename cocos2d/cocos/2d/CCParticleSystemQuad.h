@@ -121,6 +121,11 @@ public:
      * @lua NA
      */    
     virtual void updateParticleQuads() override;
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual void prepareParticleQuads() override;
     /**
      * @js NA
      * @lua NA
@@ -185,6 +190,7 @@ protected:
     GLuint              _buffersVBO[2]; //0: vertex  1: indices
 
     QuadCommand _quadCommand;           // quad command
+    float _quadTransform[6];            // position of the quads from the start positions, see prepareParticleQuads
     
 
 
@@ -193,6 +193,9 @@ protected:
     void insertProtectedChild(Node* child, int z);
     
     Vector<Node*> _protectedChildren;        ///< array of children nodes
+
+    // the listeners of the protected children have the lowest scene graph priority
+    friend class EventDispatcher;
     bool _reorderProtectedChildDirty;
     
 private:
@@ -39,6 +39,8 @@
 #include "audio/win32/AudioEngine-win32.h"
 #elif CC_TARGET_PLATFORM == CC_PLATFORM_WINRT
 #include "audio/winrt/AudioEngine-winrt.h"
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_AUDIO_MIXER
+#include "audio/linux/AudioEngine-mixer.h"
 #elif CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
 #include "audio/linux/AudioEngine-linux.h"
 #elif CC_TARGET_PLATFORM == CC_PLATFORM_TIZEN
@@ -61,6 +63,8 @@ const float AudioEngine::TIME_UNKNOWN = -1.0f;
 std::unordered_map<std::string,std::list<int>> AudioEngine::_audioPathIDMap;
 //profileName,ProfileHelper
 std::unordered_map<std::string, AudioEngine::ProfileHelper> AudioEngine::_audioPathProfileHelperMap;
+//bankName,audio file paths
+std::unordered_map<std::string, std::vector<std::string>> AudioEngine::_audioBankFilePathsMap;
 unsigned int AudioEngine::_maxInstances = MAX_AUDIOINSTANCES;
 AudioEngine::ProfileHelper* AudioEngine::_defaultProfileHelper = nullptr;
 std::unordered_map<int, AudioEngine::AudioInfo> AudioEngine::_audioIDInfoMap;
@@ -413,6 +417,7 @@ void AudioEngine::uncacheAll()
     }
     stopAll();
     _audioEngineImpl->uncacheAll();
+    _audioBankFilePathsMap.clear();
 }
 
 float AudioEngine::getDuration(int audioID)
@@ -557,6 +562,51 @@ void AudioEngine::preload(const std::string& filePath, std::function<void(bool i
     }
 }
 
+void AudioEngine::preloadBank(const std::string& bankName, const std::vector<std::string>& filePaths, std::function<void(bool isSuccess)> callback)
+{
+    auto& bankFilePaths = _audioBankFilePathsMap[bankName];
+    bankFilePaths.insert(bankFilePaths.end(), filePaths.begin(), filePaths.end());
+
+    if (filePaths.empty())
+    {
+        if (callback)
+        {
+            callback(true);
+        }
+        return;
+    }
+
+    // The callbacks are invoked in the cocos thread, so the counters don't need to be atomic
+    auto remainingCount = std::make_shared<size_t>(filePaths.size());
+    auto allSucceeded = std::make_shared<bool>(true);
+    for (const auto& filePath : filePaths)
+    {
+        preload(filePath, [remainingCount, allSucceeded, callback](bool isSuccess){
+            *allSucceeded = *allSucceeded && isSuccess;
+            if (--*remainingCount == 0 && callback)
+            {
+                callback(*allSucceeded);
+            }
+        });
+    }
+}
+
+void AudioEngine::uncacheBank(const std::string& bankName)
+{
+    auto it = _audioBankFilePathsMap.find(bankName);
+    if (it == _audioBankFilePathsMap.end())
+    {
+        return;
+    }
+
+    auto filePaths = std::move(it->second);
+    _audioBankFilePathsMap.erase(it);
+    for (const auto& filePath : filePaths)
+    {
+        uncache(filePath);
+    }
+}
+
 void AudioEngine::addTask(const std::function<void()>& task)
 {
     lazyInit();
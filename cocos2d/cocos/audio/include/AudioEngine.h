@@ -33,6 +33,7 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #ifdef ERROR
 #undef ERROR
@@ -293,6 +294,21 @@ public:
      */
     static void preload(const std::string& filePath, std::function<void(bool isSuccess)> callback);
 
+    /**
+     * Preload a bank of audio files, such as the sound effects of a scene, to uncache them together.
+     * The files are loaded at the same time, in parallel on the platforms decoding them on worker threads.
+     * @param bankName The name of the bank, the files are added to it if it's already preloaded.
+     * @param filePaths The file paths of the audios.
+     * @param callback A callback which will be called after all the files are loaded, with false if any of them failed.
+     */
+    static void preloadBank(const std::string& bankName, const std::vector<std::string>& filePaths, std::function<void(bool isSuccess)> callback = nullptr);
+
+    /**
+     * Uncache the audio files of a bank, the files shared with other banks are uncached as well.
+     * @param bankName The name of the bank.
+     */
+    static void uncacheBank(const std::string& bankName);
+
     /**
      * Gets playing audio count.
      */
@@ -354,6 +370,9 @@ protected:
     
     //profileName,ProfileHelper
     static std::unordered_map<std::string, ProfileHelper> _audioPathProfileHelperMap;
+
+    //bankName,audio file paths
+    static std::unordered_map<std::string, std::vector<std::string>> _audioBankFilePathsMap;
     
     static unsigned int _maxInstances;
     
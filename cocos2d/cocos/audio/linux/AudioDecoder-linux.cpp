@@ -0,0 +1,516 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "audio/linux/AudioDecoder-linux.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <algorithm>
+#include <string.h>
+
+#include "audio/linux/AudioMixer-linux.h"
+#include "base/CCConsole.h"
+#include "platform/CCFileUtils.h"
+
+// After the engine headers, pvmp3dec defines macros like LEFT
+#include "Tremolo/ivorbisfile.h"
+#include "pvmp3decoder_api.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace {
+    const uint16_t WAVE_FORMAT_PCM = 1;
+    const uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    uint16_t readUInt16(const unsigned char* p)
+    {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    uint32_t readUInt32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    int16_t convertSample(const unsigned char* p, uint16_t format, int bitsPerSample)
+    {
+        if (format == WAVE_FORMAT_IEEE_FLOAT)
+        {
+            uint32_t bits = readUInt32(p);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+            return (int16_t)(value * 32767.0f);
+        }
+
+        // Only the 16 most significant bits are kept, the samples of 8 bits are unsigned
+        switch (bitsPerSample)
+        {
+            case 8: return (int16_t)((p[0] - 128) << 8);
+            case 16: return (int16_t)readUInt16(p);
+            case 24: return (int16_t)readUInt16(p + 1);
+            default: return (int16_t)readUInt16(p + 2);
+        }
+    }
+
+    class WavDecoder : public AudioDecoder
+    {
+    public:
+        WavDecoder() : _format(0), _bitsPerSample(0), _samples(nullptr), _frameSize(0), _position(0) {}
+
+        virtual bool seek(uint32_t frame) override
+        {
+            if (frame > _frameCount)
+                return false;
+            _position = frame;
+            return true;
+        }
+
+    protected:
+        virtual bool open() override
+        {
+            const unsigned char* data = _data.getBytes();
+            size_t size = (size_t)_data.getSize();
+            size_t samplesSize = 0;
+
+            size_t offset = 12;
+            while (offset + 8 <= size)
+            {
+                const unsigned char* chunk = data + offset;
+                size_t chunkSize = std::min((size_t)readUInt32(chunk + 4), size - offset - 8);
+                if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+                {
+                    _format = readUInt16(chunk + 8);
+                    _sourceChannelCount = readUInt16(chunk + 10);
+                    _sampleRate = (int)readUInt32(chunk + 12);
+                    _bitsPerSample = readUInt16(chunk + 22);
+                    if (_format == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 26)
+                        _format = readUInt16(chunk + 32);
+                }
+                else if (memcmp(chunk, "data", 4) == 0)
+                {
+                    _samples = chunk + 8;
+                    samplesSize = chunkSize;
+                }
+                // Chunks are padded to an even size
+                offset += 8 + chunkSize + (chunkSize & 1);
+            }
+
+            bool supported = (_format == WAVE_FORMAT_PCM && (_bitsPerSample == 8 || _bitsPerSample == 16 || _bitsPerSample == 24 || _bitsPerSample == 32))
+                || (_format == WAVE_FORMAT_IEEE_FLOAT && _bitsPerSample == 32);
+            if (!supported || !_samples || _sourceChannelCount <= 0 || _sampleRate <= 0)
+                return false;
+
+            _frameSize = _bitsPerSample / 8 * _sourceChannelCount;
+            _frameCount = (uint32_t)(samplesSize / _frameSize);
+            return true;
+        }
+
+        virtual uint32_t readFrames(int16_t* buffer, uint32_t frames) override
+        {
+            frames = std::min(frames, _frameCount - _position);
+            int bytesPerSample = _bitsPerSample / 8;
+            for (uint32_t i = 0; i < frames; ++i)
+            {
+                const unsigned char* frame = _samples + (size_t)(_position + i) * _frameSize;
+                for (int channel = 0; channel < _sourceChannelCount; ++channel)
+                    *buffer++ = convertSample(frame + channel * bytesPerSample, _format, _bitsPerSample);
+            }
+            _position += frames;
+            return frames;
+        }
+
+    private:
+        uint16_t _format;
+        int _bitsPerSample;
+        const unsigned char* _samples;
+        size_t _frameSize;
+        uint32_t _position;
+    };
+
+    class OggDecoder : public AudioDecoder
+    {
+    public:
+        OggDecoder() : _offset(0), _opened(false) {}
+
+        virtual ~OggDecoder()
+        {
+            if (_opened)
+                ov_clear(&_file);
+        }
+
+        virtual bool seek(uint32_t frame) override
+        {
+            return frame <= _frameCount && ov_pcm_seek(&_file, frame) == 0;
+        }
+
+    protected:
+        virtual bool open() override
+        {
+            ov_callbacks callbacks = { readCallback, seekCallback, closeCallback, tellCallback };
+            if (ov_open_callbacks(this, &_file, nullptr, 0, callbacks) != 0)
+                return false;
+            _opened = true;
+
+            vorbis_info* info = ov_info(&_file, -1);
+            ogg_int64_t frameCount = ov_pcm_total(&_file, -1);
+            if (!info || info->channels <= 0 || info->rate <= 0 || frameCount < 0)
+                return false;
+            _sourceChannelCount = info->channels;
+            _sampleRate = (int)info->rate;
+            _frameCount = (uint32_t)frameCount;
+            return true;
+        }
+
+        virtual uint32_t readFrames(int16_t* buffer, uint32_t frames) override
+        {
+            int frameSize = _sourceChannelCount * (int)sizeof(int16_t);
+            char* dst = (char*)buffer;
+            int size = (int)frames * frameSize;
+            int decodedSize = 0;
+            while (decodedSize < size)
+            {
+                int bitstream = 0;
+                long ret = ov_read(&_file, dst + decodedSize, size - decodedSize, &bitstream);
+                if (ret == OV_HOLE)
+                    continue;
+                if (ret <= 0)
+                    break;
+                decodedSize += (int)ret;
+            }
+            return (uint32_t)(decodedSize / frameSize);
+        }
+
+    private:
+        static size_t readCallback(void* ptr, size_t size, size_t nmemb, void* datasource)
+        {
+            auto decoder = (OggDecoder*)datasource;
+            size_t available = (size_t)decoder->_data.getSize() - decoder->_offset;
+            size_t count = size > 0 ? std::min(nmemb, available / size) : 0;
+            memcpy(ptr, decoder->_data.getBytes() + decoder->_offset, count * size);
+            decoder->_offset += count * size;
+            return count;
+        }
+
+        static int seekCallback(void* datasource, ogg_int64_t offset, int whence)
+        {
+            auto decoder = (OggDecoder*)datasource;
+            ogg_int64_t size = (ogg_int64_t)decoder->_data.getSize();
+            ogg_int64_t position = whence == SEEK_SET ? offset
+                : (whence == SEEK_CUR ? (ogg_int64_t)decoder->_offset + offset : size + offset);
+            if (position < 0 || position > size)
+                return -1;
+            decoder->_offset = (size_t)position;
+            return 0;
+        }
+
+        static int closeCallback(void* /*datasource*/)
+        {
+            return 0;
+        }
+
+        static long tellCallback(void* datasource)
+        {
+            return (long)((OggDecoder*)datasource)->_offset;
+        }
+
+        OggVorbis_File _file;
+        size_t _offset;
+        bool _opened;
+    };
+
+    /**
+     * The MP3 frames are indexed when the file is opened, which gives the duration and allows
+     * seeking to any frame.
+     */
+    class Mp3Decoder : public AudioDecoder
+    {
+    public:
+        Mp3Decoder() : _samplesPerFrame(0), _nextFrame(0), _pendingOffset(0), _pendingFrames(0), _skippedFrames(0)
+        {
+            memset(&_config, 0, sizeof(_config));
+        }
+
+        virtual bool seek(uint32_t frame) override
+        {
+            uint32_t index = frame / _samplesPerFrame;
+            if (frame > _frameCount || index > _frameOffsets.size())
+                return false;
+
+            // The frames may use the data of the previous ones, which are decoded and dropped
+            uint32_t first = index >= 2 ? index - 2 : 0;
+            pvmp3_resetDecoder(_decoderMemory.data());
+            _nextFrame = first;
+            _pendingFrames = 0;
+            _skippedFrames = frame - first * _samplesPerFrame;
+            return true;
+        }
+
+        /// MP3 files have no signature, they start with an ID3 tag or a frame followed by another one
+        static bool isMp3(const unsigned char* data, size_t size)
+        {
+            if (size >= 10 && memcmp(data, "ID3", 3) == 0)
+                return true;
+            FrameHeader header, next;
+            return size >= 4 && parseHeader(data, header) && header.size <= size
+                && (header.size + 4 > size || parseHeader(data + header.size, next));
+        }
+
+    protected:
+        struct FrameHeader
+        {
+            int sampleRate;
+            int channelCount;
+            int samplesPerFrame;
+            size_t size;
+        };
+
+        /// Parses the header of a MPEG audio layer III frame
+        static bool parseHeader(const unsigned char* p, FrameHeader& header)
+        {
+            static const int MPEG1_BITRATES[] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+            static const int MPEG2_BITRATES[] = { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 };
+            static const int MPEG1_SAMPLE_RATES[] = { 44100, 48000, 32000 };
+
+            if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0)
+                return false;
+            int version = (p[1] >> 3) & 3;
+            int layer = (p[1] >> 1) & 3;
+            int bitrateIndex = p[2] >> 4;
+            int sampleRateIndex = (p[2] >> 2) & 3;
+            if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3)
+                return false;
+
+            // The version is 3 for MPEG 1, 2 for MPEG 2 and 0 for MPEG 2.5
+            bool mpeg1 = version == 3;
+            int bitrate = (mpeg1 ? MPEG1_BITRATES : MPEG2_BITRATES)[bitrateIndex] * 1000;
+            header.sampleRate = MPEG1_SAMPLE_RATES[sampleRateIndex] >> (mpeg1 ? 0 : (version == 2 ? 1 : 2));
+            header.channelCount = (p[3] >> 6) == 3 ? 1 : 2;
+            header.samplesPerFrame = mpeg1 ? 1152 : 576;
+            header.size = (size_t)((mpeg1 ? 144 : 72) * bitrate / header.sampleRate + ((p[2] >> 1) & 1));
+            return true;
+        }
+
+        virtual bool open() override
+        {
+            const unsigned char* data = _data.getBytes();
+            size_t size = (size_t)_data.getSize();
+
+            size_t offset = 0;
+            if (size >= 10 && memcmp(data, "ID3", 3) == 0)
+            {
+                size_t tagSize = ((size_t)(data[6] & 0x7F) << 21) | ((data[7] & 0x7F) << 14) | ((data[8] & 0x7F) << 7) | (data[9] & 0x7F);
+                offset = 10 + tagSize + ((data[5] & 0x10) ? 10 : 0);
+            }
+
+            // A frame is accepted after a sync word only if another one follows it, or it ends the file
+            FrameHeader first = { 0, 0, 0, 0 };
+            bool found = false;
+            while (offset + 4 <= size)
+            {
+                FrameHeader header, next;
+                if (parseHeader(data + offset, header) && offset + header.size <= size
+                    && (offset + header.size + 4 > size
+                        || (parseHeader(data + offset + header.size, next) && next.sampleRate == header.sampleRate)))
+                {
+                    if (!found)
+                    {
+                        first = header;
+                        found = true;
+                    }
+                    if (header.sampleRate == first.sampleRate)
+                    {
+                        _frameOffsets.push_back((uint32_t)offset);
+                        offset += header.size;
+                        continue;
+                    }
+                }
+                ++offset;
+            }
+            if (!found)
+                return false;
+
+            _sourceChannelCount = first.channelCount;
+            _sampleRate = first.sampleRate;
+            _samplesPerFrame = first.samplesPerFrame;
+            _frameCount = (uint32_t)_frameOffsets.size() * _samplesPerFrame;
+            _pendingSamples.resize(_samplesPerFrame * 2);
+
+            _decoderMemory.resize(pvmp3_decoderMemRequirements());
+            _config.equalizerType = flat;
+            _config.crcEnabled = false;
+            pvmp3_InitDecoder(&_config, _decoderMemory.data());
+            return true;
+        }
+
+        virtual uint32_t readFrames(int16_t* buffer, uint32_t frames) override
+        {
+            uint32_t decodedFrames = 0;
+            while (decodedFrames < frames)
+            {
+                if (_pendingFrames == 0 && !decodeNextFrame())
+                    break;
+
+                uint32_t count = std::min(frames - decodedFrames, _pendingFrames);
+                if (_skippedFrames > 0)
+                {
+                    count = std::min(count, _skippedFrames);
+                    _skippedFrames -= count;
+                }
+                else
+                {
+                    memcpy(buffer + decodedFrames * _sourceChannelCount, _pendingSamples.data() + _pendingOffset * _sourceChannelCount,
+                           count * _sourceChannelCount * sizeof(int16_t));
+                    decodedFrames += count;
+                }
+                _pendingOffset += count;
+                _pendingFrames -= count;
+            }
+            return decodedFrames;
+        }
+
+    private:
+        bool decodeNextFrame()
+        {
+            if (_nextFrame >= _frameOffsets.size())
+                return false;
+
+            FrameHeader header;
+            const unsigned char* frame = _data.getBytes() + _frameOffsets[_nextFrame++];
+            parseHeader(frame, header);
+
+            // The decoder takes a writable buffer, while the file may be mapped read-only
+            _inputBuffer.assign(frame, frame + header.size);
+            _config.pInputBuffer = _inputBuffer.data();
+            _config.inputBufferCurrentLength = (int32)header.size;
+            _config.inputBufferMaxLength = 0;
+            _config.inputBufferUsedLength = 0;
+            _config.pOutputBuffer = _pendingSamples.data();
+            _config.outputFrameSize = (int32)_pendingSamples.size();
+
+            // A corrupted frame is played as silence, to keep the duration
+            if (pvmp3_framedecoder(&_config, _decoderMemory.data()) != NO_DECODING_ERROR
+                || _config.outputFrameSize != (int32)_samplesPerFrame * _sourceChannelCount)
+            {
+                memset(_pendingSamples.data(), 0, _pendingSamples.size() * sizeof(int16_t));
+            }
+            _pendingOffset = 0;
+            _pendingFrames = _samplesPerFrame;
+            return true;
+        }
+
+        tPVMP3DecoderExternal _config;
+        std::vector<unsigned char> _decoderMemory;
+        std::vector<uint32_t> _frameOffsets;
+        std::vector<uint8> _inputBuffer;
+        std::vector<int16_t> _pendingSamples;
+        uint32_t _samplesPerFrame;
+        uint32_t _nextFrame;
+        uint32_t _pendingOffset;
+        uint32_t _pendingFrames;
+        uint32_t _skippedFrames;
+    };
+}
+
+AudioDecoder::AudioDecoder()
+: _sourceChannelCount(0)
+, _channelCount(0)
+, _sampleRate(0)
+, _frameCount(0)
+{
+}
+
+AudioDecoder* AudioDecoder::createWithFile(const std::string& fullPath)
+{
+    MappedData data = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
+    if (data.isNull())
+    {
+        log("AudioDecoder: can't read %s", fullPath.c_str());
+        return nullptr;
+    }
+
+    const unsigned char* bytes = data.getBytes();
+    size_t size = (size_t)data.getSize();
+    AudioDecoder* decoder = nullptr;
+    if (size >= 12 && memcmp(bytes, "RIFF", 4) == 0 && memcmp(bytes + 8, "WAVE", 4) == 0)
+        decoder = new (std::nothrow) WavDecoder();
+    else if (size >= 4 && memcmp(bytes, "OggS", 4) == 0)
+        decoder = new (std::nothrow) OggDecoder();
+    else if (Mp3Decoder::isMp3(bytes, size))
+        decoder = new (std::nothrow) Mp3Decoder();
+    else
+    {
+        log("AudioDecoder: %s isn't a WAV, OGG or MP3 file", fullPath.c_str());
+        return nullptr;
+    }
+
+    if (!decoder)
+        return nullptr;
+    decoder->_data = std::move(data);
+    if (!decoder->open())
+    {
+        log("AudioDecoder: unsupported format of %s", fullPath.c_str());
+        delete decoder;
+        return nullptr;
+    }
+    // Only the first 2 channels of surround files are kept
+    decoder->_channelCount = std::min(decoder->_sourceChannelCount, 2);
+    return decoder;
+}
+
+void AudioDecoder::decodeToPcm(PcmBuffer* pcm)
+{
+    pcm->channelCount = _channelCount;
+    pcm->sampleRate = _sampleRate;
+    pcm->samples.resize((size_t)_frameCount * _channelCount);
+    pcm->frameCount = read(pcm->samples.data(), _frameCount);
+    pcm->samples.resize((size_t)pcm->frameCount * _channelCount);
+}
+
+uint32_t AudioDecoder::read(int16_t* buffer, uint32_t frames)
+{
+    bool downmix = _sourceChannelCount != _channelCount;
+    if (downmix && _downmixBuffer.size() < (size_t)frames * _sourceChannelCount)
+        _downmixBuffer.resize((size_t)frames * _sourceChannelCount);
+
+    uint32_t decodedFrames = 0;
+    while (decodedFrames < frames)
+    {
+        int16_t* dst = downmix ? _downmixBuffer.data() : buffer + decodedFrames * _channelCount;
+        uint32_t count = readFrames(dst, frames - decodedFrames);
+        if (count == 0)
+            break;
+
+        if (downmix)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                memcpy(buffer + (decodedFrames + i) * _channelCount, dst + i * _sourceChannelCount, _channelCount * sizeof(int16_t));
+        }
+        decodedFrames += count;
+    }
+    return decodedFrames;
+}
+
+#endif
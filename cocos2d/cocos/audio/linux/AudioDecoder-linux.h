@@ -0,0 +1,104 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#ifndef __AUDIO_DECODER_LINUX_H_
+#define __AUDIO_DECODER_LINUX_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "platform/CCMappedData.h"
+
+NS_CC_BEGIN
+namespace experimental{
+
+struct PcmBuffer;
+
+/**
+ * Streaming decoder of audio files for the software mixer, giving 16-bit samples with at most
+ * 2 channels interleaved.
+ *
+ * WAV files with integer samples of 8 to 32 bits or float samples, OGG Vorbis and MP3 files are
+ * supported. The file is memory-mapped, so that streaming it doesn't read it all at once.
+ * A decoder doesn't use the engine state, so it may be used from any thread, one at a time.
+ */
+class AudioDecoder
+{
+public:
+    /**
+     * Opens a file, the format is detected from its contents.
+     * @return The decoder, or nullptr if the file can't be read or its format isn't supported.
+     */
+    static AudioDecoder* createWithFile(const std::string& fullPath);
+
+
+    virtual ~AudioDecoder() {}
+
+    int getChannelCount() const { return _channelCount; }
+    int getSampleRate() const { return _sampleRate; }
+    uint32_t getFrameCount() const { return _frameCount; }
+
+    /**
+     * Decodes the next frames.
+     * @param buffer Room for frames * getChannelCount() samples.
+     * @return The number of decoded frames, less than requested only at the end of the file.
+     */
+    uint32_t read(int16_t* buffer, uint32_t frames);
+
+    /** Moves to a frame, returns false if it's past the end of the file. */
+    virtual bool seek(uint32_t frame) = 0;
+
+    /** Decodes the rest of the file into pcm, keeping its sample rate. */
+    void decodeToPcm(PcmBuffer* pcm);
+
+protected:
+    AudioDecoder();
+
+    virtual bool open() = 0;
+    /**
+     * Decodes the next frames with all the channels of the file.
+     * @return The number of decoded frames, 0 at the end of the file or on error.
+     */
+    virtual uint32_t readFrames(int16_t* buffer, uint32_t frames) = 0;
+
+    MappedData _data;
+    /// Channels of the file, more than getChannelCount() for surround files
+    int _sourceChannelCount;
+    int _channelCount;
+    int _sampleRate;
+    uint32_t _frameCount;
+
+private:
+    std::vector<int16_t> _downmixBuffer;
+};
+
+}
+NS_CC_END
+
+#endif // __AUDIO_DECODER_LINUX_H_
+#endif
@@ -0,0 +1,703 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "audio/linux/AudioEngine-mixer.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <algorithm>
+#include <atomic>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace {
+    const int OUTPUT_SAMPLE_RATE = 44100;
+    // About 6ms, the latency of ALSA is about 4 periods
+    const int OUTPUT_PERIOD_FRAMES = 256;
+    const size_t DEFAULT_CACHE_MEMORY_LIMIT = 32 * 1024 * 1024;
+    // Files bigger than this once decoded, about 12s of stereo at 44.1 kHz, are streamed
+    const size_t STREAM_MIN_SIZE = 2 * 1024 * 1024;
+
+    AudioOutput::Type s_outputType = AudioOutput::Type::AUTO;
+    AudioEngineImpl* s_instance = nullptr;
+}
+
+struct AudioEngineImpl::Stream
+{
+    PcmStream pcm;
+    std::string fullPath;
+    /// Used by one decodeChunk() call at a time, opened by the first one if needed
+    std::shared_ptr<AudioDecoder> decoder;
+    std::atomic<bool> filling{false};
+    std::atomic<bool> loop{false};
+    std::atomic<uint32_t> seekFrame{0};
+    /// Game thread, the chunk to fill next
+    int nextChunk = 0;
+    /// Used by decodeChunk(), the frame decoded next and the generation of the last seek
+    uint32_t nextFrame = 0;
+    uint32_t decodedGeneration = 0;
+
+    /** Worker thread. Decodes the next frames into a FILLING chunk, and makes it READY. */
+    void decodeChunk(int index)
+    {
+        PcmStream::Chunk& chunk = pcm.chunks[index];
+        uint32_t generation = pcm.generation.load(std::memory_order_acquire);
+        if (!decoder)
+            decoder.reset(AudioDecoder::createWithFile(fullPath));
+
+        uint32_t frames = 0;
+        bool last = true;
+        if (decoder)
+        {
+            if (generation != decodedGeneration)
+            {
+                nextFrame = seekFrame.load(std::memory_order_relaxed);
+                decoder->seek(nextFrame);
+                decodedGeneration = generation;
+            }
+
+            bool rewound = false;
+            chunk.startFrame = nextFrame;
+            while (frames < PcmStream::CHUNK_FRAMES)
+            {
+                uint32_t count = decoder->read(chunk.samples.data() + frames * pcm.channelCount, PcmStream::CHUNK_FRAMES - frames);
+                frames += count;
+                nextFrame += count;
+                if (frames == PcmStream::CHUNK_FRAMES)
+                {
+                    last = false;
+                    break;
+                }
+                // The end of the file, unless it's empty the decoding goes on from its start when looping
+                if (!loop.load(std::memory_order_relaxed) || (count == 0 && rewound))
+                    break;
+                decoder->seek(0);
+                nextFrame = 0;
+                rewound = true;
+            }
+        }
+
+        chunk.frameCount = frames;
+        chunk.last = last;
+        chunk.generation = generation;
+        chunk.state.store(PcmStream::READY, std::memory_order_release);
+        filling.store(false, std::memory_order_release);
+    }
+};
+
+void AudioEngineImpl::setOutputType(AudioOutput::Type type)
+{
+    s_outputType = type;
+}
+
+AudioEngineImpl* AudioEngineImpl::getInstance()
+{
+    return s_instance;
+}
+
+AudioEngineImpl::AudioEngineImpl()
+: _mixer(OUTPUT_SAMPLE_RATE)
+, _output(&_mixer)
+, _cacheMemorySize(0)
+, _cacheMemoryLimit(DEFAULT_CACHE_MEMORY_LIMIT)
+, _loadQueue(std::make_shared<LoadQueue>())
+, _currentAudioID(0)
+, _scheduled(false)
+{
+    for (int i = 0; i < AudioMixer::MAX_VOICES; ++i)
+        _voiceAudioIDs[i] = AudioEngine::INVALID_AUDIO_ID;
+}
+
+AudioEngineImpl::~AudioEngineImpl()
+{
+    if (_scheduled)
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this);
+    // The mixer thread reads the decoded files until it's stopped
+    _output.stop();
+    if (s_instance == this)
+        s_instance = nullptr;
+}
+
+bool AudioEngineImpl::init()
+{
+    if (!_output.start(s_outputType, OUTPUT_PERIOD_FRAMES))
+        return false;
+
+    // With the offline output, renderOffline() calls update()
+    if (_output.getType() != AudioOutput::Type::OFFLINE)
+    {
+        Director::getInstance()->getScheduler()->schedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this, 0.0f, false);
+        _scheduled = true;
+    }
+
+    s_instance = this;
+    return true;
+}
+
+int AudioEngineImpl::play2d(const std::string &filePath, bool loop, float volume)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    if (fullPath.empty())
+        return AudioEngine::INVALID_AUDIO_ID;
+
+    int audioID = _currentAudioID++;
+    Player& player = _players[audioID];
+    player.voice = -1;
+    player.filePath = filePath;
+    player.fullPath = fullPath;
+    player.volume = volume;
+    player.loop = loop;
+    player.paused = false;
+    player.stopped = false;
+    player.stopQueued = false;
+
+    auto it = _cache.find(fullPath);
+    if (it == _cache.end())
+    {
+        loadFile(fullPath);
+        it = _cache.find(fullPath);
+    }
+
+    // The decoding is done on a worker thread, the player starts once it's done
+    CacheEntry& entry = it->second;
+    if (entry.state == CacheState::LOADING)
+    {
+        entry.pendingAudioIDs.push_back(audioID);
+        return audioID;
+    }
+
+    if (entry.state == CacheState::READY)
+    {
+        touchCache(entry);
+        player.pcm = entry.pcm;
+        if (startPlayer(audioID, player))
+            return audioID;
+    }
+    else
+    {
+        createStream(player, entry, nullptr);
+        return audioID;
+    }
+
+    _players.erase(audioID);
+    return AudioEngine::INVALID_AUDIO_ID;
+}
+
+void AudioEngineImpl::setVolume(int audioID, float volume)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return;
+    player->volume = volume;
+    if (player->voice >= 0)
+        _mixer.setVolume(player->voice, volume);
+}
+
+void AudioEngineImpl::setLoop(int audioID, bool loop)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return;
+    player->loop = loop;
+    if (player->stream)
+        player->stream->loop = loop;
+    else if (player->voice >= 0)
+        _mixer.setLoop(player->voice, loop);
+}
+
+bool AudioEngineImpl::pause(int audioID)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return false;
+    player->paused = true;
+    if (player->voice >= 0)
+        _mixer.setPaused(player->voice, true);
+    setState(audioID, AudioEngine::AudioState::PAUSED);
+    return true;
+}
+
+bool AudioEngineImpl::resume(int audioID)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return false;
+    player->paused = false;
+    if (player->voice >= 0)
+    {
+        _mixer.setPaused(player->voice, false);
+        setState(audioID, AudioEngine::AudioState::PLAYING);
+    }
+    return true;
+}
+
+bool AudioEngineImpl::stop(int audioID)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return false;
+
+    if (player->voice >= 0)
+    {
+        // The player is kept until the mixer releases its voice
+        stopVoice(*player);
+        return true;
+    }
+
+    auto it = _cache.find(player->fullPath);
+    if (it != _cache.end())
+    {
+        auto& pendingAudioIDs = it->second.pendingAudioIDs;
+        pendingAudioIDs.erase(std::remove(pendingAudioIDs.begin(), pendingAudioIDs.end(), audioID), pendingAudioIDs.end());
+    }
+    _players.erase(audioID);
+    return true;
+}
+
+void AudioEngineImpl::stopAll()
+{
+    for (auto it = _players.begin(); it != _players.end(); )
+    {
+        Player& player = it->second;
+        if (player.voice < 0)
+        {
+            it = _players.erase(it);
+            continue;
+        }
+        if (!player.stopped)
+            stopVoice(player);
+        ++it;
+    }
+    for (auto& it : _cache)
+        it.second.pendingAudioIDs.clear();
+}
+
+float AudioEngineImpl::getDuration(int audioID)
+{
+    Player* player = findPlayer(audioID);
+    if (player && player->pcm)
+        return player->pcm->getDuration();
+    if (player && player->stream)
+        return player->stream->pcm.getDuration();
+    return AudioEngine::TIME_UNKNOWN;
+}
+
+float AudioEngineImpl::getCurrentTime(int audioID)
+{
+    Player* player = findPlayer(audioID);
+    if (!player)
+        return AudioEngine::TIME_UNKNOWN;
+    if (player->voice < 0)
+        return 0.0f;
+
+    uint32_t position = _mixer.getPosition(player->voice);
+    if (player->pcm)
+        return (float)position / player->pcm->sampleRate;
+    // The decoding of a looping stream goes on from the start of the file
+    const PcmStream& stream = player->stream->pcm;
+    return (float)(stream.frameCount > 0 ? position % stream.frameCount : 0) / stream.sampleRate;
+}
+
+bool AudioEngineImpl::setCurrentTime(int audioID, float time)
+{
+    Player* player = findPlayer(audioID);
+    if (!player || (!player->stream && player->voice < 0) || time < 0.0f || time >= getDuration(audioID))
+        return false;
+
+    if (player->stream)
+    {
+        // The chunks decoded before are skipped by the mixer
+        Stream* stream = player->stream.get();
+        stream->seekFrame.store((uint32_t)(time * stream->pcm.sampleRate), std::memory_order_relaxed);
+        stream->pcm.generation.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+    _mixer.seek(player->voice, (uint32_t)(time * player->pcm->sampleRate));
+    return true;
+}
+
+void AudioEngineImpl::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
+{
+    if (Player* player = findPlayer(audioID))
+        player->finishCallback = callback;
+}
+
+void AudioEngineImpl::uncache(const std::string& filePath)
+{
+    auto it = _cache.find(FileUtils::getInstance()->fullPathForFilename(filePath));
+    if (it == _cache.end())
+        return;
+
+    // The players of the file keep its decoded audio until they stop
+    CacheEntry& entry = it->second;
+    auto preloadCallbacks = std::move(entry.preloadCallbacks);
+    if (entry.state == CacheState::READY)
+    {
+        _cacheMemorySize -= entry.pcm->samples.size() * sizeof(int16_t);
+        _lru.erase(entry.lruPosition);
+    }
+    _cache.erase(it);
+
+    for (const auto& callback : preloadCallbacks)
+        callback(false);
+}
+
+void AudioEngineImpl::uncacheAll()
+{
+    std::vector<std::string> fullPaths;
+    for (const auto& it : _cache)
+        fullPaths.push_back(it.first);
+    for (const auto& fullPath : fullPaths)
+        uncache(fullPath);
+}
+
+void AudioEngineImpl::preload(const std::string& filePath, std::function<void(bool isSuccess)> callback)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    if (fullPath.empty())
+    {
+        if (callback)
+            callback(false);
+        return;
+    }
+
+    auto it = _cache.find(fullPath);
+    if (it == _cache.end())
+    {
+        loadFile(fullPath);
+        it = _cache.find(fullPath);
+    }
+
+    CacheEntry& entry = it->second;
+    if (entry.state == CacheState::LOADING)
+    {
+        if (callback)
+            entry.preloadCallbacks.push_back(callback);
+        return;
+    }
+
+    if (entry.state == CacheState::READY)
+        touchCache(entry);
+    if (callback)
+        callback(true);
+}
+
+void AudioEngineImpl::setCacheMemoryLimit(size_t bytes)
+{
+    _cacheMemoryLimit = bytes;
+    evictCache();
+}
+
+void AudioEngineImpl::update(float dt)
+{
+    handleLoadResults();
+    retryStops();
+    handleMixerEvents();
+    fillStreams();
+}
+
+int AudioEngineImpl::renderOffline(int16_t* buffer, int frames)
+{
+    if (_output.getType() != AudioOutput::Type::OFFLINE)
+        return 0;
+    update(0.0f);
+    _mixer.render(buffer, frames);
+    update(0.0f);
+    return frames;
+}
+
+void AudioEngineImpl::runTask(const std::function<void()>& task)
+{
+    if (_output.getType() == AudioOutput::Type::OFFLINE)
+        task();
+    else
+        AudioEngine::addTask(task);
+}
+
+void AudioEngineImpl::loadFile(const std::string& fullPath)
+{
+    CacheEntry& entry = _cache[fullPath];
+    entry.state = CacheState::LOADING;
+    entry.channelCount = 0;
+    entry.sampleRate = 0;
+    entry.frameCount = 0;
+
+    auto loadQueue = _loadQueue;
+    runTask([loadQueue, fullPath]() {
+        LoadResult result;
+        result.fullPath = fullPath;
+        std::shared_ptr<AudioDecoder> decoder(AudioDecoder::createWithFile(fullPath));
+        if (decoder && (size_t)decoder->getFrameCount() * decoder->getChannelCount() * sizeof(int16_t) > STREAM_MIN_SIZE)
+        {
+            result.decoder = decoder;
+        }
+        else if (decoder)
+        {
+            result.pcm = std::make_shared<PcmBuffer>();
+            decoder->decodeToPcm(result.pcm.get());
+        }
+
+        std::lock_guard<std::mutex> lock(loadQueue->mutex);
+        loadQueue->results.push_back(std::move(result));
+    });
+}
+
+void AudioEngineImpl::handleLoadResults()
+{
+    std::vector<LoadResult> results;
+    {
+        std::lock_guard<std::mutex> lock(_loadQueue->mutex);
+        results.swap(_loadQueue->results);
+    }
+
+    for (auto& result : results)
+    {
+        // The file may have been uncached while it was loading
+        auto it = _cache.find(result.fullPath);
+        if (it == _cache.end() || it->second.state != CacheState::LOADING)
+            continue;
+
+        CacheEntry& entry = it->second;
+        bool succeed = result.pcm || result.decoder;
+        bool streamed = result.decoder != nullptr;
+        if (result.pcm)
+        {
+            entry.state = CacheState::READY;
+            entry.pcm = result.pcm;
+            _lru.push_front(result.fullPath);
+            entry.lruPosition = _lru.begin();
+            _cacheMemorySize += entry.pcm->samples.size() * sizeof(int16_t);
+        }
+        else if (result.decoder)
+        {
+            entry.state = CacheState::STREAMED;
+            entry.channelCount = result.decoder->getChannelCount();
+            entry.sampleRate = result.decoder->getSampleRate();
+            entry.frameCount = result.decoder->getFrameCount();
+        }
+
+        // The callbacks may play or uncache files, which changes the cache
+        auto pendingAudioIDs = std::move(entry.pendingAudioIDs);
+        auto preloadCallbacks = std::move(entry.preloadCallbacks);
+        if (!succeed)
+            _cache.erase(it);
+
+        for (int audioID : pendingAudioIDs)
+        {
+            auto playerIt = _players.find(audioID);
+            if (playerIt == _players.end())
+                continue;
+
+            Player& player = playerIt->second;
+            if (streamed)
+            {
+                // The decoder is reused by the first player
+                createStream(player, entry, result.decoder);
+                result.decoder = nullptr;
+                continue;
+            }
+
+            player.pcm = result.pcm;
+            if (!succeed || !startPlayer(audioID, player))
+            {
+                _players.erase(playerIt);
+                AudioEngine::remove(audioID);
+            }
+        }
+
+        for (const auto& callback : preloadCallbacks)
+            callback(succeed);
+    }
+
+    if (!results.empty())
+        evictCache();
+}
+
+void AudioEngineImpl::handleMixerEvents()
+{
+    AudioMixer::Event event;
+    while (_mixer.pollEvent(event))
+    {
+        int audioID = _voiceAudioIDs[event.voice];
+        _voiceAudioIDs[event.voice] = AudioEngine::INVALID_AUDIO_ID;
+
+        auto it = _players.find(audioID);
+        if (it == _players.end())
+            continue;
+        Player player = std::move(it->second);
+        _players.erase(it);
+
+        if (!player.stopped)
+        {
+            AudioEngine::remove(audioID);
+            if (player.finishCallback)
+                player.finishCallback(audioID, player.filePath);
+        }
+    }
+}
+
+void AudioEngineImpl::stopVoice(Player& player)
+{
+    player.stopped = true;
+    player.stopQueued = _mixer.stop(player.voice);
+}
+
+void AudioEngineImpl::retryStops()
+{
+    for (auto& it : _players)
+    {
+        Player& player = it.second;
+        if (player.stopped && !player.stopQueued)
+            player.stopQueued = _mixer.stop(player.voice);
+    }
+}
+
+void AudioEngineImpl::fillStreams()
+{
+    std::vector<int> startedAudioIDs;
+    std::vector<int> failedAudioIDs;
+    for (auto& it : _players)
+    {
+        Player& player = it.second;
+        if (!player.stream || player.stopped)
+            continue;
+
+        fillStream(player.stream);
+
+        // The player starts once its first chunk is decoded, so that it doesn't start with silence
+        if (player.voice < 0 && player.stream->pcm.chunks[0].state.load(std::memory_order_acquire) == PcmStream::READY)
+        {
+            if (startPlayer(it.first, player))
+                fillStream(player.stream);
+            else
+                failedAudioIDs.push_back(it.first);
+        }
+    }
+
+    for (int audioID : failedAudioIDs)
+    {
+        _players.erase(audioID);
+        AudioEngine::remove(audioID);
+    }
+}
+
+void AudioEngineImpl::fillStream(const std::shared_ptr<Stream>& stream)
+{
+    if (stream->filling.load(std::memory_order_acquire))
+        return;
+
+    int index = stream->nextChunk;
+    PcmStream::Chunk& chunk = stream->pcm.chunks[index];
+    if (chunk.state.load(std::memory_order_acquire) != PcmStream::EMPTY)
+        return;
+
+    chunk.state.store(PcmStream::FILLING, std::memory_order_relaxed);
+    stream->filling.store(true, std::memory_order_relaxed);
+    stream->nextChunk ^= 1;
+    runTask([stream, index]() {
+        stream->decodeChunk(index);
+    });
+}
+
+bool AudioEngineImpl::startPlayer(int audioID, Player& player)
+{
+    int voice = 0;
+    while (voice < AudioMixer::MAX_VOICES && _voiceAudioIDs[voice] != AudioEngine::INVALID_AUDIO_ID)
+        ++voice;
+    if (voice == AudioMixer::MAX_VOICES)
+        return false;
+
+    bool started = player.pcm ? _mixer.play(voice, player.pcm.get(), player.loop, player.volume)
+        : _mixer.playStream(voice, &player.stream->pcm, player.volume);
+    if (!started)
+        return false;
+
+    _voiceAudioIDs[voice] = audioID;
+    player.voice = voice;
+    if (player.paused)
+        _mixer.setPaused(voice, true);
+    AudioEngine::_audioIDInfoMap[audioID].state = player.paused ? AudioEngine::AudioState::PAUSED : AudioEngine::AudioState::PLAYING;
+    return true;
+}
+
+void AudioEngineImpl::createStream(Player& player, const CacheEntry& entry, const std::shared_ptr<AudioDecoder>& decoder)
+{
+    auto stream = std::make_shared<Stream>();
+    stream->pcm.channelCount = entry.channelCount;
+    stream->pcm.sampleRate = entry.sampleRate;
+    stream->pcm.frameCount = entry.frameCount;
+    for (auto& chunk : stream->pcm.chunks)
+        chunk.samples.resize(PcmStream::CHUNK_FRAMES * entry.channelCount);
+    stream->fullPath = player.fullPath;
+    stream->decoder = decoder;
+    stream->loop = player.loop;
+    player.stream = stream;
+
+    // The first chunk is decoded right away, the player is started by fillStreams()
+    fillStream(stream);
+}
+
+void AudioEngineImpl::touchCache(CacheEntry& entry)
+{
+    if (entry.lruPosition != _lru.begin())
+        _lru.splice(_lru.begin(), _lru, entry.lruPosition);
+}
+
+void AudioEngineImpl::evictCache()
+{
+    auto it = _lru.end();
+    while (_cacheMemorySize > _cacheMemoryLimit && it != _lru.begin())
+    {
+        --it;
+        CacheEntry& entry = _cache[*it];
+        // The files being played stay cached
+        if (entry.pcm.use_count() > 1)
+            continue;
+
+        _cacheMemorySize -= entry.pcm->samples.size() * sizeof(int16_t);
+        _cache.erase(*it);
+        it = _lru.erase(it);
+    }
+}
+
+AudioEngineImpl::Player* AudioEngineImpl::findPlayer(int audioID)
+{
+    auto it = _players.find(audioID);
+    if (it == _players.end() || it->second.stopped)
+        return nullptr;
+    return &it->second;
+}
+
+void AudioEngineImpl::setState(int audioID, AudioEngine::AudioState state)
+{
+    auto it = AudioEngine::_audioIDInfoMap.find(audioID);
+    if (it != AudioEngine::_audioIDInfoMap.end())
+        it->second.state = state;
+}
+
+#endif
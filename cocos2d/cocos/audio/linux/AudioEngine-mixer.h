@@ -0,0 +1,203 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#ifndef __AUDIO_ENGINE_MIXER_H_
+#define __AUDIO_ENGINE_MIXER_H_
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/CCRef.h"
+#include "audio/include/AudioEngine.h"
+#include "audio/linux/AudioDecoder-linux.h"
+#include "audio/linux/AudioMixer-linux.h"
+#include "audio/linux/AudioOutput-linux.h"
+
+NS_CC_BEGIN
+    namespace experimental{
+#define MAX_AUDIOINSTANCES AudioMixer::MAX_VOICES
+
+/**
+ * AudioEngine implementation for Linux mixing decoded audio in software, used by default, FMOD is
+ * used instead when the engine is configured with USE_FMOD_AUDIO on.
+ *
+ * The files are decoded by the worker threads of AudioEngine, never on the game thread. Short files
+ * are decoded whole into a cache shared by their players, so that playing a preloaded effect only
+ * posts a command to the mixer thread. The cache is limited in memory, the least recently played
+ * files are uncached first. Long files aren't cached, each player streams its file in chunks.
+ */
+class CC_DLL AudioEngineImpl : public cocos2d::Ref
+{
+public:
+    AudioEngineImpl();
+    ~AudioEngineImpl();
+
+    bool init();
+    int play2d(const std::string &fileFullPath ,bool loop ,float volume);
+    void setVolume(int audioID,float volume);
+    void setLoop(int audioID, bool loop);
+    bool pause(int audioID);
+    bool resume(int audioID);
+    bool stop(int audioID);
+    void stopAll();
+    float getDuration(int audioID);
+    float getCurrentTime(int audioID);
+    bool setCurrentTime(int audioID, float time);
+    void setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback);
+
+    void uncache(const std::string& filePath);
+    void uncacheAll();
+
+    void preload(const std::string& filePath, std::function<void(bool isSuccess)> callback);
+
+    void update(float dt);
+
+    /**
+     * Sets the memory used by the cached files, 32 MB by default. Beyond it, the least recently
+     * played files which aren't playing are uncached.
+     */
+    void setCacheMemoryLimit(size_t bytes);
+    size_t getCacheMemorySize() const { return _cacheMemorySize; }
+
+    /**
+     * Selects the output used by the next initialized engine, AudioOutput::Type::AUTO by default.
+     * With AudioOutput::Type::OFFLINE nothing is played until renderOffline() is called, so the
+     * audio doesn't depend on the wall clock. The files are then decoded on the calling thread.
+     */
+    static void setOutputType(AudioOutput::Type type);
+
+    /** Gets the initialized engine, nullptr if there's none. */
+    static AudioEngineImpl* getInstance();
+
+    /**
+     * Renders the next frames with the offline output, and handles the voices that stopped.
+     * @param buffer Interleaved stereo samples, frames * AudioMixer::CHANNEL_COUNT of them.
+     * @return The number of rendered frames, 0 if the output isn't the offline one.
+     */
+    int renderOffline(int16_t* buffer, int frames);
+
+    AudioOutput::Type getOutputType() const { return _output.getType(); }
+    AudioMixer::Stats getMixerStats() const { return _mixer.getStats(); }
+
+private:
+    struct Stream;
+
+    enum class CacheState
+    {
+        LOADING,
+        READY,
+        /// Too long to be cached, it's streamed
+        STREAMED
+    };
+
+    struct CacheEntry
+    {
+        CacheState state;
+        std::shared_ptr<PcmBuffer> pcm;
+        std::list<std::string>::iterator lruPosition;
+        /// Format of the streamed files
+        int channelCount;
+        int sampleRate;
+        uint32_t frameCount;
+        /// Players and preload callbacks waiting for the file to be loaded
+        std::vector<int> pendingAudioIDs;
+        std::vector<std::function<void(bool)>> preloadCallbacks;
+    };
+
+    /// Result of a worker thread loading a file
+    struct LoadResult
+    {
+        std::string fullPath;
+        std::shared_ptr<PcmBuffer> pcm;
+        /// Decoder of a file to stream, reused by its first player
+        std::shared_ptr<AudioDecoder> decoder;
+    };
+
+    struct LoadQueue
+    {
+        std::mutex mutex;
+        std::vector<LoadResult> results;
+    };
+
+    struct Player
+    {
+        /// Voice of the mixer, -1 until the file is loaded
+        int voice;
+        std::shared_ptr<PcmBuffer> pcm;
+        std::shared_ptr<Stream> stream;
+        std::string filePath;
+        std::string fullPath;
+        std::function<void (int, const std::string &)> finishCallback;
+        float volume;
+        bool loop;
+        bool paused;
+        /// Stopped by AudioEngine, which removes it by itself
+        bool stopped;
+        /// The mixer accepted the stop command, it's tried again by update() if the queue was full
+        bool stopQueued;
+    };
+
+    void runTask(const std::function<void()>& task);
+    void loadFile(const std::string& fullPath);
+    void handleLoadResults();
+    void handleMixerEvents();
+    void stopVoice(Player& player);
+    void retryStops();
+    void fillStreams();
+    void fillStream(const std::shared_ptr<Stream>& stream);
+    bool startPlayer(int audioID, Player& player);
+    void createStream(Player& player, const CacheEntry& entry, const std::shared_ptr<AudioDecoder>& decoder);
+    void touchCache(CacheEntry& entry);
+    void evictCache();
+    Player* findPlayer(int audioID);
+    void setState(int audioID, AudioEngine::AudioState state);
+
+    AudioMixer _mixer;
+    AudioOutput _output;
+
+    /// Loaded files by full path, and the cached ones from the most to the least recently played
+    std::unordered_map<std::string, CacheEntry> _cache;
+    std::list<std::string> _lru;
+    size_t _cacheMemorySize;
+    size_t _cacheMemoryLimit;
+    std::shared_ptr<LoadQueue> _loadQueue;
+
+    std::unordered_map<int, Player> _players;
+    /// Audio ID playing on each voice of the mixer, AudioEngine::INVALID_AUDIO_ID if it's free
+    int _voiceAudioIDs[AudioMixer::MAX_VOICES];
+    int _currentAudioID;
+    bool _scheduled;
+};
+}
+NS_CC_END
+#endif // __AUDIO_ENGINE_MIXER_H_
+#endif
@@ -0,0 +1,311 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "audio/linux/AudioMixer-linux.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace {
+    const uint64_t UNIT_STEP = (uint64_t)1 << 32;
+    const float SAMPLE_SCALE = 1.0f / 32768.0f;
+
+    /**
+     * Mixes frames of samples, from position until their end.
+     * @param wrap Whether the first frame follows the last one, for the interpolation.
+     * @return The number of mixed frames.
+     */
+    int mixSamples(const int16_t* samples, int channelCount, uint32_t frameCount, bool wrap,
+                   uint64_t& position, uint64_t step, float gain, float* mix, int frames)
+    {
+        const int rightOffset = channelCount > 1 ? 1 : 0;
+        const uint64_t end = ((uint64_t)frameCount) << 32;
+
+        int i = 0;
+        for (; i < frames && position < end; ++i)
+        {
+            uint32_t frame = (uint32_t)(position >> 32);
+            const int16_t* src = samples + frame * channelCount;
+            float left = src[0];
+            float right = src[rightOffset];
+            if (step != UNIT_STEP)
+            {
+                // Linear interpolation with the next frame
+                uint32_t nextFrame = frame + 1 < frameCount ? frame + 1 : (wrap ? 0 : frame);
+                const int16_t* next = samples + nextFrame * channelCount;
+                float fraction = (float)(uint32_t)position * (1.0f / 4294967296.0f);
+                left += (next[0] - left) * fraction;
+                right += (next[rightOffset] - right) * fraction;
+            }
+            mix[i * 2] += left * gain;
+            mix[i * 2 + 1] += right * gain;
+            position += step;
+        }
+        return i;
+    }
+}
+
+AudioMixer::AudioMixer(int sampleRate)
+: _sampleRate(sampleRate)
+, _mixBuffer(MAX_BLOCK_FRAMES * CHANNEL_COUNT)
+, _renderedFrames(0)
+, _renderCount(0)
+, _renderTime(0)
+, _maxRenderTime(0)
+, _droppedCommands(0)
+, _underruns(0)
+{
+    for (int i = 0; i < MAX_VOICES; ++i)
+        _positions[i].store(0, std::memory_order_relaxed);
+}
+
+bool AudioMixer::play(int voice, const PcmBuffer* pcm, bool loop, float volume)
+{
+    Command command = { CommandType::PLAY, loop, voice, pcm, nullptr, volume, 0 };
+    _positions[voice].store(0, std::memory_order_relaxed);
+    return _commands.push(command);
+}
+
+bool AudioMixer::playStream(int voice, PcmStream* stream, float volume)
+{
+    Command command = { CommandType::PLAY_STREAM, false, voice, nullptr, stream, volume, 0 };
+    _positions[voice].store(0, std::memory_order_relaxed);
+    return _commands.push(command);
+}
+
+void AudioMixer::setVolume(int voice, float volume)
+{
+    postCommand({ CommandType::SET_VOLUME, false, voice, nullptr, nullptr, volume, 0 });
+}
+
+void AudioMixer::setLoop(int voice, bool loop)
+{
+    postCommand({ CommandType::SET_LOOP, loop, voice, nullptr, nullptr, 0.0f, 0 });
+}
+
+void AudioMixer::setPaused(int voice, bool paused)
+{
+    postCommand({ CommandType::SET_PAUSED, paused, voice, nullptr, nullptr, 0.0f, 0 });
+}
+
+void AudioMixer::seek(int voice, uint32_t frame)
+{
+    postCommand({ CommandType::SEEK, false, voice, nullptr, nullptr, 0.0f, frame });
+}
+
+bool AudioMixer::stop(int voice)
+{
+    Command command = { CommandType::STOP, false, voice, nullptr, nullptr, 0.0f, 0 };
+    if (_commands.push(command))
+        return true;
+    _droppedCommands.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AudioMixer::postCommand(const Command& command)
+{
+    if (!_commands.push(command))
+        _droppedCommands.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioMixer::Stats AudioMixer::getStats() const
+{
+    Stats stats;
+    stats.renderedFrames = _renderedFrames.load(std::memory_order_relaxed);
+    stats.renderCount = _renderCount.load(std::memory_order_relaxed);
+    stats.renderTime = _renderTime.load(std::memory_order_relaxed);
+    stats.maxRenderTime = _maxRenderTime.load(std::memory_order_relaxed);
+    stats.droppedCommands = _droppedCommands.load(std::memory_order_relaxed);
+    stats.underruns = _underruns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioMixer::applyCommand(const Command& command)
+{
+    Voice& voice = _voices[command.voice];
+    if (command.type == CommandType::PLAY || command.type == CommandType::PLAY_STREAM)
+    {
+        int sampleRate = command.pcm ? command.pcm->sampleRate : command.stream->sampleRate;
+        voice.pcm = command.pcm;
+        voice.stream = command.stream;
+        voice.chunk = 0;
+        voice.startFrame = 0;
+        voice.position = 0;
+        voice.step = (((uint64_t)sampleRate) << 32) / _sampleRate;
+        voice.volume = command.volume;
+        voice.loop = command.flag;
+        voice.paused = false;
+        if (command.pcm && command.pcm->frameCount == 0)
+            retireVoice(command.voice, true);
+        return;
+    }
+
+    // The voice may have reached its end before the command was applied
+    if (!voice.isActive())
+        return;
+
+    switch (command.type)
+    {
+        case CommandType::SET_VOLUME:
+            voice.volume = command.volume;
+            break;
+        case CommandType::SET_LOOP:
+            voice.loop = command.flag;
+            break;
+        case CommandType::SET_PAUSED:
+            voice.paused = command.flag;
+            break;
+        case CommandType::SEEK:
+            // Streams are seeked by the decoding side
+            if (voice.pcm && command.frame < voice.pcm->frameCount)
+                voice.position = ((uint64_t)command.frame) << 32;
+            break;
+        case CommandType::STOP:
+            retireVoice(command.voice, false);
+            break;
+        default:
+            break;
+    }
+}
+
+void AudioMixer::retireVoice(int voice, bool completed)
+{
+    _voices[voice].pcm = nullptr;
+    _voices[voice].stream = nullptr;
+    // The game thread frees a voice only after receiving its event, so there's always room for it
+    _events.push({ voice, completed });
+}
+
+void AudioMixer::render(int16_t* out, int frames)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    Command command;
+    while (_commands.pop(command))
+        applyCommand(command);
+
+    float* mix = _mixBuffer.data();
+    int renderedFrames = 0;
+    while (renderedFrames < frames)
+    {
+        int blockFrames = std::min(frames - renderedFrames, (int)MAX_BLOCK_FRAMES);
+        memset(mix, 0, blockFrames * CHANNEL_COUNT * sizeof(float));
+
+        for (int i = 0; i < MAX_VOICES; ++i)
+        {
+            Voice& voice = _voices[i];
+            if (!voice.isActive() || voice.paused)
+                continue;
+            if (!(voice.pcm ? mixVoice(voice, mix, blockFrames) : mixStream(voice, mix, blockFrames)))
+                retireVoice(i, true);
+        }
+
+        int16_t* dst = out + renderedFrames * CHANNEL_COUNT;
+        for (int i = 0; i < blockFrames * CHANNEL_COUNT; ++i)
+        {
+            float sample = mix[i];
+            sample = sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+            dst[i] = (int16_t)(sample * 32767.0f);
+        }
+        renderedFrames += blockFrames;
+    }
+
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        const Voice& voice = _voices[i];
+        if (voice.isActive())
+            _positions[i].store(voice.startFrame + (uint32_t)(voice.position >> 32), std::memory_order_relaxed);
+    }
+
+    uint64_t renderTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    _renderedFrames.fetch_add(frames, std::memory_order_relaxed);
+    _renderCount.fetch_add(1, std::memory_order_relaxed);
+    _renderTime.fetch_add(renderTime, std::memory_order_relaxed);
+    if (renderTime > _maxRenderTime.load(std::memory_order_relaxed))
+        _maxRenderTime.store(renderTime, std::memory_order_relaxed);
+}
+
+bool AudioMixer::mixVoice(Voice& voice, float* mix, int frames)
+{
+    const PcmBuffer* pcm = voice.pcm;
+    const uint64_t end = ((uint64_t)pcm->frameCount) << 32;
+    const float gain = voice.volume * SAMPLE_SCALE;
+
+    int mixedFrames = 0;
+    while (mixedFrames < frames)
+    {
+        if (voice.position >= end)
+        {
+            if (!voice.loop)
+                return false;
+            voice.position %= end;
+        }
+        mixedFrames += mixSamples(pcm->samples.data(), pcm->channelCount, pcm->frameCount, voice.loop,
+                                  voice.position, voice.step, gain, mix + mixedFrames * CHANNEL_COUNT, frames - mixedFrames);
+    }
+    return true;
+}
+
+bool AudioMixer::mixStream(Voice& voice, float* mix, int frames)
+{
+    PcmStream* stream = voice.stream;
+    const float gain = voice.volume * SAMPLE_SCALE;
+
+    int mixedFrames = 0;
+    while (mixedFrames < frames)
+    {
+        PcmStream::Chunk& chunk = stream->chunks[voice.chunk];
+        if (chunk.state.load(std::memory_order_acquire) != PcmStream::READY)
+        {
+            // The rest of the block stays silent until the chunk is decoded
+            _underruns.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool stale = chunk.generation != stream->generation.load(std::memory_order_relaxed);
+        uint64_t end = ((uint64_t)chunk.frameCount) << 32;
+        if (stale || voice.position >= end)
+        {
+            bool last = chunk.last && !stale;
+            voice.position = stale ? 0 : voice.position - end;
+            voice.chunk ^= 1;
+            chunk.state.store(PcmStream::EMPTY, std::memory_order_release);
+            if (last)
+                return false;
+            continue;
+        }
+
+        voice.startFrame = chunk.startFrame;
+        mixedFrames += mixSamples(chunk.samples.data(), stream->channelCount, chunk.frameCount, false,
+                                  voice.position, voice.step, gain, mix + mixedFrames * CHANNEL_COUNT, frames - mixedFrames);
+    }
+    return true;
+}
+
+#endif
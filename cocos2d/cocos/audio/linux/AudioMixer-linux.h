@@ -0,0 +1,274 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#ifndef __AUDIO_MIXER_LINUX_H_
+#define __AUDIO_MIXER_LINUX_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+namespace experimental{
+
+/**
+ * Decoded audio, 16-bit samples with the channels interleaved.
+ * It isn't modified once decoded, so the voices playing it can read it without locking.
+ */
+struct PcmBuffer
+{
+    std::vector<int16_t> samples;
+    int channelCount = 0;
+    int sampleRate = 0;
+    uint32_t frameCount = 0;
+
+    float getDuration() const { return sampleRate > 0 ? (float)frameCount / sampleRate : 0.0f; }
+};
+
+/**
+ * Decoded audio of a long file, given to the mixer in chunks while it's played.
+ *
+ * The two chunks are used in turn, the mixer plays one while a worker thread decodes the next one
+ * into the other. The state of a chunk tells which thread owns it: the decoding side fills the EMPTY
+ * chunks, and the mixer plays the READY ones and sets them back to EMPTY.
+ */
+struct PcmStream
+{
+    static const uint32_t CHUNK_FRAMES = 32768;
+
+    enum ChunkState
+    {
+        EMPTY,
+        FILLING,
+        READY
+    };
+
+    struct Chunk
+    {
+        std::vector<int16_t> samples;
+        uint32_t frameCount = 0;
+        /// Frame of the file the chunk starts at
+        uint32_t startFrame = 0;
+        /// Whether the file ends with this chunk
+        bool last = false;
+        /// Value of PcmStream::generation when the chunk was decoded
+        uint32_t generation = 0;
+        std::atomic<int> state{EMPTY};
+    };
+
+    int channelCount = 0;
+    int sampleRate = 0;
+    uint32_t frameCount = 0;
+    Chunk chunks[2];
+    /// Incremented when seeking, the mixer skips the chunks decoded before
+    std::atomic<uint32_t> generation{0};
+
+    float getDuration() const { return sampleRate > 0 ? (float)frameCount / sampleRate : 0.0f; }
+};
+
+/**
+ * Fixed capacity queue with one producer thread and one consumer thread, which never locks
+ * or allocates memory.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    /** Called by the producer, returns false if the queue is full. */
+    bool push(const T& item)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= Capacity)
+            return false;
+        _items[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Called by the consumer, returns false if the queue is empty. */
+    bool pop(T& item)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        item = _items[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+/**
+ * Software mixer producing 16-bit stereo samples.
+ *
+ * The game thread controls the voices by posting commands, which the audio thread applies at the
+ * start of the next render() call, so neither thread waits for the other. The game thread chooses
+ * the voice to play on, and may reuse it only once the mixer has reported through pollEvent() that
+ * the voice stopped. The PcmBuffer or PcmStream of a voice must be kept alive until then.
+ */
+class AudioMixer
+{
+public:
+    static const int MAX_VOICES = 32;
+    static const int CHANNEL_COUNT = 2;
+
+    struct Event
+    {
+        int voice;
+        /// True if the voice reached its end, false if it was stopped
+        bool completed;
+    };
+
+    struct Stats
+    {
+        uint64_t renderedFrames;
+        uint64_t renderCount;
+        /// Time spent in render(), in nanoseconds
+        uint64_t renderTime;
+        uint64_t maxRenderTime;
+        unsigned int droppedCommands;
+        /// Blocks rendered with silence because the next chunk of a stream wasn't decoded in time
+        unsigned int underruns;
+    };
+
+    explicit AudioMixer(int sampleRate);
+
+    int getSampleRate() const { return _sampleRate; }
+
+    /**
+     * Game thread. Starts playing pcm on a stopped voice.
+     * @return False if the command queue is full.
+     */
+    bool play(int voice, const PcmBuffer* pcm, bool loop, float volume);
+    /**
+     * Game thread. Starts playing a stream on a stopped voice, looping it is up to the decoding side.
+     * @return False if the command queue is full.
+     */
+    bool playStream(int voice, PcmStream* stream, float volume);
+    void setVolume(int voice, float volume);
+    void setLoop(int voice, bool loop);
+    void setPaused(int voice, bool paused);
+    void seek(int voice, uint32_t frame);
+    /**
+     * Game thread. Stops a voice, which is reported by pollEvent() once it's released.
+     * @return False if the command queue is full, stopping it must be tried again.
+     */
+    bool stop(int voice);
+
+    /** Game thread. Gets the frame of its file a voice reached at the last render() call. */
+    uint32_t getPosition(int voice) const { return _positions[voice].load(std::memory_order_relaxed); }
+
+    /** Game thread. Gets the next voice that stopped, returns false if there's none. */
+    bool pollEvent(Event& event) { return _events.pop(event); }
+
+    Stats getStats() const;
+
+    /**
+     * Audio thread. Applies the posted commands and mixes the next frames of the playing voices.
+     * @param out Interleaved stereo samples, frames * CHANNEL_COUNT of them.
+     */
+    void render(int16_t* out, int frames);
+
+private:
+    enum class CommandType : uint8_t
+    {
+        PLAY,
+        PLAY_STREAM,
+        SET_VOLUME,
+        SET_LOOP,
+        SET_PAUSED,
+        SEEK,
+        STOP
+    };
+
+    struct Command
+    {
+        CommandType type;
+        bool flag;
+        int voice;
+        const PcmBuffer* pcm;
+        PcmStream* stream;
+        float volume;
+        uint32_t frame;
+    };
+
+    struct Voice
+    {
+        const PcmBuffer* pcm = nullptr;
+        PcmStream* stream = nullptr;
+        /// Chunk of the stream played
+        int chunk = 0;
+        /// Frame of the file the position is relative to
+        uint32_t startFrame = 0;
+        /// Position and step in frames of pcm or the chunk, as 32.32 fixed point numbers
+        uint64_t position = 0;
+        uint64_t step = 0;
+        float volume = 1.0f;
+        bool loop = false;
+        bool paused = false;
+
+        bool isActive() const { return pcm || stream; }
+    };
+
+    void postCommand(const Command& command);
+    void applyCommand(const Command& command);
+    void retireVoice(int voice, bool completed);
+    /// Mixes one block of frames of a voice, returns false once it reaches its end.
+    bool mixVoice(Voice& voice, float* mix, int frames);
+    bool mixStream(Voice& voice, float* mix, int frames);
+
+    static const int MAX_BLOCK_FRAMES = 1024;
+
+    int _sampleRate;
+    SpscQueue<Command, 1024> _commands;
+    SpscQueue<Event, MAX_VOICES * 2> _events;
+    Voice _voices[MAX_VOICES];
+    std::atomic<uint32_t> _positions[MAX_VOICES];
+    std::vector<float> _mixBuffer;
+
+    std::atomic<uint64_t> _renderedFrames;
+    std::atomic<uint64_t> _renderCount;
+    std::atomic<uint64_t> _renderTime;
+    std::atomic<uint64_t> _maxRenderTime;
+    std::atomic<unsigned int> _droppedCommands;
+    std::atomic<unsigned int> _underruns;
+};
+
+}
+NS_CC_END
+
+#endif // __AUDIO_MIXER_LINUX_H_
+#endif
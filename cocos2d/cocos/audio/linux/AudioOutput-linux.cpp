@@ -0,0 +1,188 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "audio/linux/AudioOutput-linux.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <chrono>
+#include <dlfcn.h>
+#include <vector>
+
+#include "audio/linux/AudioMixer-linux.h"
+#include "base/CCConsole.h"
+
+using namespace cocos2d;
+using namespace cocos2d::experimental;
+
+namespace {
+    // Values of the ALSA enums used, they are part of its ABI
+    const int ALSA_STREAM_PLAYBACK = 0;
+    const int ALSA_FORMAT_S16_LE = 2;
+    const int ALSA_ACCESS_RW_INTERLEAVED = 3;
+    const int ALSA_PERIODS = 4;
+
+    typedef int (*AlsaOpenFunc)(void** pcm, const char* name, int stream, int mode);
+    typedef int (*AlsaSetParamsFunc)(void* pcm, int format, int access, unsigned int channels,
+                                     unsigned int rate, int softResample, unsigned int latency);
+}
+
+AudioOutput::AudioOutput(AudioMixer* mixer)
+: _mixer(mixer)
+, _type(Type::OFFLINE)
+, _periodFrames(0)
+, _running(false)
+, _alsaLibrary(nullptr)
+, _alsaPcm(nullptr)
+, _alsaWrite(nullptr)
+, _alsaRecover(nullptr)
+, _alsaClose(nullptr)
+{
+}
+
+AudioOutput::~AudioOutput()
+{
+    stop();
+}
+
+bool AudioOutput::start(Type type, int periodFrames)
+{
+    stop();
+    _periodFrames = periodFrames;
+
+    if (type == Type::AUTO || type == Type::ALSA)
+    {
+        if (openAlsa(periodFrames))
+        {
+            _type = Type::ALSA;
+            _running = true;
+            _thread = std::thread(&AudioOutput::alsaLoop, this);
+            return true;
+        }
+        if (type == Type::ALSA)
+            return false;
+        log("AudioOutput: no sound device, the audio is discarded");
+        type = Type::NULL_SINK;
+    }
+
+    _type = type;
+    if (type == Type::NULL_SINK)
+    {
+        _running = true;
+        _thread = std::thread(&AudioOutput::nullSinkLoop, this);
+    }
+    return true;
+}
+
+void AudioOutput::stop()
+{
+    _running = false;
+    if (_thread.joinable())
+        _thread.join();
+    closeAlsa();
+}
+
+bool AudioOutput::openAlsa(int periodFrames)
+{
+    _alsaLibrary = dlopen("libasound.so.2", RTLD_NOW | RTLD_LOCAL);
+    if (!_alsaLibrary)
+        return false;
+
+    auto alsaOpen = (AlsaOpenFunc)dlsym(_alsaLibrary, "snd_pcm_open");
+    auto alsaSetParams = (AlsaSetParamsFunc)dlsym(_alsaLibrary, "snd_pcm_set_params");
+    _alsaWrite = (long (*)(void*, const void*, unsigned long))dlsym(_alsaLibrary, "snd_pcm_writei");
+    _alsaRecover = (int (*)(void*, int, int))dlsym(_alsaLibrary, "snd_pcm_recover");
+    _alsaClose = (int (*)(void*))dlsym(_alsaLibrary, "snd_pcm_close");
+    if (!alsaOpen || !alsaSetParams || !_alsaWrite || !_alsaRecover || !_alsaClose
+        || alsaOpen(&_alsaPcm, "default", ALSA_STREAM_PLAYBACK, 0) < 0)
+    {
+        _alsaPcm = nullptr;
+        closeAlsa();
+        return false;
+    }
+
+    unsigned int latency = (unsigned int)((int64_t)periodFrames * ALSA_PERIODS * 1000000 / _mixer->getSampleRate());
+    if (alsaSetParams(_alsaPcm, ALSA_FORMAT_S16_LE, ALSA_ACCESS_RW_INTERLEAVED, AudioMixer::CHANNEL_COUNT,
+                      _mixer->getSampleRate(), 1, latency) < 0)
+    {
+        closeAlsa();
+        return false;
+    }
+    return true;
+}
+
+void AudioOutput::closeAlsa()
+{
+    if (_alsaPcm)
+    {
+        _alsaClose(_alsaPcm);
+        _alsaPcm = nullptr;
+    }
+    if (_alsaLibrary)
+    {
+        dlclose(_alsaLibrary);
+        _alsaLibrary = nullptr;
+    }
+}
+
+void AudioOutput::alsaLoop()
+{
+    std::vector<int16_t> buffer(_periodFrames * AudioMixer::CHANNEL_COUNT);
+    while (_running)
+    {
+        _mixer->render(buffer.data(), _periodFrames);
+
+        // snd_pcm_writei() blocks until there's room in the device buffer, which paces the loop
+        int offset = 0;
+        while (offset < _periodFrames && _running)
+        {
+            long written = _alsaWrite(_alsaPcm, buffer.data() + offset * AudioMixer::CHANNEL_COUNT, _periodFrames - offset);
+            if (written < 0)
+            {
+                if (_alsaRecover(_alsaPcm, (int)written, 1) < 0)
+                {
+                    log("AudioOutput: ALSA error %ld, the audio is discarded", written);
+                    nullSinkLoop();
+                    return;
+                }
+                continue;
+            }
+            offset += (int)written;
+        }
+    }
+}
+
+void AudioOutput::nullSinkLoop()
+{
+    std::vector<int16_t> buffer(_periodFrames * AudioMixer::CHANNEL_COUNT);
+    auto period = std::chrono::microseconds((int64_t)_periodFrames * 1000000 / _mixer->getSampleRate());
+    auto deadline = std::chrono::steady_clock::now();
+    while (_running)
+    {
+        _mixer->render(buffer.data(), _periodFrames);
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+#endif
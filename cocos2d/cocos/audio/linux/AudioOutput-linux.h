@@ -0,0 +1,97 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "platform/CCPlatformConfig.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#ifndef __AUDIO_OUTPUT_LINUX_H_
+#define __AUDIO_OUTPUT_LINUX_H_
+
+#include <atomic>
+#include <thread>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+namespace experimental{
+
+class AudioMixer;
+
+/**
+ * Thread rendering an AudioMixer to the sound device.
+ *
+ * ALSA is loaded at runtime, so that the engine neither links nor needs it. Without a sound device
+ * the frames are rendered at the same pace and discarded. The offline output starts no thread,
+ * the frames are rendered only when requested, see AudioEngineImpl::renderOffline().
+ */
+class AudioOutput
+{
+public:
+    enum class Type
+    {
+        /// ALSA, or NULL_SINK if there's no sound device
+        AUTO,
+        ALSA,
+        NULL_SINK,
+        OFFLINE
+    };
+
+    explicit AudioOutput(AudioMixer* mixer);
+    ~AudioOutput();
+
+    /**
+     * Opens the output and starts rendering.
+     * @param periodFrames Frames rendered at once, the latency is about 4 periods with ALSA.
+     * @return False if the requested output can't be opened.
+     */
+    bool start(Type type, int periodFrames);
+    void stop();
+
+    /** Gets the opened output, it's never AUTO. */
+    Type getType() const { return _type; }
+
+private:
+    bool openAlsa(int periodFrames);
+    void closeAlsa();
+    void alsaLoop();
+    void nullSinkLoop();
+
+    AudioMixer* _mixer;
+    Type _type;
+    int _periodFrames;
+    std::thread _thread;
+    std::atomic<bool> _running;
+
+    void* _alsaLibrary;
+    void* _alsaPcm;
+    long (*_alsaWrite)(void* pcm, const void* buffer, unsigned long frames);
+    int (*_alsaRecover)(void* pcm, int error, int silent);
+    int (*_alsaClose)(void* pcm);
+};
+
+}
+NS_CC_END
+
+#endif // __AUDIO_OUTPUT_LINUX_H_
+#endif
@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 
 NS_CC_BEGIN
 
@@ -53,4 +54,86 @@ AsyncTaskPool::~AsyncTaskPool()
 {
 }
 
+AsyncTaskPool::TaskQueue::TaskQueue()
+: _running(false)
+, _stop(false)
+{
+}
+
+AsyncTaskPool::TaskQueue::~TaskQueue()
+{
+    std::unique_lock<std::mutex> lock(_queueMutex);
+    _stop = true;
+    while (_tasks.size())
+        _tasks.pop();
+
+    // wait for the task being performed
+    _condition.wait(lock, [this]{ return !_running; });
+}
+
+void AsyncTaskPool::TaskQueue::clear()
+{
+    std::unique_lock<std::mutex> lock(_queueMutex);
+    while (_tasks.size())
+        _tasks.pop();
+}
+
+void AsyncTaskPool::TaskQueue::enqueue(TaskCallBack callback, void* callbackParam, std::function<void()> task)
+{
+    AsyncTask asyncTask;
+    asyncTask.task = std::move(task);
+    asyncTask.callback = std::move(callback);
+    asyncTask.callbackParam = callbackParam;
+
+    bool start = false;
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        
+        // don't allow enqueueing after stopping the pool
+        if (_stop)
+        {
+            CC_ASSERT(0 && "already stop");
+            return;
+        }
+        
+        _tasks.push(std::move(asyncTask));
+        if (!_running)
+        {
+            _running = true;
+            start = true;
+        }
+    }
+
+    if (start)
+        runNext();
+}
+
+void AsyncTaskPool::TaskQueue::runNext()
+{
+    AsyncTask asyncTask;
+    {
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        if (_stop || _tasks.empty())
+        {
+            _running = false;
+            _condition.notify_all();
+            return;
+        }
+        asyncTask = std::move(_tasks.front());
+        _tasks.pop();
+    }
+
+    auto jobSystem = JobSystem::getInstance();
+    Job* job = jobSystem->createJob(asyncTask.task);
+    jobSystem->setMainThreadCompletion(job, std::bind(asyncTask.callback, asyncTask.callbackParam));
+
+    // the next task starts once this one finished, so the callbacks keep the enqueueing order
+    Job* next = jobSystem->createJob([this]{ runNext(); });
+    jobSystem->addDependency(next, job);
+    jobSystem->run(next);
+    jobSystem->run(job);
+    next->release();
+    job->release();
+}
+
 NS_CC_END
@@ -49,6 +49,7 @@ NS_CC_BEGIN
 /**
  * @class AsyncTaskPool
  * @brief This class allows to perform background operations without having to manipulate threads.
+ * The tasks run on the worker threads of the JobSystem.
  * @js NA
  */
 class CC_DLL AsyncTaskPool
@@ -87,7 +88,7 @@ public:
     /**
      * Enqueue a asynchronous task.
      *
-     * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+     * @param type task type is io task, network task or others, the tasks of a type are performed one after the other.
      * @param callback callback when the task is finished. The callback is called in the main thread instead of task thread.
      * @param callbackParam parameter used by the callback.
      * @param task: task can be lambda function to be performed off thread.
@@ -98,7 +99,7 @@ public:
     /**
     * Enqueue a asynchronous task.
     *
-    * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+    * @param type task type is io task, network task or others, the tasks of a type are performed one after the other.
     * @param task: task can be lambda function to be performed off thread.
     * @lua NA
     */
@@ -110,117 +111,50 @@ CC_CONSTRUCTOR_ACCESS:
     
 protected:
     
-    // thread tasks internally used
-    class ThreadTasks {
-        struct AsyncTaskCallBack
+    // serial task queue internally used, the tasks run on the JobSystem one after the other
+    class TaskQueue {
+        struct AsyncTask
         {
+            std::function<void()> task;
             TaskCallBack          callback;
             void*                 callbackParam;
         };
     public:
-        ThreadTasks()
-        : _stop(false)
-        {
-            _thread = std::thread(
-                                  [this]
-                                  {
-                                      for(;;)
-                                      {
-                                          std::function<void()> task;
-                                          AsyncTaskCallBack callback;
-                                          {
-                                              std::unique_lock<std::mutex> lock(this->_queueMutex);
-                                              this->_condition.wait(lock,
-                                                                    [this]{ return this->_stop || !this->_tasks.empty(); });
-                                              if(this->_stop && this->_tasks.empty())
-                                                  return;
-                                              task = std::move(this->_tasks.front());
-                                              callback = std::move(this->_taskCallBacks.front());
-                                              this->_tasks.pop();
-                                              this->_taskCallBacks.pop();
-                                          }
-                                          
-                                          task();
-                                          Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(callback.callback, callback.callbackParam));
-                                      }
-                                  }
-                                  );
-        }
-        ~ThreadTasks()
-        {
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                _stop = true;
-                
-                while(_tasks.size())
-                    _tasks.pop();
-                while (_taskCallBacks.size())
-                    _taskCallBacks.pop();
-            }
-            _condition.notify_all();
-            _thread.join();
-        }
-        void clear()
-        {
-            std::unique_lock<std::mutex> lock(_queueMutex);
-            while(_tasks.size())
-                _tasks.pop();
-            while (_taskCallBacks.size())
-                _taskCallBacks.pop();
-        }
-
-        void enqueue(TaskCallBack callback, void* callbackParam, std::function<void()> task)
-        {
-            AsyncTaskCallBack taskCallBack;
-            taskCallBack.callback = std::move(callback);
-            taskCallBack.callbackParam = callbackParam;
-
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                
-                // don't allow enqueueing after stopping the pool
-                if(_stop)
-                {
-                    CC_ASSERT(0 && "already stop");
-                    return;
-                }
-                
-                _tasks.push(std::move(task));
-                _taskCallBacks.push(std::move(taskCallBack));
-            }
-            _condition.notify_one();
-        }
+        TaskQueue();
+        ~TaskQueue();
+        void clear();
+        void enqueue(TaskCallBack callback, void* callbackParam, std::function<void()> task);
     private:
-        
-        // need to keep track of thread so we can join them
-        std::thread _thread;
+        void runNext();
+
         // the task queue
-        std::queue< std::function<void()> > _tasks;
-        std::queue<AsyncTaskCallBack> _taskCallBacks;
-        
+        std::queue<AsyncTask> _tasks;
+
         // synchronization
         std::mutex _queueMutex;
         std::condition_variable _condition;
+        // whether a job of the queue is scheduled or running
+        bool _running;
         bool _stop;
     };
     
     //tasks
-    ThreadTasks _threadTasks[int(TaskType::TASK_MAX_TYPE)];
+    TaskQueue _taskQueues[int(TaskType::TASK_MAX_TYPE)];
     
     static AsyncTaskPool* s_asyncTaskPool;
 };
 
 inline void AsyncTaskPool::stopTasks(TaskType type)
 {
-    auto& threadTask = _threadTasks[(int)type];
-    threadTask.clear();
+    auto& taskQueue = _taskQueues[(int)type];
+    taskQueue.clear();
 }
 
 inline void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, TaskCallBack callback, void* callbackParam, std::function<void()> task)
 {
-    auto& threadTask = _threadTasks[(int)type];
+    auto& taskQueue = _taskQueues[(int)type];
     
-    threadTask.enqueue(std::move(callback), callbackParam, std::move(task));
+    taskQueue.enqueue(std::move(callback), callbackParam, std::move(task));
 }
 
 inline void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, std::function<void()> task)
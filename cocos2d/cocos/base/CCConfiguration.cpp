@@ -46,6 +46,8 @@ Configuration::Configuration()
 , _supportsETC1(false)
 , _supportsS3TC(false)
 , _supportsATITC(false)
+, _supportsETC2(false)
+, _supportsASTC(false)
 , _supportsNPOT(false)
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
@@ -138,6 +140,15 @@ void Configuration::gatherGPUInfo()
     
     _supportsATITC = checkForGLExtension("GL_AMD_compressed_ATC_texture");
     _valueDict["gl.supports_ATITC"] = Value(_supportsATITC);
+
+    const char* glVersion = (const char*)glGetString(GL_VERSION);
+    _supportsETC2 = (glVersion && strncmp(glVersion, "OpenGL ES 3", 11) == 0)
+                    || checkForGLExtension("GL_ARB_ES3_compatibility")
+                    || checkForGLExtension("GL_OES_compressed_ETC2_RGBA8_texture");
+    _valueDict["gl.supports_ETC2"] = Value(_supportsETC2);
+
+    _supportsASTC = checkForGLExtension("GL_KHR_texture_compression_astc_ldr");
+    _valueDict["gl.supports_ASTC"] = Value(_supportsASTC);
     
     _supportsPVRTC = checkForGLExtension("GL_IMG_texture_compression_pvrtc");
 	_valueDict["gl.supports_PVRTC"] = Value(_supportsPVRTC);
@@ -259,6 +270,16 @@ bool Configuration::supportsATITC() const
     return _supportsATITC;
 }
 
+bool Configuration::supportsETC2() const
+{
+    return _supportsETC2;
+}
+
+bool Configuration::supportsASTC() const
+{
+    return _supportsASTC;
+}
+
 bool Configuration::supportsBGRA8888() const
 {
 	return _supportsBGRA8888;
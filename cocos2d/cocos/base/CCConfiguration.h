@@ -126,6 +126,19 @@ public:
      * @return Is true if supports ATITC Texture Compressed.
      */
     bool supportsATITC() const;
+
+    /** Whether or not ETC2 Texture Compressed is supported.
+     * It is part of OpenGL ES 3.0 and of the ES3 compatibility of desktop OpenGL.
+     *
+     * @return Is true if supports ETC2 Texture Compressed.
+     */
+    bool supportsETC2() const;
+
+    /** Whether or not ASTC Texture Compressed is supported.
+     *
+     * @return Is true if supports ASTC (LDR profile) Texture Compressed.
+     */
+    bool supportsASTC() const;
     
     /** Whether or not BGRA8888 textures are supported.
      *
@@ -263,6 +276,8 @@ protected:
     bool            _supportsETC1;
     bool            _supportsS3TC;
     bool            _supportsATITC;
+    bool            _supportsETC2;
+    bool            _supportsASTC;
     bool            _supportsNPOT;
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
@@ -69,6 +69,7 @@
 #include "base/base64.h"
 #include "base/ccUtils.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion(void);
@@ -1028,7 +1029,7 @@ void Console::addClient()
 
 void Console::createCommandAllocator()
 {
-    addCommand({"allocator", "Display allocator diagnostics for all allocators. Args: [-h | help | ]",
+    addCommand({"allocator", "Display object pool statistics and allocator diagnostics for all allocators. Args: [-h | help | ]",
         CC_CALLBACK_2(Console::commandAllocator, this)});
 }
 
@@ -1141,6 +1142,10 @@ void Console::createCommandVersion()
 
 void Console::commandAllocator(int fd, const std::string& /*args*/)
 {
+#if CC_ENABLE_OBJECT_POOLS
+    auto pools = allocator::ObjectPoolBase::statisticsForAllPools();
+    Console::Utility::mydprintf(fd, "%s", pools.c_str());
+#endif
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
     auto info = allocator::AllocatorDiagnostics::instance()->diagnostics();
     Console::Utility::mydprintf(fd, info.c_str());
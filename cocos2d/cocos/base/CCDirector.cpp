@@ -61,6 +61,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -132,6 +133,9 @@ bool Director::init()
     _scheduler->scheduleUpdate(_actionManager, Scheduler::PRIORITY_SYSTEM, false);
 
     _eventDispatcher = new (std::nothrow) EventDispatcher();
+
+    // created here so that the cocos thread owns the first queue
+    JobSystem::getInstance();
     
     _beforeSetNextScene = new (std::nothrow) EventCustom(EVENT_BEFORE_SET_NEXT_SCENE);
     _beforeSetNextScene->setUserData(this);
@@ -1112,6 +1116,9 @@ void Director::reset()
     RenderState::finalize();
     
     destroyTextureCache();
+
+    // after the texture cache, which waits for its decoding jobs
+    JobSystem::destroyInstance();
 }
 
 void Director::purgeDirector()
@@ -1140,6 +1147,9 @@ void Director::restartDirector()
 
     // Texture cache need to be reinitialized
     initTextureCache();
+
+    // JobSystem was destroyed by reset()
+    JobSystem::getInstance();
     
     // Reschedule for action manager
     getScheduler()->scheduleUpdate(getActionManager(), Scheduler::PRIORITY_SYSTEM, false);
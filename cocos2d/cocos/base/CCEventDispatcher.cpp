@@ -36,6 +36,7 @@
 #include "base/CCEventListenerController.h"
 #endif
 #include "2d/CCScene.h"
+#include "2d/CCProtectedNode.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
@@ -202,7 +203,6 @@ void EventDispatcher::EventListenerVector::clear()
 EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
-, _nodePriorityIndex(0)
 {
     _toAddedListeners.reserve(50);
     _toRemovedListeners.reserve(50);
@@ -222,75 +222,6 @@ EventDispatcher::~EventDispatcher()
     removeAllEventListeners();
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
-{
-    node->sortAllChildren();
-    
-    int i = 0;
-    auto& children = node->getChildren();
-    
-    auto childrenCount = children.size();
-    
-    if(childrenCount > 0)
-    {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
-        
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-        
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
-        }
-    }
-    else
-    {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-    }
-    
-    if (isRootNode)
-    {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::stable_sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
-    }
-}
-
 void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/* = false */)
 {
     auto listenerIter = _nodeListenersMap.find(target);
@@ -301,6 +232,9 @@ void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/
         {
             l->setPaused(true);
         }
+
+        // the node may be leaving the scene, its listeners go after the ones of the running scene
+        _dirtyNodes.insert(target);
     }
 
     for (auto& listener : _toAddedListeners)
@@ -357,7 +291,6 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
 {
     // Ensure the node is removed from these immediately also.
     // Don't want any dangling pointers or the possibility of dealing with deleted objects..
-    _nodePriorityMap.erase(target);
     _dirtyNodes.erase(target);
 
     auto listenerIter = _nodeListenersMap.find(target);
@@ -482,6 +415,7 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     if (listener->getFixedPriority() == 0)
     {
         setDirty(listenerID, DirtyFlag::SCENE_GRAPH_PRIORITY);
+        listener->_sceneGraphPriorityDirty = true;
         
         auto node = listener->getAssociatedNode();
         CCASSERT(node != nullptr, "Invalid scene graph priority!");
@@ -552,13 +486,6 @@ void EventDispatcher::debugCheckNodeHasNoEventListenersOnDestruction(Node* node)
         }
     }
     
-    // Check the node priority map
-    for (const auto & keyValuePair : _nodePriorityMap)
-    {
-        CCASSERT(keyValuePair.first != node,
-                 "Node should have no event listeners registered for it upon destruction!");
-    }
-    
     // Check the to be added list
     for (EventListener * listener : _toAddedListeners)
     {
@@ -1268,6 +1195,7 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
                 for (auto& l : *iter->second)
                 {
                     setDirty(l->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+                    l->_sceneGraphPriorityDirty = true;
                 }
             }
         }
@@ -1311,6 +1239,76 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
     }
 }
 
+int EventDispatcher::getSceneGraphDepth(Node* node, Node* rootNode)
+{
+    auto iter = _nodeDepthMap.find(node);
+    if (iter != _nodeDepthMap.end())
+        return iter->second;
+
+    // Only the children are visited, the protected children keep the priority of a node out of the scene
+    int depth = 0;
+    for (Node* current = node; current != rootNode; ++depth)
+    {
+        Node* parent = current->getParent();
+        auto protectedNode = dynamic_cast<ProtectedNode*>(parent);
+        if (parent == nullptr || (protectedNode && protectedNode->_protectedChildren.contains(current)))
+        {
+            depth = -1;
+            break;
+        }
+        current = parent;
+    }
+
+    _nodeDepthMap.emplace(node, depth);
+    return depth;
+}
+
+bool EventDispatcher::hasHigherSceneGraphPriority(Node* node1, Node* node2, Node* rootNode)
+{
+    if (node1 == node2)
+        return false;
+
+    int depth1 = getSceneGraphDepth(node1, rootNode);
+    int depth2 = getSceneGraphDepth(node2, rootNode);
+    if (depth1 < 0 || depth2 < 0)
+        return depth2 < 0 && depth1 >= 0;
+
+    if (node1->getGlobalZOrder() != node2->getGlobalZOrder())
+        return node1->getGlobalZOrder() > node2->getGlobalZOrder();
+
+    // Same visit order as Node::visit: the children with a negative local z order, the node, then the other children.
+    // Walk up to the children of the common ancestor, the children don't need to be sorted.
+    Node* child1 = nullptr;
+    Node* child2 = nullptr;
+    Node* ancestor1 = node1;
+    Node* ancestor2 = node2;
+    for (; depth1 > depth2; --depth1)
+    {
+        child1 = ancestor1;
+        ancestor1 = ancestor1->getParent();
+    }
+    for (; depth2 > depth1; --depth2)
+    {
+        child2 = ancestor2;
+        ancestor2 = ancestor2->getParent();
+    }
+
+    if (ancestor1 == ancestor2)
+    {
+        // node2 is the ancestor of node1, or the opposite
+        return child1 ? child1->_localZOrder >= 0 : child2->_localZOrder < 0;
+    }
+
+    while (ancestor1->getParent() != ancestor2->getParent())
+    {
+        ancestor1 = ancestor1->getParent();
+        ancestor2 = ancestor2->getParent();
+    }
+
+    return ancestor1->_localZOrder > ancestor2->_localZOrder ||
+        (ancestor1->_localZOrder == ancestor2->_localZOrder && ancestor1->_orderOfArrival > ancestor2->_orderOfArrival);
+}
+
 void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode)
 {
     auto listeners = getListeners(listenerID);
@@ -1322,22 +1320,41 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
+    _nodeDepthMap.clear();
+    auto compare = [this, rootNode](const EventListener* l1, const EventListener* l2) {
+        return hasHigherSceneGraphPriority(l1->getAssociatedNode(), l2->getAssociatedNode(), rootNode);
+    };
 
-    visitTarget(rootNode, true);
-    
-    // After sort: priority < 0, > 0
-    std::stable_sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
+    // The listeners of the nodes that were not moved keep their order, so only the dirty ones are sorted
+    // and merged back instead of walking the whole scene graph.
+    auto first = sceneGraphListeners->begin();
+    auto last = sceneGraphListeners->end();
+    auto middle = std::stable_partition(first, last, [](const EventListener* l) {
+        return !l->_sceneGraphPriorityDirty;
     });
+
+    if (std::is_sorted(first, middle, compare))
+    {
+        std::stable_sort(middle, last, compare);
+        std::inplace_merge(first, middle, last, compare);
+    }
+    else
+    {
+        // the scene graph changed without marking the nodes dirty, e.g. the running scene was replaced
+        std::stable_sort(first, last, compare);
+    }
+
+    for (auto& l : *sceneGraphListeners)
+    {
+        l->_sceneGraphPriorityDirty = false;
+    }
+    _nodeDepthMap.clear();
     
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
     for (auto& l : *sceneGraphListeners)
     {
-        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
+        log("listener priority: node ([%s]%p), global z order (%f)", typeid(*l->_node).name(), l->_node, l->_node->getGlobalZOrder());
     }
 #endif
 }
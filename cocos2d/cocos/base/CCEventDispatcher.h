@@ -261,8 +261,18 @@ protected:
     /** Sort event listener */
     void sortEventListeners(const EventListener::ListenerID& listenerID);
     
-    /** Sorts the listeners of specified type by scene graph priority */
+    /** Sorts the listeners of specified type by scene graph priority.
+     *  Only the listeners of the nodes marked dirty are moved, the others are already sorted.
+     */
     void sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode);
+
+    /** Whether the listeners of node1 are called before the ones of node2: node1 has a higher global z order, or
+     *  the same global z order and it is visited after node2. The nodes out of the rootNode tree are the last ones.
+     */
+    bool hasHigherSceneGraphPriority(Node* node1, Node* node2, Node* rootNode);
+
+    /** Gets the depth of a node in the rootNode tree, -1 if it isn't visited when sorting the listeners */
+    int getSceneGraphDepth(Node* node, Node* rootNode);
     
     /** Sorts the listeners of specified type by fixed priority */
     void sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID);
@@ -309,9 +319,6 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
-
     /** Remove all listeners in _toRemoveListeners list and cleanup */
     void cleanToRemovedListeners();
 
@@ -324,11 +331,8 @@ protected:
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
     
-    /** The map of node and its event priority */
-    std::unordered_map<Node*, int> _nodePriorityMap;
-    
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** The depth of the nodes in the running scene, cached while sorting the scene graph priority listeners */
+    std::unordered_map<Node*, int> _nodeDepthMap;
     
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
@@ -345,8 +349,6 @@ protected:
     /** Whether to enable dispatching event */
     bool _isEnabled;
     
-    int _nodePriorityIndex;
-    
     std::set<std::string> _internalCustomListenerIDs;
 };
 
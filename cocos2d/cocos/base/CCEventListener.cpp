@@ -43,6 +43,7 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     _listenerID = listenerID;
     _isRegistered = false;
     _paused = false;
+    _sceneGraphPriorityDirty = false;
     _isEnabled = true;
     
     return true;
@@ -32,6 +32,7 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
 
 /**
  * @addtogroup base
@@ -173,6 +174,7 @@ protected:
     int   _fixedPriority;   // The higher the number, the higher the priority, 0 is for scene graph base priority.
     Node* _node;            // scene graph based priority
     bool _paused;           // Whether the listener is paused
+    bool _sceneGraphPriorityDirty; // Whether the listener has to be moved in the scene graph priority order
     bool _isEnabled;        // Whether the listener is enabled
     friend class EventDispatcher;
 };
@@ -25,9 +25,12 @@
 
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventCustom.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(EventListenerCustom, 32)
+
 EventListenerCustom::EventListenerCustom()
 : _onCustomEvent(nullptr)
 {
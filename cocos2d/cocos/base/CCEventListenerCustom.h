@@ -61,6 +61,8 @@ class EventCustom;
 class CC_DLL EventListenerCustom : public EventListener
 {
 public:
+    CC_DECLARE_OBJECT_POOL(EventListenerCustom)
+
     /** Creates an event listener with type and callback.
      * @param eventName The type of the event.
      * @param callback The callback function when the specified event was emitted.
@@ -27,11 +27,14 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventTouch.h"
 #include "base/CCTouch.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 #include <algorithm>
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(EventListenerTouchOneByOne, 32)
+
 const std::string EventListenerTouchOneByOne::LISTENER_ID = "__cc_touch_one_by_one";
 
 EventListenerTouchOneByOne::EventListenerTouchOneByOne()
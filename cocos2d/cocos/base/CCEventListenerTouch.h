@@ -46,6 +46,8 @@ class Touch;
 class CC_DLL EventListenerTouchOneByOne : public EventListener
 {
 public:
+    CC_DECLARE_OBJECT_POOL(EventListenerTouchOneByOne)
+
     static const std::string LISTENER_ID;
     
     /** Create a one by one touch event listener.
@@ -0,0 +1,520 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+CC_IMPLEMENT_OBJECT_POOL(Job, 64)
+
+/**
+ * Fixed capacity Chase-Lev deque ("Correct and Efficient Work-Stealing for Weak Memory Models").
+ * push() and pop() may only be called by the owner thread, steal() by any thread.
+ */
+class WorkStealingQueue
+{
+public:
+    static const int64_t CAPACITY = 4096;
+    static const int64_t MASK = CAPACITY - 1;
+
+    WorkStealingQueue()
+    : _top(0)
+    , _bottom(0)
+    {
+        for (int64_t i = 0; i < CAPACITY; ++i)
+            _jobs[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    /** Returns false if the queue is full. */
+    bool push(Job* job)
+    {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY)
+            return false;
+
+        _jobs[bottom & MASK].store(job, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    Job* pop()
+    {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // empty
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = _jobs[bottom & MASK].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // last job, race against the thieves
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal()
+    {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+
+        Job* job = _jobs[top & MASK].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+protected:
+    // top and bottom are written by different threads, keep them on different cache lines
+    alignas(64) std::atomic<int64_t> _top;
+    alignas(64) std::atomic<int64_t> _bottom;
+    std::atomic<Job*> _jobs[CAPACITY];
+};
+
+// Job
+
+Job::Job(const Function& function, Job* parent)
+: _function(function)
+, _parent(parent)
+, _unfinished(1)
+, _pendingDependencies(1)
+, _referenceCount(1)
+, _completed(false)
+, _running(false)
+, _nextCompletion(nullptr)
+{
+    _continuationLock.clear();
+}
+
+Job::~Job()
+{
+}
+
+void Job::retain()
+{
+    _referenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Job::release()
+{
+    if (_referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+// JobSystem
+
+std::atomic<JobSystem*> JobSystem::s_jobSystem(nullptr);
+std::mutex JobSystem::s_instanceMutex;
+
+JobSystem* JobSystem::getInstance()
+{
+    JobSystem* jobSystem = s_jobSystem.load(std::memory_order_acquire);
+    if (jobSystem == nullptr)
+    {
+        // AsyncTaskPool::enqueue may be the first caller, on any thread
+        std::lock_guard<std::mutex> lock(s_instanceMutex);
+        jobSystem = s_jobSystem.load(std::memory_order_relaxed);
+        if (jobSystem == nullptr)
+        {
+            jobSystem = new (std::nothrow) JobSystem();
+            s_jobSystem.store(jobSystem, std::memory_order_release);
+        }
+    }
+    return jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    // main thread completions already posted to the scheduler check it
+    JobSystem* jobSystem = s_jobSystem.exchange(nullptr);
+    delete jobSystem;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+: _pendingJobs(0)
+, _sleepingWorkers(0)
+, _stop(false)
+, _mainThreadCompletions(nullptr)
+{
+    if (workerCount == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    _queues.resize(workerCount + 1);
+    for (auto& queue : _queues)
+        queue = new (std::nothrow) WorkStealingQueue();
+
+    _queueOwners.push_back(std::this_thread::get_id());
+    _workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        _workers.push_back(std::thread(&JobSystem::workerLoop, this, (int)i + 1));
+        _queueOwners.push_back(_workers.back().get_id());
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto& worker : _workers)
+        worker.join();
+
+    // drop the jobs that didn't start
+    for (auto& queue : _queues)
+    {
+        while (Job* job = queue->steal())
+            job->release();
+        delete queue;
+    }
+    for (auto& job : _injectionQueue)
+        job->release();
+
+    Job* job = _mainThreadCompletions.exchange(nullptr);
+    while (job)
+    {
+        Job* next = job->_nextCompletion;
+        job->release();
+        job = next;
+    }
+}
+
+Job* JobSystem::createJob(const Job::Function& function, Job* parent)
+{
+    if (parent)
+    {
+        CCASSERT(!parent->isFinished(), "The parent job already finished");
+        parent->_unfinished.fetch_add(1, std::memory_order_relaxed);
+        parent->retain();
+    }
+    return new (std::nothrow) Job(function, parent);
+}
+
+void JobSystem::addDependency(Job* job, Job* dependency)
+{
+    CCASSERT(!job->_running, "Dependencies must be added before running the job");
+    job->_pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+
+    while (dependency->_continuationLock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    bool completed = dependency->_completed;
+    if (!completed)
+    {
+        dependency->_continuations.push_back(job);
+        job->retain();
+    }
+    dependency->_continuationLock.clear(std::memory_order_release);
+
+    // the job isn't running yet, so this can't be the last pending dependency
+    if (completed)
+        job->_pendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void JobSystem::setMainThreadCompletion(Job* job, const Job::Function& completion)
+{
+    CCASSERT(!job->_running, "The completion must be set before running the job");
+    job->_mainThreadCompletion = completion;
+}
+
+void JobSystem::run(Job* job)
+{
+    CCASSERT(!job->_running, "The job is already running");
+    job->_running = true;
+    // released once the job completed
+    job->retain();
+    if (job->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        schedule(job);
+}
+
+void JobSystem::dispatch(const Job::Function& function, const Job::Function& mainThreadCompletion)
+{
+    Job* job = createJob(function);
+    if (mainThreadCompletion)
+        setMainThreadCompletion(job, mainThreadCompletion);
+    run(job);
+    job->release();
+}
+
+Job* JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+{
+    if (grainSize == 0)
+        grainSize = 1;
+
+    Job* parent = createJob(nullptr);
+    for (size_t begin = 0; begin < count; begin += grainSize)
+    {
+        size_t end = std::min(begin + grainSize, count);
+        Job* child = createJob([function, begin, end]() { function(begin, end); }, parent);
+        run(child);
+        child->release();
+    }
+    run(parent);
+    return parent;
+}
+
+void JobSystem::wait(Job* job)
+{
+    int queueIndex = getCurrentQueueIndex();
+    while (!job->isFinished())
+    {
+        // the cocos thread waits in the middle of a frame, so it doesn't pick up unrelated jobs
+        Job* other = queueIndex == 0 ? findAwaitedJob(job) : findJob(queueIndex);
+        if (other)
+            execute(other);
+        else
+            std::this_thread::yield();
+    }
+}
+
+int JobSystem::getCurrentQueueIndex() const
+{
+    auto threadId = std::this_thread::get_id();
+    for (size_t i = 0, count = _queueOwners.size(); i < count; ++i)
+    {
+        if (_queueOwners[i] == threadId)
+            return (int)i;
+    }
+    return -1;
+}
+
+void JobSystem::workerLoop(int queueIndex)
+{
+    // spin a little before sleeping, jobs often come in bursts
+    static const int SPIN_COUNT = 64;
+    int spins = 0;
+
+    while (!_stop.load(std::memory_order_relaxed))
+    {
+        Job* job = findJob(queueIndex);
+        if (job)
+        {
+            execute(job);
+            spins = 0;
+            continue;
+        }
+
+        if (++spins < SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        spins = 0;
+
+        // pairs with the increment of _pendingJobs in schedule(), no wake up can be missed
+        _sleepingWorkers.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _sleepCondition.wait(lock, [this]() { return _stop.load() || _pendingJobs.load() > 0; });
+        }
+        _sleepingWorkers.fetch_sub(1);
+    }
+}
+
+void JobSystem::schedule(Job* job)
+{
+    int queueIndex = getCurrentQueueIndex();
+    if (queueIndex < 0 || !_queues[queueIndex]->push(job))
+    {
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        _injectionQueue.push_back(job);
+    }
+
+    _pendingJobs.fetch_add(1);
+    if (_sleepingWorkers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _sleepCondition.notify_one();
+    }
+}
+
+Job* JobSystem::findJob(int queueIndex)
+{
+    Job* job = nullptr;
+    if (queueIndex >= 0)
+        job = _queues[queueIndex]->pop();
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        if (!_injectionQueue.empty())
+        {
+            job = _injectionQueue.front();
+            _injectionQueue.pop_front();
+        }
+    }
+
+    if (!job)
+    {
+        size_t count = _queues.size();
+        size_t start = queueIndex >= 0 ? queueIndex + 1 : 0;
+        for (size_t i = 0; i < count && !job; ++i)
+        {
+            size_t victim = (start + i) % count;
+            if ((int)victim != queueIndex)
+                job = _queues[victim]->steal();
+        }
+    }
+
+    if (job)
+        _pendingJobs.fetch_sub(1);
+    return job;
+}
+
+Job* JobSystem::findAwaitedJob(Job* awaited)
+{
+    // the children scheduled by the cocos thread are in its own queue, the others are left to the
+    // workers; unrelated jobs popped on the way are handed over to them through the injection queue
+    while (Job* job = _queues[0]->pop())
+    {
+        Job* ancestor = job;
+        while (ancestor && ancestor != awaited)
+            ancestor = ancestor->_parent;
+
+        if (ancestor)
+        {
+            _pendingJobs.fetch_sub(1);
+            return job;
+        }
+
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        _injectionQueue.push_back(job);
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    if (job->_function)
+        job->_function();
+    finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+    if (job->_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        complete(job);
+}
+
+void JobSystem::complete(Job* job)
+{
+    // queued before the continuations run, so the completions of dependent jobs are dispatched after this one
+    if (job->_mainThreadCompletion)
+    {
+        // released once the completion was called
+        job->retain();
+        pushMainThreadCompletion(job);
+    }
+
+    std::vector<Job*> continuations;
+    while (job->_continuationLock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    job->_completed = true;
+    continuations.swap(job->_continuations);
+    job->_continuationLock.clear(std::memory_order_release);
+
+    for (auto& continuation : continuations)
+    {
+        if (continuation->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            schedule(continuation);
+        continuation->release();
+    }
+
+    Job* parent = job->_parent;
+    if (parent)
+    {
+        finish(parent);
+        parent->release();
+    }
+
+    job->release();
+}
+
+void JobSystem::pushMainThreadCompletion(Job* job)
+{
+    Job* head = _mainThreadCompletions.load(std::memory_order_relaxed);
+    do
+    {
+        job->_nextCompletion = head;
+    } while (!_mainThreadCompletions.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+
+    // a single scheduler function dispatches all the completions queued until it runs
+    if (head == nullptr)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([]() {
+            JobSystem* jobSystem = s_jobSystem.load();
+            if (jobSystem)
+                jobSystem->dispatchMainThreadCompletions();
+        });
+    }
+}
+
+void JobSystem::dispatchMainThreadCompletions()
+{
+    Job* job = _mainThreadCompletions.exchange(nullptr, std::memory_order_acquire);
+
+    // the stack is last in first out, dispatch in completion order
+    Job* ordered = nullptr;
+    while (job)
+    {
+        Job* next = job->_nextCompletion;
+        job->_nextCompletion = ordered;
+        ordered = job;
+        job = next;
+    }
+
+    while (ordered)
+    {
+        Job* next = ordered->_nextCompletion;
+        ordered->_mainThreadCompletion();
+        ordered->release();
+        ordered = next;
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,221 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_JOB_SYSTEM_H__
+#define __CC_JOB_SYSTEM_H__
+
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+class JobSystem;
+class WorkStealingQueue;
+
+/**
+ * @class Job
+ * @brief A unit of work executed by the JobSystem.
+ *
+ * A job finishes once its function and the functions of all its children returned.
+ * Jobs are reference counted with atomic counters, so they can be retained and released
+ * from any thread. JobSystem::createJob() returns a job retained once for the caller.
+ * @js NA
+ */
+class CC_DLL Job
+{
+public:
+    CC_DECLARE_OBJECT_POOL(Job)
+
+    typedef std::function<void()> Function;
+
+    /** Whether the function of the job and of all its children returned. */
+    bool isFinished() const { return _unfinished.load(std::memory_order_acquire) == 0; }
+
+    /** Retains the job. */
+    void retain();
+
+    /** Releases the job, it is deleted when the last reference is released. */
+    void release();
+
+protected:
+    Job(const Function& function, Job* parent);
+    ~Job();
+
+    friend class JobSystem;
+
+    Function _function;
+    Function _mainThreadCompletion;
+    Job* _parent;
+    // 1 for the job itself plus 1 per unfinished child
+    std::atomic<int> _unfinished;
+    // 1 until the job is run plus 1 per unfinished dependency
+    std::atomic<int> _pendingDependencies;
+    std::atomic<int> _referenceCount;
+    // guards _continuations and _completed
+    std::atomic_flag _continuationLock;
+    std::vector<Job*> _continuations;
+    bool _completed;
+    bool _running;
+    // link in the list of jobs waiting for their main thread completion
+    Job* _nextCompletion;
+};
+
+/**
+ * @class JobSystem
+ * @brief Engine wide work-stealing job system.
+ *
+ * Every worker thread owns a lock-free Chase-Lev deque: it pushes and pops jobs at the bottom
+ * while idle workers steal from the top of the other deques. The cocos thread owns a deque too,
+ * jobs run from other threads go through a shared injection queue.
+ * Main thread completions are batched and dispatched from Scheduler::update.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    /**
+     * Returns the shared instance of the job system.
+     * The Director creates it on the cocos thread, which owns the first queue. It can be called from any thread.
+     */
+    static JobSystem* getInstance();
+
+    /**
+     * Destroys the job system. Jobs that didn't start yet are dropped.
+     */
+    static void destroyInstance();
+
+    /**
+     * Creates a job, it doesn't start before run() is called.
+     *
+     * @param function The function performed by the job on a worker thread.
+     * @param parent Optional parent job, it only finishes once this job finished.
+     * The parent must not have finished yet, usually the child is created by the function of its parent.
+     * @return The job, retained once. Release it once it isn't needed anymore.
+     */
+    Job* createJob(const Job::Function& function, Job* parent = nullptr);
+
+    /**
+     * Makes a job start only after another one finished. Must be called before run(job).
+     *
+     * @param job The job waiting.
+     * @param dependency The job that has to finish first.
+     */
+    void addDependency(Job* job, Job* dependency);
+
+    /**
+     * Sets a function called on the cocos thread once the job finished. Must be called before run(job).
+     */
+    void setMainThreadCompletion(Job* job, const Job::Function& completion);
+
+    /**
+     * Runs a job as soon as its dependencies finished.
+     */
+    void run(Job* job);
+
+    /**
+     * Creates and runs a job that nobody waits for.
+     *
+     * @param function The function performed on a worker thread.
+     * @param mainThreadCompletion Optional function called on the cocos thread once the job finished.
+     */
+    void dispatch(const Job::Function& function, const Job::Function& mainThreadCompletion = nullptr);
+
+    /**
+     * Creates and runs a job splitting [0, count) in ranges of at most `grainSize` elements,
+     * each range is processed by a child job.
+     *
+     * @return The parent job, retained once. It finishes once all the ranges were processed.
+     */
+    Job* parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+
+    /**
+     * Waits until the job finished. A worker thread executes other jobs meanwhile, the cocos thread
+     * only executes the job and its children, so unrelated work like an IO task never stalls a frame.
+     * Main thread completions are not waited for, they run during the next Scheduler update.
+     */
+    void wait(Job* job);
+
+    /** Returns the number of worker threads. */
+    unsigned int getWorkerCount() const { return (unsigned int)_workers.size(); }
+
+CC_CONSTRUCTOR_ACCESS:
+    /**
+     * @param workerCount The number of worker threads, 0 to use one less than the number of cores.
+     * The calling thread owns the first queue.
+     */
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+protected:
+    void workerLoop(int queueIndex);
+    int getCurrentQueueIndex() const;
+    void schedule(Job* job);
+    Job* findJob(int queueIndex);
+    Job* findAwaitedJob(Job* awaited);
+    void execute(Job* job);
+    void finish(Job* job);
+    void complete(Job* job);
+    void pushMainThreadCompletion(Job* job);
+    void dispatchMainThreadCompletions();
+
+    std::vector<std::thread> _workers;
+    std::vector<std::thread::id> _queueOwners;
+    // queue 0 is owned by the cocos thread, queue i by worker i - 1
+    std::vector<WorkStealingQueue*> _queues;
+
+    // jobs run from threads that don't own a queue, or that overflowed their queue
+    std::mutex _injectionMutex;
+    std::deque<Job*> _injectionQueue;
+
+    // jobs scheduled but not picked up yet, the workers sleep while it is 0
+    std::atomic<int> _pendingJobs;
+    std::atomic<int> _sleepingWorkers;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<bool> _stop;
+
+    // lock-free stack of the jobs whose main thread completion has to be dispatched
+    std::atomic<Job*> _mainThreadCompletions;
+
+    static std::atomic<JobSystem*> s_jobSystem;
+    // guards the creation and destruction of the shared instance
+    static std::mutex s_instanceMutex;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CC_JOB_SYSTEM_H__
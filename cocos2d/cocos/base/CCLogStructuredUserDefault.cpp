@@ -0,0 +1,672 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "base/CCLogStructuredUserDefault.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "platform/CCCommon.h"
+#include "platform/CCFileUtils.h"
+#include "tinyxml2.h"
+#include "base/base64.h"
+#include "base/ccUtils.h"
+
+#include <zlib.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define KV_FILE_NAME "UserDefault.bin"
+#define KV_CORRUPTED_FILE_SUFFIX ".corrupt"
+#define XML_FILE_NAME "UserDefault.xml"
+
+// file header: magic and version
+#define KV_FILE_MAGIC "CCKV"
+#define KV_FILE_VERSION 1
+#define KV_FILE_HEADER_SIZE 8
+
+// record header: crc32 of the rest of the record, key length, value length, value type
+#define KV_RECORD_HEADER_SIZE 13
+
+// the appended records are synced once there are that many bytes, or after that many seconds
+#define KV_SYNC_BYTES (64 * 1024)
+#define KV_SYNC_INTERVAL 1.0
+#define KV_SYNC_SCHEDULE_KEY "LogStructuredUserDefault::sync"
+
+// the file is compacted when it's larger than this and more than twice the size of the live records
+#define KV_COMPACT_MIN_SIZE (64 * 1024)
+
+NS_CC_BEGIN
+
+namespace
+{
+    void writeUint32(unsigned char* p, uint32_t value)
+    {
+        p[0] = (unsigned char)(value);
+        p[1] = (unsigned char)(value >> 8);
+        p[2] = (unsigned char)(value >> 16);
+        p[3] = (unsigned char)(value >> 24);
+    }
+
+    uint32_t readUint32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    size_t getRecordSize(size_t keySize, size_t valueSize)
+    {
+        return KV_RECORD_HEADER_SIZE + keySize + valueSize;
+    }
+
+    // Appends a record to the buffer
+    void encodeRecord(std::string& buffer, const std::string& key, unsigned char type, const void* bytes, size_t size)
+    {
+        size_t offset = buffer.size();
+        buffer.resize(offset + KV_RECORD_HEADER_SIZE);
+        buffer.append(key);
+        buffer.append((const char*)bytes, size);
+
+        unsigned char* record = (unsigned char*)&buffer[offset];
+        writeUint32(record + 4, (uint32_t)key.size());
+        writeUint32(record + 8, (uint32_t)size);
+        record[12] = type;
+        uLong crc = crc32(0L, record + 4, (uInt)(getRecordSize(key.size(), size) - 4));
+        writeUint32(record, (uint32_t)crc);
+    }
+
+    void syncFile(FILE* fp)
+    {
+        fflush(fp);
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+        _commit(_fileno(fp));
+#else
+        fsync(fileno(fp));
+#endif
+    }
+}
+
+LogStructuredUserDefault* LogStructuredUserDefault::create(const std::string& filePath)
+{
+    auto ret = new (std::nothrow) LogStructuredUserDefault();
+    if (ret && ret->init(filePath))
+    {
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+LogStructuredUserDefault::LogStructuredUserDefault()
+: _file(nullptr)
+, _fileSize(0)
+, _liveSize(0)
+, _unsyncedSize(0)
+, _lastSyncTime(0)
+, _scheduler(nullptr)
+, _syncScheduled(false)
+{
+}
+
+LogStructuredUserDefault::~LogStructuredUserDefault()
+{
+    if (_scheduler)
+    {
+        _scheduler->unschedule(KV_SYNC_SCHEDULE_KEY, this);
+        _scheduler->release();
+        _scheduler = nullptr;
+    }
+
+    if (_file)
+    {
+        syncFile(_file);
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+bool LogStructuredUserDefault::init(const std::string& filePath)
+{
+    auto fileUtils = FileUtils::getInstance();
+    _filePath = filePath.empty() ? fileUtils->getWritablePath() + KV_FILE_NAME : filePath;
+
+    // the scheduler is kept so the pending sync can be canceled even after the director is gone
+    _scheduler = Director::getInstance()->getScheduler();
+    _scheduler->retain();
+
+    bool isNewFile = !fileUtils->isFileExist(_filePath);
+    if (!isNewFile && !load())
+    {
+        // e.g. an empty file left by a crash before its header reached the disk: start over,
+        // the values of the XML file are imported again
+        if (!moveCorruptedFileAside())
+        {
+            return false;
+        }
+        isNewFile = true;
+    }
+
+    // load() may have reopened the file when it dropped a torn record
+    if (!_file && !openForAppend())
+    {
+        return false;
+    }
+
+    if (isNewFile)
+    {
+        importXMLFile();
+        sync();
+    }
+
+    _lastSyncTime = utils::gettime();
+    return true;
+}
+
+bool LogStructuredUserDefault::isValidValue(ValueType type, size_t size)
+{
+    switch (type)
+    {
+    case ValueType::DELETED:
+        return size == 0;
+    case ValueType::BOOLEAN:
+        return size == 1;
+    case ValueType::INTEGER:
+        return size == sizeof(int32_t);
+    case ValueType::DOUBLE:
+        return size == sizeof(double);
+    case ValueType::STRING:
+    case ValueType::DATA:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool LogStructuredUserDefault::load()
+{
+    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    const unsigned char* bytes = data.getBytes();
+    size_t size = (size_t)data.getSize();
+
+    if (size < KV_FILE_HEADER_SIZE || memcmp(bytes, KV_FILE_MAGIC, 4) != 0 || readUint32(bytes + 4) != KV_FILE_VERSION)
+    {
+        CCLOG("LogStructuredUserDefault: %s isn't a valid file", _filePath.c_str());
+        return false;
+    }
+
+    size_t offset = KV_FILE_HEADER_SIZE;
+    while (offset + KV_RECORD_HEADER_SIZE <= size)
+    {
+        const unsigned char* record = bytes + offset;
+        size_t keySize = readUint32(record + 4);
+        size_t valueSize = readUint32(record + 8);
+        // a torn record at the end is written by a crash in the middle of an append
+        if (keySize > size || valueSize > size || offset + getRecordSize(keySize, valueSize) > size)
+        {
+            break;
+        }
+        size_t recordSize = getRecordSize(keySize, valueSize);
+        if ((uint32_t)crc32(0L, record + 4, (uInt)(recordSize - 4)) != readUint32(record))
+        {
+            break;
+        }
+
+        ValueType type = (ValueType)record[12];
+        if (!isValidValue(type, valueSize))
+        {
+            break;
+        }
+
+        std::string key((const char*)record + KV_RECORD_HEADER_SIZE, keySize);
+        auto iter = _values.find(key);
+        if (iter != _values.end())
+        {
+            _liveSize -= getRecordSize(key.size(), iter->second.bytes.size());
+        }
+
+        if (type == ValueType::DELETED)
+        {
+            if (iter != _values.end())
+            {
+                _values.erase(iter);
+            }
+        }
+        else
+        {
+            Value& value = _values[key];
+            value.type = type;
+            value.bytes.assign((const char*)record + KV_RECORD_HEADER_SIZE + keySize, valueSize);
+            _liveSize += recordSize;
+        }
+        offset += recordSize;
+    }
+
+    _fileSize = size;
+    if (offset != size)
+    {
+        // drops the torn records by rewriting the good ones
+        CCLOG("LogStructuredUserDefault: dropped %d corrupted bytes at the end of %s", (int)(size - offset), _filePath.c_str());
+        compact();
+    }
+    return true;
+}
+
+bool LogStructuredUserDefault::moveCorruptedFileAside()
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string corruptedPath = _filePath + KV_CORRUPTED_FILE_SUFFIX;
+    if (fileUtils->isFileExist(corruptedPath))
+    {
+        fileUtils->removeFile(corruptedPath);
+    }
+    if (!fileUtils->renameFile(_filePath, corruptedPath) && !fileUtils->removeFile(_filePath))
+    {
+        CCLOG("LogStructuredUserDefault: can't move %s aside", _filePath.c_str());
+        return false;
+    }
+
+    CCLOG("LogStructuredUserDefault: moved %s to %s", _filePath.c_str(), corruptedPath.c_str());
+    _values.clear();
+    _fileSize = 0;
+    _liveSize = 0;
+    return true;
+}
+
+void LogStructuredUserDefault::importXMLFile()
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_MAC && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
+    std::string xmlPath = FileUtils::getInstance()->getWritablePath() + XML_FILE_NAME;
+    std::string xmlBuffer = FileUtils::getInstance()->getStringFromFile(xmlPath);
+    if (xmlBuffer.empty())
+    {
+        return;
+    }
+
+    tinyxml2::XMLDocument doc;
+    if (doc.Parse(xmlBuffer.c_str(), xmlBuffer.size()) != tinyxml2::XML_SUCCESS || !doc.RootElement())
+    {
+        return;
+    }
+
+    // XML values have no type, they are parsed by the getters like UserDefault does
+    for (auto node = doc.RootElement()->FirstChildElement(); node; node = node->NextSiblingElement())
+    {
+        const char* text = node->GetText();
+        std::string value = text ? text : "";
+        setValue(node->Value(), ValueType::STRING, value.data(), value.size());
+    }
+    CCLOG("LogStructuredUserDefault: imported %d values from %s", (int)_values.size(), xmlPath.c_str());
+#endif
+}
+
+bool LogStructuredUserDefault::openForAppend()
+{
+    auto fileUtils = FileUtils::getInstance();
+    bool isNewFile = !fileUtils->isFileExist(_filePath);
+    _file = fopen(fileUtils->getSuitableFOpen(_filePath).c_str(), "ab");
+    if (!_file)
+    {
+        CCLOG("LogStructuredUserDefault: can't open %s", _filePath.c_str());
+        return false;
+    }
+
+    if (isNewFile)
+    {
+        unsigned char header[KV_FILE_HEADER_SIZE];
+        memcpy(header, KV_FILE_MAGIC, 4);
+        writeUint32(header + 4, KV_FILE_VERSION);
+        fwrite(header, 1, KV_FILE_HEADER_SIZE, _file);
+        fflush(_file);
+        _fileSize = KV_FILE_HEADER_SIZE;
+        _unsyncedSize += KV_FILE_HEADER_SIZE;
+    }
+    return true;
+}
+
+const LogStructuredUserDefault::Value* LogStructuredUserDefault::findValue(const char* key) const
+{
+    if (!key)
+    {
+        return nullptr;
+    }
+    auto iter = _values.find(key);
+    return iter != _values.end() ? &iter->second : nullptr;
+}
+
+std::string LogStructuredUserDefault::getValueAsString(const Value& value) const
+{
+    // the same text as the XML implementation stores
+    char tmp[50];
+    switch (value.type)
+    {
+    case ValueType::BOOLEAN:
+        return value.bytes[0] ? "true" : "false";
+    case ValueType::INTEGER:
+    {
+        int32_t intValue;
+        memcpy(&intValue, value.bytes.data(), sizeof(intValue));
+        sprintf(tmp, "%d", (int)intValue);
+        return tmp;
+    }
+    case ValueType::DOUBLE:
+    {
+        double doubleValue;
+        memcpy(&doubleValue, value.bytes.data(), sizeof(doubleValue));
+        snprintf(tmp, sizeof(tmp), "%f", doubleValue);
+        return tmp;
+    }
+    case ValueType::DATA:
+    {
+        char* encodedData = nullptr;
+        base64Encode((const unsigned char*)value.bytes.data(), (unsigned int)value.bytes.size(), &encodedData);
+        std::string ret = encodedData ? encodedData : "";
+        free(encodedData);
+        return ret;
+    }
+    default:
+        return value.bytes;
+    }
+}
+
+bool LogStructuredUserDefault::getBoolForKey(const char* key, bool defaultValue)
+{
+    const Value* value = findValue(key);
+    if (!value)
+    {
+        return defaultValue;
+    }
+    if (value->type == ValueType::BOOLEAN)
+    {
+        return value->bytes[0] != 0;
+    }
+    return getValueAsString(*value) == "true";
+}
+
+int LogStructuredUserDefault::getIntegerForKey(const char* key, int defaultValue)
+{
+    const Value* value = findValue(key);
+    if (!value)
+    {
+        return defaultValue;
+    }
+    if (value->type == ValueType::INTEGER)
+    {
+        int32_t ret;
+        memcpy(&ret, value->bytes.data(), sizeof(ret));
+        return ret;
+    }
+    return atoi(getValueAsString(*value).c_str());
+}
+
+float LogStructuredUserDefault::getFloatForKey(const char* key, float defaultValue)
+{
+    return (float)getDoubleForKey(key, (double)defaultValue);
+}
+
+double LogStructuredUserDefault::getDoubleForKey(const char* key, double defaultValue)
+{
+    const Value* value = findValue(key);
+    if (!value)
+    {
+        return defaultValue;
+    }
+    if (value->type == ValueType::DOUBLE)
+    {
+        double ret;
+        memcpy(&ret, value->bytes.data(), sizeof(ret));
+        return ret;
+    }
+    return utils::atof(getValueAsString(*value).c_str());
+}
+
+std::string LogStructuredUserDefault::getStringForKey(const char* key, const std::string & defaultValue)
+{
+    const Value* value = findValue(key);
+    if (!value)
+    {
+        return defaultValue;
+    }
+    return getValueAsString(*value);
+}
+
+Data LogStructuredUserDefault::getDataForKey(const char* key, const Data& defaultValue)
+{
+    const Value* value = findValue(key);
+    if (!value)
+    {
+        return defaultValue;
+    }
+
+    Data ret;
+    if (value->type == ValueType::DATA)
+    {
+        ret.copy((const unsigned char*)value->bytes.data(), value->bytes.size());
+        return ret;
+    }
+
+    // the values imported from XML are base64 encoded
+    std::string encodedData = getValueAsString(*value);
+    unsigned char* decodedData = nullptr;
+    int decodedDataLen = base64Decode((const unsigned char*)encodedData.c_str(), (unsigned int)encodedData.size(), &decodedData);
+    if (decodedData)
+    {
+        ret.fastSet(decodedData, decodedDataLen);
+    }
+    return ret;
+}
+
+void LogStructuredUserDefault::setBoolForKey(const char* key, bool value)
+{
+    unsigned char byte = value ? 1 : 0;
+    setValue(key, ValueType::BOOLEAN, &byte, sizeof(byte));
+}
+
+void LogStructuredUserDefault::setIntegerForKey(const char* key, int value)
+{
+    int32_t intValue = value;
+    setValue(key, ValueType::INTEGER, &intValue, sizeof(intValue));
+}
+
+void LogStructuredUserDefault::setFloatForKey(const char* key, float value)
+{
+    setDoubleForKey(key, value);
+}
+
+void LogStructuredUserDefault::setDoubleForKey(const char* key, double value)
+{
+    setValue(key, ValueType::DOUBLE, &value, sizeof(value));
+}
+
+void LogStructuredUserDefault::setStringForKey(const char* key, const std::string & value)
+{
+    setValue(key, ValueType::STRING, value.data(), value.size());
+}
+
+void LogStructuredUserDefault::setDataForKey(const char* key, const Data& value)
+{
+    setValue(key, ValueType::DATA, value.getBytes(), (size_t)value.getSize());
+}
+
+void LogStructuredUserDefault::deleteValueForKey(const char* key)
+{
+    if (!key)
+    {
+        CCLOG("the key is invalid");
+        return;
+    }
+
+    auto iter = _values.find(key);
+    if (iter == _values.end())
+    {
+        return;
+    }
+
+    _liveSize -= getRecordSize(iter->first.size(), iter->second.bytes.size());
+    _values.erase(iter);
+    appendRecord(key, ValueType::DELETED, nullptr, 0);
+}
+
+void LogStructuredUserDefault::setValue(const char* key, ValueType type, const void* bytes, size_t size)
+{
+    if (!key)
+    {
+        return;
+    }
+
+    std::string keyString(key);
+    auto iter = _values.find(keyString);
+    if (iter != _values.end())
+    {
+        Value& value = iter->second;
+        // saving the same value again doesn't grow the file
+        if (value.type == type && value.bytes.size() == size && (size == 0 || memcmp(value.bytes.data(), bytes, size) == 0))
+        {
+            return;
+        }
+        _liveSize -= getRecordSize(keyString.size(), value.bytes.size());
+        value.type = type;
+        value.bytes.assign((const char*)bytes, size);
+    }
+    else
+    {
+        Value& value = _values[keyString];
+        value.type = type;
+        value.bytes.assign((const char*)bytes, size);
+    }
+
+    _liveSize += getRecordSize(keyString.size(), size);
+    appendRecord(keyString, type, bytes, size);
+}
+
+void LogStructuredUserDefault::appendRecord(const std::string& key, ValueType type, const void* bytes, size_t size)
+{
+    if (!_file)
+    {
+        return;
+    }
+
+    std::string record;
+    record.reserve(getRecordSize(key.size(), size));
+    encodeRecord(record, key, (unsigned char)type, bytes, size);
+
+    // the record is handed to the OS at once so it survives a crash of the game,
+    // the sync to the disk is batched
+    if (fwrite(record.data(), 1, record.size(), _file) != record.size())
+    {
+        CCLOG("LogStructuredUserDefault: failed to write %s", _filePath.c_str());
+    }
+    fflush(_file);
+    _fileSize += record.size();
+    _unsyncedSize += record.size();
+
+    if (_unsyncedSize >= KV_SYNC_BYTES || utils::gettime() - _lastSyncTime >= KV_SYNC_INTERVAL)
+    {
+        sync();
+    }
+    else
+    {
+        // the deadline has to be kept even if nothing else is appended
+        scheduleSync();
+    }
+}
+
+void LogStructuredUserDefault::scheduleSync()
+{
+    if (_syncScheduled || !_scheduler)
+    {
+        return;
+    }
+
+    _syncScheduled = true;
+    float delay = (float)std::max(KV_SYNC_INTERVAL - (utils::gettime() - _lastSyncTime), 0.0);
+    _scheduler->schedule([this](float) {
+        _syncScheduled = false;
+        sync();
+    }, this, 0, 0, delay, false, KV_SYNC_SCHEDULE_KEY);
+}
+
+void LogStructuredUserDefault::sync()
+{
+    if (_file && _unsyncedSize > 0)
+    {
+        syncFile(_file);
+        _unsyncedSize = 0;
+    }
+    _lastSyncTime = utils::gettime();
+}
+
+void LogStructuredUserDefault::flush()
+{
+    if (_fileSize > KV_COMPACT_MIN_SIZE && _fileSize > 2 * (_liveSize + KV_FILE_HEADER_SIZE))
+    {
+        compact();
+    }
+    sync();
+}
+
+bool LogStructuredUserDefault::compact()
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string tmpPath = _filePath + ".tmp";
+
+    std::string buffer;
+    buffer.reserve(KV_FILE_HEADER_SIZE + _liveSize);
+    buffer.resize(KV_FILE_HEADER_SIZE);
+    memcpy(&buffer[0], KV_FILE_MAGIC, 4);
+    writeUint32((unsigned char*)&buffer[4], KV_FILE_VERSION);
+    for (const auto& iter : _values)
+    {
+        encodeRecord(buffer, iter.first, (unsigned char)iter.second.type, iter.second.bytes.data(), iter.second.bytes.size());
+    }
+
+    FILE* fp = fopen(fileUtils->getSuitableFOpen(tmpPath).c_str(), "wb");
+    if (!fp)
+    {
+        CCLOG("LogStructuredUserDefault: can't open %s", tmpPath.c_str());
+        return false;
+    }
+    bool succeed = fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+    // the new file has to be on the disk before it replaces the old one
+    syncFile(fp);
+    fclose(fp);
+
+    if (_file)
+    {
+        fclose(_file);
+        _file = nullptr;
+    }
+
+    if (!succeed || !fileUtils->renameFile(tmpPath, _filePath))
+    {
+        CCLOG("LogStructuredUserDefault: failed to compact %s", _filePath.c_str());
+        fileUtils->removeFile(tmpPath);
+        return openForAppend();
+    }
+
+    _fileSize = buffer.size();
+    _unsyncedSize = 0;
+    return openForAppend();
+}
+
+NS_CC_END
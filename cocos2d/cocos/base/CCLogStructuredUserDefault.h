@@ -0,0 +1,155 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CCLOGSTRUCTUREDUSERDEFAULT_H__
+#define __SUPPORT_CCLOGSTRUCTUREDUSERDEFAULT_H__
+
+#include "base/CCUserDefault.h"
+#include <stdio.h>
+#include <unordered_map>
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+class Scheduler;
+
+/**
+ * LogStructuredUserDefault is a UserDefault implementation that keeps all values in a hash map
+ * and persists them in an append-only binary file.
+ *
+ * Each set or delete appends one checksummed record to the file instead of rewriting it, so the cost
+ * doesn't grow with the number of keys. Records are handed to the OS at once, and synced to the disk
+ * by flush(), once enough data has accumulated, or by the scheduler about a second after the first
+ * unsynced record. A torn record at the end of the file, left by a crash, is dropped when the file is
+ * loaded; a file without a valid header is renamed to "<file>.corrupt" and the store starts over.
+ * The file is compacted when most of its records are overwritten ones.
+ *
+ * Select it at startup, before UserDefault is used:
+ * @code
+ * UserDefault::setDelegate(LogStructuredUserDefault::create());
+ * @endcode
+ * On the platforms that store UserDefault in an XML file, the values of that file are imported
+ * the first time the binary file is created.
+ */
+class CC_DLL LogStructuredUserDefault : public UserDefault
+{
+public:
+    /**
+     * Creates the store and loads the file.
+     * @param filePath The full path of the file, it's "UserDefault.bin" in the writable path if empty.
+     * @return The store, or nullptr if the file can't be opened.
+     * @js NA
+     */
+    static LogStructuredUserDefault* create(const std::string& filePath = "");
+
+    using UserDefault::getBoolForKey;
+    using UserDefault::getIntegerForKey;
+    using UserDefault::getFloatForKey;
+    using UserDefault::getDoubleForKey;
+    using UserDefault::getStringForKey;
+    using UserDefault::getDataForKey;
+
+    // UserDefault
+    virtual bool getBoolForKey(const char* key, bool defaultValue) override;
+    virtual int getIntegerForKey(const char* key, int defaultValue) override;
+    virtual float getFloatForKey(const char* key, float defaultValue) override;
+    virtual double getDoubleForKey(const char* key, double defaultValue) override;
+    virtual std::string getStringForKey(const char* key, const std::string & defaultValue) override;
+    virtual Data getDataForKey(const char* key, const Data& defaultValue) override;
+
+    virtual void setBoolForKey(const char* key, bool value) override;
+    virtual void setIntegerForKey(const char* key, int value) override;
+    virtual void setFloatForKey(const char* key, float value) override;
+    virtual void setDoubleForKey(const char* key, double value) override;
+    virtual void setStringForKey(const char* key, const std::string & value) override;
+    virtual void setDataForKey(const char* key, const Data& value) override;
+
+    /**
+     * Syncs the appended records to the disk, and compacts the file if needed.
+     * @js NA
+     */
+    virtual void flush() override;
+
+    virtual void deleteValueForKey(const char* key) override;
+
+    /** Returns the full path of the file. */
+    const std::string& getFilePath() const { return _filePath; }
+
+protected:
+    LogStructuredUserDefault();
+    virtual ~LogStructuredUserDefault();
+
+    bool init(const std::string& filePath);
+
+private:
+    enum class ValueType : unsigned char
+    {
+        DELETED = 0,
+        BOOLEAN,
+        INTEGER,
+        DOUBLE,
+        STRING,
+        DATA
+    };
+
+    struct Value
+    {
+        ValueType type;
+        std::string bytes;
+    };
+
+    static bool isValidValue(ValueType type, size_t size);
+    bool load();
+    bool moveCorruptedFileAside();
+    void importXMLFile();
+    const Value* findValue(const char* key) const;
+    std::string getValueAsString(const Value& value) const;
+    void setValue(const char* key, ValueType type, const void* bytes, size_t size);
+    void appendRecord(const std::string& key, ValueType type, const void* bytes, size_t size);
+    bool openForAppend();
+    void sync();
+    void scheduleSync();
+    bool compact();
+
+    std::string _filePath;
+    FILE* _file;
+    std::unordered_map<std::string, Value> _values;
+    /// Size of the file, and size of the records of the live values in it
+    size_t _fileSize;
+    size_t _liveSize;
+    /// Bytes appended since the last sync
+    size_t _unsyncedSize;
+    double _lastSyncTime;
+    /// Runs the sync that is due KV_SYNC_INTERVAL after the first unsynced record
+    Scheduler* _scheduler;
+    bool _syncScheduled;
+};
+
+NS_CC_END
+// end of base group
+/** @} */
+
+#endif // __SUPPORT_CCLOGSTRUCTUREDUSERDEFAULT_H__
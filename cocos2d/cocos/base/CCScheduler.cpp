@@ -33,41 +33,43 @@ THE SOFTWARE.
 #include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 // data structures
 
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    ccSchedulerFunc     callback;
-    void                *target;
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
+// Flags of the "updates with priority"
+static const unsigned char UPDATE_PAUSED = 1 << 0;
+static const unsigned char UPDATE_DELETED = 1 << 1; // selector will no longer be called and entry will be removed at end of the next tick
 
-typedef struct _hashUpdateEntry
-{
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    void                *target;
-    ccSchedulerFunc     callback;
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
+// Set in Scheduler::_updateIndices for the updates of Scheduler::_pendingUpdates
+static const unsigned int PENDING_UPDATE = 0x80000000u;
 
 // Hash Element used for "selectors with interval"
 typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
     Timer               *currentTimer;
+    unsigned int        order;
     bool                paused;
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// Timing wheel of the timers: WHEEL_LEVELS levels of WHEEL_SLOTS slots, each slot of a level covering
+// WHEEL_SLOTS slots of the level below. A slot of the first level lasts one tick.
+static const int WHEEL_BITS = 8;
+static const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+static const int WHEEL_LEVELS = 4;
+static const double WHEEL_TICKS_PER_SECOND = 1000.0;
+
+// Timer::_wheelSlot of the timers that aren't in a slot of the wheel
+static const int TIMER_DETACHED = -1;   // not scheduled anymore
+static const int TIMER_DUE = -2;        // in Scheduler::_dueTimers or Scheduler::_timersToUpdate
+static const int TIMER_UPDATING = -3;   // being updated
+static const int TIMER_PARKED = -4;     // its target is paused, _dueTime and _lastUpdateTime are relative to the pause
+
 // implementation Timer
 
 Timer::Timer()
@@ -80,6 +82,13 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _schedulerEntry(nullptr)
+, _wheelPrev(nullptr)
+, _wheelNext(nullptr)
+, _wheelSlot(TIMER_DETACHED)
+, _dueTime(0)
+, _lastUpdateTime(0)
+, _order(0)
 {
 }
 
@@ -151,6 +160,18 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+float Timer::getTimeToNextTrigger() const
+{
+    // the first update only starts the timer
+    if (_elapsed == -1)
+    {
+        return 0;
+    }
+
+    float remaining = (_useDelay ? _delay : _interval) - _elapsed;
+    return remaining > 0 ? remaining : 0;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -252,14 +273,18 @@ const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(nullptr)
-, _updates0List(nullptr)
-, _updatesPosList(nullptr)
-, _hashForUpdates(nullptr)
+, _updatesDirty(false)
 , _hashForTimers(nullptr)
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
+, _timerTime(0)
+, _lastTimerTime(0)
+, _wheelTick(0)
+, _timerWheel(WHEEL_SLOTS * WHEEL_LEVELS, nullptr)
+, _timerUpdateIndex(-1)
+, _targetCounter(0)
+, _timerCounter(0)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
@@ -271,6 +296,9 @@ Scheduler::Scheduler(void)
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
+
+    for (auto& timer : _dueTimers)
+        timer->release();
 }
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
@@ -297,6 +325,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = _targetCounter++;
 
         HASH_ADD_PTR(_hashForTimers, target, element);
 
@@ -322,6 +351,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                rescheduleTimer(timer);
                 return;
             }
         }
@@ -331,6 +361,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -362,14 +393,9 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     timer->setAborted();
                 }
 
+                detachTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
@@ -388,118 +414,116 @@ void Scheduler::unschedule(const std::string &key, void *target)
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
+void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
-
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = nullptr;
-    listElement->markedForDeletion = false;
-
-    // empty list ?
-    if (! *list)
-    {
-        DL_APPEND(*list, listElement);
-    }
-    else
+    auto iter = _updateIndices.find(target);
+    if (iter != _updateIndices.end())
     {
-        bool added = false;
+        unsigned int index = iter->second;
+        int currentPriority = (index & PENDING_UPDATE) ? _pendingUpdates[index & ~PENDING_UPDATE].priority : _updatePriorities[index];
 
-        for (tListEntry *element = *list; element; element = element->next)
+        // change priority: should unschedule it first
+        if (currentPriority != priority)
         {
-            if (priority < element->priority)
-            {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
-
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
-
-                added = true;
-                break;
-            }
+            unscheduleUpdate(target);
         }
-
-        // Not added? priority has the higher value. Append it.
-        if (! added)
+        else
         {
-            DL_APPEND(*list, listElement);
+            // don't add it again
+            CCLOG("warning: don't update it again");
+            return;
         }
     }
 
-    // update hash entry for quick access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
-}
+    // the update is sorted in by priority before the next frame
+    PendingUpdate update;
+    update.callback = callback;
+    update.target = target;
+    update.priority = priority;
+    update.flags = paused ? UPDATE_PAUSED : 0;
 
-void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused)
-{
-    tListEntry *listElement = new (std::nothrow) tListEntry();
-
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->priority = 0;
-    listElement->markedForDeletion = false;
-
-    DL_APPEND(*list, listElement);
-
-    // update hash entry for quicker access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+    _updateIndices[target] = (unsigned int)_pendingUpdates.size() | PENDING_UPDATE;
+    _pendingUpdates.push_back(std::move(update));
+    _updatesDirty = true;
 }
 
-void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused)
+void Scheduler::flushUpdates()
 {
-    tHashUpdateEntry *hashElement = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, hashElement);
-    if (hashElement)
+    if (!_updatesDirty)
     {
-        // change priority: should unschedule it first
-        if (hashElement->entry->priority != priority)
+        return;
+    }
+    _updatesDirty = false;
+
+    // remove the deleted updates
+    size_t count = _updateTargets.size();
+    size_t firstMoved = count;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (_updateFlags[i] & UPDATE_DELETED)
         {
-            unscheduleUpdate(target);
+            firstMoved = std::min(firstMoved, i);
+            continue;
         }
-        else
+
+        if (kept != i)
         {
-            // don't add it again
-            CCLOG("warning: don't update it again");
-            return;
+            _updatePriorities[kept] = _updatePriorities[i];
+            _updateFlags[kept] = _updateFlags[i];
+            _updateTargets[kept] = _updateTargets[i];
+            _updateCallbacks[kept] = std::move(_updateCallbacks[i]);
         }
+        ++kept;
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, callback, target, paused);
-    }
-    else if (priority < 0)
+    _pendingUpdates.erase(std::remove_if(_pendingUpdates.begin(), _pendingUpdates.end(), [](const PendingUpdate& update) {
+        return (update.flags & UPDATE_DELETED) != 0;
+    }), _pendingUpdates.end());
+
+    size_t pendingCount = _pendingUpdates.size();
+    size_t total = kept + pendingCount;
+    _updatePriorities.resize(total);
+    _updateFlags.resize(total);
+    _updateTargets.resize(total);
+    _updateCallbacks.resize(total);
+
+    // merge the pending updates from the back, they go after the updates of the same priority
+    if (pendingCount > 0)
     {
-        priorityIn(&_updatesNegList, callback, target, priority, paused);
+        std::stable_sort(_pendingUpdates.begin(), _pendingUpdates.end(), [](const PendingUpdate& a, const PendingUpdate& b) {
+            return a.priority < b.priority;
+        });
+
+        ssize_t i = (ssize_t)kept - 1;
+        ssize_t j = (ssize_t)pendingCount - 1;
+        for (ssize_t k = (ssize_t)total - 1; j >= 0; --k)
+        {
+            if (i >= 0 && _updatePriorities[i] > _pendingUpdates[j].priority)
+            {
+                _updatePriorities[k] = _updatePriorities[i];
+                _updateFlags[k] = _updateFlags[i];
+                _updateTargets[k] = _updateTargets[i];
+                _updateCallbacks[k] = std::move(_updateCallbacks[i]);
+                --i;
+            }
+            else
+            {
+                PendingUpdate& update = _pendingUpdates[j];
+                _updatePriorities[k] = update.priority;
+                _updateFlags[k] = update.flags;
+                _updateTargets[k] = update.target;
+                _updateCallbacks[k] = std::move(update.callback);
+                --j;
+            }
+        }
+        firstMoved = std::min(firstMoved, (size_t)(i + 1));
+        _pendingUpdates.clear();
     }
-    else
+
+    for (size_t i = firstMoved; i < total; ++i)
     {
-        // priority > 0
-        priorityIn(&_updatesPosList, callback, target, priority, paused);
+        _updateIndices[_updateTargets[i]] = (unsigned int)i;
     }
 }
 
@@ -534,40 +558,37 @@ bool Scheduler::isScheduled(const std::string& key, const void *target) const
     return false;
 }
 
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
+void Scheduler::unscheduleUpdate(void *target)
 {
-    tHashUpdateEntry *element = nullptr;
-
-    HASH_FIND_PTR(_hashForUpdates, &entry->target, element);
-    if (element)
+    if (target == nullptr)
     {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        if (!_updateHashLocked)
-            CC_SAFE_DELETE(element->entry);
-        else
-        {
-            element->entry->markedForDeletion = true;
-            _updateDeleteVector.push_back(element->entry);
-        }
-
-        // hash entry
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
+        return;
     }
-}
 
-void Scheduler::unscheduleUpdate(void *target)
-{
-    if (target == nullptr)
+    auto iter = _updateIndices.find(target);
+    if (iter == _updateIndices.end())
     {
         return;
     }
 
-    tHashUpdateEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, element);
-    if (element)
-        this->removeUpdateFromHash(element->entry);
+    // the entry is removed from the arrays when they are flushed, the callback can't be released while it is called
+    unsigned int index = iter->second;
+    if (index & PENDING_UPDATE)
+    {
+        PendingUpdate& update = _pendingUpdates[index & ~PENDING_UPDATE];
+        update.flags |= UPDATE_DELETED;
+        if (!_updateHashLocked)
+            update.callback = nullptr;
+    }
+    else
+    {
+        _updateFlags[index] |= UPDATE_DELETED;
+        if (!_updateHashLocked)
+            _updateCallbacks[index] = nullptr;
+    }
+
+    _updateIndices.erase(iter);
+    _updatesDirty = true;
 }
 
 void Scheduler::unscheduleAll(void)
@@ -590,31 +611,19 @@ void Scheduler::unscheduleAllWithMinPriority(int minPriority)
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (size_t i = 0, count = _updateTargets.size(); i < count; ++i)
     {
-        DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+        if (!(_updateFlags[i] & UPDATE_DELETED) && _updatePriorities[i] >= minPriority)
         {
-            if(entry->priority >= minPriority)
-            {
-                unscheduleUpdate(entry->target);
-            }
-        }
-    }
-
-    if(minPriority <= 0)
-    {
-        DL_FOREACH_SAFE(_updates0List, entry, tmp)
-        {
-            unscheduleUpdate(entry->target);
+            unscheduleUpdate(_updateTargets[i]);
         }
     }
 
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    for (auto& update : _pendingUpdates)
     {
-        if(entry->priority >= minPriority)
+        if (!(update.flags & UPDATE_DELETED) && update.priority >= minPriority)
         {
-            unscheduleUpdate(entry->target);
+            unscheduleUpdate(update.target);
         }
     }
 #if CC_ENABLE_SCRIPT_BINDING
@@ -642,6 +651,11 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimer->setAborted();
         }
+
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            detachTimer((Timer*)element->timers->arr[i]);
+        }
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -690,16 +704,16 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        setTimersPaused(element, false);
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto iter = _updateIndices.find(target);
+    if (iter != _updateIndices.end())
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = false;
+        unsigned int index = iter->second;
+        unsigned char& flags = (index & PENDING_UPDATE) ? _pendingUpdates[index & ~PENDING_UPDATE].flags : _updateFlags[index];
+        flags &= ~UPDATE_PAUSED;
     }
 }
 
@@ -712,16 +726,16 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto iter = _updateIndices.find(target);
+    if (iter != _updateIndices.end())
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = true;
+        unsigned int index = iter->second;
+        unsigned char& flags = (index & PENDING_UPDATE) ? _pendingUpdates[index & ~PENDING_UPDATE].flags : _updateFlags[index];
+        flags |= UPDATE_PAUSED;
     }
 }
 
@@ -738,11 +752,12 @@ bool Scheduler::isTargetPaused(void *target)
     }
     
     // We should check update selectors if target does not have custom selectors
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if ( elementUpdate )
+    auto iter = _updateIndices.find(target);
+    if (iter != _updateIndices.end())
     {
-        return elementUpdate->entry->paused;
+        unsigned int index = iter->second;
+        unsigned char flags = (index & PENDING_UPDATE) ? _pendingUpdates[index & ~PENDING_UPDATE].flags : _updateFlags[index];
+        return (flags & UPDATE_PAUSED) != 0;
     }
     
     return false;  // should never get here
@@ -761,39 +776,26 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
         idsWithSelectors.insert(element->target);
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
-    {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
-        {
-            if(entry->priority >= minPriority)
-            {
-                entry->paused = true;
-                idsWithSelectors.insert(entry->target);
-            }
-        }
-    }
-
-    if(minPriority <= 0)
+    for (size_t i = 0, count = _updateTargets.size(); i < count; ++i)
     {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
+        if (!(_updateFlags[i] & UPDATE_DELETED) && _updatePriorities[i] >= minPriority)
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            _updateFlags[i] |= UPDATE_PAUSED;
+            idsWithSelectors.insert(_updateTargets[i]);
         }
     }
 
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
+    for (auto& update : _pendingUpdates)
     {
-        if(entry->priority >= minPriority) 
+        if (!(update.flags & UPDATE_DELETED) && update.priority >= minPriority)
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            update.flags |= UPDATE_PAUSED;
+            idsWithSelectors.insert(update.target);
         }
     }
 
@@ -819,96 +821,354 @@ void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
     _functionsToPerform.clear();
 }
 
-// main loop
-void Scheduler::update(float dt)
+// timing wheel
+
+void Scheduler::addTimer(tHashTimerEntry *element, Timer *timer)
 {
-    _updateHashLocked = true;
+    timer->_schedulerEntry = element;
+    timer->_order = ((uint64_t)element->order << 32) | _timerCounter++;
+    timer->_lastUpdateTime = _timerTime;
 
-    if (_timeScale != 1.0f)
+    // the first update only starts the timer
+    insertTimer(timer, _timerTime);
+}
+
+void Scheduler::insertTimer(Timer *timer, double dueTime)
+{
+    timer->_dueTime = dueTime;
+
+    if (timer->_schedulerEntry->paused)
     {
-        dt *= _timeScale;
+        parkTimer(timer, getTimerTime(timer));
+    }
+    else if (dueTime <= _timerTime)
+    {
+        queueTimer(timer);
+    }
+    else
+    {
+        linkTimer(timer, (uint64_t)(dueTime * WHEEL_TICKS_PER_SECOND));
     }
+}
 
-    //
-    // Selector callbacks
-    //
+void Scheduler::queueTimer(Timer *timer)
+{
+    timer->retain();
+    timer->_wheelSlot = TIMER_DUE;
 
-    // Iterate over all the Updates' selectors
-    tListEntry *entry, *tmp;
+    // Timers used to be updated target by target. During the timer pass, a timer that comes after
+    // the one being updated is still updated by this pass.
+    if (_timerUpdateIndex >= 0 && _timersToUpdate[_timerUpdateIndex]->_order < timer->_order)
+    {
+        auto position = std::upper_bound(_timersToUpdate.begin() + _timerUpdateIndex + 1, _timersToUpdate.end(), timer, [](const Timer* a, const Timer* b) {
+            return a->_order < b->_order;
+        });
+        _timersToUpdate.insert(position, timer);
+    }
+    else
+    {
+        _dueTimers.push_back(timer);
+    }
+}
+
+double Scheduler::getTimerTime(const Timer *timer) const
+{
+    if (_timerUpdateIndex >= 0 && _timersToUpdate[_timerUpdateIndex]->_order < timer->_order)
+    {
+        return _lastTimerTime;
+    }
+    return _timerTime;
+}
 
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+void Scheduler::rescheduleTimer(Timer *timer)
+{
+    // the timer was set up again, its next update starts it
+    if (timer->_wheelSlot >= 0)
+    {
+        unlinkTimer(timer);
+        insertTimer(timer, _timerTime);
+    }
+    else if (timer->_wheelSlot == TIMER_PARKED)
+    {
+        timer->_dueTime = 0;
+    }
+}
+
+void Scheduler::detachTimer(Timer *timer)
+{
+    // the due lists keep a reference on their timers, they skip the detached ones
+    if (timer->_wheelSlot >= 0)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        unlinkTimer(timer);
+    }
+    timer->_wheelSlot = TIMER_DETACHED;
+}
+
+void Scheduler::linkTimer(Timer *timer, uint64_t dueTick)
+{
+    if (dueTick <= _wheelTick)
+    {
+        dueTick = _wheelTick + 1;
+    }
+
+    uint64_t delta = dueTick - _wheelTick;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (WHEEL_BITS * (level + 1))))
+    {
+        ++level;
+    }
+
+    // timers due after the range of the wheel wait in the last slot of the last level, they are placed again when it comes
+    if (delta >= ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)))
+    {
+        dueTick = _wheelTick + ((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+    }
+
+    int slot = level * WHEEL_SLOTS + (int)((dueTick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+    Timer*& head = _timerWheel[slot];
+    timer->_wheelPrev = nullptr;
+    timer->_wheelNext = head;
+    if (head)
+    {
+        head->_wheelPrev = timer;
+    }
+    head = timer;
+    timer->_wheelSlot = slot;
+}
+
+void Scheduler::unlinkTimer(Timer *timer)
+{
+    if (timer->_wheelPrev)
+    {
+        timer->_wheelPrev->_wheelNext = timer->_wheelNext;
+    }
+    else
+    {
+        _timerWheel[timer->_wheelSlot] = timer->_wheelNext;
+    }
+
+    if (timer->_wheelNext)
+    {
+        timer->_wheelNext->_wheelPrev = timer->_wheelPrev;
+    }
+
+    timer->_wheelPrev = nullptr;
+    timer->_wheelNext = nullptr;
+    timer->_wheelSlot = TIMER_DETACHED;
+}
+
+void Scheduler::parkTimer(Timer *timer, double time)
+{
+    // a paused timer doesn't see the time pass, keep its times relative to the pause
+    timer->_wheelSlot = TIMER_PARKED;
+    timer->_dueTime -= time;
+    timer->_lastUpdateTime -= time;
+}
+
+void Scheduler::setTimersPaused(tHashTimerEntry *element, bool paused)
+{
+    if (element->paused == paused)
+    {
+        return;
+    }
+    element->paused = paused;
+
+    if (element->timers == nullptr)
+    {
+        return;
+    }
+
+    // due timers are parked when the timer pass finds them paused
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = (Timer*)element->timers->arr[i];
+        if (paused && timer->_wheelSlot >= 0)
         {
-            entry->callback(dt);
+            unlinkTimer(timer);
+            parkTimer(timer, getTimerTime(timer));
+        }
+        else if (!paused && timer->_wheelSlot == TIMER_PARKED)
+        {
+            double time = getTimerTime(timer);
+            timer->_wheelSlot = TIMER_DETACHED;
+            timer->_lastUpdateTime += time;
+            insertTimer(timer, timer->_dueTime + time);
         }
     }
+}
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
-    {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+void Scheduler::advanceTimerWheel()
+{
+    auto placeTimersOfSlot = [this](int slot) {
+        Timer *timer = _timerWheel[slot];
+        _timerWheel[slot] = nullptr;
+        while (timer)
         {
-            entry->callback(dt);
+            Timer *next = timer->_wheelNext;
+            timer->_wheelPrev = nullptr;
+            timer->_wheelNext = nullptr;
+            timer->_wheelSlot = TIMER_DETACHED;
+            insertTimer(timer, timer->_dueTime);
+            timer = next;
         }
+    };
+
+    uint64_t targetTick = (uint64_t)(_timerTime * WHEEL_TICKS_PER_SECOND);
+    if (targetTick <= _wheelTick)
+    {
+        return;
     }
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    // after a long frame, placing every timer again is cheaper than walking the slots
+    if (targetTick - _wheelTick >= (uint64_t)WHEEL_SLOTS * WHEEL_SLOTS)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        std::vector<Timer*> timers;
+        for (auto& head : _timerWheel)
+        {
+            for (Timer *timer = head; timer; timer = timer->_wheelNext)
+            {
+                timers.push_back(timer);
+            }
+        }
+
+        std::fill(_timerWheel.begin(), _timerWheel.end(), nullptr);
+        _wheelTick = targetTick;
+        for (auto& timer : timers)
         {
-            entry->callback(dt);
+            timer->_wheelPrev = nullptr;
+            timer->_wheelNext = nullptr;
+            timer->_wheelSlot = TIMER_DETACHED;
+            insertTimer(timer, timer->_dueTime);
         }
+        return;
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    while (_wheelTick < targetTick)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        ++_wheelTick;
 
-        if (! _currentTarget->paused)
+        // when a slot of an upper level starts, its timers move down, highest level first
+        for (int level = WHEEL_LEVELS - 1; level > 0; --level)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            if ((_wheelTick & (((uint64_t)1 << (WHEEL_BITS * level)) - 1)) == 0)
             {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
+                placeTimersOfSlot(level * WHEEL_SLOTS + (int)((_wheelTick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)));
+            }
+        }
 
-                elt->currentTimer->update(dt);
+        placeTimersOfSlot((int)(_wheelTick & (WHEEL_SLOTS - 1)));
+    }
+}
 
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+void Scheduler::updateTimer(Timer *timer)
+{
+    tHashTimerEntry *element = timer->_schedulerEntry;
+    if (element->paused)
+    {
+        // paused before its turn, it didn't see the current frame
+        parkTimer(timer, _lastTimerTime);
+        return;
+    }
 
-                elt->currentTimer = nullptr;
-            }
+    _currentTarget = element;
+    _currentTargetSalvaged = false;
+
+    CCASSERT
+      ( !timer->isAborted(),
+        "An aborted timer should not be updated" );
+
+    element->currentTimer = timer;
+    timer->_wheelSlot = TIMER_UPDATING;
+
+    // the timer didn't trigger since its last update, give it all the time elapsed since then
+    float dt = (float)(_timerTime - timer->_lastUpdateTime);
+    timer->_lastUpdateTime = _timerTime;
+    timer->update(dt);
+
+    element->currentTimer = nullptr;
+
+    if (timer->isAborted())
+    {
+        // The currentTimer told the remove itself. To prevent the timer from
+        // accidentally deallocating itself before finishing its step, we retained
+        // it. Now that step is done, it's safe to release it.
+        timer->release();
+    }
+    else if (timer->_wheelSlot == TIMER_UPDATING)
+    {
+        timer->_wheelSlot = TIMER_DETACHED;
+        insertTimer(timer, _timerTime + timer->getTimeToNextTrigger());
+    }
+
+    // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+    if (_currentTargetSalvaged && element->timers->num == 0)
+    {
+        removeHashElement(element);
+    }
+    _currentTarget = nullptr;
+}
+
+// main loop
+void Scheduler::update(float dt)
+{
+    _updateHashLocked = true;
+
+    if (_timeScale != 1.0f)
+    {
+        dt *= _timeScale;
+    }
+
+    //
+    // Selector callbacks
+    //
+
+    // sort in the updates scheduled since the last frame
+    flushUpdates();
+
+    // Iterate over all the Updates' selectors, they are sorted by priority
+    for (size_t i = 0, count = _updateTargets.size(); i < count; ++i)
+    {
+        if (_updateFlags[i] == 0)
+        {
+            _updateCallbacks[i](dt);
+        }
+    }
+
+    // updates scheduled during this frame are called after the others, then sorted in for the next frames
+    for (size_t i = 0; i < _pendingUpdates.size(); ++i)
+    {
+        if (_pendingUpdates[i].flags == 0)
+        {
+            _pendingUpdates[i].callback(dt);
         }
+    }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+    // Iterate over the due custom selectors, in the order they were scheduled target by target
+    _lastTimerTime = _timerTime;
+    _timerTime += dt;
+    advanceTimerWheel();
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+    _timersToUpdate.swap(_dueTimers);
+    std::sort(_timersToUpdate.begin(), _timersToUpdate.end(), [](const Timer* a, const Timer* b) {
+        return a->_order < b->_order;
+    });
+
+    // The '_timersToUpdate' array may change while inside this loop
+    for (_timerUpdateIndex = 0; _timerUpdateIndex < (ssize_t)_timersToUpdate.size(); ++_timerUpdateIndex)
+    {
+        Timer *timer = _timersToUpdate[_timerUpdateIndex];
+        if (timer->_wheelSlot == TIMER_DUE)
         {
-            removeHashElement(_currentTarget);
+            updateTimer(timer);
         }
+        timer->release();
     }
+    _timersToUpdate.clear();
+    _timerUpdateIndex = -1;
+    _lastTimerTime = _timerTime;
  
     // delete all updates that are removed in update
-    for (auto &e : _updateDeleteVector)
-        delete e;
-
-    _updateDeleteVector.clear();
+    flushUpdates();
 
     _updateHashLocked = false;
     _currentTarget = nullptr;
@@ -964,6 +1224,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = _targetCounter++;
         
         HASH_ADD_PTR(_hashForTimers, target, element);
         
@@ -989,6 +1250,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                rescheduleTimer(timer);
                 return;
             }
         }
@@ -998,6 +1260,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -1062,14 +1325,9 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     timer->setAborted();
                 }
                 
+                detachTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
@@ -32,6 +32,10 @@ THE SOFTWARE.
 #include <functional>
 #include <mutex>
 #include <set>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
@@ -40,6 +44,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Scheduler;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 
@@ -61,8 +66,13 @@ public:
     
     /** triggers the timer */
     void update(float dt);
+
+    /** Returns the time left before the timer triggers, 0 if it has to be updated next frame. */
+    float getTimeToNextTrigger() const;
     
 protected:
+    friend class Scheduler;
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -72,6 +82,15 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    // timing wheel bookkeeping, owned by the scheduler
+    struct _hashSelectorEntry* _schedulerEntry;
+    Timer* _wheelPrev;
+    Timer* _wheelNext;
+    int _wheelSlot;
+    double _dueTime;
+    double _lastUpdateTime;
+    uint64_t _order;
 };
 
 
@@ -140,10 +159,6 @@ private:
  * @{
  */
 
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 #if CC_ENABLE_SCRIPT_BINDING
 class SchedulerScriptHandlerEntry;
 #endif
@@ -508,24 +523,50 @@ protected:
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     
     void removeHashElement(struct _hashSelectorEntry *element);
-    void removeUpdateFromHash(struct _listEntry *entry);
 
     // update specific
 
-    void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
-    void appendIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused);
+    void flushUpdates();
+
+    // timer specific
 
+    void addTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void insertTimer(Timer *timer, double dueTime);
+    void queueTimer(Timer *timer);
+    void rescheduleTimer(Timer *timer);
+    void detachTimer(Timer *timer);
+    void linkTimer(Timer *timer, uint64_t dueTick);
+    void unlinkTimer(Timer *timer);
+    void parkTimer(Timer *timer, double time);
+    double getTimerTime(const Timer *timer) const;
+    void setTimersPaused(struct _hashSelectorEntry *element, bool paused);
+    void advanceTimerWheel();
+    void updateTimer(Timer *timer);
 
     float _timeScale;
 
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-    std::vector<struct _listEntry *> _updateDeleteVector; // the vector holds list entries that needs to be deleted after update
+    // parallel arrays sorted by priority, they are walked every frame
+    std::vector<int> _updatePriorities;
+    std::vector<unsigned char> _updateFlags;
+    std::vector<void*> _updateTargets;
+    std::vector<ccSchedulerFunc> _updateCallbacks;
+    // updates scheduled since the arrays were sorted. A deque, so that updates scheduled while
+    // the pending ones are called don't move them.
+    struct PendingUpdate
+    {
+        ccSchedulerFunc callback;
+        void *target;
+        int priority;
+        unsigned char flags;
+    };
+    std::deque<PendingUpdate> _pendingUpdates;
+    // index of the update of each target in the arrays, or in _pendingUpdates with the PENDING_UPDATE bit
+    std::unordered_map<void*, unsigned int> _updateIndices;
+    // whether updates were removed from the arrays or are pending
+    bool _updatesDirty;
 
     // Used for "selectors with interval"
     struct _hashSelectorEntry *_hashForTimers;
@@ -533,6 +574,20 @@ protected:
     bool _currentTargetSalvaged;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
+
+    // hierarchical timing wheel holding the timers, so only the due ones are updated
+    double _timerTime;
+    // _timerTime before the current frame, the timers updated after the current one haven't seen the frame yet
+    double _lastTimerTime;
+    uint64_t _wheelTick;
+    std::vector<Timer*> _timerWheel;
+    // timers to update during the next timer pass, and the ones of the current pass. Both retain the timers.
+    std::vector<Timer*> _dueTimers;
+    std::vector<Timer*> _timersToUpdate;
+    // index in _timersToUpdate of the timer being updated, -1 outside of the timer pass
+    ssize_t _timerUpdateIndex;
+    unsigned int _targetCounter;
+    unsigned int _timerCounter;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
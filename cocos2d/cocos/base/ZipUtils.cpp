@@ -41,6 +41,18 @@
 #include "base/ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include <map>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <errno.h>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <unistd.h>
+#define CC_ZIP_USE_PREAD 1
+#else
+#define CC_ZIP_USE_PREAD 0
+#endif
 
 // FIXME: Other platforms should use upstream minizip like mingw-w64  
 #ifdef MINIZIP_FROM_SYSTEM
@@ -501,22 +513,209 @@ void ZipUtils::setPvrEncryptionKey(unsigned int keyPart1, unsigned int keyPart2,
 
 static const std::string emptyFilename("");
 
+// the compressed data of an entry is read in chunks of this size when it's inflated
+static const size_t ZIP_READ_CHUNK_SIZE = 64 * 1024;
+
+// values of ZipEntryInfo::dataOffset before the local header is parsed, or if it can't be
+static const int64_t ZIP_DATA_OFFSET_UNKNOWN = -1;
+static const int64_t ZIP_DATA_OFFSET_INVALID = -2;
+
 struct ZipEntryInfo
 {
     unz_file_pos pos;
     uLong uncompressed_size;
+    uLong compressed_size;
+    uLong compression_method;
+    uLong flag;
+    uLong crc;
+    // offset of the compressed data in the file, it's resolved on the first read of the entry
+    int64_t dataOffset;
 };
 
 class ZipFilePrivate
 {
 public:
+    ZipFilePrivate()
+    : zipFile(nullptr)
+    , fd(-1)
+    {
+    }
+
+    ~ZipFilePrivate()
+    {
+        if (zipFile)
+        {
+            unzClose(zipFile);
+        }
+#if CC_ZIP_USE_PREAD
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+#endif
+    }
+
+    /**
+     * Reads the uncompressed data of an entry into out, which must hold entry.uncompressed_size bytes.
+     *
+     * Stored and deflated entries of a zip file opened from a path are read with pread() and inflated
+     * on the calling thread, so several threads can read entries at the same time. The others are read
+     * with minizip, one at a time.
+     */
+    bool readEntry(ZipEntryInfo& entry, unsigned char* out);
+
     unzFile zipFile;
+    // minizip reads through a single cursor, so zipFile is used by one thread at a time
+    std::mutex zipFileMutex;
+    // file descriptor of the zip file used for concurrent reads, -1 if the zip file is in memory
+    int fd;
     
     // std::unordered_map is faster if available on the platform
     typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+
+private:
+    int64_t locateEntryData(ZipEntryInfo& entry);
+    bool readEntryConcurrently(const ZipEntryInfo& entry, int64_t dataOffset, unsigned char* out);
+    bool readEntryWithMinizip(ZipEntryInfo& entry, unsigned char* out);
+    bool readFully(int64_t offset, unsigned char* out, size_t size);
 };
 
+int64_t ZipFilePrivate::locateEntryData(ZipEntryInfo& entry)
+{
+    // opening the entry in raw mode parses its local header without initializing an inflate stream
+    if (unzGoToFilePos(zipFile, &entry.pos) != UNZ_OK
+        || unzOpenCurrentFile2(zipFile, nullptr, nullptr, 1) != UNZ_OK)
+    {
+        return ZIP_DATA_OFFSET_INVALID;
+    }
+    int64_t offset = (int64_t)unzGetCurrentFileZStreamPos64(zipFile);
+    unzCloseCurrentFile(zipFile);
+    return offset > 0 ? offset : ZIP_DATA_OFFSET_INVALID;
+}
+
+bool ZipFilePrivate::readFully(int64_t offset, unsigned char* out, size_t size)
+{
+#if CC_ZIP_USE_PREAD
+    while (size > 0)
+    {
+        ssize_t n = pread(fd, out, size, (off_t)offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        out += n;
+        offset += n;
+        size -= (size_t)n;
+    }
+    return true;
+#else
+    CC_UNUSED_PARAM(offset);
+    CC_UNUSED_PARAM(out);
+    CC_UNUSED_PARAM(size);
+    return false;
+#endif
+}
+
+bool ZipFilePrivate::readEntryConcurrently(const ZipEntryInfo& entry, int64_t dataOffset, unsigned char* out)
+{
+    if (entry.compression_method == 0)
+    {
+        // stored entries are read straight into the output buffer
+        if (entry.compressed_size != entry.uncompressed_size
+            || !readFully(dataOffset, out, entry.uncompressed_size))
+        {
+            return false;
+        }
+        return crc32(0L, out, (uInt)entry.uncompressed_size) == entry.crc;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    {
+        return false;
+    }
+
+    size_t chunkSize = std::min((size_t)entry.compressed_size, ZIP_READ_CHUNK_SIZE);
+    std::unique_ptr<unsigned char[]> chunk(new (std::nothrow) unsigned char[chunkSize > 0 ? chunkSize : 1]);
+    stream.next_out = out;
+    stream.avail_out = (uInt)entry.uncompressed_size;
+
+    int64_t offset = dataOffset;
+    size_t remaining = entry.compressed_size;
+    int ret = Z_OK;
+    while (chunk && ret == Z_OK && remaining > 0)
+    {
+        size_t readSize = std::min(remaining, chunkSize);
+        if (!readFully(offset, chunk.get(), readSize))
+        {
+            break;
+        }
+        offset += readSize;
+        remaining -= readSize;
+
+        stream.next_in = chunk.get();
+        stream.avail_in = (uInt)readSize;
+        ret = inflate(&stream, Z_NO_FLUSH);
+    }
+    bool succeeded = ret == Z_STREAM_END && stream.total_out == entry.uncompressed_size;
+    inflateEnd(&stream);
+
+    return succeeded && crc32(0L, out, (uInt)entry.uncompressed_size) == entry.crc;
+}
+
+bool ZipFilePrivate::readEntryWithMinizip(ZipEntryInfo& entry, unsigned char* out)
+{
+    std::lock_guard<std::mutex> lock(zipFileMutex);
+
+    if (unzGoToFilePos(zipFile, &entry.pos) != UNZ_OK || unzOpenCurrentFile(zipFile) != UNZ_OK)
+    {
+        return false;
+    }
+
+    int nSize = unzReadCurrentFile(zipFile, out, static_cast<unsigned int>(entry.uncompressed_size));
+    CCASSERT(nSize == 0 || nSize == (int)entry.uncompressed_size, "the file size is wrong");
+    unzCloseCurrentFile(zipFile);
+    return nSize == (int)entry.uncompressed_size;
+}
+
+bool ZipFilePrivate::readEntry(ZipEntryInfo& entry, unsigned char* out)
+{
+    if (entry.uncompressed_size == 0)
+    {
+        return true;
+    }
+
+    bool canReadConcurrently = fd >= 0
+        && (entry.compression_method == 0 || entry.compression_method == Z_DEFLATED)
+        && !(entry.flag & 1); // encrypted
+
+    if (canReadConcurrently)
+    {
+        int64_t dataOffset;
+        {
+            std::lock_guard<std::mutex> lock(zipFileMutex);
+            if (entry.dataOffset == ZIP_DATA_OFFSET_UNKNOWN)
+            {
+                entry.dataOffset = locateEntryData(entry);
+            }
+            dataOffset = entry.dataOffset;
+        }
+
+        if (dataOffset >= 0)
+        {
+            return readEntryConcurrently(entry, dataOffset, out);
+        }
+    }
+
+    return readEntryWithMinizip(entry, out);
+}
+
 ZipFile *ZipFile::createWithBuffer(const void* buffer, uLong size)
 {
     ZipFile *zip = new (std::nothrow) ZipFile();
@@ -531,23 +730,24 @@ ZipFile *ZipFile::createWithBuffer(const void* buffer, uLong size)
 ZipFile::ZipFile()
 : _data(new ZipFilePrivate)
 {
-    _data->zipFile = nullptr;
 }
 
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
-    _data->zipFile = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFile).c_str());
+    std::string path = FileUtils::getInstance()->getSuitableFOpen(zipFile);
+    _data->zipFile = unzOpen(path.c_str());
+#if CC_ZIP_USE_PREAD
+    if (_data->zipFile)
+    {
+        _data->fd = open(path.c_str(), O_RDONLY);
+    }
+#endif
     setFilter(filter);
 }
 
 ZipFile::~ZipFile()
 {
-    if (_data && _data->zipFile)
-    {
-        unzClose(_data->zipFile);
-    }
-
     CC_SAFE_DELETE(_data);
 }
 
@@ -559,8 +759,17 @@ bool ZipFile::setFilter(const std::string &filter)
         CC_BREAK_IF(!_data);
         CC_BREAK_IF(!_data->zipFile);
         
+        std::lock_guard<std::mutex> lock(_data->zipFileMutex);
+
         // clear existing file list
         _data->fileList.clear();
+
+        // the index is built once from the central directory, size it up front
+        unz_global_info64 globalInfo;
+        if (unzGetGlobalInfo64(_data->zipFile, &globalInfo) == UNZ_OK)
+        {
+            _data->fileList.reserve((size_t)globalInfo.number_entry);
+        }
         
         // UNZ_MAXFILENAMEINZIP + 1 - it is done so in unzLocateFile
         char szCurrentFileName[UNZ_MAXFILENAMEINZIP + 1];
@@ -575,15 +784,19 @@ bool ZipFile::setFilter(const std::string &filter)
             int posErr = unzGetFilePos(_data->zipFile, &posInfo);
             if (posErr == UNZ_OK)
             {
-                std::string currentFileName = szCurrentFileName;
                 // cache info about filtered files only (like 'assets/')
                 if (filter.empty()
-                    || currentFileName.substr(0, filter.length()) == filter)
+                    || strncmp(szCurrentFileName, filter.c_str(), filter.length()) == 0)
                 {
                     ZipEntryInfo entry;
                     entry.pos = posInfo;
                     entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
-                    _data->fileList[currentFileName] = entry;
+                    entry.compressed_size = (uLong)fileInfo.compressed_size;
+                    entry.compression_method = fileInfo.compression_method;
+                    entry.flag = fileInfo.flag;
+                    entry.crc = fileInfo.crc;
+                    entry.dataOffset = ZIP_DATA_OFFSET_UNKNOWN;
+                    _data->fileList[szCurrentFileName] = entry;
                 }
             }
             // next file - also get the information about it
@@ -654,26 +867,24 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
-        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+        ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
         
-        ZipEntryInfo fileInfo = it->second;
-        
-        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        nRet = unzOpenCurrentFile(_data->zipFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
+        ZipEntryInfo& fileInfo = it->second;
         
         buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer, static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
+        CC_BREAK_IF(!buffer && fileInfo.uncompressed_size > 0);
+        if (!_data->readEntry(fileInfo, buffer))
+        {
+            free(buffer);
+            buffer = nullptr;
+            break;
+        }
         
         if (size)
         {
             *size = fileInfo.uncompressed_size;
         }
-        unzCloseCurrentFile(_data->zipFile);
     } while (0);
     
     return buffer;
@@ -687,22 +898,13 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
-        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+        ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
         
-        ZipEntryInfo fileInfo = it->second;
-        
-        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        nRet = unzOpenCurrentFile(_data->zipFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
+        ZipEntryInfo& fileInfo = it->second;
         
         buffer->resize(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer->buffer(), static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
-        unzCloseCurrentFile(_data->zipFile);
-        res = true;
+        res = _data->readEntry(fileInfo, static_cast<unsigned char*>(buffer->buffer()));
     } while (0);
     
     return res;
@@ -710,6 +912,7 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
 
 std::string ZipFile::getFirstFilename()
 {
+    std::lock_guard<std::mutex> lock(_data->zipFileMutex);
     if (unzGoToFirstFile(_data->zipFile) != UNZ_OK) return emptyFilename;
     std::string path;
     unz_file_info info;
@@ -719,6 +922,7 @@ std::string ZipFile::getFirstFilename()
 
 std::string ZipFile::getNextFilename()
 {
+    std::lock_guard<std::mutex> lock(_data->zipFileMutex);
     if (unzGoToNextFile(_data->zipFile) != UNZ_OK) return emptyFilename;
     std::string path;
     unz_file_info info;
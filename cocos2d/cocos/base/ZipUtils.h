@@ -227,6 +227,9 @@ typedef struct unz_file_info_s unz_file_info;
     * It will cache the file list of a particular zip file with positions inside an archive,
     * so it would be much faster to read some particular files or to check their existence.
     *
+    * getFileData() can be called from several threads at once. Stored and deflated files of a zip
+    * file opened from a path are read and inflated in parallel, the others one at a time.
+    *
     * @since v2.0.5
     */
     class CC_DLL ZipFile
@@ -0,0 +1,117 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/allocator/CCAllocationCounter.h"
+#include "base/ccConfig.h"
+
+#include <stdlib.h>
+#include <new>
+
+#include <assert.h>
+
+USING_NS_CC_ALLOCATOR;
+
+bool AllocationCounter::isEnabled()
+{
+    return CC_ENABLE_ALLOCATION_COUNTER != 0;
+}
+
+#if CC_ENABLE_ALLOCATION_COUNTER
+
+#if CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
+#error "CC_ENABLE_ALLOCATION_COUNTER and CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE both replace the global new and delete"
+#endif
+
+namespace
+{
+    // constant initialized, so it can be used by the allocations made before main()
+    thread_local uint64_t s_allocationCount = 0;
+
+    void* countedAllocate(std::size_t size)
+    {
+        ++s_allocationCount;
+        // malloc(0) may return nullptr, operator new must return a unique pointer
+        void* ptr = malloc(size ? size : 1);
+        // disabling exceptions since cocos2d-x doesn't use them, as in CCAllocatorGlobalNewDelete.cpp
+        assert(ptr && "No memory");
+        return ptr;
+    }
+}
+
+uint64_t AllocationCounter::getCount()
+{
+    return s_allocationCount;
+}
+
+void* operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++s_allocationCount;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++s_allocationCount;
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+#else
+
+uint64_t AllocationCounter::getCount()
+{
+    return 0;
+}
+
+#endif // CC_ENABLE_ALLOCATION_COUNTER
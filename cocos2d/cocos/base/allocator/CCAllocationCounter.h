@@ -0,0 +1,55 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef CC_ALLOCATION_COUNTER_H
+#define CC_ALLOCATION_COUNTER_H
+
+#include <stdint.h>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/allocator/CCAllocatorMacros.h"
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+/**
+ Counts the calls to the global operator new made by each thread, including the ones of the STL containers.
+ The count is only kept when CC_ENABLE_ALLOCATION_COUNTER is on, which replaces the global new and delete
+ with ones calling malloc and free. The allocations of C libraries calling malloc directly aren't counted.
+ */
+class CC_DLL AllocationCounter
+{
+public:
+    /** Whether the engine was built with the allocations counted, getCount() always returns 0 otherwise. */
+    static bool isEnabled();
+
+    /** The number of calls to the global operator new made by the calling thread since it started. */
+    static uint64_t getCount();
+};
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
+
+#endif//CC_ALLOCATION_COUNTER_H
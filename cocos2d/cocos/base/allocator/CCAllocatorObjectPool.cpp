@@ -0,0 +1,91 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/allocator/CCAllocatorObjectPool.h"
+#include "base/allocator/CCAllocatorMutex.h"
+
+#include <sstream>
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+namespace
+{
+    // list of all the object pools, pools are created lazily from any thread
+    ObjectPoolBase* s_pools = nullptr;
+    
+    AllocatorMutex& poolsMutex()
+    {
+        static AllocatorMutex mutex;
+        return mutex;
+    }
+}
+
+ObjectPoolBase::ObjectPoolBase(const char* name)
+    : _name(name)
+    , _inUse(0)
+    , _highestInUse(0)
+    , _pooledAllocations(0)
+    , _fallbackAllocations(0)
+    , _nextPool(nullptr)
+{
+    LOCK(poolsMutex());
+    _nextPool = s_pools;
+    s_pools = this;
+    UNLOCK(poolsMutex());
+}
+
+ObjectPoolBase::~ObjectPoolBase()
+{
+    LOCK(poolsMutex());
+    auto pp = &s_pools;
+    for (; *pp && *pp != this; pp = &(*pp)->_nextPool);
+    if (*pp == this)
+        *pp = _nextPool;
+    UNLOCK(poolsMutex());
+}
+
+std::string ObjectPoolBase::statistics() const
+{
+    std::stringstream s;
+    s << _name << " in use:" << _inUse << " highest:" << _highestInUse
+      << " pooled:" << _pooledAllocations << " fallback:" << _fallbackAllocations << "\n";
+    return s.str();
+}
+
+std::string ObjectPoolBase::statisticsForAllPools()
+{
+    std::string data;
+    LOCK(poolsMutex());
+    for (auto pool = s_pools; pool; pool = pool->_nextPool)
+    {
+        data += pool->statistics();
+    }
+    UNLOCK(poolsMutex());
+    return data;
+}
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
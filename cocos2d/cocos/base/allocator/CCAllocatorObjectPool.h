@@ -0,0 +1,138 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef CC_ALLOCATOR_OBJECT_POOL_H
+#define CC_ALLOCATOR_OBJECT_POOL_H
+/// @cond DO_NOT_SHOW
+
+#include <new>
+#include <string>
+#include <atomic>
+
+#include "base/allocator/CCAllocatorMacros.h"
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+// @brief
+// Common base of the per-class object pools, keeps them in a list so their statistics
+// can be reported together (see the "allocator" console command).
+class CC_DLL ObjectPoolBase
+{
+public:
+    
+    explicit ObjectPoolBase(const char* name);
+    virtual ~ObjectPoolBase();
+    
+    // @brief one line of statistics for this pool.
+    std::string statistics() const;
+    
+    // @brief the statistics of all the object pools created so far.
+    static std::string statisticsForAllPools();
+    
+protected:
+    
+    void trackAllocation(bool pooled)
+    {
+        if (pooled)
+        {
+            size_t inUse = ++_inUse;
+            ++_pooledAllocations;
+            size_t highest = _highestInUse.load(std::memory_order_relaxed);
+            while (inUse > highest && !_highestInUse.compare_exchange_weak(highest, inUse, std::memory_order_relaxed))
+            {}
+        }
+        else
+        {
+            ++_fallbackAllocations;
+        }
+    }
+    
+    void trackDeallocation(bool pooled)
+    {
+        if (pooled)
+            --_inUse;
+    }
+    
+    const char* _name;
+    std::atomic<size_t> _inUse;
+    std::atomic<size_t> _highestInUse;
+    std::atomic<size_t> _pooledAllocations;
+    std::atomic<size_t> _fallbackAllocations;
+    ObjectPoolBase* _nextPool;
+};
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
+
+#if CC_ENABLE_OBJECT_POOLS
+
+// @brief declares class specific new/delete operators for T backed by a thread safe pool.
+// Put it in the public section of the class and CC_IMPLEMENT_OBJECT_POOL in its source file.
+// Derived classes inherit the operators, their objects have another size and are
+// given to the global allocator unless they declare a pool of their own.
+#define CC_DECLARE_OBJECT_POOL(T) \
+    static void* operator new(size_t size); \
+    static void* operator new(size_t size, const std::nothrow_t&) throw(); \
+    static void* operator new(size_t /*size*/, void* address) throw() { return address; } \
+    static void operator delete(void* address, size_t size); \
+    static void operator delete(void* address, const std::nothrow_t&) throw(); \
+    static void operator delete(void* /*address*/, void* /*place*/) throw() {}
+
+// @brief defines the operators declared by CC_DECLARE_OBJECT_POOL.
+// @param pageSize the number of objects added to the pool each time it runs dry,
+// it can be overridden from the Configuration using the class name as key.
+#define CC_IMPLEMENT_OBJECT_POOL(T, pageSize) \
+    static NS_CC_ALLOCATOR::ObjectPool<T>& T##ObjectPool() \
+    { \
+        static NS_CC_ALLOCATOR::ObjectPool<T>* pool = NS_CC_ALLOCATOR::ObjectPool<T>::create(#T, pageSize); \
+        return *pool; \
+    } \
+    void* T::operator new(size_t size) \
+    { \
+        return T##ObjectPool().allocate(size); \
+    } \
+    void* T::operator new(size_t size, const std::nothrow_t&) throw() \
+    { \
+        return T##ObjectPool().allocate(size); \
+    } \
+    void T::operator delete(void* address, size_t size) \
+    { \
+        T##ObjectPool().deallocate(address, size); \
+    } \
+    void T::operator delete(void* address, const std::nothrow_t&) throw() \
+    { \
+        T##ObjectPool().deallocateUnsized(address); \
+    }
+
+#else
+
+#define CC_DECLARE_OBJECT_POOL(...)
+#define CC_IMPLEMENT_OBJECT_POOL(...)
+
+#endif // CC_ENABLE_OBJECT_POOLS
+
+/// @endcond
+#endif//CC_ALLOCATOR_OBJECT_POOL_H
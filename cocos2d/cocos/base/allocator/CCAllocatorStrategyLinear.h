@@ -0,0 +1,270 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef CC_ALLOCATOR_STRATEGY_LINEAR_H
+#define CC_ALLOCATOR_STRATEGY_LINEAR_H
+/// @cond DO_NOT_SHOW
+
+/****************************************************************************
+                                    WARNING!
+     Memory handed out by this allocator is only valid until the next reset().
+     Containers using LinearSTLAllocator must be emptied and their storage
+     released (e.g. by assigning a new container) before the reset.
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <cstddef>
+#include <sstream>
+#include <type_traits>
+
+#include "base/allocator/CCAllocatorBase.h"
+#include "base/allocator/CCAllocatorMacros.h"
+#include "base/allocator/CCAllocatorGlobal.h"
+#include "base/allocator/CCAllocatorDiagnostics.h"
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+// @brief
+// Linear (bump) allocator strategy for short lived allocations, e.g. per-frame temporaries.
+// Allocating advances a cursor in the current page, deallocating does nothing,
+// and reset() rewinds the cursor and releases everything at once.
+// When a frame overflows the first page, the pages are merged into one page big enough
+// for the whole frame on the next reset(), so steady state frames don't touch the system allocator.
+// Not thread safe, an instance is meant to be used by a single thread.
+class AllocatorStrategyLinear
+    : public AllocatorBase
+{
+public:
+    
+    AllocatorStrategyLinear(const char* tag = nullptr, size_t pageSize = 64 * 1024)
+        : _pages(nullptr)
+        , _cursor(nullptr)
+        , _end(nullptr)
+        , _pageSize(pageSize)
+        , _used(0)
+        , _highestUsed(0)
+        , _pageAllocations(0)
+        , _lastPageAllocations(0)
+        , _totalPageAllocations(0)
+    {
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        AllocatorDiagnostics::instance()->trackAllocator(this);
+        AllocatorBase::setTag(tag ? tag : "AllocatorStrategyLinear");
+#endif
+    }
+    
+    virtual ~AllocatorStrategyLinear()
+    {
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        AllocatorDiagnostics::instance()->untrackAllocator(this);
+#endif
+        releasePages();
+    }
+    
+    // @brief allocate size bytes aligned to alignment, which must be a power of two.
+    CC_ALLOCATOR_INLINE void* allocate(size_t size, size_t alignment = kDefaultAlignment)
+    {
+        uint8_t* address = (uint8_t*)aligned(_cursor, alignment);
+        if (nullptr == _cursor || address + size > _end)
+        {
+            newPage(size + alignment);
+            address = (uint8_t*)aligned(_cursor, alignment);
+        }
+        _cursor = address + size;
+        _used += size;
+        return address;
+    }
+    
+    // @brief memory is only given back by reset().
+    CC_ALLOCATOR_INLINE void deallocate(void* address, size_t size = 0)
+    {
+    }
+    
+    // @brief release every allocation made since the last reset.
+    // If the allocations did not fit in a single page, the pages are replaced by one page
+    // big enough to hold all of them.
+    void reset()
+    {
+        if (_pages && _pages->next)
+        {
+            size_t capacity = 0;
+            for (Page* page = _pages; page; page = page->next)
+                capacity += page->size;
+            releasePages();
+            if (_pageSize < capacity)
+                _pageSize = capacity;
+            newPage(0);
+        }
+        else if (_pages)
+        {
+            _cursor = (uint8_t*)(_pages + 1);
+        }
+        
+        if (_highestUsed < _used)
+            _highestUsed = _used;
+        _used = 0;
+        _lastPageAllocations = _pageAllocations;
+        _pageAllocations = 0;
+    }
+    
+    // @brief the number of bytes allocated since the last reset.
+    size_t getUsedBytes() const { return _used; }
+    
+    // @brief the highest number of bytes allocated between two resets.
+    size_t getHighestUsedBytes() const { return _highestUsed; }
+    
+    // @brief the number of pages requested from the global allocator since the last reset.
+    unsigned int getPageAllocations() const { return _pageAllocations; }
+    
+    // @brief the number of pages requested from the global allocator between the last two resets,
+    // including the page merge made by the last reset. Zero once the allocator reached its steady state.
+    unsigned int getLastPageAllocations() const { return _lastPageAllocations; }
+    
+    // @brief the number of pages requested from the global allocator since construction.
+    unsigned int getTotalPageAllocations() const { return _totalPageAllocations; }
+    
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+    std::string diagnostics() const
+    {
+        std::stringstream s;
+        s << AllocatorBase::tag() << " page:" << _pageSize << " used:" << _used << " highest:" << _highestUsed << " page allocations:" << _totalPageAllocations << "\n";
+        return s.str();
+    }
+#endif
+    
+protected:
+    
+    struct Page
+    {
+        Page* next;
+        size_t size;
+        // keeps the first allocation of the page aligned
+        char padding[kDefaultAlignment - (2 * sizeof(void*)) % kDefaultAlignment];
+    };
+    
+    void newPage(size_t minimumSize)
+    {
+        size_t size = _pageSize > minimumSize ? _pageSize : minimumSize;
+        Page* page = (Page*)ccAllocatorGlobal.allocate(sizeof(Page) + size);
+        page->next = _pages;
+        page->size = size;
+        _pages = page;
+        _cursor = (uint8_t*)(page + 1);
+        _end = _cursor + size;
+        ++_pageAllocations;
+        ++_totalPageAllocations;
+    }
+    
+    void releasePages()
+    {
+        while (_pages)
+        {
+            Page* next = _pages->next;
+            ccAllocatorGlobal.deallocate(_pages);
+            _pages = next;
+        }
+        _cursor = _end = nullptr;
+    }
+    
+    Page* _pages;
+    uint8_t* _cursor;
+    uint8_t* _end;
+    size_t _pageSize;
+    size_t _used;
+    size_t _highestUsed;
+    unsigned int _pageAllocations;
+    unsigned int _lastPageAllocations;
+    unsigned int _totalPageAllocations;
+};
+
+// @brief
+// STL compatible allocator that takes its memory from an AllocatorStrategyLinear.
+// @param T the type of object allocated by the container.
+template <typename T>
+class LinearSTLAllocator
+{
+public:
+    
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    
+    // the allocator follows the storage, so containers can be reassigned to start over after a reset
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    
+    template <typename U>
+    struct rebind
+    {
+        typedef LinearSTLAllocator<U> other;
+    };
+    
+    LinearSTLAllocator(AllocatorStrategyLinear* allocator = nullptr)
+        : _allocator(allocator)
+    {}
+    
+    template <typename U>
+    LinearSTLAllocator(const LinearSTLAllocator<U>& other)
+        : _allocator(other._allocator)
+    {}
+    
+    T* allocate(size_t count)
+    {
+        if (nullptr == _allocator)
+            return (T*)ccAllocatorGlobal.allocate(count * sizeof(T));
+        return (T*)_allocator->allocate(count * sizeof(T), alignof(T) > (size_t)AllocatorBase::kDefaultAlignment ? alignof(T) : (size_t)AllocatorBase::kDefaultAlignment);
+    }
+    
+    void deallocate(T* address, size_t count)
+    {
+        if (nullptr == _allocator)
+            ccAllocatorGlobal.deallocate(address);
+    }
+    
+    template <typename U>
+    bool operator==(const LinearSTLAllocator<U>& other) const
+    {
+        return _allocator == other._allocator;
+    }
+    
+    template <typename U>
+    bool operator!=(const LinearSTLAllocator<U>& other) const
+    {
+        return _allocator != other._allocator;
+    }
+    
+    AllocatorStrategyLinear* _allocator;
+};
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
+
+/// @endcond
+#endif//CC_ALLOCATOR_STRATEGY_LINEAR_H
@@ -36,6 +36,7 @@
 #include "base/allocator/CCAllocatorGlobal.h"
 #include "base/allocator/CCAllocatorStrategyFixedBlock.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
+#include "base/allocator/CCAllocatorObjectPool.h"
 #include "base/CCConfiguration.h"
 
 NS_CC_BEGIN
@@ -166,6 +167,84 @@ public:
 #endif
 };
 
+/**
+ * ObjectTraits for pools backing class specific new/delete operators.
+ *
+ * The new expression constructs and the delete expression destroys the object,
+ * so the pool must do neither.
+ *
+ * @param T Type of object.
+ */
+template <typename T>
+class ObjectPoolTraits
+    : public ObjectTraits<T, AllocatorBase::kDefaultAlignment>
+{
+public:
+    
+    void construct(T* /*address*/)
+    {}
+    
+    void destroy(T* /*address*/)
+    {}
+};
+
+/**
+ * Thread safe pool for objects of type T, used by CC_IMPLEMENT_OBJECT_POOL.
+ *
+ * Blocks of exactly sizeof(T) come from the pool, other sizes (objects of derived classes)
+ * are given to the global allocator. Counts are kept for the "allocator" console command.
+ *
+ * @param T Type of object.
+ * @see CC_DECLARE_OBJECT_POOL
+ */
+template <typename T>
+class ObjectPool
+    : public AllocatorStrategyPool<T, ObjectPoolTraits<T>, locking_semantics>
+    , public ObjectPoolBase
+{
+public:
+    
+    typedef AllocatorStrategyPool<T, ObjectPoolTraits<T>, locking_semantics> tPoolStrategy;
+    
+    /** Creates a pool that is never destroyed, since objects may be released after the static destructors ran.*/
+    static ObjectPool* create(const char* name, size_t pageSize)
+    {
+        void* memory = ccAllocatorGlobal.allocate(sizeof(ObjectPool));
+        return new (memory) ObjectPool(name, pageSize);
+    }
+    
+    CC_ALLOCATOR_INLINE void* allocate(size_t size)
+    {
+        trackAllocation(sizeof(T) == size);
+        return tPoolStrategy::allocate(size);
+    }
+    
+    CC_ALLOCATOR_INLINE void deallocate(void* address, size_t size)
+    {
+        if (address)
+        {
+            trackDeallocation(sizeof(T) == size);
+            tPoolStrategy::deallocate(address, size);
+        }
+    }
+    
+    /** Deallocates a block whose size is unknown, by checking whether the pool owns it.*/
+    void deallocateUnsized(void* address)
+    {
+        if (address)
+        {
+            deallocate(address, tPoolStrategy::owns(address) ? sizeof(T) : 0);
+        }
+    }
+    
+protected:
+    
+    ObjectPool(const char* name, size_t pageSize)
+        : tPoolStrategy(name, pageSize)
+        , ObjectPoolBase(name)
+    {}
+};
+
 NS_CC_ALLOCATOR_END
 NS_CC_END
 
@@ -384,6 +384,25 @@ THE SOFTWARE.
 # define CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE 0
 # endif//CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
 
+/** @def CC_ENABLE_ALLOCATION_COUNTER
+ * Turn on counting the calls to the global operator new of each thread,
+ * read with AllocationCounter and Renderer::getLastFrameAllocations().
+ * It replaces the global new and delete of the whole application, so it's off by default,
+ * and can't be used with CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE.
+ */
+#ifndef CC_ENABLE_ALLOCATION_COUNTER
+# define CC_ENABLE_ALLOCATION_COUNTER 0
+#endif
+
+/** @def CC_ENABLE_OBJECT_POOLS
+ * Turn on the per-class object pools of frequently created objects
+ * (Node, Sprite, MoveTo, Sequence, CallFunc and the common event listeners).
+ * Their pool statistics are printed by the "allocator" console command.
+ */
+#ifndef CC_ENABLE_OBJECT_POOLS
+# define CC_ENABLE_OBJECT_POOLS 1
+#endif
+
 /** @def CC_ALLOCATOR_GLOBAL
  * Specify allocator to use for global allocator.
  */
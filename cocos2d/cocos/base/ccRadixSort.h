@@ -0,0 +1,126 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_RADIX_SORT_H__
+#define __CC_RADIX_SORT_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+namespace utils
+{
+    /** Maps a float to an unsigned integer whose natural ordering matches the float ordering.
+     * -0.0f and +0.0f map to the same value, so they keep comparing equal.
+     */
+    inline uint32_t floatToOrderedBits(float value)
+    {
+        if (value == 0.0f)
+            value = 0.0f;
+
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    /** Stable LSD radix sort of `count` values by their 64-bit unsigned keys.
+     * Only the bytes in [firstByte, 8) of the keys take part in the ordering, lower bytes ride along.
+     * A pass is skipped when all keys share the same byte, so keys with narrow ranges cost few passes.
+     * @param keys The keys, sorted in place.
+     * @param values The values, permuted together with the keys.
+     * @param keysScratch Scratch buffer holding at least `count` keys.
+     * @param valuesScratch Scratch buffer holding at least `count` values.
+     * @param count The number of keys/values.
+     * @param firstByte The least significant byte of the keys that is compared.
+     */
+    template <typename T>
+    void radixSort(uint64_t* keys, T* values, uint64_t* keysScratch, T* valuesScratch, size_t count, int firstByte = 0)
+    {
+        if (count < 2)
+            return;
+
+        uint32_t histograms[8][256];
+        memset(histograms, 0, sizeof(histograms));
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t key = keys[i];
+            for (int b = firstByte; b < 8; ++b)
+                ++histograms[b][(key >> (b * 8)) & 0xFF];
+        }
+
+        uint64_t* srcKeys = keys;
+        T* srcValues = values;
+        uint64_t* dstKeys = keysScratch;
+        T* dstValues = valuesScratch;
+
+        for (int b = firstByte; b < 8; ++b)
+        {
+            uint32_t* histogram = histograms[b];
+            const int shift = b * 8;
+            if (histogram[(srcKeys[0] >> shift) & 0xFF] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (int i = 0; i < 256; ++i)
+            {
+                uint32_t bucketSize = histogram[i];
+                histogram[i] = offset;
+                offset += bucketSize;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t dst = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+                dstKeys[dst] = srcKeys[i];
+                dstValues[dst] = srcValues[i];
+            }
+
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+        }
+
+        if (srcKeys != keys)
+        {
+            std::copy(srcKeys, srcKeys + count, keys);
+            std::copy(srcValues, srcValues + count, values);
+        }
+    }
+}
+
+NS_CC_END
+
+/**
+ end of base group
+ @}
+ */
+#endif // __CC_RADIX_SORT_H__
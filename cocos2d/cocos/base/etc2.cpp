@@ -0,0 +1,439 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/etc2.h"
+
+#include <limits.h>
+#include <string.h>
+
+/* From the OpenGL ES 3.0 specification, appendix C.1 ETC Compressed Texture Image Formats.
+
+ ETC2 RGB blocks are read like ETC1 blocks, as a 64 bit big endian integer. In the differential
+ mode, a red, green or blue base color that overflows the 5 bit range selects another mode:
+
+ - red overflows: T mode, two 4 bit base colors and a distance; the paint colors are
+   C1, C2 + d, C2 and C2 - d.
+ - green overflows: H mode, two 4 bit base colors and a distance; the paint colors are
+   C1 + d, C1 - d, C2 + d and C2 - d.
+ - blue overflows: planar mode, an origin, horizontal and vertical color in 6:7:6 bits which
+   are interpolated over the block.
+
+ The T and H modes select the paint color of each pixel with a 2 bit index stored like the
+ ETC1 pixel indices.
+
+ EAC alpha blocks are 64 bits too: an 8 bit base value, a 4 bit multiplier, a 4 bit modifier
+ table index and 16 pixel indices of 3 bits, column by column. The alpha of a pixel is
+ clamp(base + modifier * multiplier).
+ */
+
+static const int kDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int kAlphaModifierTable[16][8] = {
+/* 0 */{ -3, -6, -9, -15, 2, 5, 8, 14 },
+/* 1 */{ -3, -7, -10, -13, 2, 6, 9, 12 },
+/* 2 */{ -2, -5, -8, -13, 1, 4, 7, 12 },
+/* 3 */{ -2, -4, -6, -13, 1, 3, 5, 12 },
+/* 4 */{ -3, -6, -8, -12, 2, 5, 7, 11 },
+/* 5 */{ -3, -7, -9, -11, 2, 6, 8, 10 },
+/* 6 */{ -4, -7, -8, -11, 3, 6, 7, 10 },
+/* 7 */{ -3, -5, -8, -11, 2, 4, 7, 10 },
+/* 8 */{ -2, -6, -8, -10, 1, 5, 7, 9 },
+/* 9 */{ -2, -5, -8, -10, 1, 4, 7, 9 },
+/* 10 */{ -2, -4, -8, -10, 1, 3, 7, 9 },
+/* 11 */{ -2, -5, -7, -10, 1, 4, 6, 9 },
+/* 12 */{ -3, -4, -7, -10, 2, 3, 6, 9 },
+/* 13 */{ -1, -2, -3, -10, 0, 1, 2, 9 },
+/* 14 */{ -4, -6, -8, -9, 3, 5, 7, 8 },
+/* 15 */{ -3, -5, -7, -9, 2, 4, 6, 8 } };
+
+// the table with a zero modifier, used for blocks with a single alpha value
+static const int kAlphaConstantTable = 13;
+static const int kAlphaConstantIndex = 4;
+
+static inline etc1_byte clamp(int x) {
+    return (etc1_byte) (x >= 0 ? (x < 255 ? x : 255) : 0);
+}
+
+static inline int extend4To8(int c) {
+    return (c << 4) | c;
+}
+
+static inline int extend6To8(int c) {
+    return (c << 2) | (c >> 4);
+}
+
+static inline int extend7To8(int c) {
+    return (c << 1) | (c >> 6);
+}
+
+static inline int signed3Bits(etc1_uint32 bits) {
+    int d = bits & 7;
+    return d < 4 ? d : d - 8;
+}
+
+static etc1_uint32 readBigEndian(const etc1_byte* pIn) {
+    return (pIn[0] << 24) | (pIn[1] << 16) | (pIn[2] << 8) | pIn[3];
+}
+
+static void decode_paint_colors(const int paint[4][3], etc1_uint32 low, etc1_byte* pOut) {
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            int i = x * 4 + y;
+            int index = (((low >> (i + 16)) & 1) << 1) | ((low >> i) & 1);
+            etc1_byte* q = pOut + 4 * (x + 4 * y);
+            q[0] = clamp(paint[index][0]);
+            q[1] = clamp(paint[index][1]);
+            q[2] = clamp(paint[index][2]);
+        }
+    }
+}
+
+static void decode_t_mode(etc1_uint32 high, etc1_uint32 low, etc1_byte* pOut) {
+    int r1 = extend4To8((((high >> 27) & 3) << 2) | ((high >> 24) & 3));
+    int g1 = extend4To8((high >> 20) & 0xf);
+    int b1 = extend4To8((high >> 16) & 0xf);
+    int r2 = extend4To8((high >> 12) & 0xf);
+    int g2 = extend4To8((high >> 8) & 0xf);
+    int b2 = extend4To8((high >> 4) & 0xf);
+    int d = kDistanceTable[(((high >> 2) & 3) << 1) | (high & 1)];
+
+    const int paint[4][3] = {
+        { r1, g1, b1 },
+        { r2 + d, g2 + d, b2 + d },
+        { r2, g2, b2 },
+        { r2 - d, g2 - d, b2 - d } };
+    decode_paint_colors(paint, low, pOut);
+}
+
+static void decode_h_mode(etc1_uint32 high, etc1_uint32 low, etc1_byte* pOut) {
+    int r14 = (high >> 27) & 0xf;
+    int g14 = (((high >> 24) & 7) << 1) | ((high >> 20) & 1);
+    int b14 = (((high >> 19) & 1) << 3) | ((high >> 15) & 7);
+    int r24 = (high >> 11) & 0xf;
+    int g24 = (high >> 7) & 0xf;
+    int b24 = (high >> 3) & 0xf;
+    int order = ((r14 << 8) | (g14 << 4) | b14) >= ((r24 << 8) | (g24 << 4) | b24) ? 1 : 0;
+    int d = kDistanceTable[(((high >> 2) & 1) << 2) | ((high & 1) << 1) | order];
+
+    int r1 = extend4To8(r14), g1 = extend4To8(g14), b1 = extend4To8(b14);
+    int r2 = extend4To8(r24), g2 = extend4To8(g24), b2 = extend4To8(b24);
+    const int paint[4][3] = {
+        { r1 + d, g1 + d, b1 + d },
+        { r1 - d, g1 - d, b1 - d },
+        { r2 + d, g2 + d, b2 + d },
+        { r2 - d, g2 - d, b2 - d } };
+    decode_paint_colors(paint, low, pOut);
+}
+
+static void decode_planar_mode(etc1_uint32 high, etc1_uint32 low, etc1_byte* pOut) {
+    int ro = extend6To8((high >> 25) & 0x3f);
+    int go = extend7To8((((high >> 24) & 1) << 6) | ((high >> 17) & 0x3f));
+    int bo = extend6To8((((high >> 16) & 1) << 5) | (((high >> 11) & 3) << 3) | ((high >> 7) & 7));
+    int rh = extend6To8((((high >> 2) & 0x1f) << 1) | (high & 1));
+    int gh = extend7To8((low >> 25) & 0x7f);
+    int bh = extend6To8((low >> 19) & 0x3f);
+    int rv = extend6To8((low >> 13) & 0x3f);
+    int gv = extend7To8((low >> 6) & 0x7f);
+    int bv = extend6To8(low & 0x3f);
+
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            etc1_byte* q = pOut + 4 * (x + 4 * y);
+            q[0] = clamp((x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2);
+            q[1] = clamp((x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2);
+            q[2] = clamp((x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2);
+        }
+    }
+}
+
+void etc2_decode_rgb_block(const etc1_byte* pIn, etc1_byte* pOut) {
+    etc1_uint32 high = readBigEndian(pIn);
+    etc1_uint32 low = readBigEndian(pIn + 4);
+
+    if (high & 2) {
+        int r = ((high >> 27) & 0x1f) + signed3Bits(high >> 24);
+        int g = ((high >> 19) & 0x1f) + signed3Bits(high >> 16);
+        int b = ((high >> 11) & 0x1f) + signed3Bits(high >> 8);
+        if (r < 0 || r > 31) {
+            decode_t_mode(high, low, pOut);
+            return;
+        }
+        if (g < 0 || g > 31) {
+            decode_h_mode(high, low, pOut);
+            return;
+        }
+        if (b < 0 || b > 31) {
+            decode_planar_mode(high, low, pOut);
+            return;
+        }
+    }
+
+    // individual or differential mode, the same as ETC1
+    etc1_byte rgb[ETC1_DECODED_BLOCK_SIZE];
+    etc1_decode_block(pIn, rgb);
+    for (int i = 0; i < 16; i++) {
+        pOut[i * 4] = rgb[i * 3];
+        pOut[i * 4 + 1] = rgb[i * 3 + 1];
+        pOut[i * 4 + 2] = rgb[i * 3 + 2];
+    }
+}
+
+void etc2_decode_alpha_block(const etc1_byte* pIn, etc1_byte* pOut) {
+    int base = pIn[0];
+    int multiplier = pIn[1] >> 4;
+    const int* modifiers = kAlphaModifierTable[pIn[1] & 0xf];
+    unsigned long long bits = 0;
+    for (int i = 2; i < 8; i++) {
+        bits = (bits << 8) | pIn[i];
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int index = (int) ((bits >> (45 - 3 * i)) & 7);
+        int x = i >> 2;
+        int y = i & 3;
+        pOut[4 * (x + 4 * y) + 3] = clamp(base + modifiers[index] * multiplier);
+    }
+}
+
+// Returns the squared error of the best indices for the given base, multiplier and table,
+// or stops as soon as the error reaches maxError.
+static int encode_alpha_indices(const int* alpha, int base, int multiplier, const int* modifiers,
+        int maxError, int* indices) {
+    int error = 0;
+    for (int i = 0; i < 16 && error < maxError; i++) {
+        int bestError = INT_MAX;
+        for (int k = 0; k < 8; k++) {
+            int d = clamp(base + modifiers[k] * multiplier) - alpha[i];
+            if (d * d < bestError) {
+                bestError = d * d;
+                indices[i] = k;
+            }
+        }
+        error += bestError;
+    }
+    return error;
+}
+
+void etc2_encode_alpha_block(const etc1_byte* pIn, etc1_byte* pOut) {
+    int alpha[16];
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (int i = 0; i < 16; i++) {
+        int x = i >> 2;
+        int y = i & 3;
+        alpha[i] = pIn[4 * (x + 4 * y) + 3];
+        minAlpha = alpha[i] < minAlpha ? alpha[i] : minAlpha;
+        maxAlpha = alpha[i] > maxAlpha ? alpha[i] : maxAlpha;
+    }
+
+    int bestBase = minAlpha;
+    int bestMultiplier = 1;
+    int bestTable = kAlphaConstantTable;
+    int bestIndices[16];
+    for (int i = 0; i < 16; i++) {
+        bestIndices[i] = kAlphaConstantIndex;
+    }
+
+    if (minAlpha != maxAlpha) {
+        // fit the range of each table around the range of the block
+        int bestError = INT_MAX;
+        int indices[16];
+        for (int t = 0; t < 16 && bestError > 0; t++) {
+            const int* modifiers = kAlphaModifierTable[t];
+            int modifierRange = modifiers[7] - modifiers[3];
+            int fit = (maxAlpha - minAlpha + modifierRange - 1) / modifierRange;
+            for (int m = fit - 1; m <= fit + 1; m++) {
+                if (m < 1 || m > 15) {
+                    continue;
+                }
+                int center = (minAlpha + maxAlpha - (modifiers[3] + modifiers[7]) * m + 1) / 2;
+                for (int base = center - 1; base <= center + 1; base++) {
+                    if (base < 0 || base > 255) {
+                        continue;
+                    }
+                    int error = encode_alpha_indices(alpha, base, m, modifiers, bestError, indices);
+                    if (error < bestError) {
+                        bestError = error;
+                        bestBase = base;
+                        bestMultiplier = m;
+                        bestTable = t;
+                        memcpy(bestIndices, indices, sizeof(indices));
+                    }
+                }
+            }
+        }
+    }
+
+    unsigned long long bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits = (bits << 3) | bestIndices[i];
+    }
+    pOut[0] = (etc1_byte) bestBase;
+    pOut[1] = (etc1_byte) ((bestMultiplier << 4) | bestTable);
+    for (int i = 7; i >= 2; i--, bits >>= 8) {
+        pOut[i] = (etc1_byte) bits;
+    }
+}
+
+// Return the size of the encoded image data (does not include size of PKM header).
+
+etc1_uint32 etc2_get_encoded_data_size(etc1_uint32 width, etc1_uint32 height, etc1_bool hasAlpha) {
+    etc1_uint32 blocks = ((width + 3) >> 2) * ((height + 3) >> 2);
+    return blocks * (hasAlpha ? ETC2_RGBA_ENCODED_BLOCK_SIZE : ETC2_RGB_ENCODED_BLOCK_SIZE);
+}
+
+// Encode an entire image. The pixels of the partial blocks on the right and bottom edges
+// repeat the last column and row of the image.
+
+int etc2_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 stride, etc1_bool hasAlpha, etc1_byte* pOut) {
+    if (width == 0 || height == 0) {
+        return -1;
+    }
+    etc1_byte block[64];
+    etc1_byte rgb[ETC1_DECODED_BLOCK_SIZE];
+    for (etc1_uint32 by = 0; by < height; by += 4) {
+        for (etc1_uint32 bx = 0; bx < width; bx += 4) {
+            for (etc1_uint32 y = 0; y < 4; y++) {
+                etc1_uint32 sy = by + y < height ? by + y : height - 1;
+                for (etc1_uint32 x = 0; x < 4; x++) {
+                    etc1_uint32 sx = bx + x < width ? bx + x : width - 1;
+                    const etc1_byte* p = pIn + sy * stride + sx * 4;
+                    etc1_byte* q = block + 4 * (x + 4 * y);
+                    q[0] = p[0];
+                    q[1] = p[1];
+                    q[2] = p[2];
+                    q[3] = p[3];
+                    rgb[3 * (x + 4 * y)] = p[0];
+                    rgb[3 * (x + 4 * y) + 1] = p[1];
+                    rgb[3 * (x + 4 * y) + 2] = p[2];
+                }
+            }
+            if (hasAlpha) {
+                etc2_encode_alpha_block(block, pOut);
+                pOut += 8;
+            }
+            etc1_encode_block(rgb, 0xffff, pOut);
+            pOut += ETC2_RGB_ENCODED_BLOCK_SIZE;
+        }
+    }
+    return 0;
+}
+
+// Decode an entire image.
+
+int etc2_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
+        etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 stride, etc1_bool hasAlpha) {
+    etc1_byte block[64];
+    for (etc1_uint32 by = 0; by < height; by += 4) {
+        etc1_uint32 yEnd = height - by < 4 ? height - by : 4;
+        for (etc1_uint32 bx = 0; bx < width; bx += 4) {
+            etc1_uint32 xEnd = width - bx < 4 ? width - bx : 4;
+            if (hasAlpha) {
+                etc2_decode_alpha_block(pIn, block);
+                pIn += 8;
+            } else {
+                for (int i = 0; i < 16; i++) {
+                    block[i * 4 + 3] = 255;
+                }
+            }
+            etc2_decode_rgb_block(pIn, block);
+            pIn += ETC2_RGB_ENCODED_BLOCK_SIZE;
+
+            for (etc1_uint32 y = 0; y < yEnd; y++) {
+                memcpy(pOut + (by + y) * stride + bx * 4, block + 16 * y, xEnd * 4);
+            }
+        }
+    }
+    return 0;
+}
+
+static const char kMagic[] = { 'P', 'K', 'M', ' ', '2', '0' };
+
+static const etc1_uint32 ETC2_PKM_FORMAT_OFFSET = 6;
+static const etc1_uint32 ETC2_PKM_ENCODED_WIDTH_OFFSET = 8;
+static const etc1_uint32 ETC2_PKM_ENCODED_HEIGHT_OFFSET = 10;
+static const etc1_uint32 ETC2_PKM_WIDTH_OFFSET = 12;
+static const etc1_uint32 ETC2_PKM_HEIGHT_OFFSET = 14;
+
+static const etc1_uint32 ETC1_RGB_NO_MIPMAPS = 0;
+static const etc1_uint32 ETC2_RGB_NO_MIPMAPS = 1;
+static const etc1_uint32 ETC2_RGBA_NO_MIPMAPS = 3;
+
+static void writeBEUint16(etc1_byte* pOut, etc1_uint32 data) {
+    pOut[0] = (etc1_byte) (data >> 8);
+    pOut[1] = (etc1_byte) data;
+}
+
+static etc1_uint32 readBEUint16(const etc1_byte* pIn) {
+    return (pIn[0] << 8) | pIn[1];
+}
+
+// Format a PKM 2.0 header
+
+void etc2_pkm_format_header(etc1_byte* pHeader, etc1_uint32 width, etc1_uint32 height, etc1_bool hasAlpha) {
+    memcpy(pHeader, kMagic, sizeof(kMagic));
+    etc1_uint32 encodedWidth = (width + 3) & ~3;
+    etc1_uint32 encodedHeight = (height + 3) & ~3;
+    writeBEUint16(pHeader + ETC2_PKM_FORMAT_OFFSET, hasAlpha ? ETC2_RGBA_NO_MIPMAPS : ETC2_RGB_NO_MIPMAPS);
+    writeBEUint16(pHeader + ETC2_PKM_ENCODED_WIDTH_OFFSET, encodedWidth);
+    writeBEUint16(pHeader + ETC2_PKM_ENCODED_HEIGHT_OFFSET, encodedHeight);
+    writeBEUint16(pHeader + ETC2_PKM_WIDTH_OFFSET, width);
+    writeBEUint16(pHeader + ETC2_PKM_HEIGHT_OFFSET, height);
+}
+
+// Check if a PKM 2.0 header is correctly formatted.
+
+etc1_bool etc2_pkm_is_valid(const etc1_byte* pHeader) {
+    if (memcmp(pHeader, kMagic, sizeof(kMagic))) {
+        return false;
+    }
+    etc1_uint32 format = readBEUint16(pHeader + ETC2_PKM_FORMAT_OFFSET);
+    etc1_uint32 encodedWidth = readBEUint16(pHeader + ETC2_PKM_ENCODED_WIDTH_OFFSET);
+    etc1_uint32 encodedHeight = readBEUint16(pHeader + ETC2_PKM_ENCODED_HEIGHT_OFFSET);
+    etc1_uint32 width = readBEUint16(pHeader + ETC2_PKM_WIDTH_OFFSET);
+    etc1_uint32 height = readBEUint16(pHeader + ETC2_PKM_HEIGHT_OFFSET);
+    return (format == ETC1_RGB_NO_MIPMAPS || format == ETC2_RGB_NO_MIPMAPS || format == ETC2_RGBA_NO_MIPMAPS) &&
+            encodedWidth >= width && encodedWidth - width < 4 &&
+            encodedHeight >= height && encodedHeight - height < 4;
+}
+
+// Read the image width from a PKM 2.0 header
+
+etc1_uint32 etc2_pkm_get_width(const etc1_byte* pHeader) {
+    return readBEUint16(pHeader + ETC2_PKM_WIDTH_OFFSET);
+}
+
+// Read the image height from a PKM 2.0 header
+
+etc1_uint32 etc2_pkm_get_height(const etc1_byte* pHeader) {
+    return readBEUint16(pHeader + ETC2_PKM_HEIGHT_OFFSET);
+}
+
+// Whether the PKM 2.0 header describes an RGBA8 image
+
+etc1_bool etc2_pkm_has_alpha(const etc1_byte* pHeader) {
+    return readBEUint16(pHeader + ETC2_PKM_FORMAT_OFFSET) == ETC2_RGBA_NO_MIPMAPS;
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __etc2_h__
+#define __etc2_h__
+/// @cond DO_NOT_SHOW
+
+#include "base/etc1.h"
+
+#define ETC2_RGB_ENCODED_BLOCK_SIZE 8
+#define ETC2_RGBA_ENCODED_BLOCK_SIZE 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ETC2 is a superset of ETC1: every ETC1 block is a valid ETC2 RGB block. ETC2 adds the T, H and
+// planar modes for the color, and the RGBA8 format prepends an EAC block with the alpha to each
+// color block.
+
+// Decode the RGB part of a block of pixels.
+//
+// pIn is an ETC2 RGB compressed block.
+//
+// pOut is a pointer to a 4 x 4 square of 4-byte pixels in form R, G, B, A. Byte (4 * (x + 4 * y))
+// is the R value of pixel (x, y). The A values are not written.
+void etc2_decode_rgb_block(const etc1_byte* pIn, etc1_byte* pOut);
+
+// Decode the alpha of a block of pixels.
+//
+// pIn is an EAC compressed alpha block.
+//
+// pOut is a pointer to a 4 x 4 square of 4-byte pixels in form R, G, B, A. Only the A values are written.
+void etc2_decode_alpha_block(const etc1_byte* pIn, etc1_byte* pOut);
+
+// Encode the alpha of a block of pixels.
+//
+// pIn is a pointer to a 4 x 4 square of 4-byte pixels in form R, G, B, A. Only the A values are read.
+//
+// pOut is an EAC compressed version of the alpha.
+void etc2_encode_alpha_block(const etc1_byte* pIn, etc1_byte* pOut);
+
+// Return the size of the encoded image data (does not include size of PKM header).
+etc1_uint32 etc2_get_encoded_data_size(etc1_uint32 width, etc1_uint32 height, etc1_bool hasAlpha);
+
+// Encode an entire image.
+// pIn - pointer to the image data, 4-byte pixels in form R, G, B, A. Pixel (x,y) is at pIn + 4 * x + stride * y.
+// pOut - pointer to encoded data. Must be large enough to store entire encoded image.
+// hasAlpha - encode GL_COMPRESSED_RGBA8_ETC2_EAC if true, GL_COMPRESSED_RGB8_ETC2 otherwise.
+// The color is encoded with the ETC1 modes only.
+// returns non-zero if there is an error.
+int etc2_encode_image(const etc1_byte* pIn, etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 stride, etc1_bool hasAlpha, etc1_byte* pOut);
+
+// Decode an entire image.
+// pIn - pointer to encoded data.
+// pOut - pointer to the image data, 4-byte pixels in form R, G, B, A. Pixel (x,y) is written
+//        at pOut + 4 * x + stride * y. The alpha is 255 if hasAlpha is false.
+// returns non-zero if there is an error.
+int etc2_decode_image(const etc1_byte* pIn, etc1_byte* pOut,
+        etc1_uint32 width, etc1_uint32 height,
+        etc1_uint32 stride, etc1_bool hasAlpha);
+
+// Size of a PKM 2.0 header, in bytes.
+#define ETC2_PKM_HEADER_SIZE 16
+
+// Format a PKM 2.0 header
+void etc2_pkm_format_header(etc1_byte* pHeader, etc1_uint32 width, etc1_uint32 height, etc1_bool hasAlpha);
+
+// Check if a PKM 2.0 header is correctly formatted and holds an ETC2 RGB or RGBA8 image.
+etc1_bool etc2_pkm_is_valid(const etc1_byte* pHeader);
+
+// Read the image width from a PKM 2.0 header
+etc1_uint32 etc2_pkm_get_width(const etc1_byte* pHeader);
+
+// Read the image height from a PKM 2.0 header
+etc1_uint32 etc2_pkm_get_height(const etc1_byte* pHeader);
+
+// Whether the PKM 2.0 header describes an RGBA8 image
+etc1_bool etc2_pkm_has_alpha(const etc1_byte* pHeader);
+
+#ifdef __cplusplus
+}
+#endif
+
+/// @endcond
+#endif
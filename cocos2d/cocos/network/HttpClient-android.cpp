@@ -882,6 +882,7 @@ HttpClient::HttpClient()
 : _isInited(false)
 , _timeoutForConnect(30)
 , _timeoutForRead(60)
+, _maxConcurrentRequests(6)
 , _threadCount(0)
 , _cookie(nullptr)
 , _requestSentinel(new HttpRequest())
@@ -1073,6 +1074,18 @@ int HttpClient::getTimeoutForRead()
     std::lock_guard<std::mutex> lock(_timeoutForReadMutex);
     return _timeoutForRead;
 }
+
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    _maxConcurrentRequests = value;
+}
+
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    return _maxConcurrentRequests;
+}
     
 const std::string& HttpClient::getCookieFilename()
 {
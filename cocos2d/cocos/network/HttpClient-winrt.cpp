@@ -249,6 +249,7 @@ namespace network {
     HttpClient::HttpClient()
         : _timeoutForConnect(30)
         , _timeoutForRead(60)
+        , _maxConcurrentRequests(6)
     {
     }
 
@@ -27,6 +27,8 @@
 
 #include "network/HttpClient.h"
 #include <queue>
+#include <algorithm>
+#include <chrono>
 #include <errno.h>
 #include <curl/curl.h>
 #include "base/CCDirector.h"
@@ -42,7 +44,28 @@ typedef int int32_t;
 
 static HttpClient* _httpClient = nullptr; // pointer to singleton
 
-typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
+// The multi handle of the worker thread, guarded by _requestQueueMutex; used to wake the thread up.
+static CURLM* s_multiHandle = nullptr;
+
+// The number of easy handles kept for reuse by the worker thread.
+static const size_t MAX_IDLE_HANDLES = 16;
+
+// How long the worker thread waits for the sockets when curl_multi_poll isn't available.
+static const int WAIT_TIMEOUT_MS = 10;
+
+// A request performed by the multi handle of the worker thread
+struct HttpTransfer
+{
+    HttpRequest* request;
+    HttpResponse* response;
+    CURL* handle;
+    /// Keeps custom header data
+    curl_slist* headers;
+    /// Whether the request was sent with sendImmediate
+    bool immediate;
+    bool finished;
+    char errorBuffer[CURL_ERROR_SIZE];
+};
 
 // Callback function used by libcurl for collect response data
 static size_t writeData(void *ptr, size_t size, size_t nmemb, void *stream)
@@ -70,104 +93,6 @@ static size_t writeHeaderData(void *ptr, size_t size, size_t nmemb, void *stream
     return sizes;
 }
 
-
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPutTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processDeleteTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
-
-// Worker thread
-void HttpClient::networkThread()
-{
-    increaseThreadCount();
-
-    while (true)
-    {
-        HttpRequest *request;
-
-        // step 1: send http request if the requestQueue isn't empty
-        {
-            std::lock_guard<std::mutex> lock(_requestQueueMutex);
-            while (_requestQueue.empty())
-            {
-                _sleepCondition.wait(_requestQueueMutex);
-            }
-            request = _requestQueue.at(0);
-            _requestQueue.erase(0);
-        }
-
-        if (request == _requestSentinel) {
-            break;
-        }
-
-        // step 2: libcurl sync access
-        
-        // Create a HttpResponse object, the default setting is http access failed
-        HttpResponse *response = new (std::nothrow) HttpResponse(request);
-
-        processResponse(response, _responseMessage);
-
-
-        // add response packet into queue
-        _responseQueueMutex.lock();
-        _responseQueue.pushBack(response);
-        _responseQueueMutex.unlock();
-
-        _schedulerMutex.lock();
-        if (nullptr != _scheduler)
-        {
-            _scheduler->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
-        }
-        _schedulerMutex.unlock();
-    }
-    
-    // cleanup: if worker thread received quit signal, clean up un-completed request queue
-    _requestQueueMutex.lock();
-    _requestQueue.clear();
-    _requestQueueMutex.unlock();
-
-    _responseQueueMutex.lock();
-    _responseQueue.clear();
-    _responseQueueMutex.unlock();
-
-    decreaseThreadCountAndMayDeleteThis();
-}
-
-// Worker thread
-void HttpClient::networkThreadAlone(HttpRequest* request, HttpResponse* response)
-{
-    increaseThreadCount();
-
-    char responseMessage[RESPONSE_BUFFER_SIZE] = { 0 };
-    processResponse(response, responseMessage);
-
-    _schedulerMutex.lock();
-    if (nullptr != _scheduler)
-    {
-        _scheduler->performFunctionInCocosThread([this, response, request]{
-            const ccHttpRequestCallback& callback = request->getCallback();
-            Ref* pTarget = request->getTarget();
-            SEL_HttpResponse pSelector = request->getSelector();
-
-            if (callback != nullptr)
-            {
-                callback(this, response);
-            }
-            else if (pTarget && pSelector)
-            {
-                (pTarget->*pSelector)(this, response);
-            }
-            response->release();
-            // do not release in other thread
-            request->release();
-        });
-    }
-    _schedulerMutex.unlock();
-
-    decreaseThreadCountAndMayDeleteThis();
-}
-
 //Configure curl's timeout property
 static bool configureCURL(HttpClient* client, CURL* handle, char* errorBuffer)
 {
@@ -205,138 +130,353 @@ static bool configureCURL(HttpClient* client, CURL* handle, char* errorBuffer)
 
     curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
 
+    // keep the connections alive between the requests
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+#if LIBCURL_VERSION_NUM >= 0x072f00 // 7.47.0
+    // use HTTP/2 for https when libcurl is built with nghttp2, and multiplex the requests to the same host
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+#endif
+
     return true;
 }
 
-class CURLRaii
+template <class T>
+static bool setOption(CURL* handle, CURLoption option, T data)
 {
-    /// Instance of CURL
-    CURL *_curl;
-    /// Keeps custom header data
-    curl_slist *_headers;
-public:
-    CURLRaii()
-        : _curl(curl_easy_init())
-        , _headers(nullptr)
+    return CURLE_OK == curl_easy_setopt(handle, option, data);
+}
+
+// Sets the easy handle of a transfer up for its request
+static bool setupTransfer(HttpClient* client, HttpTransfer* transfer, CURLSH* shareHandle)
+{
+    CURL* handle = transfer->handle;
+    HttpRequest* request = transfer->request;
+    HttpResponse* response = transfer->response;
+
+    if (!configureCURL(client, handle, transfer->errorBuffer))
+        return false;
+
+    /* get custom header data (if set) */
+    std::vector<std::string> headers = request->getHeaders();
+    if (!headers.empty())
     {
+        /* append custom headers one by one */
+        for (auto& header : headers)
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        /* set custom headers for curl */
+        if (!setOption(handle, CURLOPT_HTTPHEADER, transfer->headers))
+            return false;
+    }
+    std::string cookieFilename = client->getCookieFilename();
+    if (!cookieFilename.empty()) {
+        if (!setOption(handle, CURLOPT_COOKIEFILE, cookieFilename.c_str())) {
+            return false;
+        }
+        if (!setOption(handle, CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
+            return false;
+        }
     }
 
-    ~CURLRaii()
+    bool ok = setOption(handle, CURLOPT_SHARE, shareHandle)
+            && setOption(handle, CURLOPT_PRIVATE, (void*)transfer)
+            && setOption(handle, CURLOPT_URL, request->getUrl())
+            && setOption(handle, CURLOPT_WRITEFUNCTION, writeData)
+            && setOption(handle, CURLOPT_WRITEDATA, (void*)response->getResponseData())
+            && setOption(handle, CURLOPT_HEADERFUNCTION, writeHeaderData)
+            && setOption(handle, CURLOPT_HEADERDATA, (void*)response->getResponseHeader());
+    if (!ok)
+        return false;
+
+    switch (request->getRequestType())
     {
-        if (_curl)
-            curl_easy_cleanup(_curl);
-        /* free the linked list for header data */
-        if (_headers)
-            curl_slist_free_all(_headers);
+    case HttpRequest::Type::GET: // HTTP GET
+        return setOption(handle, CURLOPT_FOLLOWLOCATION, 1L);
+
+    case HttpRequest::Type::POST: // HTTP POST
+        return setOption(handle, CURLOPT_POST, 1L)
+            && setOption(handle, CURLOPT_POSTFIELDS, request->getRequestData())
+            && setOption(handle, CURLOPT_POSTFIELDSIZE, (long)request->getRequestDataSize());
+
+    case HttpRequest::Type::PUT:
+        return setOption(handle, CURLOPT_CUSTOMREQUEST, "PUT")
+            && setOption(handle, CURLOPT_POSTFIELDS, request->getRequestData())
+            && setOption(handle, CURLOPT_POSTFIELDSIZE, (long)request->getRequestDataSize());
+
+    case HttpRequest::Type::DELETE:
+        return setOption(handle, CURLOPT_CUSTOMREQUEST, "DELETE")
+            && setOption(handle, CURLOPT_FOLLOWLOCATION, 1L);
+
+    default:
+        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT or DELETE is supported");
+        return false;
     }
+}
 
-    template <class T>
-    bool setOption(CURLoption option, T data)
+// Writes the result of a transfer to its HttpResponse
+static void finishTransfer(HttpTransfer* transfer, CURLcode result)
+{
+    long responseCode = -1;
+    bool succeed = false;
+    if (result == CURLE_OK)
     {
-        return CURLE_OK == curl_easy_setopt(_curl, option, data);
+        CURLcode code = curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &responseCode);
+        if (code != CURLE_OK)
+        {
+            CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
+            strncpy(transfer->errorBuffer, curl_easy_strerror(code), CURL_ERROR_SIZE - 1);
+            responseCode = -1;
+        }
+        else if (responseCode < 200 || responseCode >= 300)
+        {
+            // the transfer itself worked, the server answered with an error status
+            snprintf(transfer->errorBuffer, CURL_ERROR_SIZE, "The requested URL returned error: %ld", responseCode);
+        }
+        else
+        {
+            succeed = true;
+        }
+    }
+    else if (transfer->errorBuffer[0] == '\0')
+    {
+        strncpy(transfer->errorBuffer, curl_easy_strerror(result), CURL_ERROR_SIZE - 1);
     }
 
-    /**
-     * @brief Inits CURL instance for common usage
-     * @param request Null not allowed
-     * @param callback Response write callback
-     * @param stream Response write stream
-     */
-    bool init(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, write_callback headerCallback, void* headerStream, char* errorBuffer)
+    // write data to HttpResponse
+    HttpResponse* response = transfer->response;
+    response->setResponseCode(responseCode);
+    response->setSucceed(succeed);
+    if (!succeed)
     {
-        if (!_curl)
-            return false;
-        if (!configureCURL(client, _curl, errorBuffer))
-            return false;
+        response->setErrorBuffer(transfer->errorBuffer);
+    }
+}
 
-        /* get custom header data (if set) */
-        std::vector<std::string> headers=request->getHeaders();
-        if(!headers.empty())
+// Worker thread
+void HttpClient::networkThread()
+{
+    increaseThreadCount();
+
+    // the requests are performed concurrently by a curl multi handle, which keeps the connections
+    // alive and shares them between the requests; cookies, DNS and TLS sessions are shared as well
+    CURLM* multiHandle = curl_multi_init();
+    CURLSH* shareHandle = curl_share_init();
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x072b00 // 7.43.0
+    curl_multi_setopt(multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+    std::vector<HttpTransfer*> transfers;
+    std::vector<HttpRequest*> requests;
+    std::vector<CURL*> idleHandles;
+    size_t queuedTransfers = 0; // the transfers of the requests sent with send(), limited by _maxConcurrentRequests
+    bool quit = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_requestQueueMutex);
+        s_multiHandle = multiHandle;
+    }
+
+    while (!quit)
+    {
+        // step 1: take the requests to start, sleep if there is nothing to do
+        size_t maxConcurrentRequests = std::max(getMaxConcurrentRequests(), 1);
+        requests.clear();
+        size_t immediateRequests = 0;
         {
-            /* append custom headers one by one */
-            for (auto& header : headers)
-                _headers = curl_slist_append(_headers,header.c_str());
-            /* set custom headers for curl */
-            if (!setOption(CURLOPT_HTTPHEADER, _headers))
-                return false;
+            std::lock_guard<std::mutex> lock(_requestQueueMutex);
+            while (transfers.empty() && _requestQueue.empty() && _immediateRequestQueue.empty())
+            {
+                _sleepCondition.wait(_requestQueueMutex);
+            }
+
+            if (_requestQueue.contains(_requestSentinel))
+            {
+                quit = true;
+                break;
+            }
+
+            // the requests sent with sendImmediate don't wait for the other ones
+            for (auto request : _immediateRequestQueue)
+            {
+                requests.push_back(request);
+            }
+            immediateRequests = requests.size();
+            _immediateRequestQueue.clear();
+
+            while (!_requestQueue.empty() && queuedTransfers + requests.size() - immediateRequests < maxConcurrentRequests)
+            {
+                requests.push_back(_requestQueue.at(0));
+                _requestQueue.erase(0);
+            }
         }
-        std::string cookieFilename = client->getCookieFilename();
-        if (!cookieFilename.empty()) {
-            if (!setOption(CURLOPT_COOKIEFILE, cookieFilename.c_str())) {
-                return false;
+
+        // step 2: add the transfers of the new requests to the multi handle
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            HttpTransfer* transfer = new (std::nothrow) HttpTransfer();
+            transfer->request = requests[i];
+            // Create a HttpResponse object, the default setting is http access failed
+            transfer->response = new (std::nothrow) HttpResponse(requests[i]);
+            transfer->handle = nullptr;
+            transfer->headers = nullptr;
+            transfer->immediate = i < immediateRequests;
+            memset(transfer->errorBuffer, 0, sizeof(transfer->errorBuffer));
+
+            if (!idleHandles.empty())
+            {
+                transfer->handle = idleHandles.back();
+                idleHandles.pop_back();
+            }
+            else
+            {
+                transfer->handle = curl_easy_init();
             }
-            if (!setOption(CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
-                return false;
+
+            transfers.push_back(transfer);
+            if (!transfer->immediate)
+            {
+                ++queuedTransfers;
+            }
+
+            CURLMcode code = CURLM_OK;
+            if (!setupTransfer(this, transfer, shareHandle) || (code = curl_multi_add_handle(multiHandle, transfer->handle)) != CURLM_OK)
+            {
+                if (code != CURLM_OK)
+                {
+                    strncpy(transfer->errorBuffer, curl_multi_strerror(code), CURL_ERROR_SIZE - 1);
+                }
+                finishTransfer(transfer, CURLE_FAILED_INIT);
+                transfer->finished = true;
             }
         }
 
-        return setOption(CURLOPT_URL, request->getUrl())
-                && setOption(CURLOPT_WRITEFUNCTION, callback)
-                && setOption(CURLOPT_WRITEDATA, stream)
-                && setOption(CURLOPT_HEADERFUNCTION, headerCallback)
-                && setOption(CURLOPT_HEADERDATA, headerStream);
-        
-    }
+        // step 3: perform the transfers
+        int runningHandles = 0;
+        curl_multi_perform(multiHandle, &runningHandles);
 
-    /// @param responseCode Null not allowed
-    bool perform(long *responseCode)
-    {
-        if (CURLE_OK != curl_easy_perform(_curl))
-            return false;
-        CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
-        if (code != CURLE_OK || !(*responseCode >= 200 && *responseCode < 300)) {
-            CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
-            return false;
+        CURLMsg* message = nullptr;
+        int queuedMessages = 0;
+        while ((message = curl_multi_info_read(multiHandle, &queuedMessages)) != nullptr)
+        {
+            if (message->msg == CURLMSG_DONE)
+            {
+                HttpTransfer* transfer = nullptr;
+                curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+                finishTransfer(transfer, message->data.result);
+                transfer->finished = true;
+                curl_multi_remove_handle(multiHandle, message->easy_handle);
+            }
+        }
+
+        // step 4: hand the finished responses to the cocos thread, and recycle the easy handles
+        for (auto it = transfers.begin(); it != transfers.end();)
+        {
+            HttpTransfer* transfer = *it;
+            if (!transfer->finished)
+            {
+                ++it;
+                continue;
+            }
+            it = transfers.erase(it);
+
+            if (!transfer->immediate)
+            {
+                --queuedTransfers;
+            }
+
+            // write the cookies received by the request to the cookie file
+            if (!getCookieFilename().empty())
+            {
+                curl_easy_setopt(transfer->handle, CURLOPT_COOKIELIST, "FLUSH");
+            }
+            if (transfer->handle && idleHandles.size() < MAX_IDLE_HANDLES)
+            {
+                curl_easy_reset(transfer->handle);
+                idleHandles.push_back(transfer->handle);
+            }
+            else if (transfer->handle)
+            {
+                curl_easy_cleanup(transfer->handle);
+            }
+            if (transfer->headers)
+            {
+                curl_slist_free_all(transfer->headers);
+            }
+
+            // add response packet into queue
+            _responseQueueMutex.lock();
+            _responseQueue.pushBack(transfer->response);
+            _responseQueueMutex.unlock();
+            // dispatchResponseCallbacks releases the response after its callback
+            delete transfer;
+
+            _schedulerMutex.lock();
+            if (nullptr != _scheduler)
+            {
+                _scheduler->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
+            }
+            _schedulerMutex.unlock();
+        }
+
+        // step 5: wait for the sockets of the transfers, or for new requests
+        if (!transfers.empty())
+        {
+#if LIBCURL_VERSION_NUM >= 0x074400 // 7.68.0
+            // send() and sendImmediate() wake the poll up
+            curl_multi_poll(multiHandle, nullptr, 0, 1000, nullptr);
+#else
+            auto waitStart = std::chrono::steady_clock::now();
+            int numfds = 0;
+            CURLMcode code = curl_multi_wait(multiHandle, nullptr, 0, WAIT_TIMEOUT_MS, &numfds);
+            if (code != CURLM_OK || numfds == 0)
+            {
+                // numfds is also 0 after a normal timeout, only sleep for the rest of the timeout when
+                // curl_multi_wait returned at once because curl had no socket to wait for, e.g. while resolving
+                auto remaining = std::chrono::milliseconds(WAIT_TIMEOUT_MS) - (std::chrono::steady_clock::now() - waitStart);
+                if (remaining > std::chrono::milliseconds(0))
+                    std::this_thread::sleep_for(remaining);
+            }
+#endif
         }
-        // Get some mor data.
-        
-        return true;
     }
-};
 
-//Process Get Request
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    // cleanup: if worker thread received quit signal, clean up un-completed request queue
+    _requestQueueMutex.lock();
+    s_multiHandle = nullptr;
+    _requestQueue.clear();
+    _immediateRequestQueue.clear();
+    _requestQueueMutex.unlock();
 
-//Process POST Request
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_POST, 1)
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    _responseQueueMutex.lock();
+    _responseQueue.clear();
+    _responseQueueMutex.unlock();
 
-//Process PUT Request
-static int processPutTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    for (auto transfer : transfers)
+    {
+        if (transfer->handle)
+        {
+            curl_multi_remove_handle(multiHandle, transfer->handle);
+            curl_easy_cleanup(transfer->handle);
+        }
+        if (transfer->headers)
+        {
+            curl_slist_free_all(transfer->headers);
+        }
+        transfer->response->release();
+        transfer->request->release();
+        delete transfer;
+    }
+    for (auto handle : idleHandles)
+    {
+        curl_easy_cleanup(handle);
+    }
+    curl_multi_cleanup(multiHandle);
+    curl_share_cleanup(shareHandle);
 
-//Process DELETE Request
-static int processDeleteTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    decreaseThreadCountAndMayDeleteThis();
 }
 
 // HttpClient implementation
@@ -400,6 +540,7 @@ HttpClient::HttpClient()
 : _isInited(false)
 , _timeoutForConnect(30)
 , _timeoutForRead(60)
+, _maxConcurrentRequests(6)
 , _threadCount(0)
 , _cookie(nullptr)
 , _requestSentinel(new HttpRequest())
@@ -452,6 +593,7 @@ void HttpClient::send(HttpRequest* request)
 
     _requestQueueMutex.lock();
     _requestQueue.pushBack(request);
+    wakeUpMultiHandle();
     _requestQueueMutex.unlock();
 
     // Notify thread start to work
@@ -460,17 +602,36 @@ void HttpClient::send(HttpRequest* request)
 
 void HttpClient::sendImmediate(HttpRequest* request)
 {
+    if (false == lazyInitThreadSemaphore())
+    {
+        return;
+    }
+
     if(!request)
     {
         return;
     }
 
     request->retain();
-    // Create a HttpResponse object, the default setting is http access failed
-    HttpResponse *response = new (std::nothrow) HttpResponse(request);
 
-    auto t = std::thread(&HttpClient::networkThreadAlone, this, request, response);
-    t.detach();
+    // the worker thread starts the request at once, regardless of the max concurrent requests
+    _requestQueueMutex.lock();
+    _immediateRequestQueue.pushBack(request);
+    wakeUpMultiHandle();
+    _requestQueueMutex.unlock();
+
+    _sleepCondition.notify_one();
+}
+
+// Wakes the worker thread up when it waits for the sockets of the running requests, _requestQueueMutex must be locked
+void HttpClient::wakeUpMultiHandle()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400 // 7.68.0
+    if (s_multiHandle)
+    {
+        curl_multi_wakeup(s_multiHandle);
+    }
+#endif
 }
 
 // Poll and notify main thread if responses exists in queue
@@ -509,74 +670,6 @@ void HttpClient::dispatchResponseCallbacks()
         request->release();
     }
 }
-
-// Process Response
-void HttpClient::processResponse(HttpResponse* response, char* responseMessage)
-{
-    auto request = response->getHttpRequest();
-    long responseCode = -1;
-    int retValue = 0;
-
-    // Process the request -> get response packet
-    switch (request->getRequestType())
-    {
-    case HttpRequest::Type::GET: // HTTP GET
-        retValue = processGetTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::POST: // HTTP POST
-        retValue = processPostTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::PUT:
-        retValue = processPutTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::DELETE:
-        retValue = processDeleteTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    default:
-        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT or DELETE is supported");
-        break;
-    }
-
-    // write data to HttpResponse
-    response->setResponseCode(responseCode);
-    if (retValue != 0)
-    {
-        response->setSucceed(false);
-        response->setErrorBuffer(responseMessage);
-    }
-    else
-    {
-        response->setSucceed(true);
-    }
-}
     
 void HttpClient::clearResponseAndRequestQueue()
 {
@@ -658,6 +751,18 @@ int HttpClient::getTimeoutForRead()
     std::lock_guard<std::mutex> lock(_timeoutForReadMutex);
     return _timeoutForRead;
 }
+
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    _maxConcurrentRequests = value;
+}
+
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    return _maxConcurrentRequests;
+}
     
 const std::string& HttpClient::getCookieFilename()
 {
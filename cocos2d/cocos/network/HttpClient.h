@@ -145,6 +145,22 @@ public:
      */
     int getTimeoutForRead();
 
+    /**
+     * Set the maximum number of the requests added with send() that are performed at the same time.
+     * The requests above the limit wait in the queue, the ones added with sendImmediate() are not limited.
+     * The default value is 6.
+     *
+     * @param value the maximum number of concurrent requests.
+     */
+    void setMaxConcurrentRequests(int value);
+
+    /**
+     * Get the maximum number of the requests added with send() that are performed at the same time.
+     *
+     * @return int the maximum number of concurrent requests.
+     */
+    int getMaxConcurrentRequests();
+
     HttpCookie* getCookie() const {return _cookie; }
 
     std::mutex& getCookieFileMutex() {return _cookieFileMutex;}
@@ -194,6 +210,7 @@ private:
     void dispatchResponseCallbacks();
 
     void processResponse(HttpResponse* response, char* responseMessage);
+    void wakeUpMultiHandle();
     void increaseThreadCount();
     void decreaseThreadCountAndMayDeleteThis();
 
@@ -206,6 +223,9 @@ private:
     int _timeoutForRead;
     std::mutex _timeoutForReadMutex;
 
+    int _maxConcurrentRequests;
+    std::mutex _maxConcurrentRequestsMutex;
+
     int  _threadCount;
     std::mutex _threadCountMutex;
 
@@ -213,6 +233,7 @@ private:
     std::mutex _schedulerMutex;
 
     Vector<HttpRequest*>  _requestQueue;
+    Vector<HttpRequest*>  _immediateRequestQueue;
     std::mutex _requestQueueMutex;
 
     Vector<HttpResponse*> _responseQueue;
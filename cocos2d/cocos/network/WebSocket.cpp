@@ -50,6 +50,8 @@
 
 #define WS_RX_BUFFER_SIZE (65536)
 #define WS_RESERVE_RECEIVE_BUFFER_SIZE (4096)
+// The websocket thread sleeps in 'lws_service' until a socket event, a wake up or this timeout.
+#define WS_SERVICE_TIMEOUT_MS (1000)
 
 //#define WEBSOCKETS_LOGGING
 #define  LOG_TAG    "WebSocket.cpp"
@@ -271,6 +273,15 @@ public:
     // Sends message to Websocket thread. It's needs to be invoked in Cocos thread.
     void sendMessageToWebSocketThread(WsMessage *msg);
 
+    // Asks the websocket thread to wait for the socket of a websocket to be writable, and wakes the thread up.
+    // It's used when there is data to send or the connection is closing.
+    void requestWritable(WebSocket* ws);
+    // Removes the writable requests of a websocket which is being destroyed.
+    void cancelWritableRequests(WebSocket* ws);
+
+    // Makes 'lws_service' return at once, it can be invoked in any thread.
+    void wakeUp();
+
     // Waits the sub-thread (websocket thread) to exit,
     void joinWebSocketThread();
 
@@ -285,7 +296,10 @@ public:
     std::mutex   _subThreadWsMessageQueueMutex;
     std::thread* _subThreadInstance;
 private:
-    bool _needQuit;
+    std::atomic<bool> _needQuit;
+    std::mutex _contextMutex;
+    std::vector<WebSocket*> _writableRequests;
+    std::mutex _writableRequestsMutex;
 };
 
 // Wrapper for converting websocket callback from static function to member function of WebSocket class.
@@ -341,6 +355,35 @@ bool WsThreadHelper::createWebSocketThread()
 void WsThreadHelper::quitWebSocketThread()
 {
     _needQuit = true;
+    wakeUp();
+}
+
+void WsThreadHelper::requestWritable(WebSocket* ws)
+{
+    {
+        std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+        if (std::find(_writableRequests.begin(), _writableRequests.end(), ws) == _writableRequests.end())
+        {
+            _writableRequests.push_back(ws);
+        }
+    }
+    wakeUp();
+}
+
+void WsThreadHelper::cancelWritableRequests(WebSocket* ws)
+{
+    std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+    _writableRequests.erase(std::remove(_writableRequests.begin(), _writableRequests.end(), ws), _writableRequests.end());
+}
+
+void WsThreadHelper::wakeUp()
+{
+    // lws_cancel_service writes to the wake up pipe of the context, the poll in 'lws_service' returns at once
+    std::lock_guard<std::mutex> lk(_contextMutex);
+    if (__wsContext != nullptr)
+    {
+        lws_cancel_service(__wsContext);
+    }
 }
 
 void WsThreadHelper::onSubThreadLoop()
@@ -375,14 +418,27 @@ void WsThreadHelper::onSubThreadLoop()
         }
         __wsHelper->_subThreadWsMessageQueueMutex.unlock();
 
-        // The second parameter passed to 'lws_service' means the timeout in milliseconds while polling websocket events.
-        // The lower value the better, otherwise, it may trigger high CPU usage.
-        // We set 2ms in 'lws_service' then sleep 3ms to make lower CPU cost.
+        // lws_callback_on_writable can only be invoked in websocket thread, the requests from cocos thread are
+        // handled here. The lock keeps the websockets alive since their destructors cancel their requests.
+        {
+            std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+            for (auto ws : _writableRequests)
+            {
+                if (ws->_wsInstance != nullptr)
+                {
+                    lws_callback_on_writable(ws->_wsInstance);
+                }
+            }
+            _writableRequests.clear();
+        }
+
+        // 'lws_service' sleeps in poll until a socket event happens, so incoming messages are handled at once.
+        // Sending, connecting and closing from cocos thread wake it up by 'lws_cancel_service', the timeout only
+        // lets libwebsockets check its internal timeouts.
         // Since messages are received in websocket thread and user code is in cocos thread, we need to post event to
         // cocos thread and trigger user callbacks by 'Scheduler::performFunctionInCocosThread'. If game's fps is set
-        // to 60 (16.66ms), the latency will be (2ms + 3ms + 16.66ms + internet delay) > 21ms
-        lws_service(__wsContext, 2);
-        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        // to 60 (16.66ms), the latency will be (16.66ms + internet delay)
+        lws_service(__wsContext, WS_SERVICE_TIMEOUT_MS);
     }
 }
 
@@ -401,14 +457,21 @@ void WsThreadHelper::onSubThreadStarted()
     __defaultProtocols[0].id = std::numeric_limits<uint32_t>::max();
 
     lws_context_creation_info creationInfo = convertToContextCreationInfo(__defaultProtocols, true);
+    std::lock_guard<std::mutex> lk(_contextMutex);
     __wsContext = lws_create_context(&creationInfo);
 }
 
 void WsThreadHelper::onSubThreadEnded()
 {
-    if (__wsContext != nullptr)
+    struct lws_context* context = nullptr;
+    {
+        // the context is destroyed outside the lock since the callbacks invoked by 'lws_context_destroy' may wake up
+        std::lock_guard<std::mutex> lk(_contextMutex);
+        std::swap(context, __wsContext);
+    }
+    if (context != nullptr)
     {
-        lws_context_destroy(__wsContext);
+        lws_context_destroy(context);
     }
 }
 
@@ -434,8 +497,11 @@ void WsThreadHelper::sendMessageToCocosThread(const std::function<void()>& cb)
 
 void WsThreadHelper::sendMessageToWebSocketThread(WsMessage *msg)
 {
-    std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
-    _subThreadWsMessageQueue->push_back(msg);
+    {
+        std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
+        _subThreadWsMessageQueue->push_back(msg);
+    }
+    wakeUp();
 }
 
 void WsThreadHelper::joinWebSocketThread()
@@ -457,25 +523,20 @@ public:
     {
     }
 
+    // The frame doesn't copy the payload, 'lws_write' writes the frame header into the LWS_PRE bytes before 'buf',
+    // they're either the padding reserved by 'allocSendingBytes' or the bytes of the previous frame which was sent.
     bool init(unsigned char* buf, ssize_t len)
     {
-        if (buf == nullptr && len > 0)
+        if (buf == nullptr)
             return false;
 
-        if (!_data.empty())
+        if (_payload != nullptr)
         {
             LOGD("WebSocketFrame was initialized, should not init it again!\n");
             return false;
         }
 
-        _data.reserve(LWS_PRE + len);
-        _data.resize(LWS_PRE, 0x00);
-        if (len > 0)
-        {
-            _data.insert(_data.end(), buf, buf + len);
-        }
-
-        _payload = _data.data() + LWS_PRE;
+        _payload = buf;
         _payloadLength = len;
         _frameLength = len;
         return true;
@@ -495,8 +556,30 @@ private:
     ssize_t _payloadLength;
 
     ssize_t _frameLength;
-    std::vector<unsigned char> _data;
 };
+
+// Allocates the bytes of a message to send with LWS_PRE bytes of padding before them,
+// so that the frames are written by 'lws_write' in place.
+static char* allocSendingBytes(size_t len)
+{
+    char* buf = (char*)malloc(LWS_PRE + len + 1);
+    if (buf == nullptr)
+    {
+        return nullptr;
+    }
+    // Make sure the last byte is '\0'
+    buf[LWS_PRE + len] = '\0';
+    return buf + LWS_PRE;
+}
+
+static void freeSendingBytes(WebSocket::Data* data)
+{
+    if (data->bytes != nullptr)
+    {
+        free(data->bytes - LWS_PRE);
+        data->bytes = nullptr;
+    }
+}
 //
 
 void WebSocket::closeAllConnections()
@@ -546,6 +629,11 @@ WebSocket::~WebSocket()
 {
     LOGD("In the destructor of WebSocket (%p)\n", this);
 
+    if (__wsHelper != nullptr)
+    {
+        __wsHelper->cancelWritableRequests(this);
+    }
+
     std::lock_guard<std::mutex> lk(__instanceMutex);
 
     if (__websocketInstances != nullptr)
@@ -653,10 +741,8 @@ void WebSocket::send(const std::string& message)
     {
         // In main thread
         Data* data = new (std::nothrow) Data();
-        data->bytes = (char*)malloc(message.length() + 1);
-        // Make sure the last byte is '\0'
-        data->bytes[message.length()] = '\0';
-        strcpy(data->bytes, message.c_str());
+        data->bytes = allocSendingBytes(message.length());
+        memcpy(data->bytes, message.c_str(), message.length());
         data->len = static_cast<ssize_t>(message.length());
 
         WsMessage* msg = new (std::nothrow) WsMessage();
@@ -664,6 +750,7 @@ void WebSocket::send(const std::string& message)
         msg->data = data;
         msg->user = this;
         __wsHelper->sendMessageToWebSocketThread(msg);
+        __wsHelper->requestWritable(this);
     }
     else
     {
@@ -677,15 +764,10 @@ void WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
     {
         // In main thread
         Data* data = new (std::nothrow) Data();
-        if (len == 0)
-        {
-            // If data length is zero, allocate 1 byte for safe.
-            data->bytes = (char*)malloc(1);
-            data->bytes[0] = '\0';
-        }
-        else
+        // If data length is zero, one byte is still allocated for safe.
+        data->bytes = allocSendingBytes(len);
+        if (len > 0)
         {
-            data->bytes = (char*)malloc(len);
             memcpy((void*)data->bytes, (void*)binaryMsg, len);
         }
         data->len = len;
@@ -695,6 +777,7 @@ void WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
         msg->data = data;
         msg->user = this;
         __wsHelper->sendMessageToWebSocketThread(msg);
+        __wsHelper->requestWritable(this);
     }
     else
     {
@@ -728,6 +811,9 @@ void WebSocket::close()
         _readyStateMutex.unlock();
     }
 
+    // The connection is closed by the writable callback
+    __wsHelper->requestWritable(this);
+
     {
         std::unique_lock<std::mutex> lkClose(_closeMutex);
         _closeCondition.wait(lkClose);
@@ -758,6 +844,8 @@ void WebSocket::closeAsync()
     }
 
     _readyState = State::CLOSING;
+    // The connection is closed by the writable callback
+    __wsHelper->requestWritable(this);
 }
 
 WebSocket::State WebSocket::getReadyState()
@@ -945,6 +1033,7 @@ int WebSocket::onClientWritable()
         }
     }
 
+    bool hasPendingMessages = false;
     do
     {
         std::lock_guard<std::mutex> lk(__wsHelper->_subThreadWsMessageQueueMutex);
@@ -1000,7 +1089,7 @@ int WebSocket::onClientWritable()
                   // These codes should never be called.
                     LOGD("WebSocketFrame initialization failed, drop the sending data, msg(%d)\n", (int)subThreadMsg->id);
                     delete frame;
-                    CC_SAFE_FREE(data->bytes);
+                    freeSendingBytes(data);
                     CC_SAFE_DELETE(data);
                     __wsHelper->_subThreadWsMessageQueue->erase(iter);
                     CC_SAFE_DELETE(subThreadMsg);
@@ -1040,7 +1129,7 @@ int WebSocket::onClientWritable()
             {
                 LOGD("ERROR: msg(%u), lws_write return: %d, but it should be %d, drop this message.\n", subThreadMsg->id, (int)bytesWrite, (int)n);
                 // socket error, we need to close the socket connection
-                CC_SAFE_FREE(data->bytes);
+                freeSendingBytes(data);
                 delete ((WebSocketFrame*)data->ext);
                 data->ext = nullptr;
                 CC_SAFE_DELETE(data);
@@ -1079,7 +1168,7 @@ int WebSocket::onClientWritable()
                     closeAsync();
                 }
 
-                CC_SAFE_FREE(data->bytes);
+                freeSendingBytes(data);
                 delete ((WebSocketFrame*)data->ext);
                 data->ext = nullptr;
                 CC_SAFE_DELETE(data);
@@ -1090,9 +1179,19 @@ int WebSocket::onClientWritable()
             }
         }
 
+        // Only waits for the next writable callback while there is still data to send,
+        // otherwise the callback is requested again by 'send' or 'close'.
+        for (auto msg : *__wsHelper->_subThreadWsMessageQueue)
+        {
+            if (msg->user == this && msg->what != WS_MSG_TO_SUBTHREAD_CREATE_CONNECTION)
+            {
+                hasPendingMessages = true;
+                break;
+            }
+        }
     } while(false);
 
-    if (_wsInstance != nullptr)
+    if (_wsInstance != nullptr && hasPendingMessages)
     {
         lws_callback_on_writable(_wsInstance);
     }
@@ -1105,10 +1204,17 @@ int WebSocket::onClientReceivedData(void* in, ssize_t len)
     // In websocket thread
     static int packageIndex = 0;
     packageIndex++;
+
+    size_t remainingSize = lws_remaining_packet_payload(_wsInstance);
+    int isFinalFragment = lws_is_final_fragment(_wsInstance);
+
     if (in != nullptr && len > 0)
     {
         LOGD("Receiving data:index:%d, len=%d\n", packageIndex, (int)len);
 
+        // Reserves the rest of the frame and the '\0' appended to text messages at once,
+        // the buffer is then handed to cocos thread without being copied again.
+        _receivedData.reserve(_receivedData.size() + len + remainingSize + 1);
         unsigned char* inData = (unsigned char*)in;
         _receivedData.insert(_receivedData.end(), inData, inData + len);
     }
@@ -1118,8 +1224,6 @@ int WebSocket::onClientReceivedData(void* in, ssize_t len)
     }
 
     // If no more data pending, send it to the client thread
-    size_t remainingSize = lws_remaining_packet_payload(_wsInstance);
-    int isFinalFragment = lws_is_final_fragment(_wsInstance);
 //    LOGD("remainingSize: %d, isFinalFragment: %d\n", (int)remainingSize, isFinalFragment);
 
     if (remainingSize == 0 && isFinalFragment)
@@ -1316,6 +1420,8 @@ int WebSocket::onSocketCallback(struct lws *wsi,
 
         case LWS_CALLBACK_WSI_DESTROY:
             ret = onConnectionClosed();
+            // Don't ask the destroyed wsi for writable callbacks any more
+            _wsInstance = nullptr;
             break;
 
         case LWS_CALLBACK_CLIENT_RECEIVE:
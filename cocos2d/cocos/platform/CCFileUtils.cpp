@@ -554,7 +554,8 @@ void FileUtils::setDelegate(FileUtils *delegate)
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _fullPathCacheGeneration(0)
+    , _writablePath("")
 {
 }
 
@@ -623,8 +624,15 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     DECLARE_GUARD;
+    invalidateFullPathCaches();
+}
+
+void FileUtils::invalidateFullPathCaches()
+{
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _missingPathCache.clear();
+    ++_fullPathCacheGeneration;
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename) const
@@ -651,6 +659,27 @@ Data FileUtils::getDataFromFile(const std::string& filename) const
     return d;
 }
 
+MappedData FileUtils::getMappedDataFromFile(const std::string& filename) const
+{
+    const std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+    {
+        return MappedData();
+    }
+
+    // only files on the file system can be mapped, not the ones in the Android package
+    if (fullPath[0] == '/')
+    {
+        MappedData mapped = MappedData::createWithFile(getSuitableFOpen(fullPath));
+        if (!mapped.isNull())
+        {
+            return mapped;
+        }
+    }
+
+    return MappedData(getDataFromFile(fullPath));
+}
+
 void FileUtils::getDataFromFile(const std::string& filename, std::function<void(Data)> callback) const
 {
     auto fullPath = fullPathForFilename(filename);
@@ -816,9 +845,6 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
 
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
-    
-    DECLARE_GUARD;
-
     if (filename.empty())
     {
         return "";
@@ -829,40 +855,139 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    std::string newFilename;
+    std::vector<std::string> searchPaths;
+    std::vector<std::string> resolutions;
+    std::vector<std::pair<std::string, std::string>> writableLocations;
+    std::shared_ptr<const std::unordered_set<std::string>> assetManifest;
+    std::string defaultResRootPath;
+    bool knownMissing = false;
+    unsigned int generation = 0;
     {
-        return cacheIter->second;
-    }
+        DECLARE_GUARD;
 
-    // Get the new file name.
-    const std::string newFilename( getNewFilename(filename) );
+        // Already Cached ?
+        auto cacheIter = _fullPathCache.find(filename);
+        if(cacheIter != _fullPathCache.end())
+        {
+            return cacheIter->second;
+        }
 
-    std::string fullpath;
+        // Not found before? Only the locations inside the writable path may have changed since.
+        auto missingIter = _missingPathCache.find(filename);
+        if (missingIter != _missingPathCache.end())
+        {
+            if (missingIter->second.empty())
+            {
+                return "";
+            }
+            knownMissing = true;
+            writableLocations = missingIter->second;
+        }
+        else
+        {
+            searchPaths = _searchPathArray;
+            resolutions = _searchResolutionsOrderArray;
+            assetManifest = _assetManifest;
+            defaultResRootPath = _defaultResRootPath;
+        }
 
-    for (const auto& searchIt : _searchPathArray)
+        // Get the new file name.
+        newFilename = getNewFilename(filename);
+        generation = _fullPathCacheGeneration;
+    }
+
+    // The file system is searched without holding the lock, so that the threads looking up
+    // different files don't wait for each other.
+    std::string fullpath;
+    if (knownMissing)
     {
-        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        for (const auto& location : writableLocations)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            fullpath = this->getPathForFilename(newFilename, location.second, location.first);
+            if (!fullpath.empty())
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        const std::string writablePath = getWritablePath();
+
+        // the manifest lists paths relative to the default resource root path
+        std::string file = newFilename;
+        std::string filePath;
+        size_t pos = newFilename.find_last_of('/');
+        if (pos != std::string::npos)
+        {
+            filePath = newFilename.substr(0, pos + 1);
+            file = newFilename.substr(pos + 1);
+        }
+
+        for (const auto& searchIt : searchPaths)
+        {
+            bool inWritablePath = !writablePath.empty()
+                && searchIt.compare(0, writablePath.length(), writablePath) == 0;
+            bool useManifest = assetManifest && !inWritablePath
+                && searchIt.compare(0, defaultResRootPath.length(), defaultResRootPath) == 0;
+
+            for (const auto& resolutionIt : resolutions)
+            {
+                if (useManifest)
+                {
+                    std::string directory = searchIt + filePath + resolutionIt;
+                    std::string relativePath = directory.substr(defaultResRootPath.length()) + file;
+                    fullpath = assetManifest->count(relativePath) ? directory + file : "";
+                }
+                else
+                {
+                    fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+                }
+
+                if (!fullpath.empty())
+                {
+                    break;
+                }
+
+                if (inWritablePath)
+                {
+                    writableLocations.emplace_back(searchIt, resolutionIt);
+                }
+            }
 
+            if (!fullpath.empty())
+            {
+                break;
+            }
+        }
+    }
+
+    {
+        DECLARE_GUARD;
+
+        // the search paths may have changed during the search
+        if (generation == _fullPathCacheGeneration)
+        {
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
                 _fullPathCache.emplace(filename, fullpath);
-                return fullpath;
+                _missingPathCache.erase(filename);
+            }
+            else if (!knownMissing)
+            {
+                _missingPathCache.emplace(filename, std::move(writableLocations));
             }
-
         }
     }
 
-    if(isPopupNotify()){
+    if(fullpath.empty() && !knownMissing && isPopupNotify()){
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
 
     // The file wasn't found, return empty string.
-    return "";
+    return fullpath;
 }
 
 
@@ -935,8 +1060,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     bool existDefault = false;
 
-    _fullPathCache.clear();
-    _fullPathCacheDir.clear();
+    invalidateFullPathCaches();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -974,6 +1098,8 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
     }
+
+    invalidateFullPathCaches();
 }
 
 const std::vector<std::string> FileUtils::getSearchResolutionsOrder() const
@@ -1011,8 +1137,7 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
     DECLARE_GUARD;
     if (_defaultResRootPath != path)
     {
-        _fullPathCache.clear();
-        _fullPathCacheDir.clear();
+        invalidateFullPathCaches();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
         {
@@ -1030,8 +1155,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
     _originalSearchPaths = searchPaths;
 
-    _fullPathCache.clear();
-    _fullPathCacheDir.clear();
+    invalidateFullPathCaches();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -1082,13 +1206,14 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+
+    invalidateFullPathCaches();
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     DECLARE_GUARD;
-    _fullPathCache.clear();
-    _fullPathCacheDir.clear();
+    invalidateFullPathCaches();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1112,6 +1237,54 @@ void FileUtils::loadFilenameLookupDictionaryFromFile(const std::string &filename
     }
 }
 
+void FileUtils::setAssetManifest(const std::vector<std::string>& files)
+{
+    std::shared_ptr<const std::unordered_set<std::string>> manifest;
+    if (!files.empty())
+    {
+        manifest = std::make_shared<const std::unordered_set<std::string>>(files.begin(), files.end());
+    }
+
+    DECLARE_GUARD;
+    _assetManifest = std::move(manifest);
+    invalidateFullPathCaches();
+}
+
+bool FileUtils::loadAssetManifestFromFile(const std::string &filename)
+{
+    std::string contents = getStringFromFile(filename);
+    if (contents.empty())
+    {
+        CCLOG("cocos2d: FileUtils: Can't load the asset manifest %s", filename.c_str());
+        return false;
+    }
+
+    std::vector<std::string> files;
+    size_t start = 0;
+    while (start < contents.length())
+    {
+        size_t end = contents.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = contents.length();
+        }
+
+        size_t length = end - start;
+        if (length > 0 && contents[end - 1] == '\r')
+        {
+            --length;
+        }
+        if (length > 0 && contents[start] != '#')
+        {
+            files.emplace_back(contents, start, length);
+        }
+        start = end + 1;
+    }
+
+    setAssetManifest(files);
+    return true;
+}
+
 std::string FileUtils::getFullPathForFilenameWithinDirectory(const std::string& directory, const std::string& filename) const
 {
     // get directory+filename, safely adding '/' as necessary
@@ -29,13 +29,16 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <mutex>
+#include <memory>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
+#include "platform/CCMappedData.h"
 #include "base/CCAsyncTaskPool.h"
 #include "base/CCScheduler.h"
 #include "base/CCDirector.h"
@@ -184,6 +187,20 @@ public:
      *  @return A data object.
      */
     virtual Data getDataFromFile(const std::string& filename) const;
+
+    /**
+     *  Gets the read-only contents of a file without copying them when possible.
+     *
+     *  Files of at least 16 KB on the file system are mapped into memory on the platforms that
+     *  support it; the others, like the files in the Android package, are read as with getDataFromFile().
+     *  It's meant for consumers that only parse the contents, like image decoders and JSON parsers.
+     *
+     *  @param filename The file name, it can be a relative or an absolute path.
+     *  @return The contents, which are null if the file can't be read.
+     *  @js NA
+     *  @lua NA
+     */
+    virtual MappedData getMappedDataFromFile(const std::string& filename) const;
     
 
     /**
@@ -336,6 +353,12 @@ public:
 
      If the new file can't be found on the file system, it will return the parameter filename directly.
 
+     Both found and missing files are cached, until the search paths, the resolution orders or the
+     filename lookup dictionary change, or purgeCachedEntries() is called. A missing file is looked up
+     again only in the search paths inside the writable path, the others are expected not to change.
+     The file system is searched without holding the FileUtils lock, so it can be called from several
+     threads at once.
+
      This method was added to simplify multiplatform support. Whether you are using cocos2d-js or any cross-compilation toolchain like StellaSDK or Apportable,
      you might need to load different resources for a given file in the different platforms.
 
@@ -387,6 +410,28 @@ public:
      */
     virtual void setFilenameLookupDictionary(const ValueMap& filenameLookupDict);
 
+    /**
+     *  Sets the list of the files shipped in the default resource root path.
+     *
+     *  When it's set, fullPathForFilename() looks the files of the search paths inside the default
+     *  resource root path up in this list instead of checking the file system, so the list must contain
+     *  all of them. The search paths inside the writable path are still checked on the file system.
+     *
+     *  @param files The paths of the files, relative to the default resource root path and separated by '/'.
+     *               An empty list turns the manifest off.
+     */
+    void setAssetManifest(const std::vector<std::string>& files);
+
+    /**
+     *  Loads the asset manifest from a text file which contains one relative path per line.
+     *  Empty lines and lines starting with '#' are ignored.
+     *
+     *  @param filename The manifest file name.
+     *  @return True if the manifest was loaded.
+     *  @see setAssetManifest()
+     */
+    bool loadAssetManifestFromFile(const std::string &filename);
+
     /**
      *  Gets full path from a file name and the path of the relative file.
      *  @param filename The file name.
@@ -845,7 +890,11 @@ public:
     virtual void listFilesRecursivelyAsync(const std::string& dirPath, std::function<void(std::vector<std::string>)> callback) const;
 
     /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache; }
+    const std::unordered_map<std::string, std::string> getFullPathCache() const
+    {
+        std::lock_guard<std::recursive_mutex> mutexGuard(_mutex);
+        return _fullPathCache;
+    }
 
     /**
      *  Gets the new filename from the filename lookup dictionary.
@@ -915,6 +964,12 @@ protected:
      */
     virtual std::string fullPathForDirectory(const std::string &dirname) const;
 
+    /**
+     * Clears the full path caches, and drops the results of the searches started before.
+     * The caller must hold _mutex.
+     */
+    void invalidateFullPathCaches();
+
     /**
     * mutex used to protect fields. 
     */
@@ -968,6 +1023,24 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCacheDir;
 
+    /**
+     *  The cache of files which weren't found, with the locations to check again next time:
+     *  the search path and resolution directory pairs inside the writable path.
+     */
+    mutable std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> _missingPathCache;
+
+    /**
+     *  Incremented whenever the full path caches are cleared. A search which started before
+     *  doesn't store its result.
+     */
+    unsigned int _fullPathCacheGeneration;
+
+    /**
+     *  The files shipped in the default resource root path, see setAssetManifest().
+     *  It's replaced instead of modified, so searches can use it without holding the lock.
+     */
+    std::shared_ptr<const std::unordered_set<std::string>> _assetManifest;
+
     /**
      * Writable path.
      */
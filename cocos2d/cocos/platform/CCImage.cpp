@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 
 #include <string>
+#include <list>
+#include <mutex>
 #include <ctype.h>
 
 #include "base/CCData.h"
@@ -87,6 +89,7 @@ extern "C"
 #endif //CC_USE_TIFF
 
 #include "base/etc1.h"
+#include "base/etc2.h"
     
 #if CC_USE_JPEG
 #include "jpeglib.h"
@@ -428,6 +431,92 @@ namespace
 
 //////////////////////////////////////////////////////////////////////////
 
+//struct and data for astc struct
+namespace
+{
+    const uint32_t ASTC_MAGIC = 0x5CA1AB13;
+
+    struct ASTCTexHeader
+    {
+        uint8_t magic[4];
+        uint8_t blockDimX;
+        uint8_t blockDimY;
+        uint8_t blockDimZ;
+        uint8_t xSize[3];
+        uint8_t ySize[3];
+        uint8_t zSize[3];
+    };
+
+    uint32_t readASTCSize(const uint8_t size[3])
+    {
+        return size[0] | (size[1] << 8) | (size[2] << 16);
+    }
+}
+//astc struct end
+
+//////////////////////////////////////////////////////////////////////////
+
+// cache of the images decoded by software, most recently used first
+namespace
+{
+    struct DecodedImage
+    {
+        std::string path;
+        ssize_t sourceLen;
+        int width;
+        int height;
+        Texture2D::PixelFormat format;
+        std::vector<unsigned char> data;
+    };
+
+    std::mutex s_decodedImagesMutex;
+    std::list<DecodedImage> s_decodedImages;
+    size_t s_decodedImagesSize = 0;
+    size_t s_decodedImagesLimit = 8 * 1024 * 1024;
+
+    void trimDecodedImages()
+    {
+        while (s_decodedImagesSize > s_decodedImagesLimit && !s_decodedImages.empty())
+        {
+            s_decodedImagesSize -= s_decodedImages.back().data.size();
+            s_decodedImages.pop_back();
+        }
+    }
+
+    const DecodedImage* findDecodedImage(const std::string& path, ssize_t sourceLen)
+    {
+        for (auto it = s_decodedImages.begin(); it != s_decodedImages.end(); ++it)
+        {
+            if (it->path == path && it->sourceLen == sourceLen)
+            {
+                s_decodedImages.splice(s_decodedImages.begin(), s_decodedImages, it);
+                return &s_decodedImages.front();
+            }
+        }
+        return nullptr;
+    }
+
+    void addDecodedImage(const std::string& path, ssize_t sourceLen, int width, int height,
+                         Texture2D::PixelFormat format, const unsigned char* data, ssize_t dataLen)
+    {
+        if (path.empty() || static_cast<size_t>(dataLen) > s_decodedImagesLimit)
+            return;
+
+        s_decodedImages.push_front(DecodedImage());
+        DecodedImage& image = s_decodedImages.front();
+        image.path = path;
+        image.sourceLen = sourceLen;
+        image.width = width;
+        image.height = height;
+        image.format = format;
+        image.data.assign(data, data + dataLen);
+        s_decodedImagesSize += dataLen;
+        trimDecodedImages();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 namespace
 {
     typedef struct 
@@ -453,6 +542,65 @@ namespace
         }
     }
 #endif //CC_USE_PNG
+
+    // The row buffers of the PNG and JPEG decoders are reused since textures are usually loaded in bursts.
+    // Images can be decoded on the main thread and on the texture loading threads at the same time.
+    std::mutex s_rowBuffersMutex;
+    std::vector<std::vector<unsigned char>> s_rowBuffers;
+    const size_t MAX_POOLED_ROW_BUFFERS = 4;
+
+    void acquireRowBuffer(std::vector<unsigned char>& buffer, size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_rowBuffersMutex);
+            if (!s_rowBuffers.empty())
+            {
+                buffer.swap(s_rowBuffers.back());
+                s_rowBuffers.pop_back();
+            }
+        }
+        buffer.resize(size);
+    }
+
+    void releaseRowBuffer(std::vector<unsigned char>& buffer)
+    {
+        if (buffer.capacity() == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(s_rowBuffersMutex);
+        if (s_rowBuffers.size() < MAX_POOLED_ROW_BUFFERS)
+        {
+            s_rowBuffers.push_back(std::vector<unsigned char>());
+            s_rowBuffers.back().swap(buffer);
+        }
+        else
+        {
+            std::vector<unsigned char>().swap(buffer);
+        }
+    }
+
+    // the pixel format the decoded rows are converted to, originFormat if they are kept as they are
+    Texture2D::PixelFormat getDecodeFormat(Texture2D::PixelFormat originFormat, Texture2D::PixelFormat format)
+    {
+        if (format == Texture2D::PixelFormat::AUTO || format == Texture2D::PixelFormat::NONE
+            || !Texture2D::canConvertPixels(originFormat, format))
+        {
+            return originFormat;
+        }
+        return format;
+    }
+
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+    void premultiplyAlphaRow(unsigned char* row, int width)
+    {
+        unsigned int* fourBytes = (unsigned int*)row;
+        for (int i = 0; i < width; i++)
+        {
+            unsigned char* p = row + i * 4;
+            fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        }
+    }
+#endif
 }
 
 Texture2D::PixelFormat getDevicePixelFormat(Texture2D::PixelFormat format)
@@ -491,6 +639,7 @@ Image::Image()
 , _renderFormat(Texture2D::PixelFormat::NONE)
 , _numberOfMipmaps(0)
 , _hasPremultipliedAlpha(false)
+, _decodePixelFormat(Texture2D::PixelFormat::AUTO)
 {
 
 }
@@ -511,7 +660,9 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    // the decoders copy the pixels out, so the file can be mapped instead of read;
+    // the mapping is copy-on-write because encrypted CCZ data is decrypted in place
+    MappedData data = FileUtils::getInstance()->getMappedDataFromFile(_filePath);
 
     if (!data.isNull())
     {
@@ -526,7 +677,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    MappedData data = FileUtils::getInstance()->getMappedDataFromFile(fullpath);
 
     if (!data.isNull())
     {
@@ -590,6 +741,12 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
         case Format::ATITC:
             ret = initWithATITCData(unpackedData, unpackedLen);
             break;
+        case Format::ETC2:
+            ret = initWithETC2Data(unpackedData, unpackedLen);
+            break;
+        case Format::ASTC:
+            ret = initWithASTCData(unpackedData, unpackedLen);
+            break;
         default:
             {
                 // load and detect image format
@@ -660,6 +817,23 @@ bool Image::isATITC(const unsigned char *data, ssize_t /*dataLen*/)
     return true;
 }
 
+bool Image::isEtc2(const unsigned char * data, ssize_t dataLen)
+{
+    return dataLen >= ETC2_PKM_HEADER_SIZE && etc2_pkm_is_valid((etc1_byte*)data);
+}
+
+bool Image::isASTC(const unsigned char * data, ssize_t dataLen)
+{
+    if (dataLen < (ssize_t)sizeof(ASTCTexHeader))
+    {
+        return false;
+    }
+
+    const ASTCTexHeader* header = (const ASTCTexHeader*)data;
+    uint32_t magic = header->magic[0] | (header->magic[1] << 8) | (header->magic[2] << 16) | ((uint32_t)header->magic[3] << 24);
+    return magic == ASTC_MAGIC;
+}
+
 bool Image::isJpg(const unsigned char * data, ssize_t dataLen)
 {
     if (dataLen <= 4)
@@ -747,6 +921,14 @@ Image::Format Image::detectFormat(const unsigned char * data, ssize_t dataLen)
     {
         return Format::ATITC;
     }
+    else if (isEtc2(data, dataLen))
+    {
+        return Format::ETC2;
+    }
+    else if (isASTC(data, dataLen))
+    {
+        return Format::ASTC;
+    }
     else
     {
         return Format::UNKNOWN;
@@ -986,18 +1168,36 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         _width  = cinfo.output_width;
         _height = cinfo.output_height;
 
-        _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
+        // the scan lines are converted to the decode format one by one
+        auto format = getDecodeFormat(_renderFormat, _decodePixelFormat);
+        size_t rowBytes = cinfo.output_width * cinfo.output_components;
+        size_t outRowBytes = cinfo.output_width * Texture2D::getPixelFormatInfoMap().at(format).bpp / 8;
+        bool convert = format != _renderFormat;
+
+        _dataLen = outRowBytes * cinfo.output_height;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
         CC_BREAK_IF(! _data);
 
+        if (convert)
+        {
+            acquireRowBuffer(_rowBuffer, rowBytes);
+        }
+
         /* now actually read the jpeg into the raw buffer */
         /* read one scan line at a time */
         while (cinfo.output_scanline < cinfo.output_height)
         {
-            row_pointer[0] = _data + location;
-            location += cinfo.output_width*cinfo.output_components;
+            unsigned char* outRow = _data + location;
+            row_pointer[0] = convert ? _rowBuffer.data() : outRow;
+            location += outRowBytes;
             jpeg_read_scanlines(&cinfo, row_pointer, 1);
+
+            if (convert)
+            {
+                Texture2D::convertPixels(row_pointer[0], rowBytes, _renderFormat, format, outRow);
+            }
         }
+        _renderFormat = format;
 
     /* When read image file with broken data, jpeg_finish_decompress() may cause error.
      * Besides, jpeg_destroy_decompress() shall deallocate and release all memory associated
@@ -1010,6 +1210,7 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         ret = true;
     } while (0);
 
+    releaseRowBuffer(_rowBuffer);
     return ret;
 #else
     CCLOG("jpeg is not enabled, please enable it in ccConfig.h");
@@ -1121,47 +1322,101 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
 
         // read png data
         png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
 
         rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 
-        _dataLen = rowbytes * _height;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        if (!_data)
+        if (png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE)
         {
-            if (row_pointers != nullptr)
+            // the rows are premultiplied and converted to the decode format one by one,
+            // while they are still in the cache
+            auto format = getDecodeFormat(_renderFormat, _decodePixelFormat);
+            size_t outRowBytes = _width * Texture2D::getPixelFormatInfoMap().at(format).bpp / 8;
+            bool convert = format != _renderFormat;
+
+            _dataLen = outRowBytes * _height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            CC_BREAK_IF(!_data);
+
+            if (convert)
             {
-                free(row_pointers);
+                acquireRowBuffer(_rowBuffer, rowbytes);
             }
-            break;
-        }
 
-        for (unsigned short i = 0; i < _height; ++i)
-        {
-            row_pointers[i] = _data + i*rowbytes;
-        }
-        png_read_image(png_ptr, row_pointers);
+            bool premultiply = false;
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+            premultiply = (color_type == PNG_COLOR_TYPE_RGB_ALPHA && PNG_PREMULTIPLIED_ALPHA_ENABLED);
+#endif
+            for (int i = 0; i < _height; ++i)
+            {
+                unsigned char* outRow = _data + i * outRowBytes;
+                unsigned char* row = convert ? _rowBuffer.data() : outRow;
+                png_read_row(png_ptr, row, nullptr);
 
-        png_read_end(png_ptr, nullptr);
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+                if (premultiply)
+                {
+                    premultiplyAlphaRow(row, _width);
+                }
+#endif
+                if (convert)
+                {
+                    Texture2D::convertPixels(row, rowbytes, _renderFormat, format, outRow);
+                }
+            }
+            _renderFormat = format;
 
-        // premultiplied alpha for RGBA8888
-        if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
+            png_read_end(png_ptr, nullptr);
+
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+            if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
+            {
+                _hasPremultipliedAlpha = true;
+            }
+#endif
+        }
+        else
         {
-            if (PNG_PREMULTIPLIED_ALPHA_ENABLED)
+            // interlaced images are decoded in several passes over the whole image
+            png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+
+            _dataLen = rowbytes * _height;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+            if (!_data)
             {
-                premultipliedAlpha();
+                if (row_pointers != nullptr)
+                {
+                    free(row_pointers);
+                }
+                break;
             }
-            else
+
+            for (unsigned short i = 0; i < _height; ++i)
+            {
+                row_pointers[i] = _data + i*rowbytes;
+            }
+            png_read_image(png_ptr, row_pointers);
+
+            png_read_end(png_ptr, nullptr);
+
+            // premultiplied alpha for RGBA8888
+            if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
             {
+                if (PNG_PREMULTIPLIED_ALPHA_ENABLED)
+                {
+                    premultipliedAlpha();
+                }
+                else
+                {
 #if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
-                _hasPremultipliedAlpha = true;
+                    _hasPremultipliedAlpha = true;
 #endif
+                }
             }
-        }
 
-        if (row_pointers != nullptr)
-        {
-            free(row_pointers);
+            if (row_pointers != nullptr)
+            {
+                free(row_pointers);
+            }
         }
 
         ret = true;
@@ -1171,6 +1426,7 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
     {
         png_destroy_read_struct(&png_ptr, (info_ptr) ? &info_ptr : 0, 0);
     }
+    releaseRowBuffer(_rowBuffer);
     return ret;
 #else
     CCLOG("png is not enabled, please enable it in ccConfig.h");
@@ -1774,6 +2030,122 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
     return false;
 }
 
+bool Image::initWithETC2Data(const unsigned char * data, ssize_t dataLen)
+{
+    const etc1_byte* header = static_cast<const etc1_byte*>(data);
+
+    _width = etc2_pkm_get_width(header);
+    _height = etc2_pkm_get_height(header);
+
+    if (0 == _width || 0 == _height)
+    {
+        return false;
+    }
+
+    bool hasAlpha = etc2_pkm_has_alpha(header) != 0;
+    ssize_t encodedLen = etc2_get_encoded_data_size(_width, _height, hasAlpha);
+    if (dataLen - ETC2_PKM_HEADER_SIZE < encodedLen)
+    {
+        CCLOG("cocos2d: the ETC2 image is truncated: %s", _filePath.c_str());
+        return false;
+    }
+
+    if (Configuration::getInstance()->supportsETC2())
+    {
+        _renderFormat = hasAlpha ? Texture2D::PixelFormat::ETC2_RGBA : Texture2D::PixelFormat::ETC2_RGB;
+        _dataLen = encodedLen;
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        memcpy(_data, static_cast<const unsigned char*>(data) + ETC2_PKM_HEADER_SIZE, _dataLen);
+        return true;
+    }
+
+    // if it is not gles 3 or device do not support ETC2, decode texture by software,
+    // reusing the pixels decoded when the texture was loaded last time
+    std::lock_guard<std::mutex> lock(s_decodedImagesMutex);
+
+    const DecodedImage* decoded = findDecodedImage(_filePath, dataLen);
+    if (decoded != nullptr)
+    {
+        _renderFormat = decoded->format;
+        _dataLen = decoded->data.size();
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        memcpy(_data, decoded->data.data(), _dataLen);
+        return true;
+    }
+
+    CCLOG("cocos2d: Hardware ETC2 decoder not present. Using software decoder");
+
+    int bytePerPixel = 4;
+    unsigned int stride = _width * bytePerPixel;
+    _renderFormat = Texture2D::PixelFormat::RGBA8888;
+
+    _dataLen = _width * _height * bytePerPixel;
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+
+    if (etc2_decode_image(static_cast<const unsigned char*>(data) + ETC2_PKM_HEADER_SIZE, static_cast<etc1_byte*>(_data), _width, _height, stride, hasAlpha) != 0)
+    {
+        _dataLen = 0;
+        if (_data != nullptr)
+        {
+            free(_data);
+        }
+        return false;
+    }
+
+    addDecodedImage(_filePath, dataLen, _width, _height, _renderFormat, _data, _dataLen);
+    return true;
+}
+
+bool Image::initWithASTCData(const unsigned char * data, ssize_t dataLen)
+{
+    const ASTCTexHeader* header = (const ASTCTexHeader*)data;
+
+    _width = readASTCSize(header->xSize);
+    _height = readASTCSize(header->ySize);
+
+    if (0 == _width || 0 == _height || readASTCSize(header->zSize) > 1 || header->blockDimZ > 1)
+    {
+        return false;
+    }
+
+    if (!Configuration::getInstance()->supportsASTC())
+    {
+        CCLOG("cocos2d: WARNING: ASTC textures are not supported by the device: %s", _filePath.c_str());
+        return false;
+    }
+
+    if (header->blockDimX == 4 && header->blockDimY == 4)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_4x4;
+    }
+    else if (header->blockDimX == 6 && header->blockDimY == 6)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_6x6;
+    }
+    else if (header->blockDimX == 8 && header->blockDimY == 8)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_8x8;
+    }
+    else
+    {
+        CCLOG("cocos2d: WARNING: unsupported ASTC block size %dx%d", header->blockDimX, header->blockDimY);
+        return false;
+    }
+
+    ssize_t encodedLen = ((_width + header->blockDimX - 1) / header->blockDimX)
+                       * ((_height + header->blockDimY - 1) / header->blockDimY) * 16;
+    if (dataLen - (ssize_t)sizeof(ASTCTexHeader) < encodedLen)
+    {
+        CCLOG("cocos2d: the ASTC image is truncated: %s", _filePath.c_str());
+        return false;
+    }
+
+    _dataLen = encodedLen;
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+    memcpy(_data, data + sizeof(ASTCTexHeader), _dataLen);
+    return true;
+}
+
 bool Image::initWithTGAData(tImageTGA* tgaData)
 {
     bool ret = false;
@@ -2474,6 +2846,13 @@ void Image::premultipliedAlpha()
 }
 
 
+void Image::setSoftwareDecodeCacheLimit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(s_decodedImagesMutex);
+    s_decodedImagesLimit = bytes;
+    trimDecodedImages();
+}
+
 void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
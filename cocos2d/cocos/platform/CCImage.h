@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __CC_IMAGE_H__
 /// @cond DO_NOT_SHOW
 
+#include <vector>
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
 
@@ -93,6 +94,10 @@ public:
         S3TC,
         //! ATITC
         ATITC,
+        //! ETC2 (PKM 2.0)
+        ETC2,
+        //! ASTC
+        ASTC,
         //! TGA
         TGA,
         //! Raw Data
@@ -116,6 +121,21 @@ public:
      */
     static void setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
 
+    /** Converts PNG and JPEG images to this pixel format row by row while decoding them, with the same result
+     as the conversion of Texture2D::initWithImage, but without a second buffer for the whole image.
+     PixelFormat::AUTO, the default, keeps the decoded pixel format.
+     Call it before initWithImageFile or initWithImageData.
+     */
+    void setDecodePixelFormat(Texture2D::PixelFormat format) { _decodePixelFormat = format; }
+
+    /** Sets the memory limit of the cache of ETC2 images that were decoded by software, because the GPU doesn't
+     support ETC2. They are decoded again when the textures are reloaded or loaded again otherwise.
+     0 disables the cache.
+
+     @param bytes (default: 8 MB)
+     */
+    static void setSoftwareDecodeCacheLimit(size_t bytes);
+
     /**
     @brief Load the image from the specified path.
     @param path   the absolute file path.
@@ -176,6 +196,8 @@ protected:
     bool initWithETCData(const unsigned char * data, ssize_t dataLen);
     bool initWithS3TCData(const unsigned char * data, ssize_t dataLen);
     bool initWithATITCData(const unsigned char *data, ssize_t dataLen);
+    bool initWithETC2Data(const unsigned char * data, ssize_t dataLen);
+    bool initWithASTCData(const unsigned char * data, ssize_t dataLen);
     typedef struct sImageTGA tImageTGA;
     bool initWithTGAData(tImageTGA* tgaData);
 
@@ -206,6 +228,9 @@ protected:
     // false if we can't auto detect the image is premultiplied or not.
     bool _hasPremultipliedAlpha;
     std::string _filePath;
+    Texture2D::PixelFormat _decodePixelFormat;
+    // one row of the decoded image before it is converted to _decodePixelFormat
+    std::vector<unsigned char> _rowBuffer;
 
 
 protected:
@@ -231,6 +256,8 @@ protected:
     bool isEtc(const unsigned char * data, ssize_t dataLen);
     bool isS3TC(const unsigned char * data,ssize_t dataLen);
     bool isATITC(const unsigned char *data, ssize_t dataLen);
+    bool isEtc2(const unsigned char * data, ssize_t dataLen);
+    bool isASTC(const unsigned char * data, ssize_t dataLen);
 };
 
 // end of platform group
@@ -0,0 +1,172 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "platform/CCMappedData.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CC_MAPPED_DATA_USE_MMAP 1
+#else
+#define CC_MAPPED_DATA_USE_MMAP 0
+#endif
+
+NS_CC_BEGIN
+
+// smaller files cost less to read than to map and unmap
+static const off_t MIN_MAPPED_FILE_SIZE = 16 * 1024;
+
+MappedData::MappedData()
+: _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+{
+}
+
+MappedData::MappedData(Data&& data)
+: _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+, _data(std::move(data))
+{
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+}
+
+MappedData::MappedData(MappedData&& other)
+: _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+{
+    move(other);
+}
+
+MappedData& MappedData::operator=(MappedData&& other)
+{
+    if (this != &other)
+    {
+        clear();
+        move(other);
+    }
+    return *this;
+}
+
+MappedData::~MappedData()
+{
+    clear();
+}
+
+void MappedData::move(MappedData& other)
+{
+    _bytes = other._bytes;
+    _size = other._size;
+    _mapped = other._mapped;
+    _data = std::move(other._data);
+
+    other._bytes = nullptr;
+    other._size = 0;
+    other._mapped = false;
+}
+
+void MappedData::clear()
+{
+#if CC_MAPPED_DATA_USE_MMAP
+    if (_mapped && _bytes)
+    {
+        munmap(_bytes, (size_t)_size);
+    }
+#endif
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+    _mapped = false;
+}
+
+MappedData MappedData::createWithFile(const std::string& fullPath)
+{
+    MappedData ret;
+#if CC_MAPPED_DATA_USE_MMAP
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return ret;
+    }
+
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == 0 && S_ISREG(statBuf.st_mode) && statBuf.st_size > 0)
+    {
+        if (statBuf.st_size >= MIN_MAPPED_FILE_SIZE)
+        {
+            // writable and private: some decoders, like the encrypted CCZ one, decrypt the input in place,
+            // the pages they touch are copied and the file is never modified
+            void* address = mmap(nullptr, (size_t)statBuf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED)
+            {
+                ret._bytes = static_cast<unsigned char*>(address);
+                ret._size = (ssize_t)statBuf.st_size;
+                ret._mapped = true;
+            }
+        }
+        else
+        {
+            size_t size = (size_t)statBuf.st_size;
+            unsigned char* buffer = (unsigned char*)malloc(size);
+            size_t readSize = 0;
+            while (buffer && readSize < size)
+            {
+                ssize_t n = read(fd, buffer + readSize, size - readSize);
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    break;
+                }
+                readSize += (size_t)n;
+            }
+
+            if (buffer && readSize == size)
+            {
+                Data data;
+                data.fastSet(buffer, (ssize_t)size);
+                ret = MappedData(std::move(data));
+            }
+            else
+            {
+                free(buffer);
+            }
+        }
+    }
+    close(fd);
+#else
+    CC_UNUSED_PARAM(fullPath);
+#endif
+    return ret;
+}
+
+NS_CC_END
@@ -0,0 +1,102 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CC_MAPPED_DATA_H__
+#define __CC_MAPPED_DATA_H__
+
+#include "base/CCData.h"
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * Read-only contents of a file, returned by FileUtils::getMappedDataFromFile().
+ *
+ * Large files on the file system are mapped into memory instead of being read, so their pages
+ * are loaded on demand and shared with the OS file cache. The mapping is released when the object
+ * is destroyed. Other files, like the ones in the Android package or on Windows, are read into a Data.
+ *
+ * The mapping is private and copy-on-write, so decoders that modify their input in place, like the
+ * encrypted CCZ one, work on a copy of the pages they write and never change the file.
+ *
+ * The file must not be truncated while it's mapped. It's meant for assets, not for files that the
+ * game keeps writing.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL MappedData
+{
+public:
+    /** Creates an empty object. */
+    MappedData();
+
+    /** Wraps the contents read into a Data. */
+    explicit MappedData(Data&& data);
+
+    MappedData(MappedData&& other);
+    MappedData& operator=(MappedData&& other);
+    ~MappedData();
+
+    /**
+     * Maps a file into memory, or reads it if it's smaller than a few pages.
+     * @param fullPath The full path of the file on the file system.
+     * @return The contents, which are null if the file can't be opened or isn't supported on this platform.
+     */
+    static MappedData createWithFile(const std::string& fullPath);
+
+    /** Gets the contents, which stay valid until this object is destroyed or cleared. */
+    const unsigned char* getBytes() const { return _bytes; }
+
+    /** Gets the size of the contents. */
+    ssize_t getSize() const { return _size; }
+
+    /** Checks whether the contents are empty. */
+    bool isNull() const { return _bytes == nullptr || _size == 0; }
+
+    /** Checks whether the contents are mapped from the file. */
+    bool isMapped() const { return _mapped; }
+
+    /** Releases the contents. */
+    void clear();
+
+private:
+    MappedData(const MappedData&) = delete;
+    MappedData& operator=(const MappedData&) = delete;
+
+    void move(MappedData& other);
+
+    unsigned char* _bytes;
+    ssize_t _size;
+    bool _mapped;
+    /// Owns the contents when they were read instead of mapped
+    Data _data;
+};
+
+NS_CC_END
+// end of platform group
+/** @} */
+
+#endif // __CC_MAPPED_DATA_H__
@@ -216,6 +216,14 @@ public:
     static const char* SHADER_NAME_LABEL_OUTLINE;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_GLOW;
+    /** @} */
+    /** @{
+        Built in shader for labels whose quads are batched by the renderer.
+        The vertices are not multiplied by the MV matrix and the text color comes from the vertex color.
+    */
+    static const char* SHADER_NAME_LABEL_NORMAL_NO_MVP;
+    static const char* SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL_NO_MVP;
+    /** @} */
 
     /**Built in shader used for 3D, support Position vertex attribute, with color specified by a uniform.*/
     static const char* SHADER_3D_POSITION;
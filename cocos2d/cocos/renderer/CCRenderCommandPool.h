@@ -27,7 +27,7 @@
 #define __CC_RENDERCOMMANDPOOL_H__
 /// @cond DO_NOT_SHOW
 
-#include <list>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 
@@ -62,8 +62,9 @@ public:
         {
             AllocateCommands();
         }
-        result = _freePool.front();
-        _freePool.pop_front();
+        // the free pool is used as a stack, so recycling commands doesn't allocate list nodes
+        result = _freePool.back();
+        _freePool.pop_back();
         //_usedPool.insert(result);
         return result;
     }
@@ -86,14 +87,15 @@ private:
         static const int COMMANDS_ALLOCATE_BLOCK_SIZE = 32;
         T* commands = new (std::nothrow) T[COMMANDS_ALLOCATE_BLOCK_SIZE];
         _allocatedPoolBlocks.push_back(commands);
+        _freePool.reserve(_allocatedPoolBlocks.size() * COMMANDS_ALLOCATE_BLOCK_SIZE);
         for(int index = 0; index < COMMANDS_ALLOCATE_BLOCK_SIZE; ++index)
         {
             _freePool.push_back(commands+index);
         }
     }
 
-    std::list<T*> _allocatedPoolBlocks;
-    std::list<T*> _freePool;
+    std::vector<T*> _allocatedPoolBlocks;
+    std::vector<T*> _freePool;
     //std::set<T*> _usedPool;
 };
 
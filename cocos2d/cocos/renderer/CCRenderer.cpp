@@ -42,6 +42,9 @@
 
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
+#include "base/CCProfiling.h"
+#include "base/allocator/CCAllocationCounter.h"
+#include "base/ccRadixSort.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
@@ -51,14 +54,11 @@
 NS_CC_BEGIN
 
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
-{
-    return a->getGlobalOrder() < b->getGlobalOrder();
-}
+static const uint64_t SORT_KEY_ORDER_MASK = 0xFFFFFFFF00000000ULL;
 
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
+static inline uint64_t packSortKey(uint32_t order, size_t index)
 {
-    return  a->getDepth() > b->getDepth();
+    return (static_cast<uint64_t>(order) << 32) | static_cast<uint32_t>(index);
 }
 
 // queue
@@ -72,11 +72,15 @@ void RenderQueue::push_back(RenderCommand* command)
     float z = command->getGlobalOrder();
     if(z < 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
+        auto& queue = _commands[QUEUE_GROUP::GLOBALZ_NEG];
+        _sortKeys[QUEUE_GROUP::GLOBALZ_NEG].push_back(packSortKey(utils::floatToOrderedBits(z), queue.size()));
+        queue.push_back(command);
     }
     else if(z > 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
+        auto& queue = _commands[QUEUE_GROUP::GLOBALZ_POS];
+        _sortKeys[QUEUE_GROUP::GLOBALZ_POS].push_back(packSortKey(utils::floatToOrderedBits(z), queue.size()));
+        queue.push_back(command);
     }
     else
     {
@@ -84,7 +88,10 @@ void RenderQueue::push_back(RenderCommand* command)
         {
             if(command->isTransparent())
             {
-                _commands[QUEUE_GROUP::TRANSPARENT_3D].push_back(command);
+                // far to near, so the depth is inverted
+                auto& queue = _commands[QUEUE_GROUP::TRANSPARENT_3D];
+                _sortKeys[QUEUE_GROUP::TRANSPARENT_3D].push_back(packSortKey(~utils::floatToOrderedBits(command->getDepth()), queue.size()));
+                queue.push_back(command);
             }
             else
             {
@@ -112,9 +119,43 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    sortSubQueue(QUEUE_GROUP::TRANSPARENT_3D);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_NEG);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_POS);
+}
+
+void RenderQueue::sortSubQueue(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    auto& keys = _sortKeys[group];
+    const size_t count = commands.size();
+    CCASSERT(keys.size() == count, "RenderQueue: sort keys out of sync with the commands");
+    if (count < 2)
+        return;
+
+    _commandsScratch.resize(count);
+    if (count < RADIX_SORT_THRESHOLD)
+    {
+        // keys are unique thanks to the push index, so sorting them gives the stable order
+        std::sort(keys.begin(), keys.end());
+        for (size_t i = 0; i < count; ++i)
+        {
+            _commandsScratch[i] = commands[static_cast<uint32_t>(keys[i])];
+        }
+        std::copy(_commandsScratch.begin(), _commandsScratch.end(), commands.begin());
+    }
+    else
+    {
+        // the push index is already in order, only the high 32 bits need to be sorted
+        _sortKeysScratch.resize(count);
+        utils::radixSort(keys.data(), commands.data(), _sortKeysScratch.data(), _commandsScratch.data(), count, 4);
+    }
+
+    // renumber the push index so the keys match the new positions
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = (keys[i] & SORT_KEY_ORDER_MASK) | static_cast<uint32_t>(i);
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -138,6 +179,7 @@ void RenderQueue::clear()
     for(int i = 0; i < QUEUE_COUNT; ++i)
     {
         _commands[i].clear();
+        _sortKeys[i].clear();
     }
 }
 
@@ -147,6 +189,8 @@ void RenderQueue::realloc(size_t reserveSize)
     {
         _commands[i] = std::vector<RenderCommand*>();
         _commands[i].reserve(reserveSize);
+        _sortKeys[i] = std::vector<uint64_t>();
+        _sortKeys[i].reserve(reserveSize);
     }
 }
 
@@ -198,12 +242,17 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 // constructors, destructor, init
 //
 Renderer::Renderer()
-:_lastBatchedMeshCommand(nullptr)
+:_frameAllocator("Renderer frame allocator")
+,_commandGroupStack(GroupStack::container_type(allocator::LinearSTLAllocator<int>(&_frameAllocator)))
+,_lastBatchedMeshCommand(nullptr)
+,_queuedTriangleCommands(allocator::LinearSTLAllocator<TrianglesCommand*>(&_frameAllocator))
 ,_triBatchesToDrawCapacity(-1)
 ,_triBatchesToDraw(nullptr)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_frameStartAllocations(allocator::AllocationCounter::getCount())
+,_lastFrameAllocations(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -641,10 +690,12 @@ void Renderer::render()
     {
         //Process render commands
         //1. Sort render commands based on ID
+        CC_PROFILER_START("Renderer - sort");
         for (auto &renderqueue : _renderGroups)
         {
             renderqueue.sort();
         }
+        CC_PROFILER_STOP("Renderer - sort");
         visitRenderQueue(_renderGroups[0]);
     }
     clean();
@@ -665,10 +716,27 @@ void Renderer::clean()
     }
 
     // Clear batch commands
-    _queuedTriangleCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
     _lastBatchedMeshCommand = nullptr;
+
+    resetFrameAllocator();
+
+    uint64_t allocations = allocator::AllocationCounter::getCount();
+    _lastFrameAllocations = allocations - _frameStartAllocations;
+    _frameStartAllocations = allocations;
+}
+
+void Renderer::resetFrameAllocator()
+{
+    // the storage of the containers is released by the reset, so they start over empty
+    _queuedTriangleCommands = TrianglesCommandQueue(allocator::LinearSTLAllocator<TrianglesCommand*>(&_frameAllocator));
+    _commandGroupStack = GroupStack(GroupStack::container_type(allocator::LinearSTLAllocator<int>(&_frameAllocator)));
+
+    _frameAllocator.reset();
+
+    _commandGroupStack.push(DEFAULT_RENDER_QUEUE);
+    _queuedTriangleCommands.reserve(BATCH_TRIAGCOMMAND_RESERVED_SIZE);
 }
 
 void Renderer::clear()
@@ -34,6 +34,7 @@
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCGLProgram.h"
 #include "platform/CCGL.h"
+#include "base/allocator/CCAllocatorStrategyLinear.h"
 
 #if !defined(NDEBUG) && CC_TARGET_PLATFORM == CC_PLATFORM_IOS
 
@@ -67,6 +68,9 @@ class MeshCommand;
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
  are the ones that have `z < 0` and `z > 0`.
+ A 64-bit sort key is packed for each of them when it is pushed: the high 32 bits hold the
+ order-preserving bits of the global Z (or the inverted depth for transparent 3D commands),
+ the low 32 bits the push index, so equal orders keep their submission order.
 */
 class RenderQueue {
 public:
@@ -112,10 +116,21 @@ public:
     void saveRenderState();
     /**Restore the saved DepthState, CullState, DepthWriteState render state.*/
     void restoreRenderState();
-    
+
+    /**Sub queues with at least this many commands are sorted with a radix sort instead of a comparison sort.*/
+    static const size_t RADIX_SORT_THRESHOLD = 256;
+
 protected:
+    /**Sort the sub queue by its packed sort keys.*/
+    void sortSubQueue(QUEUE_GROUP group);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**The packed sort keys of the sorted sub queues, parallel to _commands.*/
+    std::vector<uint64_t> _sortKeys[QUEUE_COUNT];
+    /**Scratch buffers reused by the radix sort.*/
+    std::vector<uint64_t> _sortKeysScratch;
+    std::vector<RenderCommand*> _commandsScratch;
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -209,7 +224,23 @@ public:
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /**
+     Returns the per-frame linear allocator. Its memory is released all at once in `clean()`,
+     so it must only be used for temporaries that don't outlive the current frame.
+     getLastPageAllocations() on it tells how many pages the last frame had to request,
+     which is zero once the frame allocations reached their steady state.
+     */
+    allocator::AllocatorStrategyLinear* getFrameAllocator() { return &_frameAllocator; }
+
+    /**
+     Returns the number of calls to the global operator new the rendering thread made during the last frame,
+     between the last two calls to `clean()`. Always 0 when CC_ENABLE_ALLOCATION_COUNTER is off.
+     */
+    uint64_t getLastFrameAllocations() const { return _lastFrameAllocations; }
+
 protected:
+    typedef std::vector<TrianglesCommand*, allocator::LinearSTLAllocator<TrianglesCommand*>> TrianglesCommandQueue;
+    typedef std::stack<int, std::vector<int, allocator::LinearSTLAllocator<int>>> GroupStack;
 
     //Setup VBO or VAO based on OpenGL extensions
     void setupBuffer();
@@ -233,15 +264,21 @@ protected:
     void fillVerticesAndIndices(const TrianglesCommand* cmd);
 
 
+    //Restart the containers living in the frame allocator and release the frame memory
+    void resetFrameAllocator();
+
     /* clear color set outside be used in setGLDefaultValues() */
     Color4F _clearColor;
 
-    std::stack<int> _commandGroupStack;
+    // must be declared before the containers using it
+    allocator::AllocatorStrategyLinear _frameAllocator;
+
+    GroupStack _commandGroupStack;
     
     std::vector<RenderQueue> _renderGroups;
 
     MeshCommand* _lastBatchedMeshCommand;
-    std::vector<TrianglesCommand*> _queuedTriangleCommands;
+    TrianglesCommandQueue _queuedTriangleCommands;
 
     //for TrianglesCommand
     V3F_C4B_T2F _verts[VBO_SIZE];
@@ -268,6 +305,9 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    // global operator new calls counted at the end of the last frame, and during it
+    uint64_t _frameStartAllocations;
+    uint64_t _lastFrameAllocations;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
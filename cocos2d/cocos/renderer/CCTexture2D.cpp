@@ -53,6 +53,23 @@ THE SOFTWARE.
     #include "renderer/CCTextureCache.h"
 #endif
 
+// ETC2 is core in OpenGL ES 3.0 and ASTC comes with extensions, older GL headers don't define them
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+#define GL_COMPRESSED_RGBA_ASTC_6x6_KHR 0x93B4
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
+
 NS_CC_BEGIN
 
 
@@ -108,6 +125,13 @@ namespace {
         PixelFormatInfoMapValue(Texture2D::PixelFormat::ATC_INTERPOLATED_ALPHA, Texture2D::PixelFormatInfo(GL_ATC_RGBA_INTERPOLATED_ALPHA_AMD,
             0xFFFFFFFF, 0xFFFFFFFF, 8, true, false)),
 #endif
+
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGB, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGB8_ETC2, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, false)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGBA, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+        // 128 bits per block, the bpp of ASTC_6x6 (3.56) is rounded up
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_4x4, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_4x4_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_6x6, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_6x6_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_8x8, Texture2D::PixelFormatInfo(GL_COMPRESSED_RGBA_ASTC_8x8_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 2, true, true)),
     };
 }
 
@@ -592,7 +616,9 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
     if (info.compressed && !Configuration::getInstance()->supportsPVRTC()
                         && !Configuration::getInstance()->supportsETC()
                         && !Configuration::getInstance()->supportsS3TC()
-                        && !Configuration::getInstance()->supportsATITC())
+                        && !Configuration::getInstance()->supportsATITC()
+                        && !Configuration::getInstance()->supportsETC2()
+                        && !Configuration::getInstance()->supportsASTC())
     {
         CCLOG("cocos2d: WARNING: PVRTC/ETC images are not supported");
         return false;
@@ -1073,6 +1099,88 @@ Texture2D::PixelFormat Texture2D::convertDataToFormat(const unsigned char* data,
     }
 }
 
+Texture2D::PixelConverter Texture2D::getPixelConverter(PixelFormat originFormat, PixelFormat format)
+{
+    PixelConverter convert = nullptr;
+
+    // the same conversions as the convertXXXToFormat functions
+    switch (originFormat)
+    {
+    case PixelFormat::I8:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: convert = convertI8ToRGBA8888; break;
+        case PixelFormat::RGB888: convert = convertI8ToRGB888; break;
+        case PixelFormat::RGB565: convert = convertI8ToRGB565; break;
+        case PixelFormat::AI88: convert = convertI8ToAI88; break;
+        case PixelFormat::RGBA4444: convert = convertI8ToRGBA4444; break;
+        case PixelFormat::RGB5A1: convert = convertI8ToRGB5A1; break;
+        default: break;
+        }
+        break;
+    case PixelFormat::AI88:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: convert = convertAI88ToRGBA8888; break;
+        case PixelFormat::RGB888: convert = convertAI88ToRGB888; break;
+        case PixelFormat::RGB565: convert = convertAI88ToRGB565; break;
+        case PixelFormat::A8: convert = convertAI88ToA8; break;
+        case PixelFormat::I8: convert = convertAI88ToI8; break;
+        case PixelFormat::RGBA4444: convert = convertAI88ToRGBA4444; break;
+        case PixelFormat::RGB5A1: convert = convertAI88ToRGB5A1; break;
+        default: break;
+        }
+        break;
+    case PixelFormat::RGB888:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: convert = convertRGB888ToRGBA8888; break;
+        case PixelFormat::RGB565: convert = convertRGB888ToRGB565; break;
+        case PixelFormat::A8: convert = convertRGB888ToA8; break;
+        case PixelFormat::I8: convert = convertRGB888ToI8; break;
+        case PixelFormat::AI88: convert = convertRGB888ToAI88; break;
+        case PixelFormat::RGBA4444: convert = convertRGB888ToRGBA4444; break;
+        case PixelFormat::RGB5A1: convert = convertRGB888ToRGB5A1; break;
+        default: break;
+        }
+        break;
+    case PixelFormat::RGBA8888:
+        switch (format)
+        {
+        case PixelFormat::RGB888: convert = convertRGBA8888ToRGB888; break;
+        case PixelFormat::RGB565: convert = convertRGBA8888ToRGB565; break;
+        case PixelFormat::A8: convert = convertRGBA8888ToA8; break;
+        case PixelFormat::I8: convert = convertRGBA8888ToI8; break;
+        case PixelFormat::AI88: convert = convertRGBA8888ToAI88; break;
+        case PixelFormat::RGBA4444: convert = convertRGBA8888ToRGBA4444; break;
+        case PixelFormat::RGB5A1: convert = convertRGBA8888ToRGB5A1; break;
+        default: break;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return convert;
+}
+
+bool Texture2D::convertPixels(const unsigned char* data, ssize_t dataLen, PixelFormat originFormat, PixelFormat format, unsigned char* outData)
+{
+    auto convert = getPixelConverter(originFormat, format);
+    if (convert == nullptr)
+    {
+        return false;
+    }
+
+    convert(data, dataLen, outData);
+    return true;
+}
+
+bool Texture2D::canConvertPixels(PixelFormat originFormat, PixelFormat format)
+{
+    return getPixelConverter(originFormat, format) != nullptr;
+}
+
 // implementation Texture2D (Text)
 bool Texture2D::initWithString(const char *text, const std::string& fontName, float fontSize, const Size& dimensions/* = Size(0, 0)*/, TextHAlignment hAlignment/* =  TextHAlignment::CENTER */, TextVAlignment vAlignment/* =  TextVAlignment::TOP */, bool enableWrap /* = false */, int overflow /* = 0 */)
 {
@@ -1395,6 +1503,21 @@ const char* Texture2D::getStringForFormat() const
 
         case Texture2D::PixelFormat::ATC_INTERPOLATED_ALPHA:
             return "ATC_INTERPOLATED_ALPHA";
+
+        case Texture2D::PixelFormat::ETC2_RGB:
+            return "ETC2_RGB";
+
+        case Texture2D::PixelFormat::ETC2_RGBA:
+            return "ETC2_RGBA";
+
+        case Texture2D::PixelFormat::ASTC_4x4:
+            return "ASTC_4x4";
+
+        case Texture2D::PixelFormat::ASTC_6x6:
+            return "ASTC_6x6";
+
+        case Texture2D::PixelFormat::ASTC_8x8:
+            return "ASTC_8x8";
             
         default:
             CCASSERT(false , "unrecognized pixel format");
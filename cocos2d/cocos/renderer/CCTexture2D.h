@@ -115,6 +115,16 @@ public:
         ATC_EXPLICIT_ALPHA,
         //! ATITC-compressed texture: ATC_INTERPOLATED_ALPHA
         ATC_INTERPOLATED_ALPHA,
+        //! ETC2-compressed texture: ETC2_RGB
+        ETC2_RGB,
+        //! ETC2-compressed texture: ETC2_RGBA (RGBA8 with EAC alpha)
+        ETC2_RGBA,
+        //! ASTC-compressed texture with 4x4 blocks
+        ASTC_4x4,
+        //! ASTC-compressed texture with 6x6 blocks
+        ASTC_6x6,
+        //! ASTC-compressed texture with 8x8 blocks
+        ASTC_8x8,
         //! Default texture format: AUTO
         DEFAULT = AUTO,
         
@@ -418,6 +428,15 @@ public:
 public:
     /** Get pixel info map, the key-value pairs is PixelFormat and PixelFormatInfo.*/
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
+
+    /** Converts the pixels the same way initWithImage does, but into a buffer owned by the caller.
+     * Decoders use it to convert an image row by row, instead of converting the whole image afterwards.
+     * @param outData Buffer large enough for the converted pixels.
+     * @return false if the conversion isn't supported, outData is left untouched then.
+     */
+    static bool convertPixels(const unsigned char* data, ssize_t dataLen, PixelFormat originFormat, PixelFormat format, unsigned char* outData);
+    /** Whether convertPixels supports the conversion. */
+    static bool canConvertPixels(PixelFormat originFormat, PixelFormat format);
     
 private:
     /**
@@ -476,6 +495,9 @@ private:
     static PixelFormat convertRGB888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
     static PixelFormat convertRGBA8888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
 
+    typedef void (*PixelConverter)(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    static PixelConverter getPixelConverter(PixelFormat originFormat, PixelFormat format);
+
     //I8 to XXX
     static void convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
     static void convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
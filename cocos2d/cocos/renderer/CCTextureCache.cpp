@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include <errno.h>
 #include <stack>
 #include <cctype>
+#include <algorithm>
 #include <list>
 
 #include "renderer/CCTexture2D.h"
@@ -41,6 +42,8 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCJobSystem.h"
+#include "base/CCConfiguration.h"
 
 
 
@@ -50,6 +53,46 @@ NS_CC_BEGIN
 
 std::string TextureCache::s_etc1AlphaFileSuffix = "@alpha";
 
+namespace
+{
+    /* The ASTC (.astc) and ETC2 (.pkm) files written next to the PNG, JPEG and WebP images by the
+     texture transcoder tool are loaded instead of the images when the GPU supports them.
+     If the image itself is missing, the ETC2 file is decoded by software on the other GPUs.
+     Returns the file to load, fullpath if there is no usable compressed file.
+     */
+    std::string getCompressedTexturePath(const std::string& path, const std::string& fullpath)
+    {
+        const std::string& name = fullpath.empty() ? path : fullpath;
+        size_t dot = name.find_last_of('.');
+        if (dot == std::string::npos || name.find_first_of("/\\", dot) != std::string::npos)
+            return fullpath;
+
+        std::string extension = name.substr(dot);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".webp")
+            return fullpath;
+        // the nine-patch info is read from the pixels of the image
+        if (NinePatchImageParser::isNinePatchImage(name))
+            return fullpath;
+
+        auto fileUtils = FileUtils::getInstance();
+        auto configuration = Configuration::getInstance();
+        std::string basename = name.substr(0, dot);
+
+        if (fullpath.empty())
+        {
+            // no image to fall back on, any GPU loads the ETC2 file
+            return fileUtils->fullPathForFilename(basename + ".pkm");
+        }
+
+        if (configuration->supportsASTC() && fileUtils->isFileExist(basename + ".astc"))
+            return basename + ".astc";
+        if (configuration->supportsETC2() && fileUtils->isFileExist(basename + ".pkm"))
+            return basename + ".pkm";
+        return fullpath;
+    }
+}
+
 // implementation TextureCache
 
 void TextureCache::setETC1AlphaFileSuffix(const std::string& suffix)
@@ -68,9 +111,11 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _needQuit(false)
+: _needQuit(false)
 , _asyncRefCount(0)
+, _decodingCount(0)
+, _asyncDecoderCount(0)
+, _asyncUploadTimeBudget(0.008f)
 {
 }
 
@@ -80,8 +125,6 @@ TextureCache::~TextureCache()
 
     for (auto& texture : _textures)
         texture.second->release();
-
-    CC_SAFE_DELETE(_loadingThread);
 }
 
 void TextureCache::destroyInstance()
@@ -110,31 +153,35 @@ public:
       const std::string& key )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        loadSuccess(false), decoded(false)
     {}
 
     std::string filename;
+    // the file which is decoded, a compressed texture instead of filename if there is one
+    std::string loadPath;
     std::function<void(Texture2D*)> callback;
     std::string callbackKey;
     Image image;
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
     bool loadSuccess;
+    // set by the decoding job, guarded by _responseMutex
+    bool decoded;
 };
 
 /**
  The addImageAsync logic follow the steps:
  - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then mark it decoded (JobSystem workers, up to _asyncDecoderCount at once)
+ - on schedule callback, get the decoded AsyncStructs from the front of _asyncStructQueue, convert image to texture, then delete AsyncStruct (GL thread)
 
  the Critical Area include these members:
  - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - AsyncStruct::decoded: locked by _responseMutex
 
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in decoding job, delete in GL thread(by Image instance)
 
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -146,7 +193,8 @@ public:
  - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
 
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
+ - Convert image to texture faster than load image from disk, and the textures
+ created per frame are limited by _asyncUploadTimeBudget, so this isn't a
  problem.
 
  Call unbindImageAsync(path) to prevent the call to the callback when the
@@ -160,16 +208,16 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 /**
  The addImageAsync logic follow the steps:
  - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then mark it decoded (JobSystem workers, up to _asyncDecoderCount at once)
+ - on schedule callback, get the decoded AsyncStructs from the front of _asyncStructQueue, convert image to texture, then delete AsyncStruct (GL thread)
  
  the Critical Area include these members:
  - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - AsyncStruct::decoded: locked by _responseMutex
  
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in decoding job, delete in GL thread(by Image instance)
  
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -181,7 +229,8 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
  
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
+ - Convert image to texture faster than load image from disk, and the textures
+ created per frame are limited by _asyncUploadTimeBudget, so this isn't a
  problem.
 
  The callbackKey allows to unbind the callback in cases where the loading of
@@ -206,17 +255,19 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     }
 
     // check if file exists
-    if (fullpath.empty() || !FileUtils::getInstance()->isFileExist(fullpath)) {
+    std::string loadPath = getCompressedTexturePath(path, fullpath);
+    if (loadPath.empty() || !FileUtils::getInstance()->isFileExist(loadPath)) {
         if (callback) callback(nullptr);
         return;
     }
-
-    // lazy init
-    if (_loadingThread == nullptr)
+    if (fullpath.empty())
     {
-        // create a new thread to load images
-        _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+        fullpath = loadPath;
+        if (_textures.find(fullpath) != _textures.end())
+        {
+            if (callback) callback(_textures[fullpath]);
+            return;
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -229,12 +280,28 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     // generate async struct
     AsyncStruct *data =
       new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+    data->loadPath = loadPath;
     
     // add async struct into queue
     _asyncStructQueue.push_back(data);
     std::unique_lock<std::mutex> ul(_requestMutex);
     _requestQueue.push_back(data);
-    _sleepCondition.notify_one();
+    startDecoding();
+}
+
+void TextureCache::startDecoding()
+{
+    // called with _requestMutex locked
+    auto jobSystem = JobSystem::getInstance();
+    unsigned int decoderCount = _asyncDecoderCount > 0 ? _asyncDecoderCount : std::max(jobSystem->getWorkerCount(), 1u);
+
+    while (_decodingCount < decoderCount && !_requestQueue.empty() && !_needQuit)
+    {
+        AsyncStruct* asyncStruct = _requestQueue.front();
+        _requestQueue.pop_front();
+        ++_decodingCount;
+        jobSystem->dispatch([this, asyncStruct]() { loadImage(asyncStruct); });
+    }
 }
 
 void TextureCache::unbindImageAsync(const std::string& callbackKey)
@@ -266,34 +333,14 @@ void TextureCache::unbindAllImageAsync()
     }
 }
 
-void TextureCache::loadImage()
+void TextureCache::loadImage(AsyncStruct* asyncStruct)
 {
-    AsyncStruct *asyncStruct = nullptr;
-    while (!_needQuit)
+    // each decoding job keeps decoding requests until the queue is empty
+    while (asyncStruct)
     {
-        std::unique_lock<std::mutex> ul(_requestMutex);
-        // pop an AsyncStruct from request queue
-        if (_requestQueue.empty())
-        {
-            asyncStruct = nullptr;
-        }
-        else
-        {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
-        }
-
-        if (nullptr == asyncStruct) {
-            if (_needQuit) {
-                break;
-            }
-            _sleepCondition.wait(ul);
-            continue;
-        }
-        ul.unlock();
-
-        // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+        // load image, converted to the pixel format of the texture while it is decoded
+        asyncStruct->image.setDecodePixelFormat(asyncStruct->pixelFormat);
+        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->loadPath);
 
         // ETC1 ALPHA supports.
         if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
@@ -302,10 +349,24 @@ void TextureCache::loadImage()
             if (FileUtils::getInstance()->isFileExist(alphaFile))
                 asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
         }
-        // push the asyncStruct to response queue
+
         _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
+        asyncStruct->decoded = true;
         _responseMutex.unlock();
+
+        // pop the next AsyncStruct from request queue
+        std::unique_lock<std::mutex> ul(_requestMutex);
+        if (_needQuit || _requestQueue.empty())
+        {
+            asyncStruct = nullptr;
+            --_decodingCount;
+            _sleepCondition.notify_all();
+        }
+        else
+        {
+            asyncStruct = _requestQueue.front();
+            _requestQueue.pop_front();
+        }
     }
 }
 
@@ -313,28 +374,19 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
-    while (true)
+    double startTime = utils::gettime();
+    while (!_asyncStructQueue.empty())
     {
-        // pop an AsyncStruct from response queue
+        // images are decoded in parallel, but the callbacks are called in the order of the requests
+        asyncStruct = _asyncStructQueue.front();
         _responseMutex.lock();
-        if (_responseQueue.empty())
-        {
-            asyncStruct = nullptr;
-        }
-        else
-        {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
-        }
+        bool decoded = asyncStruct->decoded;
         _responseMutex.unlock();
 
-        if (nullptr == asyncStruct) {
+        if (!decoded) {
             break;
         }
+        _asyncStructQueue.pop_front();
 
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
@@ -356,7 +408,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 this->parseNinePatchImage(image, texture, asyncStruct->filename);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
-                VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+                VolatileTextureMgr::addImageTexture(texture, asyncStruct->loadPath);
 #endif
                 // cache the texture. retain it, since it is added in the map
                 _textures.emplace(asyncStruct->filename, texture);
@@ -387,6 +439,11 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         // release the asyncStruct
         delete asyncStruct;
         --_asyncRefCount;
+
+        // the remaining textures are created during the next frames once the budget is spent
+        if (_asyncUploadTimeBudget > 0 && utils::gettime() - startTime >= _asyncUploadTimeBudget) {
+            break;
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -404,9 +461,16 @@ Texture2D * TextureCache::addImage(const std::string &path)
     // Needed since addImageAsync calls this method from a different thread
 
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string loadPath;
     if (fullpath.size() == 0)
     {
-        return nullptr;
+        // only a compressed texture may be shipped
+        loadPath = getCompressedTexturePath(path, fullpath);
+        if (loadPath.empty())
+        {
+            return nullptr;
+        }
+        fullpath = loadPath;
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
@@ -414,13 +478,19 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
     if (!texture)
     {
+        if (loadPath.empty())
+        {
+            loadPath = getCompressedTexturePath(path, fullpath);
+        }
+
         // all images are handled by UIImage except PVR extension that is handled by our own handler
         do
         {
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            image->setDecodePixelFormat(Texture2D::getDefaultAlphaPixelFormat());
+            bool bRet = image->initWithImageFile(loadPath);
             CC_BREAK_IF(!bRet);
 
             texture = new (std::nothrow) Texture2D();
@@ -429,7 +499,7 @@ Texture2D * TextureCache::addImage(const std::string &path)
             {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
-                VolatileTextureMgr::addImageTexture(texture, fullpath);
+                VolatileTextureMgr::addImageTexture(texture, loadPath);
 #endif
                 // texture already retained, no need to re-retain it
                 _textures.emplace(fullpath, texture);
@@ -548,7 +618,8 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            image->setDecodePixelFormat(Texture2D::getDefaultAlphaPixelFormat());
+            bool bRet = image->initWithImageFile(getCompressedTexturePath(fileName, fullpath));
             CC_BREAK_IF(!bRet);
 
             ret = texture->initWithImage(image);
@@ -659,12 +730,10 @@ std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
+    // notify the decoding jobs to quit, and wait for the images being decoded
     std::unique_lock<std::mutex> ul(_requestMutex);
     _needQuit = true;
-    _sleepCondition.notify_one();
-    ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    _sleepCondition.wait(ul, [this]{ return _decodingCount == 0; });
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -937,6 +1006,8 @@ void VolatileTextureMgr::reloadTexture(Texture2D* texture, const std::string& fi
     Image* image = new (std::nothrow) Image();
     Data data = FileUtils::getInstance()->getDataFromFile(filename);
 
+    if (image)
+        image->setDecodePixelFormat(pixelFormat);
     if (image && image->initWithImageData(data.getBytes(), data.getSize()))
         texture->initWithImage(image, pixelFormat);
 
@@ -116,7 +116,8 @@ public:
 
     /** Returns a Texture2D object given a file image.
     * If the file image was not previously loaded, it will create a new Texture2D object and it will return it.
-    * Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
+    * Otherwise it will load a texture on the JobSystem, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
+    * Several images are decoded in parallel, the callbacks are called in the order of the requests.
     * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
     * Supported image extensions: .png, .jpg
      @param filepath The file path.
@@ -140,6 +141,25 @@ public:
      */
     virtual void unbindAllImageAsync();
 
+    /** Sets how many images addImageAsync decodes in parallel on the JobSystem.
+     * @param count The number of images decoded at once, 0 to use all the workers of the JobSystem.
+     * @since v3.17
+     */
+    void setAsyncDecoderCount(unsigned int count) { _asyncDecoderCount = count; }
+
+    /** Gets how many images addImageAsync decodes in parallel, 0 means all the workers of the JobSystem. */
+    unsigned int getAsyncDecoderCount() const { return _asyncDecoderCount; }
+
+    /** Sets the time spent each frame creating the textures of the images loaded by addImageAsync.
+     * At least one texture is created per frame, the others wait for the next frames once the budget is spent.
+     * @param seconds The time budget in seconds, 0 for no limit. The default is 8 milliseconds.
+     * @since v3.17
+     */
+    void setAsyncUploadTimeBudget(float seconds) { _asyncUploadTimeBudget = seconds; }
+
+    /** Gets the time spent each frame creating the textures of the images loaded by addImageAsync. */
+    float getAsyncUploadTimeBudget() const { return _asyncUploadTimeBudget; }
+
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image.
@@ -222,19 +242,20 @@ public:
 
 private:
     void addImageAsyncCallBack(float dt);
-    void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
 public:
 protected:
     struct AsyncStruct;
-    
-    std::thread* _loadingThread;
+
+    void loadImage(AsyncStruct* asyncStruct);
+    void startDecoding();
 
     std::deque<AsyncStruct*> _asyncStructQueue;
     std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
 
+    // _requestMutex guards _requestQueue, _decodingCount and _needQuit
     std::mutex _requestMutex;
+    // guards AsyncStruct::decoded
     std::mutex _responseMutex;
     
     std::condition_variable _sleepCondition;
@@ -243,6 +264,11 @@ protected:
 
     int _asyncRefCount;
 
+    // number of decoding jobs running
+    unsigned int _decodingCount;
+    unsigned int _asyncDecoderCount;
+    float _asyncUploadTimeBudget;
+
     std::unordered_map<std::string, Texture2D*> _textures;
 
     static std::string s_etc1AlphaFileSuffix;
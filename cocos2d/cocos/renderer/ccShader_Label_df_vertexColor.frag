@@ -0,0 +1,19 @@
+const char* ccLabelDistanceFieldVertexColor_frag = R"(
+
+#ifdef GL_ES
+precision lowp float;
+#endif
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+// same as ccLabelDistanceFieldNormal_frag, but the text color is multiplied into the vertex color
+// so labels with different text colors can be drawn in the same batch
+void main()
+{
+    float dist = texture2D(CC_Texture0, v_texCoord).a;
+    float width = 0.04;
+    float alpha = smoothstep(0.5-width, 0.5+width, dist);
+    gl_FragColor = v_fragmentColor * vec4(1.0, 1.0, 1.0, alpha);
+}
+)";
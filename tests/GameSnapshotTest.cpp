@@ -0,0 +1,215 @@
+/**
+ * @file GameSnapshotTest.cpp
+ * @brief 关卡快照的往返测试
+ * @details 从模型采集快照、经IO线程写入文件、再读出并重建模型，检查每个字段都没有变化；
+ *          另外检查动画中的操作不进入快照、动画中途撤销也不会丢掉已完成的操作，
+ *          以及损坏的快照文件会被拒绝。只读写文件，不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "models/GameModel.h"
+#include "managers/UndoManager.h"
+#include "services/GameSnapshotService.h"
+
+#include <future>
+
+USING_NS_CC;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        ++failures;
+    }
+}
+
+/**
+ * @brief 等IO队列里排在前面的保存任务执行完
+ */
+void waitForIO()
+{
+    std::promise<void> done;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [&done]() {
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+Card* createCard(int cardId, CardFaceType face, CardSuitType suit, float x, float y)
+{
+    Card* card = Card::create(cardId, face, suit);
+    card->setPosition(Vec2(x, y));
+    return card;
+}
+
+/**
+ * @brief 3张主牌区卡牌（一张未翻开）、2张堆牌区卡牌，以及一张已经匹配掉的卡牌
+ */
+GameModel* createGameModel()
+{
+    GameModel* gameModel = GameModel::create();
+    gameModel->addPlayfieldCard(createCard(0, CardFaceType::KING, CardSuitType::CLUBS, 250.0f, 1400.0f));
+    gameModel->addPlayfieldCard(createCard(1, CardFaceType::QUEEN, CardSuitType::HEARTS, 400.5f, 1250.25f));
+    gameModel->addPlayfieldCard(createCard(2, CardFaceType::ACE, CardSuitType::SPADES, 550.0f, 1100.0f));
+    gameModel->getPlayfieldCards()[2]->setVisible(false);
+    gameModel->addStackCard(createCard(3, CardFaceType::THREE, CardSuitType::DIAMONDS, 200.0f, 290.0f));
+    gameModel->addStackCard(createCard(4, CardFaceType::FOUR, CardSuitType::CLUBS, 700.0f, 290.0f));
+    gameModel->registerCard(createCard(5, CardFaceType::FIVE, CardSuitType::HEARTS, 700.0f, 290.0f));
+    gameModel->setGameState(GameStateType::PLAYING);
+    return gameModel;
+}
+
+UndoRecord createRecord(UndoRecord::OperationType operationType, int sourceCardId, int targetCardId)
+{
+    UndoRecord record;
+    record.operationType = operationType;
+    record.sourceCardId = sourceCardId;
+    record.targetCardId = targetCardId;
+    record.sourcePosition = Vec2(550.0f, 1100.0f);
+    record.targetPosition = Vec2(700.0f, 290.0f);
+    record.sourceVisible = false;
+    record.removedStackCardId = targetCardId;
+    record.stackCardIds = { 3, targetCardId };
+    return record;
+}
+
+bool isSameRecord(const UndoRecord& a, const UndoRecord& b)
+{
+    return a.operationType == b.operationType && a.sourceCardId == b.sourceCardId && a.targetCardId == b.targetCardId
+        && a.sourcePosition == b.sourcePosition && a.targetPosition == b.targetPosition
+        && a.sourceVisible == b.sourceVisible && a.targetVisible == b.targetVisible
+        && a.removedPlayfieldCardId == b.removedPlayfieldCardId && a.removedStackCardId == b.removedStackCardId
+        && a.stackCardIds == b.stackCardIds;
+}
+
+bool isSameCard(const Card* a, const Card* b)
+{
+    return a && b && a->getCardId() == b->getCardId() && a->getFace() == b->getFace() && a->getSuit() == b->getSuit()
+        && a->getArea() == b->getArea() && a->isVisible() == b->isVisible() && a->getStackIndex() == b->getStackIndex()
+        && a->getPosition() == b->getPosition();
+}
+
+bool isSameCards(const std::vector<Card*>& a, const std::vector<Card*>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!isSameCard(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testRoundTrip()
+{
+    GameModel* gameModel = createGameModel();
+    UndoManager* undoManager = UndoManager::create(gameModel);
+    undoManager->recordUndo(createRecord(UndoRecord::OperationType::STACK_SUPPLEMENT, 3, 5));
+    undoManager->recordUndo(createRecord(UndoRecord::OperationType::PLAYFIELD_TO_STACK, 1, 4));
+
+    GameSnapshotService::saveSnapshotAsync(GameSnapshotService::captureSnapshot(7, gameModel, undoManager->getUndoModel()));
+    waitForIO();
+
+    GameSnapshot loaded;
+    check(GameSnapshotService::loadSnapshot(loaded), "the saved snapshot loads");
+    check(loaded.levelId == 7, "the level id survives the round trip");
+    check(loaded.gameState == GameStateType::PLAYING, "the game state survives the round trip");
+
+    const auto& records = undoManager->getUndoModel()->getRecords();
+    check(loaded.undoRecords.size() == records.size(), "all undo records survive the round trip");
+    for (size_t i = 0; i < loaded.undoRecords.size() && i < records.size(); ++i) {
+        check(isSameRecord(loaded.undoRecords[i], records[i]), "an undo record survives the round trip");
+    }
+
+    GameModel* restored = GameSnapshotService::restoreGameModel(loaded);
+    check(restored != nullptr, "the game model is restored from the snapshot");
+    if (restored) {
+        check(isSameCards(restored->getPlayfieldCards(), gameModel->getPlayfieldCards()), "the playfield cards are restored in order");
+        check(isSameCards(restored->getStackCards(), gameModel->getStackCards()), "the stack cards are restored in order");
+        check(isSameCard(restored->findCardById(5), gameModel->findCardById(5)), "a card outside both areas is restored");
+        check(restored->getGameState() == GameStateType::PLAYING, "the restored game state matches");
+        delete restored;
+    }
+
+    delete undoManager;
+    delete gameModel;
+}
+
+void testPendingRecords()
+{
+    GameModel* gameModel = createGameModel();
+    UndoManager* undoManager = UndoManager::create(gameModel);
+    std::set<int> pendingUndoSerials;
+    UndoRecord committed = createRecord(UndoRecord::OperationType::STACK_SUPPLEMENT, 3, 5);
+    undoManager->recordUndo(committed);
+    pendingUndoSerials.insert(undoManager->recordUndo(createRecord(UndoRecord::OperationType::PLAYFIELD_TO_STACK, 1, 4)));
+
+    // 动画还没结束的操作不进入快照
+    GameSnapshot snapshot = GameSnapshotService::captureSnapshot(7, gameModel, undoManager->getUndoModel(), pendingUndoSerials);
+    check(snapshot.undoRecords.size() == 1 && isSameRecord(snapshot.undoRecords[0], committed),
+          "a pending undo record is left out of the snapshot");
+
+    // 动画中途撤销弹出未完成的记录，已完成的那条必须保留
+    check(undoManager->executeUndo(), "the pending move is undone");
+    snapshot = GameSnapshotService::captureSnapshot(7, gameModel, undoManager->getUndoModel(), pendingUndoSerials);
+    check(snapshot.undoRecords.size() == 1 && isSameRecord(snapshot.undoRecords[0], committed),
+          "undoing a pending move keeps the committed undo record");
+
+    // 从快照恢复的记录重新分配序号，不会和新记录重复
+    undoManager->restoreRecords(snapshot.undoRecords);
+    int serial = undoManager->recordUndo(createRecord(UndoRecord::OperationType::PLAYFIELD_TO_STACK, 1, 4));
+    const auto& records = undoManager->getUndoModel()->getRecords();
+    check(records.size() == 2 && records[0].serial != serial, "restored undo records get their own serials");
+
+    delete undoManager;
+    delete gameModel;
+}
+
+void testCorruptedSnapshot()
+{
+    GameModel* gameModel = createGameModel();
+    GameSnapshotService::saveSnapshotAsync(GameSnapshotService::captureSnapshot(7, gameModel, nullptr));
+    waitForIO();
+    delete gameModel;
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = fileUtils->getWritablePath() + "game_snapshot.bin";
+    Data data = fileUtils->getDataFromFile(path);
+    check(data.getSize() > 16, "the snapshot file is written");
+    if (data.getSize() > 16) {
+        data.getBytes()[16] ^= 0xff;
+        fileUtils->writeDataToFile(data, path);
+    }
+    GameSnapshot loaded;
+    check(!GameSnapshotService::loadSnapshot(loaded), "a corrupted snapshot is rejected");
+
+    GameSnapshotService::clearSnapshot();
+    waitForIO();
+    check(!GameSnapshotService::loadSnapshot(loaded), "a cleared snapshot doesn't load");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->createDirectory(fileUtils->getWritablePath());
+
+    testRoundTrip();
+    testPendingRecords();
+    testCorruptedSnapshot();
+
+    AsyncTaskPool::destroyInstance();
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
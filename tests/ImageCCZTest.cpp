@@ -0,0 +1,162 @@
+/**
+ * @file ImageCCZTest.cpp
+ * @brief 加密 CCZ 图片的加载测试
+ * @details 大于 16 KB 的图片文件以内存映射的方式解码，加密的 CCZ 会在输入上原地解密。
+ *          生成一张加密的 .png.ccz，检查 Image::initWithImageFile 能解出原来的像素，
+ *          并且磁盘上的文件没有被改写。不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "base/ZipUtils.h"
+
+#include <cstring>
+#include <zlib.h>
+
+USING_NS_CC;
+
+namespace {
+
+const int IMAGE_SIZE = 128;
+const unsigned int KEY[4] = { 0x12345678, 0x9abcdef0, 0x0fedcba9, 0x87654321 };
+
+int failures = 0;
+
+void check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        ++failures;
+    }
+}
+
+void writeBigEndian(unsigned char* out, unsigned int value)
+{
+    out[0] = (unsigned char)(value >> 24);
+    out[1] = (unsigned char)(value >> 16);
+    out[2] = (unsigned char)(value >> 8);
+    out[3] = (unsigned char)value;
+}
+
+/**
+ * @brief 按 ZipUtils 解密时的算法加密：由 4 段密钥展开出 1024 个字的密钥流，
+ *        前 512 个字全部异或，之后每 64 个字异或一个
+ */
+void encryptCCZ(unsigned int* data, size_t len)
+{
+    const int enclen = 1024;
+    unsigned int key[enclen] = { 0 };
+    unsigned int y = 0, p = 0, e = 0;
+    unsigned int rounds = 6;
+    unsigned int sum = 0;
+    unsigned int z = key[enclen - 1];
+    do {
+        sum += 0x9e3779b9;
+        e = (sum >> 2) & 3;
+        for (p = 0; p < enclen - 1; p++) {
+            y = key[p + 1];
+            z = key[p] += ((z >> 5 ^ y << 2) + (y >> 3 ^ z << 4)) ^ ((sum ^ y) + (KEY[(p & 3) ^ e] ^ z));
+        }
+        y = key[0];
+        z = key[enclen - 1] += ((z >> 5 ^ y << 2) + (y >> 3 ^ z << 4)) ^ ((sum ^ y) + (KEY[(p & 3) ^ e] ^ z));
+    } while (--rounds);
+
+    int b = 0;
+    size_t i = 0;
+    for (; i < len && i < 512; i++) {
+        data[i] ^= key[b++];
+        b %= enclen;
+    }
+    for (; i < len; i += 64) {
+        data[i] ^= key[b++];
+        b %= enclen;
+    }
+}
+
+/**
+ * @brief 把 PNG 文件压缩并加密成 CCZp 格式：16 字节的文件头后面是 zlib 数据，
+ *        从第 12 个字节（未压缩长度）开始加密，reserved 里存解密后前 128 个字的校验和
+ */
+bool writeEncryptedCCZ(const Data& png, const std::string& path)
+{
+    uLongf compressedSize = compressBound((uLong)png.getSize());
+    std::vector<unsigned char> ccz(16 + compressedSize, 0);
+    if (compress(ccz.data() + 16, &compressedSize, png.getBytes(), (uLong)png.getSize()) != Z_OK) {
+        return false;
+    }
+    ccz.resize(16 + compressedSize);
+    memcpy(ccz.data(), "CCZp", 4);
+    writeBigEndian(ccz.data() + 12, (unsigned int)png.getSize());
+
+    std::vector<unsigned int> words((ccz.size() - 12) / 4);
+    memcpy(words.data(), ccz.data() + 12, words.size() * 4);
+    unsigned int checksum = 0;
+    for (size_t i = 0; i < words.size() && i < 128; ++i) {
+        checksum ^= words[i];
+    }
+    writeBigEndian(ccz.data() + 8, checksum);
+    encryptCCZ(words.data(), words.size());
+    memcpy(ccz.data() + 12, words.data(), words.size() * 4);
+
+    Data data;
+    data.copy(ccz.data(), (ssize_t)ccz.size());
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+bool isSamePixels(Image* image, const std::vector<unsigned char>& rgb)
+{
+    return image->getWidth() == IMAGE_SIZE && image->getHeight() == IMAGE_SIZE
+        && image->getRenderFormat() == Texture2D::PixelFormat::RGB888
+        && image->getDataLen() == (ssize_t)rgb.size() && memcmp(image->getData(), rgb.data(), rgb.size()) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->createDirectory(fileUtils->getWritablePath());
+    std::string pngPath = fileUtils->getWritablePath() + "ImageCCZTest.png";
+    std::string cczPath = fileUtils->getWritablePath() + "ImageCCZTest.png.ccz";
+
+    // 噪声压缩不了，保证加密后的文件超过 16 KB、会被映射
+    std::vector<unsigned char> rgba(IMAGE_SIZE * IMAGE_SIZE * 4);
+    std::vector<unsigned char> rgb;
+    unsigned int seed = 1;
+    for (size_t i = 0; i < rgba.size(); ++i) {
+        seed = seed * 1103515245 + 12345;
+        rgba[i] = (i % 4 == 3) ? 255 : (unsigned char)(seed >> 16);
+        if (i % 4 != 3) {
+            rgb.push_back(rgba[i]);
+        }
+    }
+    auto source = new (std::nothrow) Image();
+    bool saved = source->initWithRawData(rgba.data(), (ssize_t)rgba.size(), IMAGE_SIZE, IMAGE_SIZE, 8, false)
+        && source->saveToFile(pngPath, true);
+    source->release();
+    Data png = fileUtils->getDataFromFile(pngPath);
+    check(saved && !png.isNull(), "the source PNG is written");
+    check(writeEncryptedCCZ(png, cczPath), "the encrypted CCZ is written");
+    Data ccz = fileUtils->getDataFromFile(cczPath);
+    check(ccz.getSize() >= 16 * 1024, "the encrypted CCZ is large enough to be mapped");
+
+    ZipUtils::setPvrEncryptionKey(KEY[0], KEY[1], KEY[2], KEY[3]);
+
+    auto image = new (std::nothrow) Image();
+    check(image->initWithImageFile(cczPath), "initWithImageFile loads the encrypted CCZ");
+    check(isSamePixels(image, rgb), "initWithImageFile decodes the original pixels");
+    image->release();
+
+    // 原地解密只改动映射的副本
+    Data after = fileUtils->getDataFromFile(cczPath);
+    check(after.getSize() == ccz.getSize() && memcmp(after.getBytes(), ccz.getBytes(), (size_t)ccz.getSize()) == 0,
+          "loading doesn't modify the file");
+
+    fileUtils->removeFile(pngPath);
+    fileUtils->removeFile(cczPath);
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
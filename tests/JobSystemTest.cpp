@@ -0,0 +1,228 @@
+/**
+ * @file JobSystemTest.cpp
+ * @brief JobSystem 的并发测试
+ * @details 分别用 1、4、8 个工作线程检查 parallelFor、嵌套的子任务、依赖链和从其他线程派发任务，
+ *          检查依赖链的主线程回调按依赖顺序调用，以及多个线程同时第一次调用 JobSystem::getInstance
+ *          只会创建一个实例。这些检查主要用来在 ThreadSanitizer 和 AddressSanitizer 下运行，例如
+ *          cmake -DBUILD_TESTS=ON -DCMAKE_CXX_FLAGS=-fsanitize=thread 后运行 ctest。不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "base/CCJobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+USING_NS_CC;
+
+namespace {
+
+const int JOB_COUNT = 1000;
+const int CHAIN_LENGTH = 100;
+const int THREAD_COUNT = 8;
+
+int failures = 0;
+
+void check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        ++failures;
+    }
+}
+
+/**
+ * @brief 指定工作线程数的 JobSystem，调用构造函数的线程拥有第一个队列
+ */
+class TestJobSystem : public JobSystem
+{
+public:
+    explicit TestJobSystem(unsigned int workerCount) : JobSystem(workerCount) {}
+};
+
+void testParallelFor(JobSystem* jobSystem)
+{
+    std::vector<std::atomic<int>> visits(JOB_COUNT * 10);
+    for (auto& visit : visits) {
+        visit = 0;
+    }
+    Job* job = jobSystem->parallelFor(visits.size(), 7, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    jobSystem->wait(job);
+    job->release();
+
+    bool once = true;
+    for (auto& visit : visits) {
+        once = once && visit == 1;
+    }
+    check(once, "parallelFor visits every index once");
+}
+
+void testNestedChildren(JobSystem* jobSystem)
+{
+    std::atomic<int> leaves(0);
+    Job* root = jobSystem->createJob(nullptr);
+    // 每个子任务在自己的函数里再创建子任务，父任务要等全部孙任务结束
+    Job* parent = jobSystem->createJob([&, jobSystem]() {
+        for (int i = 0; i < 10; ++i) {
+            Job* child = jobSystem->createJob([&, jobSystem]() {
+                for (int j = 0; j < 10; ++j) {
+                    Job* grandChild = jobSystem->createJob([&]() { ++leaves; }, root);
+                    jobSystem->run(grandChild);
+                    grandChild->release();
+                }
+            }, root);
+            jobSystem->run(child);
+            child->release();
+        }
+    }, root);
+    jobSystem->run(parent);
+    parent->release();
+    jobSystem->run(root);
+    jobSystem->wait(root);
+    root->release();
+    check(leaves == 100, "a job finishes only after all its nested children");
+}
+
+void testDependencyChain(JobSystem* jobSystem)
+{
+    std::atomic<int> next(0);
+    std::atomic<bool> ordered(true);
+    std::vector<Job*> jobs;
+    for (int i = 0; i < CHAIN_LENGTH; ++i) {
+        Job* job = jobSystem->createJob([&, i]() {
+            if (next.fetch_add(1) != i) {
+                ordered = false;
+            }
+        });
+        if (!jobs.empty()) {
+            jobSystem->addDependency(job, jobs.back());
+        }
+        jobs.push_back(job);
+    }
+    // 倒着启动，依赖仍然保证顺序
+    for (auto it = jobs.rbegin(); it != jobs.rend(); ++it) {
+        jobSystem->run(*it);
+    }
+    jobSystem->wait(jobs.back());
+    for (auto job : jobs) {
+        job->release();
+    }
+    check(ordered && next == CHAIN_LENGTH, "a dependency chain runs in order");
+}
+
+void testForeignThreads(JobSystem* jobSystem)
+{
+    std::atomic<int> done(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.push_back(std::thread([&, jobSystem]() {
+            for (int i = 0; i < JOB_COUNT; ++i) {
+                jobSystem->dispatch([&]() { ++done; });
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (done != THREAD_COUNT * JOB_COUNT && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    check(done == THREAD_COUNT * JOB_COUNT, "jobs dispatched from other threads all run");
+}
+
+void testMainThreadCompletions()
+{
+    auto jobSystem = JobSystem::getInstance();
+    auto scheduler = Director::getInstance()->getScheduler();
+    std::vector<int> completions;
+    std::vector<Job*> jobs;
+    for (int i = 0; i < CHAIN_LENGTH; ++i) {
+        Job* job = jobSystem->createJob(nullptr);
+        jobSystem->setMainThreadCompletion(job, [&completions, i]() { completions.push_back(i); });
+        if (!jobs.empty()) {
+            jobSystem->addDependency(job, jobs.back());
+        }
+        jobs.push_back(job);
+    }
+    for (auto job : jobs) {
+        jobSystem->run(job);
+    }
+    while (completions.size() < (size_t)CHAIN_LENGTH) {
+        scheduler->update(0.0f);
+        std::this_thread::yield();
+    }
+    for (auto job : jobs) {
+        job->release();
+    }
+
+    bool ordered = true;
+    for (int i = 0; i < CHAIN_LENGTH; ++i) {
+        ordered = ordered && completions[i] == i;
+    }
+    check(ordered, "main thread completions are called in dependency order");
+}
+
+void testConcurrentGetInstance()
+{
+    // Director 创建的实例先销毁，让几个线程同时第一次调用 getInstance
+    JobSystem::destroyInstance();
+    std::atomic<int> ready(0);
+    std::vector<JobSystem*> instances(THREAD_COUNT, nullptr);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            ++ready;
+            while (ready != THREAD_COUNT) {
+                std::this_thread::yield();
+            }
+            instances[t] = JobSystem::getInstance();
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    bool same = instances[0] != nullptr;
+    for (auto instance : instances) {
+        same = same && instance == instances[0];
+    }
+    check(same, "concurrent first calls to getInstance create a single instance");
+
+    // 重新在这个线程上创建，后面的检查由它拥有第一个队列
+    JobSystem::destroyInstance();
+    JobSystem::getInstance();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Director 在这个线程上创建 JobSystem
+    Director::getInstance();
+
+    const unsigned int workerCounts[] = { 1, 4, 8 };
+    for (unsigned int workerCount : workerCounts) {
+        auto jobSystem = new (std::nothrow) TestJobSystem(workerCount);
+        testParallelFor(jobSystem);
+        testNestedChildren(jobSystem);
+        testDependencyChain(jobSystem);
+        testForeignThreads(jobSystem);
+        delete jobSystem;
+    }
+    testConcurrentGetInstance();
+    testMainThreadCompletions();
+
+    JobSystem::destroyInstance();
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
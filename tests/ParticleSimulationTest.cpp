@@ -0,0 +1,191 @@
+/**
+ * @file ParticleSimulationTest.cpp
+ * @brief 粒子在 JobSystem 上模拟的测试
+ * @details 回放测试依赖同一个随机种子总是得到同样的粒子：同一个种子模拟两次、以及关掉并行模拟再模拟一次，
+ *          粒子必须逐位相同，换一个种子则不同。另外检查 cocos 线程在 JobSystem::wait 里
+ *          不会执行无关的任务（比如纹理解码或 IO 任务），否则会卡住这一帧。不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "base/CCJobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+USING_NS_CC;
+
+namespace {
+
+const int FRAME_COUNT = 120;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+int failures = 0;
+
+void check(bool condition, const char* description)
+{
+    if (!condition) {
+        printf("FAILED: %s\n", description);
+        ++failures;
+    }
+}
+
+/**
+ * @brief 不创建 GL 资源的发射器，只用来读出粒子数据
+ */
+class TestParticleSystem : public ParticleSystem
+{
+public:
+    /**
+     * @brief 把存活粒子的位置、大小、颜色和旋转依次追加到 out
+     */
+    void readParticles(std::vector<float>& out)
+    {
+        waitForSimulation();
+        const float* arrays[] = {
+            _particleData.posx, _particleData.posy, _particleData.size, _particleData.rotation,
+            _particleData.colorR, _particleData.colorG, _particleData.colorB, _particleData.colorA
+        };
+        for (const float* values : arrays) {
+            out.insert(out.end(), values, values + _particleCount);
+        }
+    }
+
+    int getParticleCount() const { return _particleCount; }
+};
+
+/**
+ * @brief 用给定的种子模拟 FRAME_COUNT 帧，返回最后的粒子数据
+ */
+std::vector<float> simulate(unsigned int seed, bool parallel, int* particleCount)
+{
+    ParticleSystem::setParallelSimulationEnabled(parallel);
+    auto system = new (std::nothrow) TestParticleSystem();
+    system->initWithTotalParticles(2000);
+    system->setDuration(ParticleSystem::DURATION_INFINITY);
+    system->setEmitterMode(ParticleSystem::Mode::GRAVITY);
+    system->setGravity(Vec2(0.0f, -200.0f));
+    system->setSpeed(150.0f);
+    system->setSpeedVar(60.0f);
+    system->setRadialAccel(-40.0f);
+    system->setTangentialAccel(30.0f);
+    system->setTangentialAccelVar(10.0f);
+    system->setAngle(90.0f);
+    system->setAngleVar(360.0f);
+    system->setLife(2.0f);
+    system->setLifeVar(1.0f);
+    system->setStartSize(20.0f);
+    system->setStartSizeVar(8.0f);
+    system->setEndSize(4.0f);
+    system->setStartSpin(0.0f);
+    system->setStartSpinVar(180.0f);
+    system->setEndSpin(90.0f);
+    system->setStartColor(Color4F(1.0f, 0.5f, 0.2f, 1.0f));
+    system->setStartColorVar(Color4F(0.2f, 0.2f, 0.2f, 0.0f));
+    system->setEndColor(Color4F(0.2f, 0.2f, 1.0f, 0.0f));
+    system->setEmissionRate(800.0f);
+    system->setPosition(Vec2(480.0f, 320.0f));
+
+    srand(seed);
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        system->update(FRAME_TIME);
+    }
+
+    std::vector<float> particles;
+    system->readParticles(particles);
+    *particleCount = system->getParticleCount();
+    system->release();
+    ParticleSystem::setParallelSimulationEnabled(true);
+    return particles;
+}
+
+bool isSameBits(const std::vector<float>& a, const std::vector<float>& b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+void testDeterministicPerSeed()
+{
+    int count = 0;
+    std::vector<float> first = simulate(42, true, &count);
+    check(count >= 256, "enough particles are alive to be simulated on the JobSystem");
+
+    int otherCount = 0;
+    check(isSameBits(simulate(42, true, &otherCount), first), "the same seed gives the same particles");
+    check(isSameBits(simulate(42, false, &otherCount), first), "the JobSystem and the cocos thread give the same particles");
+    check(!isSameBits(simulate(43, true, &otherCount), first), "another seed gives other particles");
+}
+
+void testWaitDoesntRunUnrelatedJobs()
+{
+    auto jobSystem = JobSystem::getInstance();
+    auto cocosThread = std::this_thread::get_id();
+
+    // 先让所有工作线程忙起来，保证接下来的两个任务都留在 cocos 线程的队列里
+    std::atomic<int> blockedWorkers(0);
+    std::atomic<bool> releaseWorkers(false);
+    for (unsigned int i = 0; i < jobSystem->getWorkerCount(); ++i) {
+        jobSystem->dispatch([&]() {
+            ++blockedWorkers;
+            while (!releaseWorkers) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (blockedWorkers != (int)jobSystem->getWorkerCount()) {
+        std::this_thread::yield();
+    }
+
+    // 等待的任务先入队，无关的任务后入队，cocos 线程的队列先弹出的是无关的任务
+    std::atomic<bool> awaitedOnCocosThread(false);
+    Job* awaited = jobSystem->createJob([&]() {
+        awaitedOnCocosThread = std::this_thread::get_id() == cocosThread;
+    });
+    jobSystem->run(awaited);
+    std::atomic<bool> unrelatedDone(false);
+    std::atomic<bool> unrelatedOnCocosThread(false);
+    jobSystem->dispatch([&]() {
+        unrelatedOnCocosThread = std::this_thread::get_id() == cocosThread;
+        unrelatedDone = true;
+    });
+
+    jobSystem->wait(awaited);
+    check(awaited->isFinished() && awaitedOnCocosThread, "the cocos thread runs the job it waits for");
+    awaited->release();
+
+    releaseWorkers = true;
+    while (!unrelatedDone) {
+        std::this_thread::yield();
+    }
+    check(!unrelatedOnCocosThread, "waiting on the cocos thread doesn't run an unrelated job");
+
+    // 等待的任务的子任务仍然可以在 cocos 线程上执行
+    std::atomic<int> processed(0);
+    Job* parallel = jobSystem->parallelFor(1000, 10, [&](size_t begin, size_t end) {
+        processed += (int)(end - begin);
+    });
+    jobSystem->wait(parallel);
+    check(processed == 1000, "waiting for a parallelFor processes every range");
+    parallel->release();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // 在 cocos 线程上创建 JobSystem
+    Director::getInstance();
+    JobSystem::getInstance();
+
+    testDeterministicPerSeed();
+    testWaitDoesntRunUnrelatedJobs();
+
+    JobSystem::destroyInstance();
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file AnalyticsBenchmark.cpp
+ * @brief AnalyticsManager 记录事件的基准
+ * @details 主线程每帧都可能记录事件，AnalyticsManager::logEvent 入队应在 1 微秒以内。
+ *          启动后台线程（不上报，只写缓存文件），每轮记录 1000 个事件后请求落盘，
+ *          等后台线程取走全部事件再开始下一轮，保证计时的都是真正入队而不是队列满时的丢弃。
+ *          最后发出 Director::EVENT_RESET，和游戏退出时一样结束后台线程。不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "managers/AnalyticsManager.h"
+#include "Benchmark.h"
+
+#include <thread>
+
+USING_NS_CC;
+
+namespace {
+
+const int EVENT_COUNT = 1000;
+const int ITERATIONS = 50;
+
+/**
+ * @brief 请求落盘并等后台线程取走全部事件
+ */
+void waitForDrain(AnalyticsManager* analytics)
+{
+    analytics->flush();
+    while (analytics->getQueuedEventCount() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->createDirectory(fileUtils->getWritablePath());
+    std::string spoolPath = fileUtils->getWritablePath() + "analytics/";
+    fileUtils->removeDirectory(spoolPath);
+
+    auto analytics = AnalyticsManager::getInstance();
+    analytics->start("");
+
+    std::vector<double> times;
+    times.reserve(ITERATIONS);
+    for (int i = 0; i <= ITERATIONS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < EVENT_COUNT; ++j) {
+            analytics->logEvent("benchmark_event", i, j, EVENT_COUNT);
+        }
+        auto end = std::chrono::steady_clock::now();
+        // 第一轮预热
+        if (i > 0) {
+            times.push_back(std::chrono::duration<double, std::nano>(end - start).count() / EVENT_COUNT);
+        }
+        waitForDrain(analytics);
+    }
+    std::sort(times.begin(), times.end());
+
+    printf("AnalyticsManager::logEvent, %d events per round\n", EVENT_COUNT);
+    benchmark::reportCount("logEvent (median round)", times[times.size() / 2], "ns/event");
+    benchmark::reportCount("logEvent (slowest round)", times.back(), "ns/event");
+
+    // Director::reset() 在销毁引擎单例之前发出这个事件，管理器在这里写完最后一批并结束后台线程
+    Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(Director::EVENT_RESET);
+    fileUtils->removeDirectory(spoolPath);
+    return 0;
+}
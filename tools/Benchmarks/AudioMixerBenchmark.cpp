@@ -0,0 +1,137 @@
+/**
+ * @file AudioMixerBenchmark.cpp
+ * @brief Linux 软件混音器的基准
+ * @details 用离线输出驱动 AudioEngine：分别同时循环播放 1、8、32 个声音，每次用 renderOffline() 渲染
+ *          1 秒的音频，声音一半是 44.1 kHz 立体声、一半是 22.05 kHz 单声道（需要重采样）。
+ *          报告 AudioMixer::Stats 里每帧的平均混音耗时、单次 render() 的最长耗时，以及比实时快多少倍。
+ *          只在 USE_FMOD_AUDIO=OFF 的 Linux 构建里运行，不需要声卡和 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "Benchmark.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_AUDIO_MIXER
+#include "audio/include/AudioEngine.h"
+#include "audio/linux/AudioEngine-mixer.h"
+
+USING_NS_CC;
+using namespace cocos2d::experimental;
+
+namespace {
+
+const int OUTPUT_SAMPLE_RATE = 44100;
+const int BLOCK_FRAMES = 512;
+const int ITERATIONS = 5;
+
+void writeLittleEndian(std::vector<unsigned char>& out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back((unsigned char)(value >> (i * 8)));
+    }
+}
+
+/**
+ * @brief 写一个 2 秒的 16 位 PCM 正弦波 WAV 文件
+ */
+bool writeSineWav(const std::string& path, int sampleRate, int channelCount, float frequency)
+{
+    const int frameCount = sampleRate * 2;
+    const uint32_t dataSize = frameCount * channelCount * 2;
+    std::vector<unsigned char> wav;
+    wav.reserve(44 + dataSize);
+    wav.insert(wav.end(), { 'R', 'I', 'F', 'F' });
+    writeLittleEndian(wav, 36 + dataSize, 4);
+    wav.insert(wav.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+    writeLittleEndian(wav, 16, 4);
+    writeLittleEndian(wav, 1, 2);
+    writeLittleEndian(wav, channelCount, 2);
+    writeLittleEndian(wav, sampleRate, 4);
+    writeLittleEndian(wav, sampleRate * channelCount * 2, 4);
+    writeLittleEndian(wav, channelCount * 2, 2);
+    writeLittleEndian(wav, 16, 2);
+    wav.insert(wav.end(), { 'd', 'a', 't', 'a' });
+    writeLittleEndian(wav, dataSize, 4);
+    for (int i = 0; i < frameCount; ++i) {
+        int16_t sample = (int16_t)(8000.0f * sinf(2.0f * (float)M_PI * frequency * i / sampleRate));
+        for (int c = 0; c < channelCount; ++c) {
+            writeLittleEndian(wav, (uint16_t)sample, 2);
+        }
+    }
+
+    Data data;
+    data.copy(wav.data(), (ssize_t)wav.size());
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+/**
+ * @brief 循环播放 voiceCount 个声音，测渲染 1 秒音频的耗时
+ */
+void measureVoices(int voiceCount, const std::string& stereoPath, const std::string& monoPath)
+{
+    AudioEngine::stopAll();
+    for (int i = 0; i < voiceCount; ++i) {
+        AudioEngine::play2d(i % 2 == 0 ? stereoPath : monoPath, true, 1.0f / voiceCount);
+    }
+
+    auto engine = AudioEngineImpl::getInstance();
+    std::vector<int16_t> buffer(BLOCK_FRAMES * AudioMixer::CHANNEL_COUNT);
+    // 第一次渲染应用播放命令，之后才是真正的混音
+    engine->renderOffline(buffer.data(), BLOCK_FRAMES);
+    AudioMixer::Stats before = engine->getMixerStats();
+
+    double milliseconds = benchmark::measure(ITERATIONS, [&]() {
+        for (int frames = 0; frames < OUTPUT_SAMPLE_RATE; frames += BLOCK_FRAMES) {
+            engine->renderOffline(buffer.data(), BLOCK_FRAMES);
+        }
+    });
+    AudioMixer::Stats after = engine->getMixerStats();
+
+    uint64_t renderedFrames = after.renderedFrames - before.renderedFrames;
+    uint64_t renderTime = after.renderTime - before.renderTime;
+    printf("%d voices\n", voiceCount);
+    benchmark::report("render 1 s of audio", milliseconds);
+    benchmark::reportCount("mixing time per frame", renderedFrames > 0 ? (double)renderTime / renderedFrames : 0.0, "ns");
+    benchmark::reportCount("longest render() so far", after.maxRenderTime / 1000.0, "us");
+    benchmark::reportCount("faster than real time", milliseconds > 0.0 ? 1000.0 / milliseconds : 0.0, "x");
+    benchmark::reportCount("dropped commands", after.droppedCommands - before.droppedCommands, "commands");
+    benchmark::reportCount("underruns", after.underruns - before.underruns, "blocks");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->createDirectory(fileUtils->getWritablePath());
+    std::string stereoPath = fileUtils->getWritablePath() + "AudioMixerBenchmark_stereo.wav";
+    std::string monoPath = fileUtils->getWritablePath() + "AudioMixerBenchmark_mono.wav";
+    if (!writeSineWav(stereoPath, 44100, 2, 440.0f) || !writeSineWav(monoPath, 22050, 1, 660.0f)) {
+        printf("error: can't write the WAV files\n");
+        return 1;
+    }
+
+    // 离线输出不启动混音线程，文件在调用线程上解码
+    AudioEngineImpl::setOutputType(AudioOutput::Type::OFFLINE);
+    AudioEngine::preload(stereoPath);
+    AudioEngine::preload(monoPath);
+
+    const int voiceCounts[] = { 1, 8, AudioMixer::MAX_VOICES };
+    for (int voiceCount : voiceCounts) {
+        measureVoices(voiceCount, stereoPath, monoPath);
+    }
+
+    AudioEngine::end();
+    fileUtils->removeFile(stereoPath);
+    fileUtils->removeFile(monoPath);
+    return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+    printf("AudioMixerBenchmark needs the Linux software mixer, configure with -DUSE_FMOD_AUDIO=OFF\n");
+    return 0;
+}
+
+#endif
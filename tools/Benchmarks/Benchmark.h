@@ -0,0 +1,67 @@
+/**
+ * @file Benchmark.h
+ * @brief 性能基准的公共工具
+ * @details 每个基准是一个独立的可执行文件，用 BUILD_BENCHMARKS 打开，
+ *          run_benchmarks 目标在工程根目录下依次运行全部基准并打印耗时。
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace benchmark {
+
+/**
+ * @brief 运行 iterations 次，返回单次耗时的中位数（毫秒）
+ * @details 先预热一次，中位数不受偶发的调度抖动影响
+ */
+inline double measure(int iterations, const std::function<void()>& run)
+{
+    run();
+
+    std::vector<double> times;
+    times.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/**
+ * @brief 打印一项耗时
+ */
+inline void report(const char* name, double milliseconds)
+{
+    printf("  %-48s %10.3f ms\n", name, milliseconds);
+}
+
+/**
+ * @brief 打印一项计数
+ */
+inline void reportCount(const char* name, double count, const char* unit)
+{
+    printf("  %-48s %10.1f %s\n", name, count, unit);
+}
+
+/**
+ * @brief 打印优化前后的耗时和加速比
+ */
+inline void compare(const char* baselineName, double baseline, const char* optimizedName, double optimized)
+{
+    report(baselineName, baseline);
+    report(optimizedName, optimized);
+    printf("  %-48s %10.2fx\n", "speedup", optimized > 0.0 ? baseline / optimized : 0.0);
+}
+
+} // namespace benchmark
+
+#endif // __BENCHMARK_H__
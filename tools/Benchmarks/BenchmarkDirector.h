@@ -0,0 +1,87 @@
+/**
+ * @file BenchmarkDirector.h
+ * @brief 使用引擎的基准的公共工具
+ * @details 查找工程资源，创建 OpenGL 窗口并让 Director 运行场景。
+ *          运行场景的基准需要能创建 OpenGL 上下文的桌面环境。
+ */
+
+#ifndef __BENCHMARK_DIRECTOR_H__
+#define __BENCHMARK_DIRECTOR_H__
+
+#include "cocos2d.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+namespace benchmark {
+
+/**
+ * @brief 把工程的 Resources 目录加入搜索路径，run_benchmarks 在工程根目录下运行基准
+ */
+inline void addProjectResources()
+{
+    auto fileUtils = cocos2d::FileUtils::getInstance();
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd))) {
+        fileUtils->addSearchPath(std::string(cwd) + "/Resources", true);
+    }
+}
+
+/**
+ * @brief 创建 960x640 的窗口，创建纹理之前必须先调用
+ * @return 无法创建 OpenGL 窗口时返回 false
+ */
+inline bool createWindow()
+{
+    auto director = cocos2d::Director::getInstance();
+    if (director->getOpenGLView()) {
+        return true;
+    }
+
+    auto glview = cocos2d::GLViewImpl::createWithRect("Benchmark", cocos2d::Rect(0, 0, 960, 640));
+    if (!glview) {
+        printf("error: can't create an OpenGL window\n");
+        return false;
+    }
+    director->setOpenGLView(glview);
+    glview->setDesignResolutionSize(960, 640, ResolutionPolicy::NO_BORDER);
+    director->setAnimationInterval(0.0f);
+    return true;
+}
+
+/**
+ * @brief 运行 scene 并画出第一帧
+ * @return 无法创建 OpenGL 窗口时返回 false
+ */
+inline bool runScene(cocos2d::Scene* scene)
+{
+    if (!createWindow()) {
+        return false;
+    }
+
+    auto director = cocos2d::Director::getInstance();
+    if (director->getRunningScene()) {
+        director->replaceScene(scene);
+    } else {
+        director->runWithScene(scene);
+    }
+    // 下一帧才会切换到新场景
+    director->mainLoop();
+    return true;
+}
+
+/**
+ * @brief 画一帧
+ */
+inline void drawFrame()
+{
+    cocos2d::Director::getInstance()->mainLoop();
+}
+
+} // namespace benchmark
+
+#endif // __BENCHMARK_DIRECTOR_H__
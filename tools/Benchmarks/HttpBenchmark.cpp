@@ -0,0 +1,157 @@
+/**
+ * @file HttpBenchmark.cpp
+ * @brief HttpClient 吞吐量基准
+ * @details 在本机起一个 HTTP 服务器，用 HttpClient::send 发 1000 个 GET 请求，统计每秒完成的请求数：
+ *          最多 1 个并发请求（像原来一个请求接一个请求地处理），和默认的 6 个并发请求。
+ *          另外检查服务器返回 404 时，响应带着真实的状态码并且失败。cocos 线程只转调度器，不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "network/HttpClient.h"
+#include "libwebsockets.h"
+#include "Benchmark.h"
+#include "LocalServer.h"
+
+#include <cstring>
+#include <thread>
+
+USING_NS_CC;
+using namespace cocos2d::network;
+
+namespace {
+
+const int REQUEST_COUNT = 1000;
+const double TIMEOUT_MS = 30000.0;
+const char BODY[] = "{\"score\":1024,\"level\":3}";
+
+/**
+ * @brief /missing 返回 404，其余路径返回一小段 JSON，连接保持以便复用
+ */
+int onHttpCallback(struct lws* wsi, enum lws_callback_reasons reason, void* user, void* in, size_t len)
+{
+    if (reason != LWS_CALLBACK_HTTP) {
+        return 0;
+    }
+
+    bool missing = strcmp((const char*)in, "/missing") == 0;
+    unsigned char headers[LWS_PRE + 512];
+    unsigned char* start = headers + LWS_PRE;
+    unsigned char* p = start;
+    unsigned char* end = headers + sizeof(headers);
+    if (lws_add_http_header_status(wsi, missing ? HTTP_STATUS_NOT_FOUND : HTTP_STATUS_OK, &p, end)
+        || lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_TYPE, (const unsigned char*)"application/json", 16, &p, end)
+        || lws_add_http_header_content_length(wsi, sizeof(BODY) - 1, &p, end)
+        || lws_finalize_http_header(wsi, &p, end)) {
+        return 1;
+    }
+    lws_write(wsi, start, p - start, LWS_WRITE_HTTP_HEADERS);
+
+    unsigned char body[LWS_PRE + sizeof(BODY)];
+    memcpy(body + LWS_PRE, BODY, sizeof(BODY) - 1);
+    lws_write(wsi, body + LWS_PRE, sizeof(BODY) - 1, LWS_WRITE_HTTP_FINAL);
+    return lws_http_transaction_completed(wsi) ? -1 : 0;
+}
+
+struct lws_protocols HTTP_PROTOCOLS[] = {
+    { "http", onHttpCallback, 0, 0, 0, nullptr, 0 },
+    { nullptr, nullptr, 0, 0, 0, nullptr, 0 }
+};
+
+/**
+ * @brief 像 cocos 线程一样转调度器，直到 done 返回 true
+ * @return 超时返回 false
+ */
+bool waitFor(const std::function<bool()>& done)
+{
+    auto scheduler = Director::getInstance()->getScheduler();
+    auto start = std::chrono::steady_clock::now();
+    while (!done()) {
+        if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > TIMEOUT_MS) {
+            return false;
+        }
+        scheduler->update(0.0f);
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+/**
+ * @brief 发出 REQUEST_COUNT 个请求，等全部回调完成
+ * @return 每秒完成的请求数，有请求失败或超时时返回 0
+ */
+double measureRequestsPerSecond(const std::string& url, int maxConcurrentRequests)
+{
+    auto client = HttpClient::getInstance();
+    client->setMaxConcurrentRequests(maxConcurrentRequests);
+
+    int completed = 0;
+    int succeeded = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REQUEST_COUNT; ++i) {
+        auto request = new (std::nothrow) HttpRequest();
+        request->setUrl(url);
+        request->setRequestType(HttpRequest::Type::GET);
+        request->setResponseCallback([&](HttpClient*, HttpResponse* response) {
+            ++completed;
+            if (response->isSucceed() && response->getResponseData()->size() == sizeof(BODY) - 1) {
+                ++succeeded;
+            }
+        });
+        client->send(request);
+        request->release();
+    }
+    if (!waitFor([&]() { return completed == REQUEST_COUNT; }) || succeeded != REQUEST_COUNT) {
+        return 0.0;
+    }
+    return REQUEST_COUNT / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief 服务器返回 404 时，响应必须失败并带着 404 和错误信息
+ */
+bool checkNotFound(const std::string& url)
+{
+    bool completed = false;
+    bool ok = false;
+    auto request = new (std::nothrow) HttpRequest();
+    request->setUrl(url);
+    request->setRequestType(HttpRequest::Type::GET);
+    request->setResponseCallback([&](HttpClient*, HttpResponse* response) {
+        completed = true;
+        ok = !response->isSucceed() && response->getResponseCode() == 404 && response->getErrorBuffer()[0] != '\0';
+    });
+    HttpClient::getInstance()->send(request);
+    request->release();
+    return waitFor([&]() { return completed; }) && ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::LocalServer server;
+    if (!server.start(HTTP_PROTOCOLS)) {
+        return 1;
+    }
+
+    std::string url = StringUtils::format("http://127.0.0.1:%d/", server.getPort());
+    double sequential = measureRequestsPerSecond(url + "score", 1);
+    double concurrent = measureRequestsPerSecond(url + "score", 6);
+    bool notFound = checkNotFound(url + "missing");
+
+    HttpClient::destroyInstance();
+    server.stop();
+
+    printf("HttpClient, %d GET requests to a local server on port %d\n", REQUEST_COUNT, server.getPort());
+    benchmark::reportCount("1 concurrent request", sequential, "requests/s");
+    benchmark::reportCount("6 concurrent requests", concurrent, "requests/s");
+    if (sequential == 0.0 || concurrent == 0.0) {
+        printf("error: some requests failed\n");
+        return 1;
+    }
+    if (!notFound) {
+        printf("error: a 404 response doesn't fail with response code 404\n");
+        return 1;
+    }
+    return 0;
+}
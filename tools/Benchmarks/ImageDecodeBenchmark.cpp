@@ -0,0 +1,138 @@
+/**
+ * @file ImageDecodeBenchmark.cpp
+ * @brief PNG/JPEG 解码基准
+ * @details 解码 Resources/res 下全部的 PNG 和 JPEG，转成 16 位纹理格式（有透明通道的转 RGBA4444，其余转 RGB565），对比：
+ *          原来先解码出整张 RGB(A) 图、再整张转换的做法，和 Image::setDecodePixelFormat 逐行解码转换的做法。
+ *          两种做法的结果必须逐字节相同。只解码不上传纹理，不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "Benchmark.h"
+#include "BenchmarkDirector.h"
+
+#include <cstring>
+
+USING_NS_CC;
+
+namespace {
+
+const int ITERATIONS = 20;
+
+struct ImageFile
+{
+    std::string path;
+    Data data;
+};
+
+bool isDecodedRowByRow(const std::string& extension)
+{
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+Texture2D::PixelFormat getTargetFormat(Image* image)
+{
+    return image->hasAlpha() ? Texture2D::PixelFormat::RGBA4444 : Texture2D::PixelFormat::RGB565;
+}
+
+/**
+ * @brief 原来的做法：先解码出整张图，再用和 Texture2D::initWithImage 相同的转换函数整张转换
+ * @param format 返回图片的目标格式
+ * @param intermediateBytes 返回整张解码图的字节数，即逐行解码省掉的那块缓冲区
+ */
+bool decodeThenConvert(const ImageFile& file, std::vector<unsigned char>& pixels, Texture2D::PixelFormat& format, ssize_t& intermediateBytes)
+{
+    Image image;
+    if (!image.initWithImageData(file.data.getBytes(), file.data.getSize())) {
+        return false;
+    }
+    format = getTargetFormat(&image);
+    auto& info = Texture2D::getPixelFormatInfoMap().at(format);
+    pixels.resize((size_t)image.getWidth() * image.getHeight() * info.bpp / 8);
+    intermediateBytes = image.getDataLen();
+    return Texture2D::convertPixels(image.getData(), image.getDataLen(), image.getRenderFormat(), format, pixels.data());
+}
+
+/**
+ * @brief 逐行解码并转换成目标格式
+ */
+bool decodeRowByRow(const ImageFile& file, Texture2D::PixelFormat format, std::vector<unsigned char>& pixels)
+{
+    Image image;
+    image.setDecodePixelFormat(format);
+    if (!image.initWithImageData(file.data.getBytes(), file.data.getSize()) || image.getRenderFormat() != format) {
+        return false;
+    }
+    pixels.assign(image.getData(), image.getData() + image.getDataLen());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::addProjectResources();
+    auto fileUtils = FileUtils::getInstance();
+    std::vector<std::string> paths;
+    fileUtils->listFilesRecursively("res", &paths);
+
+    std::vector<ImageFile> files;
+    for (const auto& path : paths) {
+        if (isDecodedRowByRow(fileUtils->getFileExtension(path))) {
+            files.push_back(ImageFile{path, fileUtils->getDataFromFile(path)});
+        }
+    }
+    if (files.empty()) {
+        printf("error: no PNG or JPEG files in Resources/res, run it from the project root\n");
+        return 1;
+    }
+
+    // 先用原来的做法得到每张图的目标格式和参考结果
+    std::vector<Texture2D::PixelFormat> formats(files.size());
+    std::vector<std::vector<unsigned char>> expected(files.size());
+    ssize_t largestIntermediate = 0;
+    ssize_t totalIntermediate = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        ssize_t intermediate = 0;
+        if (!decodeThenConvert(files[i], expected[i], formats[i], intermediate)) {
+            printf("error: can't decode and convert %s\n", files[i].path.c_str());
+            return 1;
+        }
+        largestIntermediate = std::max(largestIntermediate, intermediate);
+        totalIntermediate += intermediate;
+    }
+
+    std::vector<unsigned char> pixels;
+    bool converted = true;
+    double baseline = benchmark::measure(ITERATIONS, [&]() {
+        Texture2D::PixelFormat format;
+        ssize_t intermediate = 0;
+        for (const auto& file : files) {
+            converted = decodeThenConvert(file, pixels, format, intermediate) && converted;
+        }
+    });
+
+    bool decoded = true;
+    double optimized = benchmark::measure(ITERATIONS, [&]() {
+        for (size_t i = 0; i < files.size(); ++i) {
+            decoded = decodeRowByRow(files[i], formats[i], pixels) && decoded;
+        }
+    });
+
+    printf("Image decode, %d PNG/JPEG files in Resources/res\n", (int)files.size());
+    benchmark::compare("decode, then convert the whole image", baseline, "Image::setDecodePixelFormat (row by row)", optimized);
+    benchmark::reportCount("full-size decode buffers avoided, largest image", (double)largestIntermediate, "bytes");
+    benchmark::reportCount("full-size decode buffers avoided, all images", (double)totalIntermediate, "bytes");
+
+    if (!converted || !decoded) {
+        printf("error: some images failed to decode\n");
+        return 1;
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+        decodeRowByRow(files[i], formats[i], pixels);
+        if (pixels.size() != expected[i].size() || memcmp(pixels.data(), expected[i].data(), pixels.size()) != 0) {
+            printf("error: %s decoded row by row differs from the whole image conversion\n", files[i].path.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file LabelBatchBenchmark.cpp
+ * @brief TTF 标签合批基准
+ * @details 200 个共用一个字体图集的 TTF 标签，文字和颜色各不相同，统计一帧的 draw call 数和帧耗时。
+ *          带阴影的标签仍然每个标签单独绘制，作为合批之前的对照。
+ */
+
+#include "cocos2d.h"
+#include "Benchmark.h"
+#include "BenchmarkDirector.h"
+
+USING_NS_CC;
+
+namespace {
+
+const int LABEL_COUNT = 200;
+const int ITERATIONS = 100;
+
+/**
+ * @brief 200 个分数和关卡标签，shadow 为 true 时走不合批的绘制路径
+ */
+Scene* createLabelScene(bool shadow)
+{
+    auto scene = Scene::create();
+    TTFConfig config("fonts/arial.ttf", 20);
+    for (int i = 0; i < LABEL_COUNT; ++i) {
+        auto label = Label::createWithTTF(config, StringUtils::format("Level %d  Score %d", i + 1, i * 137 % 10000));
+        label->setTextColor(Color4B(55 + i % 200, 255 - i % 200, 128, 255));
+        label->setPosition(80.0f + (i % 5) * 190.0f, 20.0f + (i / 5) * 15.0f);
+        if (shadow) {
+            label->enableShadow();
+        }
+        scene->addChild(label);
+    }
+    return scene;
+}
+
+/**
+ * @brief 运行场景，返回一帧的 draw call 数和耗时
+ */
+bool measureScene(bool shadow, ssize_t& drawCalls, double& frameTime)
+{
+    if (!benchmark::runScene(createLabelScene(shadow))) {
+        return false;
+    }
+    frameTime = benchmark::measure(ITERATIONS, benchmark::drawFrame);
+    drawCalls = Director::getInstance()->getRenderer()->getDrawnBatches();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::addProjectResources();
+    if (!benchmark::createWindow()) {
+        return 1;
+    }
+
+    ssize_t unbatchedDrawCalls = 0;
+    ssize_t batchedDrawCalls = 0;
+    double unbatchedFrame = 0.0;
+    double batchedFrame = 0.0;
+    if (!measureScene(true, unbatchedDrawCalls, unbatchedFrame) || !measureScene(false, batchedDrawCalls, batchedFrame)) {
+        return 1;
+    }
+
+    printf("Label batching, %d TTF labels sharing a font atlas\n", LABEL_COUNT);
+    benchmark::reportCount("draw calls, labels with a shadow (not batched)", (double)unbatchedDrawCalls, "");
+    benchmark::reportCount("draw calls, normal labels (batched)", (double)batchedDrawCalls, "");
+    benchmark::compare("frame, labels with a shadow", unbatchedFrame, "frame, normal labels", batchedFrame);
+    return batchedDrawCalls < unbatchedDrawCalls ? 0 : 1;
+}
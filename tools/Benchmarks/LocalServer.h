@@ -0,0 +1,88 @@
+/**
+ * @file LocalServer.h
+ * @brief 网络基准用的本机服务器
+ * @details 在 127.0.0.1 上用 libwebsockets 监听，在自己的线程里处理连接，协议的回调由各个基准提供。
+ */
+
+#ifndef __LOCAL_SERVER_H__
+#define __LOCAL_SERVER_H__
+
+#include "libwebsockets.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace benchmark {
+
+class LocalServer
+{
+public:
+    static const int FIRST_PORT = 9002;
+    static const int PORT_COUNT = 10;
+
+    ~LocalServer()
+    {
+        stop();
+    }
+
+    /**
+     * @brief 从 FIRST_PORT 开始找一个空闲端口监听
+     * @param protocols 以空项结尾，第一个协议同时处理 HTTP 请求
+     * @return 所有端口都被占用时返回 false
+     */
+    bool start(const struct lws_protocols* protocols)
+    {
+        lws_set_log_level(LLL_ERR | LLL_WARN, nullptr);
+        for (int port = FIRST_PORT; port < FIRST_PORT + PORT_COUNT && _context == nullptr; ++port) {
+            lws_context_creation_info info;
+            memset(&info, 0, sizeof(info));
+            info.port = port;
+            info.iface = "127.0.0.1";
+            info.protocols = protocols;
+            info.gid = -1;
+            info.uid = -1;
+            _context = lws_create_context(&info);
+            _port = port;
+        }
+        if (_context == nullptr) {
+            printf("error: no free port for the local server in %d-%d\n", FIRST_PORT, FIRST_PORT + PORT_COUNT - 1);
+            return false;
+        }
+
+        _quit = false;
+        _thread = std::thread([this]() {
+            while (!_quit) {
+                lws_service(_context, 1000);
+            }
+        });
+        return true;
+    }
+
+    void stop()
+    {
+        if (_context == nullptr) {
+            return;
+        }
+        _quit = true;
+        lws_cancel_service(_context);
+        _thread.join();
+        lws_context_destroy(_context);
+        _context = nullptr;
+    }
+
+    int getPort() const
+    {
+        return _port;
+    }
+
+private:
+    struct lws_context* _context = nullptr;
+    std::thread _thread;
+    std::atomic<bool> _quit{false};
+    int _port = 0;
+};
+
+} // namespace benchmark
+
+#endif // __LOCAL_SERVER_H__
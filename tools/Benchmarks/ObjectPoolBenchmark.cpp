@@ -0,0 +1,163 @@
+/**
+ * @file ObjectPoolBenchmark.cpp
+ * @brief 对象池基准
+ * @details 一帧里突然创建 2000 个节点，每个节点带一个精灵，精灵运行 Sequence(MoveTo, CallFunc)，
+ *          然后全部移除并清空自动释放池。对象池版本用引擎的 Node、Sprite、MoveTo、Sequence 和 CallFunc；
+ *          对照版本用多了 32 个字节的子类，大小和池不同，由全局的 new 分配，构造和析构完全一样，
+ *          不用关掉 CC_ENABLE_OBJECT_POOLS 重新编译引擎就能对比。精灵的着色器需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "Benchmark.h"
+#include "BenchmarkDirector.h"
+
+USING_NS_CC;
+
+namespace {
+
+const int BURST_SIZE = 2000;
+const int ITERATIONS = 50;
+
+// 以下子类只是比父类多出 _padding，对象池只分配恰好是父类大小的对象。
+// _padding 可能放进父类末尾的对齐空隙里，所以要比父类的对齐大
+
+class UnpooledNode : public Node
+{
+public:
+    static UnpooledNode* create()
+    {
+        auto node = new (std::nothrow) UnpooledNode();
+        node->init();
+        node->autorelease();
+        return node;
+    }
+
+private:
+    char _padding[32];
+};
+
+class UnpooledSprite : public Sprite
+{
+public:
+    static UnpooledSprite* create()
+    {
+        auto sprite = new (std::nothrow) UnpooledSprite();
+        sprite->init();
+        sprite->autorelease();
+        return sprite;
+    }
+
+private:
+    char _padding[32];
+};
+
+class UnpooledMoveTo : public MoveTo
+{
+public:
+    static UnpooledMoveTo* create(float duration, const Vec2& position)
+    {
+        auto action = new (std::nothrow) UnpooledMoveTo();
+        action->initWithDuration(duration, position);
+        action->autorelease();
+        return action;
+    }
+
+private:
+    char _padding[32];
+};
+
+class UnpooledCallFunc : public CallFunc
+{
+public:
+    static UnpooledCallFunc* create(const std::function<void()>& func)
+    {
+        auto action = new (std::nothrow) UnpooledCallFunc();
+        action->initWithFunction(func);
+        action->autorelease();
+        return action;
+    }
+
+private:
+    char _padding[32];
+};
+
+class UnpooledSequence : public Sequence
+{
+public:
+    static UnpooledSequence* create(FiniteTimeAction* one, FiniteTimeAction* two)
+    {
+        auto action = new (std::nothrow) UnpooledSequence();
+        action->initWithTwoActions(one, two);
+        action->autorelease();
+        return action;
+    }
+
+private:
+    char _padding[32];
+};
+
+static_assert(sizeof(UnpooledNode) != sizeof(Node), "UnpooledNode must not fit in the Node pool");
+static_assert(sizeof(UnpooledSprite) != sizeof(Sprite), "UnpooledSprite must not fit in the Sprite pool");
+static_assert(sizeof(UnpooledMoveTo) != sizeof(MoveTo), "UnpooledMoveTo must not fit in the MoveTo pool");
+static_assert(sizeof(UnpooledCallFunc) != sizeof(CallFunc), "UnpooledCallFunc must not fit in the CallFunc pool");
+static_assert(sizeof(UnpooledSequence) != sizeof(Sequence), "UnpooledSequence must not fit in the Sequence pool");
+
+/**
+ * @brief 创建一批节点、精灵和动作，再全部销毁
+ */
+template <typename NodeType, typename SpriteType, typename MoveToType, typename CallFuncType, typename SequenceType>
+void runBurst(Node* parent)
+{
+    for (int i = 0; i < BURST_SIZE; ++i) {
+        auto node = NodeType::create();
+        auto sprite = SpriteType::create();
+        auto move = MoveToType::create(1.0f, Vec2((float)i, (float)i));
+        auto done = CallFuncType::create([]() {});
+        sprite->runAction(SequenceType::create(move, done));
+        node->addChild(sprite);
+        parent->addChild(node);
+    }
+    parent->removeAllChildren();
+    PoolManager::getInstance()->getCurrentPool()->clear();
+}
+
+/**
+ * @brief 引擎类的 create 函数，Sequence::create 是变参的，这里包装成两个参数
+ */
+struct PooledSequence
+{
+    static Sequence* create(FiniteTimeAction* one, FiniteTimeAction* two)
+    {
+        return Sequence::createWithTwoActions(one, two);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (!benchmark::createWindow()) {
+        return 1;
+    }
+
+    auto parent = Node::create();
+    parent->retain();
+
+    double unpooled = benchmark::measure(ITERATIONS, [&]() {
+        runBurst<UnpooledNode, UnpooledSprite, UnpooledMoveTo, UnpooledCallFunc, UnpooledSequence>(parent);
+    });
+    double pooled = benchmark::measure(ITERATIONS, [&]() {
+        runBurst<Node, Sprite, MoveTo, CallFunc, PooledSequence>(parent);
+    });
+
+    printf("create and destroy %d nodes with a sprite and a Sequence(MoveTo, CallFunc)\n", BURST_SIZE);
+    benchmark::compare("global new", unpooled, "object pools", pooled);
+#if CC_ENABLE_OBJECT_POOLS
+    printf("%s", allocator::ObjectPoolBase::statisticsForAllPools().c_str());
+#else
+    printf("  the object pools are off (CC_ENABLE_OBJECT_POOLS=0), both runs use the global new\n");
+#endif
+
+    parent->release();
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file SchedulerBenchmark.cpp
+ * @brief 调度器基准
+ * @details 1 万个目标，每个目标一个逐帧 update 和一个间隔不同的定时器，测量：
+ *          一帧 Scheduler::update 的耗时、全部暂停再恢复的耗时、全部取消再重新调度的耗时。
+ */
+
+#include "cocos2d.h"
+#include "Benchmark.h"
+
+USING_NS_CC;
+
+namespace {
+
+const int TARGET_COUNT = 10000;
+const int ITERATIONS = 200;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+/**
+ * @brief 调度目标，计数被调用的次数
+ */
+struct Target
+{
+    int updates = 0;
+    int timers = 0;
+
+    void update(float dt)
+    {
+        ++updates;
+    }
+};
+
+void scheduleAll(Scheduler* scheduler, std::vector<Target>& targets)
+{
+    for (size_t i = 0; i < targets.size(); ++i) {
+        Target* target = &targets[i];
+        // 优先级和间隔各不相同，定时器分散在时间轮的不同槽里
+        scheduler->scheduleUpdate(target, (int)(i % 7) - 3, false);
+        scheduler->schedule([target](float) { ++target->timers; }, target, 0.05f + (i % 100) * 0.01f, false, "timer");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto scheduler = new (std::nothrow) Scheduler();
+    std::vector<Target> targets(TARGET_COUNT);
+    scheduleAll(scheduler, targets);
+
+    double frame = benchmark::measure(ITERATIONS, [&]() {
+        scheduler->update(FRAME_TIME);
+    });
+
+    double pauseResume = benchmark::measure(ITERATIONS / 10, [&]() {
+        for (auto& target : targets) {
+            scheduler->pauseTarget(&target);
+        }
+        scheduler->update(FRAME_TIME);
+        for (auto& target : targets) {
+            scheduler->resumeTarget(&target);
+        }
+    });
+
+    double reschedule = benchmark::measure(ITERATIONS / 10, [&]() {
+        for (auto& target : targets) {
+            scheduler->unscheduleAllForTarget(&target);
+        }
+        scheduleAll(scheduler, targets);
+    });
+
+    printf("Scheduler, %d targets with an update and a timer\n", TARGET_COUNT);
+    benchmark::report("Scheduler::update, one frame", frame);
+    benchmark::report("pause, update and resume all the targets", pauseResume);
+    benchmark::report("unschedule and reschedule all the targets", reschedule);
+
+    int updates = 0;
+    int timers = 0;
+    for (auto& target : targets) {
+        updates += target.updates;
+        timers += target.timers;
+    }
+    benchmark::reportCount("update calls", updates, "");
+    benchmark::reportCount("timer calls", timers, "");
+
+    scheduler->release();
+    return updates > 0 && timers > 0 ? 0 : 1;
+}
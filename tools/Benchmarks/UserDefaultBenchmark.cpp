@@ -0,0 +1,109 @@
+/**
+ * @file UserDefaultBenchmark.cpp
+ * @brief UserDefault 读写基准
+ * @details LogStructuredUserDefault 写入 1 万个键再 flush、读出全部键、重新打开文件加载全部键。
+ *          XML 的 UserDefault 每次读写都要解析或重写整个文件，1 万个键要跑几分钟，所以只测 1000 个键，
+ *          两者都按每 1000 个键的耗时对比。只读写文件，不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "base/CCLogStructuredUserDefault.h"
+#include "Benchmark.h"
+
+USING_NS_CC;
+
+namespace {
+
+const int KEY_COUNT = 10000;
+const int XML_KEY_COUNT = 1000;
+const int ITERATIONS = 5;
+
+std::string getKey(int i)
+{
+    return StringUtils::format("level_%d_best_score", i);
+}
+
+/**
+ * @brief 写入 count 个键，值每次都不同，保证真的写文件
+ */
+void setKeys(UserDefault* store, int count, int& round)
+{
+    ++round;
+    for (int i = 0; i < count; ++i) {
+        store->setIntegerForKey(getKey(i).c_str(), i * 31 + round);
+    }
+    store->flush();
+}
+
+/**
+ * @brief 读出 count 个键，返回值与最后一次写入不同的键数
+ */
+int getKeys(UserDefault* store, int count, int round)
+{
+    int mismatched = 0;
+    for (int i = 0; i < count; ++i) {
+        if (store->getIntegerForKey(getKey(i).c_str(), -1) != i * 31 + round) {
+            ++mismatched;
+        }
+    }
+    return mismatched;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->createDirectory(fileUtils->getWritablePath());
+    std::string binPath = fileUtils->getWritablePath() + "UserDefaultBenchmark.bin";
+    fileUtils->removeFile(binPath);
+
+    int round = 0;
+    int mismatched = 0;
+    // UserDefault owns the store, destroyInstance() closes the file
+    auto store = LogStructuredUserDefault::create(binPath);
+    if (!store) {
+        printf("error: can't create %s\n", binPath.c_str());
+        return 1;
+    }
+    UserDefault::setDelegate(store);
+    double logSet = benchmark::measure(ITERATIONS, [&]() {
+        setKeys(store, KEY_COUNT, round);
+    });
+    double logGet = benchmark::measure(ITERATIONS, [&]() {
+        mismatched += getKeys(store, KEY_COUNT, round);
+    });
+    UserDefault::destroyInstance();
+
+    double logLoad = benchmark::measure(ITERATIONS, [&]() {
+        auto reopened = LogStructuredUserDefault::create(binPath);
+        UserDefault::setDelegate(reopened);
+        mismatched += reopened ? getKeys(reopened, 1, round) : 1;
+        UserDefault::destroyInstance();
+    });
+    long fileSize = fileUtils->getFileSize(binPath);
+    fileUtils->removeFile(binPath);
+
+    // 没有 delegate 时是 XML 的 UserDefault，写在可写目录下的 UserDefault.xml 里
+    auto xml = UserDefault::getInstance();
+    int xmlRound = 0;
+    double xmlSet = benchmark::measure(1, [&]() {
+        setKeys(xml, XML_KEY_COUNT, xmlRound);
+    });
+    double xmlGet = benchmark::measure(1, [&]() {
+        mismatched += getKeys(xml, XML_KEY_COUNT, xmlRound);
+    });
+    fileUtils->removeFile(UserDefault::getXMLFilePath());
+
+    double scale = (double)XML_KEY_COUNT / KEY_COUNT;
+    printf("UserDefault, %d keys (XML: %d keys), times per %d keys\n", KEY_COUNT, XML_KEY_COUNT, XML_KEY_COUNT);
+    benchmark::compare("XML UserDefault, set and flush", xmlSet, "LogStructuredUserDefault, set and flush", logSet * scale);
+    benchmark::compare("XML UserDefault, get", xmlGet, "LogStructuredUserDefault, get", logGet * scale);
+    benchmark::report("LogStructuredUserDefault, load all 10,000 keys", logLoad);
+    benchmark::reportCount("LogStructuredUserDefault file size", (double)fileSize, "bytes");
+    if (mismatched != 0) {
+        printf("error: %d values read back differ from the values set\n", mismatched);
+        return 1;
+    }
+    return 0;
+}
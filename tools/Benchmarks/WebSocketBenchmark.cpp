@@ -0,0 +1,173 @@
+/**
+ * @file WebSocketBenchmark.cpp
+ * @brief WebSocket 往返延迟基准
+ * @details 在本机起一个 libwebsockets 回显服务器，WebSocket 连上后逐条发送消息，
+ *          测量从 send 到 onMessage 回调的往返延迟。cocos 线程只转调度器，不画帧，不需要 OpenGL 窗口。
+ *          原来的网络线程每轮 lws_service 2 ms 再睡 3 ms，每条收到的消息最多多等 5 ms。
+ */
+
+#include "cocos2d.h"
+#include "network/WebSocket.h"
+#include "libwebsockets.h"
+#include "Benchmark.h"
+#include "LocalServer.h"
+
+#include <cstring>
+#include <thread>
+
+USING_NS_CC;
+using namespace cocos2d::network;
+
+namespace {
+
+const int ITERATIONS = 200;
+const size_t SMALL_MESSAGE = 64;
+const size_t LARGE_MESSAGE = 64 * 1024;
+const double TIMEOUT_MS = 5000.0;
+
+/**
+ * @brief 回显服务器的连接数据，收齐一条消息后原样发回
+ */
+struct EchoSession
+{
+    unsigned char buffer[LWS_PRE + LARGE_MESSAGE];
+    size_t length;
+    bool binary;
+};
+
+int onEchoCallback(struct lws* wsi, enum lws_callback_reasons reason, void* user, void* in, size_t len)
+{
+    auto session = static_cast<EchoSession*>(user);
+    switch (reason) {
+        case LWS_CALLBACK_ESTABLISHED:
+            session->length = 0;
+            break;
+        case LWS_CALLBACK_RECEIVE:
+            if (session->length + len > LARGE_MESSAGE) {
+                return -1;
+            }
+            memcpy(session->buffer + LWS_PRE + session->length, in, len);
+            session->length += len;
+            session->binary = lws_frame_is_binary(wsi) != 0;
+            if (lws_is_final_fragment(wsi) && lws_remaining_packet_payload(wsi) == 0) {
+                lws_callback_on_writable(wsi);
+            }
+            break;
+        case LWS_CALLBACK_SERVER_WRITEABLE:
+            if (session->length > 0) {
+                lws_write(wsi, session->buffer + LWS_PRE, session->length, session->binary ? LWS_WRITE_BINARY : LWS_WRITE_TEXT);
+                session->length = 0;
+            }
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+struct lws_protocols ECHO_PROTOCOLS[] = {
+    { "echo", onEchoCallback, sizeof(EchoSession), LARGE_MESSAGE, 0, nullptr, 0 },
+    { nullptr, nullptr, 0, 0, 0, nullptr, 0 }
+};
+
+/**
+ * @brief 记录连接状态和收到的消息数
+ */
+class EchoClient : public WebSocket::Delegate
+{
+public:
+    bool opened = false;
+    bool failed = false;
+    int received = 0;
+    size_t receivedLength = 0;
+
+    virtual void onOpen(WebSocket* ws) override
+    {
+        opened = true;
+    }
+
+    virtual void onMessage(WebSocket* ws, const WebSocket::Data& data) override
+    {
+        ++received;
+        receivedLength = (size_t)data.len;
+    }
+
+    virtual void onClose(WebSocket* ws) override
+    {
+    }
+
+    virtual void onError(WebSocket* ws, const WebSocket::ErrorCode& error) override
+    {
+        failed = true;
+    }
+};
+
+/**
+ * @brief 像 cocos 线程一样转调度器，直到 done 返回 true
+ * @return 超时或连接出错时返回 false
+ */
+bool waitFor(EchoClient& client, const std::function<bool()>& done)
+{
+    auto scheduler = Director::getInstance()->getScheduler();
+    auto start = std::chrono::steady_clock::now();
+    while (!done()) {
+        if (client.failed || std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > TIMEOUT_MS) {
+            return false;
+        }
+        scheduler->update(0.0f);
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+/**
+ * @brief 发送 message 并等它回显回来，返回往返延迟的中位数
+ */
+double measureRoundTrip(WebSocket* ws, EchoClient& client, const std::string& message, bool& ok)
+{
+    return benchmark::measure(ITERATIONS, [&]() {
+        int expected = client.received + 1;
+        if (message.size() == SMALL_MESSAGE) {
+            ws->send(message);
+        } else {
+            ws->send((const unsigned char*)message.data(), (unsigned int)message.size());
+        }
+        ok = waitFor(client, [&]() { return client.received >= expected; }) && client.receivedLength == message.size() && ok;
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::LocalServer server;
+    if (!server.start(ECHO_PROTOCOLS)) {
+        return 1;
+    }
+
+    EchoClient client;
+    auto ws = new (std::nothrow) WebSocket();
+    std::vector<std::string> protocols(1, "echo");
+    if (!ws->init(client, StringUtils::format("ws://127.0.0.1:%d", server.getPort()), &protocols)
+        || !waitFor(client, [&]() { return client.opened; })) {
+        printf("error: can't connect to the echo server\n");
+        return 1;
+    }
+
+    bool ok = true;
+    double small = measureRoundTrip(ws, client, std::string(SMALL_MESSAGE, 'a'), ok);
+    double large = measureRoundTrip(ws, client, std::string(LARGE_MESSAGE, 'b'), ok);
+
+    ws->close();
+    delete ws;
+    server.stop();
+
+    printf("WebSocket round trip, local echo server on port %d\n", server.getPort());
+    benchmark::report("64 B text message", small);
+    benchmark::report("64 KB binary message", large);
+    if (!ok) {
+        printf("error: some messages didn't come back\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file ZipReadBenchmark.cpp
+ * @brief 从 zip 包读取资源的基准
+ * @details 把 Resources/res 下的全部牌面资源各打包两份：一份不压缩（像 APK/OBB 里的 PNG 那样），一份 deflate 压缩。
+ *          测量 ZipFile::getFileData 在一个线程里把整个包读 10 遍的耗时，以及分给 4 个线程同时读的耗时，
+ *          读出的数据必须和原文件逐字节相同。只读文件，不需要 OpenGL 窗口。
+ */
+
+#include "cocos2d.h"
+#include "base/ZipUtils.h"
+#include "Benchmark.h"
+#include "BenchmarkDirector.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <zlib.h>
+
+USING_NS_CC;
+
+namespace {
+
+const int ITERATIONS = 20;
+const int THREAD_COUNT = 4;
+// 每次测量把整个包读 PASSES 遍，摊掉创建线程的开销
+const int PASSES = 10;
+
+struct Entry
+{
+    std::string name;
+    Data data;
+};
+
+void writeUInt16(std::vector<unsigned char>& out, uint16_t value)
+{
+    out.push_back((unsigned char)(value & 0xff));
+    out.push_back((unsigned char)(value >> 8));
+}
+
+void writeUInt32(std::vector<unsigned char>& out, uint32_t value)
+{
+    writeUInt16(out, (uint16_t)(value & 0xffff));
+    writeUInt16(out, (uint16_t)(value >> 16));
+}
+
+/**
+ * @brief raw deflate，和 zip 包里的格式一样，不带 zlib 头
+ */
+bool deflateRaw(const Data& data, std::vector<unsigned char>& out)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out.resize(deflateBound(&stream, (uLong)data.getSize()));
+    stream.next_in = data.getBytes();
+    stream.avail_in = (uInt)data.getSize();
+    stream.next_out = out.data();
+    stream.avail_out = (uInt)out.size();
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+/**
+ * @brief 写一个最简单的 zip 包：没有目录项、注释和 zip64，每个文件一个本地文件头，最后是中央目录
+ */
+bool writeZip(const std::string& path, const std::vector<Entry>& entries, const std::vector<bool>& compressed)
+{
+    std::vector<unsigned char> zip;
+    std::vector<unsigned char> directory;
+    std::vector<unsigned char> deflated;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        uint32_t crc = (uint32_t)crc32(0, entry.data.getBytes(), (uInt)entry.data.getSize());
+        const unsigned char* body = entry.data.getBytes();
+        size_t bodySize = (size_t)entry.data.getSize();
+        uint16_t method = 0;
+        if (compressed[i]) {
+            if (!deflateRaw(entry.data, deflated)) {
+                return false;
+            }
+            body = deflated.data();
+            bodySize = deflated.size();
+            method = Z_DEFLATED;
+        }
+
+        // 中央目录和本地文件头的公共字段
+        std::vector<unsigned char> fields;
+        writeUInt16(fields, 20);
+        writeUInt16(fields, 0);
+        writeUInt16(fields, method);
+        writeUInt16(fields, 0);
+        writeUInt16(fields, 0x21);
+        writeUInt32(fields, crc);
+        writeUInt32(fields, (uint32_t)bodySize);
+        writeUInt32(fields, (uint32_t)entry.data.getSize());
+        writeUInt16(fields, (uint16_t)entry.name.size());
+        writeUInt16(fields, 0);
+
+        writeUInt32(directory, 0x02014b50);
+        writeUInt16(directory, 20);
+        directory.insert(directory.end(), fields.begin(), fields.end());
+        writeUInt16(directory, 0);
+        writeUInt16(directory, 0);
+        writeUInt16(directory, 0);
+        writeUInt32(directory, 0);
+        writeUInt32(directory, (uint32_t)zip.size());
+        directory.insert(directory.end(), entry.name.begin(), entry.name.end());
+
+        writeUInt32(zip, 0x04034b50);
+        zip.insert(zip.end(), fields.begin(), fields.end());
+        zip.insert(zip.end(), entry.name.begin(), entry.name.end());
+        zip.insert(zip.end(), body, body + bodySize);
+    }
+
+    uint32_t directoryOffset = (uint32_t)zip.size();
+    zip.insert(zip.end(), directory.begin(), directory.end());
+    writeUInt32(zip, 0x06054b50);
+    writeUInt16(zip, 0);
+    writeUInt16(zip, 0);
+    writeUInt16(zip, (uint16_t)entries.size());
+    writeUInt16(zip, (uint16_t)entries.size());
+    writeUInt32(zip, (uint32_t)directory.size());
+    writeUInt32(zip, directoryOffset);
+    writeUInt16(zip, 0);
+
+    Data data;
+    data.copy(zip.data(), (ssize_t)zip.size());
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+/**
+ * @brief 读 PASSES 遍第 first, first + step, ... 个文件，返回和原文件相同的个数
+ */
+int readEntries(ZipFile* zip, const std::vector<Entry>& entries, size_t first, size_t step)
+{
+    int matched = 0;
+    for (size_t i = first; i < entries.size() * PASSES; i += step) {
+        const Entry& entry = entries[i % entries.size()];
+        ssize_t size = 0;
+        unsigned char* data = zip->getFileData(entry.name, &size);
+        if (data != nullptr && size == entry.data.getSize() && memcmp(data, entry.data.getBytes(), (size_t)size) == 0) {
+            ++matched;
+        }
+        free(data);
+    }
+    return matched;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::addProjectResources();
+    auto fileUtils = FileUtils::getInstance();
+    std::vector<std::string> paths;
+    fileUtils->listFilesRecursively("res", &paths);
+
+    std::vector<Entry> entries;
+    std::vector<bool> compressed;
+    for (const auto& path : paths) {
+        if (path.back() == '/' || fileUtils->getFileExtension(path) != ".png") {
+            continue;
+        }
+        Data data = fileUtils->getDataFromFile(path);
+        std::string name = path.substr(path.rfind("/res/") + 5);
+        entries.push_back(Entry{"stored/" + name, data});
+        compressed.push_back(false);
+        entries.push_back(Entry{"deflated/" + name, data});
+        compressed.push_back(true);
+    }
+    if (entries.empty()) {
+        printf("error: no PNG files in Resources/res, run it from the project root\n");
+        return 1;
+    }
+
+    std::string zipPath = fileUtils->getWritablePath() + "ZipReadBenchmark.zip";
+    if (!fileUtils->createDirectory(fileUtils->getWritablePath()) || !writeZip(zipPath, entries, compressed)) {
+        printf("error: can't write %s\n", zipPath.c_str());
+        return 1;
+    }
+    auto zip = new (std::nothrow) ZipFile(zipPath);
+
+    std::atomic<int> matched{0};
+    double serial = benchmark::measure(ITERATIONS, [&]() {
+        matched = readEntries(zip, entries, 0, 1);
+    });
+    bool serialMatched = matched == (int)entries.size() * PASSES;
+
+    double parallel = benchmark::measure(ITERATIONS, [&]() {
+        matched = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < THREAD_COUNT; ++i) {
+            threads.push_back(std::thread([&, i]() {
+                matched += readEntries(zip, entries, (size_t)i, THREAD_COUNT);
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+    bool parallelMatched = matched == (int)entries.size() * PASSES;
+
+    delete zip;
+    fileUtils->removeFile(zipPath);
+
+    printf("ZipFile read, %d card assets, stored and deflated, %d passes\n", (int)entries.size() / 2, PASSES);
+    benchmark::compare("one thread", serial, "4 threads", parallel);
+    if (!serialMatched || !parallelMatched) {
+        printf("error: some files read from the zip differ from the originals\n");
+        return 1;
+    }
+    return 0;
+}
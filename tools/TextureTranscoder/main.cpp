@@ -0,0 +1,244 @@
+/**
+ * @file main.cpp
+ * @brief 纹理压缩工具
+ * @details 离线把 PNG/JPEG/WebP 图片转换为 ETC2 纹理 (.pkm)，指定 astcenc 时同时生成 ASTC 纹理 (.astc)。
+ *          压缩纹理写在原图片旁边，运行时 TextureCache 按 GPU 支持的格式选择加载，
+ *          显存和上传数据量是 RGBA8888 的 1/4 到 1/16。
+ *
+ * 用法: TextureTranscoder [--astcenc <astcenc 路径>] [--astc-block <4x4|6x6|8x8>] [--force] <文件或目录>...
+ */
+
+#include "cocos2d.h"
+#include "base/etc2.h"
+#include "base/CCNinePatchImageParser.h"
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+/**
+ * @brief 命令行参数
+ */
+struct Options
+{
+    std::string astcenc;            ///< astcenc 可执行文件，为空时不生成 ASTC
+    std::string astcBlock = "6x6";  ///< ASTC 块大小
+    bool force = false;             ///< 忽略修改时间，全部重新生成
+};
+
+/**
+ * @brief 文件修改时间，文件不存在时返回 -1
+ */
+long long getModifiedTime(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+    return static_cast<long long>(st.st_mtime);
+}
+
+/**
+ * @brief 压缩纹理是否比原图片新
+ */
+bool isUpToDate(const std::string& source, const std::string& target, const Options& options)
+{
+    if (options.force) {
+        return false;
+    }
+    long long targetTime = getModifiedTime(target);
+    return targetTime >= 0 && targetTime >= getModifiedTime(source);
+}
+
+std::string replaceExtension(const std::string& path, const std::string& extension)
+{
+    return path.substr(0, path.find_last_of('.')) + extension;
+}
+
+/**
+ * @brief 是否需要转换的图片，九宫格图片的像素里有切分信息，不能压缩
+ */
+bool isSourceImage(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".webp")
+        && !NinePatchImageParser::isNinePatchImage(path);
+}
+
+/**
+ * @brief 读取图片并转换为 RGBA8888 像素
+ */
+bool loadRGBA(const std::string& path, int& width, int& height, std::vector<unsigned char>& pixels)
+{
+    Image image;
+    if (!image.initWithImageFile(path) || image.isCompressed()) {
+        return false;
+    }
+
+    width = image.getWidth();
+    height = image.getHeight();
+    pixels.resize(width * height * 4);
+
+    if (image.getRenderFormat() == Texture2D::PixelFormat::RGBA8888) {
+        memcpy(pixels.data(), image.getData(), pixels.size());
+        return true;
+    }
+    return Texture2D::convertPixels(image.getData(), image.getDataLen(), image.getRenderFormat(),
+                                    Texture2D::PixelFormat::RGBA8888, pixels.data());
+}
+
+/**
+ * @brief 生成 ETC2 纹理，全部不透明的图片不带 alpha 块
+ * @return 压缩后的字节数，失败返回 0
+ */
+size_t writeETC2(const std::string& source, const std::string& target)
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    if (!loadRGBA(source, width, height, pixels)) {
+        printf("error: can't read %s\n", source.c_str());
+        return 0;
+    }
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < pixels.size() && !hasAlpha; i += 4) {
+        hasAlpha = pixels[i] != 255;
+    }
+
+    size_t encodedSize = etc2_get_encoded_data_size(width, height, hasAlpha);
+    std::vector<unsigned char> pkm(ETC2_PKM_HEADER_SIZE + encodedSize);
+    etc2_pkm_format_header(pkm.data(), width, height, hasAlpha);
+    if (etc2_encode_image(pixels.data(), width, height, width * 4, hasAlpha, pkm.data() + ETC2_PKM_HEADER_SIZE) != 0) {
+        printf("error: can't encode %s\n", source.c_str());
+        return 0;
+    }
+
+    Data data;
+    data.copy(pkm.data(), pkm.size());
+    if (!FileUtils::getInstance()->writeDataToFile(data, target)) {
+        printf("error: can't write %s\n", target.c_str());
+        return 0;
+    }
+    printf("%s: %dx%d %s, %d KB -> %d KB\n", target.c_str(), width, height, hasAlpha ? "RGBA8" : "RGB8",
+           static_cast<int>(pixels.size() / 1024), static_cast<int>(encodedSize / 1024));
+    return encodedSize;
+}
+
+/**
+ * @brief 调用 astcenc 生成 ASTC 纹理，alpha 不预乘，与 ETC2 纹理一致
+ */
+bool writeASTC(const std::string& source, const std::string& target, const Options& options)
+{
+    std::string command = "\"" + options.astcenc + "\" -cl \"" + source + "\" \"" + target + "\" "
+                        + options.astcBlock + " -medium -silent";
+    if (system(command.c_str()) != 0) {
+        printf("error: %s failed\n", command.c_str());
+        return false;
+    }
+    printf("%s: ASTC %s\n", target.c_str(), options.astcBlock.c_str());
+    return true;
+}
+
+/**
+ * @brief 转换一张图片
+ * @return 是否成功，已经是最新的也算成功
+ */
+bool transcode(const std::string& source, const Options& options)
+{
+    bool ok = true;
+
+    std::string pkm = replaceExtension(source, ".pkm");
+    if (!isUpToDate(source, pkm, options)) {
+        ok = writeETC2(source, pkm) > 0;
+    }
+
+    std::string astc = replaceExtension(source, ".astc");
+    if (!options.astcenc.empty() && !isUpToDate(source, astc, options)) {
+        ok = writeASTC(source, astc, options) && ok;
+    }
+    return ok;
+}
+
+void printUsage()
+{
+    printf("usage: TextureTranscoder [--astcenc <astcenc>] [--astc-block <4x4|6x6|8x8>] [--force] <file or directory>...\n"
+           "writes an ETC2 texture (.pkm) next to each PNG, JPEG and WebP image, and an ASTC texture (.astc)\n"
+           "with astcenc. The textures are only written again when the images are newer.\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--astcenc" && i + 1 < argc) {
+            options.astcenc = argv[++i];
+        } else if (arg == "--astc-block" && i + 1 < argc) {
+            options.astcBlock = argv[++i];
+        } else if (arg == "--force") {
+            options.force = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            printUsage();
+            return 1;
+        } else if (FileUtils::getInstance()->isAbsolutePath(arg)) {
+            inputs.push_back(arg);
+        } else {
+            // FileUtils 的相对路径基于资源目录，命令行参数基于当前目录
+            char cwd[4096];
+            inputs.push_back(std::string(getcwd(cwd, sizeof(cwd)) ? cwd : ".") + "/" + arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (options.astcBlock != "4x4" && options.astcBlock != "6x6" && options.astcBlock != "8x8") {
+        printf("error: the engine only loads 4x4, 6x6 and 8x8 ASTC blocks\n");
+        return 1;
+    }
+
+    // 压缩纹理按非预乘 alpha 加载
+    Image::setPNGPremultipliedAlphaEnabled(false);
+
+    auto fileUtils = FileUtils::getInstance();
+    int failed = 0;
+    for (const auto& input : inputs) {
+        std::vector<std::string> files;
+        if (fileUtils->isDirectoryExist(input)) {
+            fileUtils->listFilesRecursively(input, &files);
+        } else {
+            files.push_back(input);
+        }
+
+        for (const auto& file : files) {
+            if (isSourceImage(file) && !transcode(file, options)) {
+                ++failed;
+            }
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}